@@ -1,5 +1,6 @@
 #include <JuceHeader.h>
 #include "MainComponent.h"
+#include "CommandLineRenderer.h"
 
 class TrackerAdjustApplication : public juce::JUCEApplication
 {
@@ -8,10 +9,21 @@ public:
 
     const juce::String getApplicationName() override { return "Tracker Adjust"; }
     const juce::String getApplicationVersion() override { return "0.1.0"; }
-    bool moreThanOneInstanceAllowed() override { return false; }
+    bool moreThanOneInstanceAllowed() override
+    {
+        // Batch renders must not be forwarded to an already running instance
+        return CommandLineRenderer::isRenderCommand (getCommandLineParameters());
+    }
 
-    void initialise (const juce::String&) override
+    void initialise (const juce::String& commandLine) override
     {
+        if (CommandLineRenderer::isRenderCommand (commandLine))
+        {
+            setApplicationReturnValue (CommandLineRenderer::run (commandLine));
+            quit();
+            return;
+        }
+
         mainWindow = std::make_unique<MainWindow> (getApplicationName());
     }
 
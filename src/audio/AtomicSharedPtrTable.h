@@ -0,0 +1,143 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <vector>
+#include <JuceHeader.h>
+
+// Fixed table of published immutable objects, one slot per index.
+//
+// Writers (message thread / loader threads) swap individual slot pointers.
+// Readers (audio thread) do an atomic pointer load plus a ref-count bump:
+// no lock, no map lookup, no heap traffic. Replaced objects are parked in a
+// retired list that only the writer side frees, so the audio thread never
+// drops the last reference and never deallocates.
+//
+// T must derive from std::enable_shared_from_this<T> and be owned by a
+// shared_ptr when published.
+template <typename T, int NumSlots>
+class AtomicSharedPtrTable
+{
+public:
+    using Ptr = std::shared_ptr<const T>;
+    static constexpr int kNumSlots = NumSlots;
+
+    AtomicSharedPtrTable()
+    {
+        for (auto& slot : slots)
+            slot.store (nullptr, std::memory_order_relaxed);
+    }
+
+    ~AtomicSharedPtrTable()
+    {
+        for (auto& slot : slots)
+            slot.store (nullptr, std::memory_order_relaxed);
+    }
+
+    //==============================================================================
+    // Writer side (message thread / loader threads)
+
+    void publish (int index, Ptr value)
+    {
+        if (! isValidSlot (index))
+            return;
+
+        const juce::ScopedLock sl (writeLock);
+        swapSlot (index, std::move (value));
+        collectGarbageLocked();
+    }
+
+    void remove (int index)
+    {
+        publish (index, nullptr);
+    }
+
+    // Makes the table hold exactly these entries. Only slots whose pointer
+    // changes are swapped, so unchanged entries stay valid for readers.
+    void assign (const std::map<int, Ptr>& entries)
+    {
+        const juce::ScopedLock sl (writeLock);
+        for (int i = 0; i < kNumSlots; ++i)
+        {
+            auto it = entries.find (i);
+            auto next = it != entries.end() ? it->second : nullptr;
+            if (next != owners[static_cast<size_t> (i)])
+                swapSlot (i, std::move (next));
+        }
+        collectGarbageLocked();
+    }
+
+    void clear()
+    {
+        const juce::ScopedLock sl (writeLock);
+        for (int i = 0; i < kNumSlots; ++i)
+            swapSlot (i, nullptr);
+        collectGarbageLocked();
+    }
+
+    // Frees retired objects that no reader holds any more.
+    // Returns the number of objects still waiting to be freed.
+    int collectGarbage()
+    {
+        const juce::ScopedLock sl (writeLock);
+        collectGarbageLocked();
+        return static_cast<int> (retired.size());
+    }
+
+    //==============================================================================
+    // Reader side (any thread, real-time safe)
+
+    // Returns the published object, or nullptr if the slot is empty.
+    Ptr acquire (int index) const noexcept
+    {
+        if (! isValidSlot (index))
+            return {};
+
+        activeReaders.fetch_add (1, std::memory_order_seq_cst);
+        const auto* raw = slots[static_cast<size_t> (index)].load (std::memory_order_seq_cst);
+        Ptr result = raw != nullptr ? raw->shared_from_this() : nullptr;
+        activeReaders.fetch_sub (1, std::memory_order_seq_cst);
+        return result;
+    }
+
+    static bool isValidSlot (int index)
+    {
+        return index >= 0 && index < kNumSlots;
+    }
+
+private:
+    std::array<std::atomic<const T*>, kNumSlots> slots;
+    std::array<Ptr, kNumSlots> owners;
+    std::vector<Ptr> retired;
+    mutable std::atomic<int> activeReaders { 0 };
+    juce::CriticalSection writeLock;
+
+    void swapSlot (int index, Ptr next)
+    {
+        const auto idx = static_cast<size_t> (index);
+        slots[idx].store (next.get(), std::memory_order_seq_cst);
+
+        if (owners[idx] != nullptr)
+            retired.push_back (std::move (owners[idx]));
+
+        owners[idx] = std::move (next);
+    }
+
+    void collectGarbageLocked()
+    {
+        // A reader between its slot load and its ref-count bump may still be
+        // about to take a reference to a retired object; wait for the next
+        // collection if any reader is mid-acquire.
+        if (activeReaders.load (std::memory_order_seq_cst) != 0)
+            return;
+
+        retired.erase (std::remove_if (retired.begin(), retired.end(),
+                                       [] (const Ptr& p) { return p.use_count() == 1; }),
+                       retired.end());
+    }
+
+    JUCE_DECLARE_NON_COPYABLE (AtomicSharedPtrTable)
+};
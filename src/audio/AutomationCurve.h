@@ -0,0 +1,126 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+#include <JuceHeader.h>
+#include "PluginAutomationData.h"
+
+// Realtime-safe breakpoint table compiled from an AutomationLane.
+//
+// Every segment between two points is stored as a cubic in the segment-local
+// position t (0..1), so Linear, Step, SCurve and Smooth (Catmull-Rom) all
+// evaluate with the same branch-free polynomial. Evaluation matches
+// AutomationLane::getValueAtRow() but never allocates, so it can run on the
+// audio thread once compiled on the message thread.
+struct CompiledAutomationCurve
+{
+    struct Segment
+    {
+        float startRow = 0.0f;
+        float endRow = 0.0f;
+        float invLength = 0.0f;
+        float c0 = 0.0f, c1 = 0.0f, c2 = 0.0f, c3 = 0.0f;
+    };
+
+    std::vector<Segment> segments;
+    float firstRow = 0.0f;
+    float lastRow = 0.0f;
+    float firstValue = 0.0f;
+    float lastValue = 0.0f;
+    bool hasPoints = false;
+
+    static CompiledAutomationCurve compile (const AutomationLane& lane)
+    {
+        CompiledAutomationCurve curve;
+        const auto& points = lane.points;
+        if (points.empty())
+            return curve;
+
+        curve.hasPoints = true;
+        curve.firstRow = static_cast<float> (points.front().row);
+        curve.lastRow = static_cast<float> (points.back().row);
+        curve.firstValue = points.front().value;
+        curve.lastValue = points.back().value;
+        curve.segments.reserve (points.size());
+
+        for (size_t i = 0; i + 1 < points.size(); ++i)
+        {
+            const auto& a = points[i];
+            const auto& b = points[i + 1];
+
+            Segment seg;
+            seg.startRow = static_cast<float> (a.row);
+            seg.endRow = static_cast<float> (b.row);
+            seg.c0 = a.value;
+
+            const float range = seg.endRow - seg.startRow;
+            if (range <= 0.0f)
+            {
+                curve.segments.push_back (seg);
+                continue;
+            }
+
+            seg.invLength = 1.0f / range;
+            const float delta = b.value - a.value;
+
+            switch (a.curveType)
+            {
+                case AutomationCurveType::Step:
+                    break;
+
+                case AutomationCurveType::SCurve:
+                    // a + delta * (3t^2 - 2t^3)
+                    seg.c2 = 3.0f * delta;
+                    seg.c3 = -2.0f * delta;
+                    break;
+
+                case AutomationCurveType::Smooth:
+                {
+                    const float p0 = (i > 0) ? points[i - 1].value : a.value;
+                    const float p1 = a.value;
+                    const float p2 = b.value;
+                    const float p3 = (i + 2 < points.size()) ? points[i + 2].value : b.value;
+                    seg.c1 = 0.5f * (-p0 + p2);
+                    seg.c2 = 0.5f * (2.0f * p0 - 5.0f * p1 + 4.0f * p2 - p3);
+                    seg.c3 = 0.5f * (-p0 + 3.0f * p1 - 3.0f * p2 + p3);
+                    break;
+                }
+
+                case AutomationCurveType::Linear:
+                default:
+                    seg.c1 = delta;
+                    break;
+            }
+
+            curve.segments.push_back (seg);
+        }
+
+        return curve;
+    }
+
+    bool isEmpty() const { return ! hasPoints; }
+
+    /** Value at a fractional row position (same semantics as AutomationLane::getValueAtRow). */
+    float evaluate (double rowPosition, float defaultValue = 0.5f) const noexcept
+    {
+        if (! hasPoints)
+            return defaultValue;
+
+        const auto row = static_cast<float> (rowPosition);
+        if (row <= firstRow)
+            return firstValue;
+        if (row >= lastRow)
+            return lastValue;
+
+        // First segment whose end lies beyond the position
+        auto it = std::upper_bound (segments.begin(), segments.end(), row,
+                                    [] (float r, const Segment& s) { return r < s.endRow; });
+        if (it == segments.end())
+            return lastValue;
+
+        const auto& seg = *it;
+        const float t = (row - seg.startRow) * seg.invLength;
+        const float value = seg.c0 + t * (seg.c1 + t * (seg.c2 + t * seg.c3));
+        return juce::jlimit (0.0f, 1.0f, value);
+    }
+};
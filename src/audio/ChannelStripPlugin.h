@@ -3,6 +3,11 @@
 #include <JuceHeader.h>
 #include <tracktion_engine/tracktion_engine.h>
 #include "MixerState.h"
+#include "FusedTrackChain.h"
+#include "ThreeBandEQ.h"
+#include "PluginAutomationStage.h"
+#include "SilenceGate.h"
+#include "Dynamics.h"
 
 namespace te = tracktion;
 
@@ -15,7 +20,8 @@ namespace te = tracktion;
  * Signal chain position:
  *   Sampler -> InstrumentEffects -> ChannelStrip -> [Insert Plugins] -> TrackOutput
  */
-class ChannelStripPlugin : public te::Plugin
+class ChannelStripPlugin : public te::Plugin,
+                           public FusedChainStage
 {
 public:
     ChannelStripPlugin (te::PluginCreationInfo);
@@ -41,19 +47,32 @@ public:
 
     void setMixState (const TrackMixState& s);
 
+    // Plugin automation for this track is applied from here, ahead of the inserts
+    void setAutomationStage (PluginAutomationStage* stage, int trackIndex)
+    {
+        automationStage = stage;
+        automationTrackIndex = trackIndex;
+    }
+
 private:
     juce::SpinLock mixStateLock;
     TrackMixState sharedMixState;
     TrackMixState localMixState;
 
-    // EQ filters (3-band)
-    juce::dsp::IIR::Filter<float> eqLowL, eqLowR;
-    juce::dsp::IIR::Filter<float> eqMidL, eqMidR;
-    juce::dsp::IIR::Filter<float> eqHighL, eqHighR;
+    // EQ (3-band)
+    ThreeBandEQ eq;
+
+    // Compressor
+    Dynamics::Compressor compressor;
+
+    // Asleep once the input has been silent for the EQ and compressor tails
+    SilenceGate silenceGate;
+    juce::int64 getTailSamples() const;
 
-    // Compressor state
-    float compEnvelope = 0.0f;
+    PluginAutomationStage* automationStage = nullptr;
+    int automationTrackIndex = -1;
 
+    void processStage (const te::PluginRenderContext&) override;
     void processEQ (juce::AudioBuffer<float>& buffer, int startSample, int numSamples);
     void processCompressor (juce::AudioBuffer<float>& buffer, int startSample, int numSamples);
 
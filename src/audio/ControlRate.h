@@ -0,0 +1,103 @@
+#pragma once
+
+#include <utility>
+#include <JuceHeader.h>
+#include "TrackerEvent.h"
+
+/**
+ * Fixed control-rate grid for the track plugins.
+ *
+ * Modulators (LFOs, envelopes, slides, portamento) step once per tick, every
+ * kInterval samples of the edit timeline, wherever the host's blocks happen
+ * to start and end. MIDI events are applied at their own sample. A block is
+ * walked in segments split at both, so the same project renders the same
+ * output at 64 or 1024 samples per block and large blocks don't step the
+ * modulation in block-sized stairs.
+ */
+namespace ControlRate
+{
+constexpr int kInterval = 32;
+
+/** Samples from position up to the next tick (kInterval when position is on one). */
+inline int samplesToNextTick (juce::int64 position) noexcept
+{
+    const auto phase = static_cast<int> (((position % kInterval) + kInterval) % kInterval);
+    return kInterval - phase;
+}
+
+inline bool isTick (juce::int64 position) noexcept
+{
+    return samplesToNextTick (position) == kInterval;
+}
+
+/**
+ * Walks a block of numSamples starting at blockStart (edit samples).
+ *
+ *  - onTick (offset) runs at every tick in the block, before events on the same sample
+ *  - onTrackerEvent (event) runs for each pattern FX event at its sample,
+ *    ahead of MIDI on the same sample
+ *  - onEvent (message) runs for each message at its sample (events are in
+ *    timestamp order, timestamps in seconds from the block start, clamped
+ *    into the block)
+ *  - render (offset, numSamples) covers each stretch between them, with
+ *    offsets relative to the block start
+ */
+template <typename Events, typename OnTick, typename OnTrackerEvent, typename OnEvent, typename Render>
+void process (juce::int64 blockStart, int numSamples, double sampleRate,
+              TrackerEventList::Range trackerEvents, const Events* events,
+              OnTick&& onTick, OnTrackerEvent&& onTrackerEvent, OnEvent&& onEvent, Render&& render)
+{
+    auto eventIt = events != nullptr ? std::begin (*events) : decltype (std::begin (*events)) {};
+    const auto eventEnd = events != nullptr ? std::end (*events) : eventIt;
+    auto trackerIt = trackerEvents.begin();
+
+    const int lastOffset = juce::jmax (0, numSamples - 1);
+    auto offsetOf = [lastOffset, sampleRate] (const auto& m)
+    {
+        return juce::jlimit (0, lastOffset, juce::roundToInt (m.getTimeStamp() * sampleRate));
+    };
+    auto trackerOffsetOf = [lastOffset, sampleRate, blockStart] (const TrackerEvent& e)
+    {
+        return static_cast<int> (juce::jlimit<juce::int64> (0, lastOffset,
+                                                            TrackerEventList::getSample (e, sampleRate) - blockStart));
+    };
+
+    for (int done = 0; done < numSamples;)
+    {
+        const auto position = blockStart + done;
+        if (isTick (position))
+            onTick (done);
+
+        while (trackerIt != trackerEvents.end() && trackerOffsetOf (*trackerIt) <= done)
+            onTrackerEvent (*trackerIt++);
+
+        while (eventIt != eventEnd && offsetOf (*eventIt) <= done)
+            onEvent (*eventIt++);
+
+        int n = juce::jmin (numSamples - done, samplesToNextTick (position));
+        if (trackerIt != trackerEvents.end())
+            n = juce::jmin (n, trackerOffsetOf (*trackerIt) - done);
+        if (eventIt != eventEnd)
+            n = juce::jmin (n, offsetOf (*eventIt) - done);
+
+        render (done, n);
+        done += n;
+    }
+
+    // Only left over when the block is empty
+    while (trackerIt != trackerEvents.end())
+        onTrackerEvent (*trackerIt++);
+    while (eventIt != eventEnd)
+        onEvent (*eventIt++);
+}
+
+/** The same walk for a block without pattern FX events. */
+template <typename Events, typename OnTick, typename OnEvent, typename Render>
+void process (juce::int64 blockStart, int numSamples, double sampleRate, const Events* events,
+              OnTick&& onTick, OnEvent&& onEvent, Render&& render)
+{
+    process (blockStart, numSamples, sampleRate, TrackerEventList::Range {}, events,
+             std::forward<OnTick> (onTick), [] (const TrackerEvent&) {},
+             std::forward<OnEvent> (onEvent), std::forward<Render> (render));
+}
+} // namespace ControlRate
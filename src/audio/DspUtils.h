@@ -4,7 +4,8 @@
 
 /**
  * Shared DSP utilities used across audio plugins.
- * Consolidates duplicated EQ, compressor, and safety limiter code.
+ * Consolidates duplicated EQ and safety limiter code (compressors and the
+ * master limiter are in Dynamics.h).
  */
 namespace DspUtils
 {
@@ -76,49 +77,6 @@ inline void process3BandEQ (juce::AudioBuffer<float>& buffer, int startSample, i
     }
 }
 
-//==============================================================================
-// Feed-forward compressor
-//==============================================================================
-
-inline void processCompressor (juce::AudioBuffer<float>& buffer, int startSample, int numSamples,
-                               double sampleRate, float& envelope,
-                               double compThreshold, double compRatio,
-                               double compAttack, double compRelease)
-{
-    if (compThreshold >= 0.0 && compRatio <= 1.0) return;
-
-    float thresholdLinear = juce::Decibels::decibelsToGain (static_cast<float> (compThreshold));
-    float ratio = static_cast<float> (juce::jmax (1.0, compRatio));
-
-    float attackCoeff  = std::exp (-1.0f / (static_cast<float> (compAttack) * 0.001f * static_cast<float> (sampleRate)));
-    float releaseCoeff = std::exp (-1.0f / (static_cast<float> (compRelease) * 0.001f * static_cast<float> (sampleRate)));
-
-    int numChannels = buffer.getNumChannels();
-
-    for (int i = 0; i < numSamples; ++i)
-    {
-        float peak = 0.0f;
-        for (int ch = 0; ch < numChannels; ++ch)
-            peak = juce::jmax (peak, std::abs (buffer.getSample (ch, startSample + i)));
-
-        if (peak > envelope)
-            envelope = attackCoeff * envelope + (1.0f - attackCoeff) * peak;
-        else
-            envelope = releaseCoeff * envelope + (1.0f - releaseCoeff) * peak;
-
-        float gain = 1.0f;
-        if (envelope > thresholdLinear && thresholdLinear > 0.0f)
-        {
-            float overDB = juce::Decibels::gainToDecibels (envelope / thresholdLinear);
-            float reductionDB = overDB * (1.0f - 1.0f / ratio);
-            gain = juce::Decibels::decibelsToGain (-reductionDB);
-        }
-
-        for (int ch = 0; ch < numChannels; ++ch)
-            buffer.getWritePointer (ch)[startSample + i] *= gain;
-    }
-}
-
 //==============================================================================
 // Safety limiter: clamp and NaN/Inf protection
 //==============================================================================
@@ -0,0 +1,463 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <JuceHeader.h>
+
+/**
+ * Compressor and limiter kernels shared by the mixer channel, channel strip
+ * and master.
+ *
+ * Blocks are processed in kChunk-sample chunks: stereo-linked peak
+ * detection, the gain computer and applying the gain are vector operations
+ * over the chunk, leaving only the envelope follower serial. Gain is worked
+ * out in the log2 domain with polynomial log2/exp2 instead of per-sample dB
+ * conversions, and attack/release coefficients are only recomputed when the
+ * settings change.
+ */
+namespace Dynamics
+{
+constexpr int kChunk = 64;
+
+/** log2 (x) for normal x > 0, within 2.2e-5 (about 0.00013 dB). */
+inline float fastLog2 (float x) noexcept
+{
+    uint32_t bits;
+    std::memcpy (&bits, &x, sizeof (bits));
+    const auto exponent = static_cast<float> (static_cast<int> ((bits >> 23) & 0xffu) - 127);
+
+    bits = (bits & 0x007fffffu) | 0x3f800000u;   // mantissa in [1, 2)
+    float m;
+    std::memcpy (&m, &bits, sizeof (m));
+
+    // log2 (1 + t) on [0, 1), exact at both ends so octaves join up
+    const float t = m - 1.0f;
+    const float p = t * (1.4417403f + t * (-0.70777018f + t * (0.412344216f + t * (-0.190319029f + t * 0.04400469f))));
+    return exponent + p;
+}
+
+/** 2^x for x <= 0, within 5e-6 relative down to 2^-125 (and tiny below that). */
+inline float fastExp2 (float x) noexcept
+{
+    // Truncation rounds towards zero, so for x <= 0 this leaves t in (0, 1]
+    // without a branch or a call to floor. The exponent is clamped as an int:
+    // clamping x first stops the loop vectorising.
+    const int whole = juce::jmax (static_cast<int> (x), -125) - 1;
+    const float t = x - static_cast<float> (whole);
+
+    // 2^t on [0, 1], exact at both ends
+    const float p = 1.0f + t * (0.692995655f + t * (0.241565598f + t * (0.0517522761f + t * 0.0136864712f)));
+
+    const auto bits = static_cast<uint32_t> (whole + 127) << 23;
+    float scale;
+    std::memcpy (&scale, &bits, sizeof (scale));
+    return p * scale;
+}
+
+/** Coefficient of a one-pole follower with this time constant. */
+inline float timeConstantCoeff (double milliseconds, double sampleRate) noexcept
+{
+    return static_cast<float> (std::exp (-1.0 / (juce::jmax (0.01, milliseconds) * 0.001 * sampleRate)));
+}
+
+/** out[i] = max (|left[i]|, |right[i]|); right may be nullptr. */
+inline void linkedPeak (float* out, const float* left, const float* right, float* scratch, int n) noexcept
+{
+    juce::FloatVectorOperations::abs (out, left, n);
+    if (right != nullptr)
+    {
+        juce::FloatVectorOperations::abs (scratch, right, n);
+        juce::FloatVectorOperations::max (out, out, scratch, n);
+    }
+}
+
+//==============================================================================
+/** Feed-forward peak compressor with a stereo-linked envelope. */
+class Compressor
+{
+public:
+    struct Settings
+    {
+        double thresholdDb = 0.0;
+        double ratio = 1.0;
+        double attackMs = 10.0;
+        double releaseMs = 100.0;
+
+        bool isActive() const { return thresholdDb < 0.0 || ratio > 1.0; }
+        bool operator== (const Settings&) const = default;
+    };
+
+    /** Works with TrackMixState, GroupBusState and MasterMixState. */
+    template <typename MixState>
+    static Settings settingsFrom (const MixState& s)
+    {
+        return { s.compThreshold, s.compRatio, s.compAttack, s.compRelease };
+    }
+
+    void prepare (double newSampleRate)
+    {
+        sampleRate = newSampleRate;
+        primed = false;
+        reset();
+    }
+
+    void reset() noexcept { envelope = 0.0f; }
+
+    /** Cheap when nothing changed; call once per block with the latest mix state. */
+    void setSettings (const Settings& newSettings) noexcept
+    {
+        if (primed && newSettings == settings)
+            return;
+
+        settings = newSettings;
+        primed = true;
+
+        threshold = static_cast<float> (std::pow (10.0, settings.thresholdDb * 0.05));
+        log2Threshold = static_cast<float> (settings.thresholdDb / (20.0 * std::log10 (2.0)));
+        slope = static_cast<float> (1.0 - 1.0 / juce::jmax (1.0, settings.ratio));
+        attackCoeff = timeConstantCoeff (settings.attackMs, sampleRate);
+        releaseCoeff = timeConstantCoeff (settings.releaseMs, sampleRate);
+    }
+
+    bool isActive() const noexcept { return settings.isActive(); }
+    float getEnvelope() const noexcept { return envelope; }
+
+    /** Processes in place. right may be nullptr for mono. */
+    void process (float* left, float* right, int numSamples) noexcept
+    {
+        if (! isActive())
+            return;
+
+        float peak[kChunk];
+        float gain[kChunk];
+
+        while (numSamples > 0)
+        {
+            const int n = juce::jmin (numSamples, kChunk);
+            linkedPeak (peak, left, right, gain, n);
+
+            // Envelope follower: the only serial part
+            float env = envelope;
+            float maxEnv = 0.0f;
+            for (int i = 0; i < n; ++i)
+            {
+                const float coeff = peak[i] > env ? attackCoeff : releaseCoeff;
+                env = peak[i] + coeff * (env - peak[i]);
+                gain[i] = env;
+                maxEnv = juce::jmax (maxEnv, env);
+            }
+            envelope = env;
+
+            // Gain computer: reduce by slope * (level - threshold) in log2 units.
+            // Chunks that stay under the threshold are left alone.
+            if (maxEnv > threshold && slope > 0.0f)
+            {
+                for (int i = 0; i < n; ++i)
+                    gain[i] = fastExp2 (slope * (log2Threshold - fastLog2 (juce::jmax (gain[i], threshold))));
+
+                juce::FloatVectorOperations::multiply (left, gain, n);
+                if (right != nullptr)
+                    juce::FloatVectorOperations::multiply (right, gain, n);
+            }
+
+            left += n;
+            if (right != nullptr)
+                right += n;
+            numSamples -= n;
+        }
+    }
+
+    void process (juce::AudioBuffer<float>& buffer, int startSample, int numSamples) noexcept
+    {
+        if (buffer.getNumChannels() >= 2)
+            process (buffer.getWritePointer (0, startSample), buffer.getWritePointer (1, startSample), numSamples);
+        else if (buffer.getNumChannels() == 1)
+            process (buffer.getWritePointer (0, startSample), nullptr, numSamples);
+    }
+
+private:
+    double sampleRate = 44100.0;
+    Settings settings;
+    bool primed = false;
+
+    float threshold = 1.0f;
+    float log2Threshold = 0.0f;
+    float slope = 0.0f;
+    float attackCoeff = 0.0f;
+    float releaseCoeff = 0.0f;
+    float envelope = 0.0f;
+};
+
+//==============================================================================
+/**
+ * Peak limiter: instant attack, exponential release.
+ *
+ * With a lookahead the audio is delayed by that long while the gain ramps
+ * down ahead of each peak (a running minimum over the lookahead window,
+ * smoothed by a moving average of the same length), so peaks come out at
+ * the threshold without the click of an instant gain change.
+ *
+ * Prepared with a fixed latency it always delays by kMaxLookaheadMs, padding
+ * the lookahead out to that, so the owner can report one latency that never
+ * changes while the lookahead setting only sets the detection window.
+ */
+class Limiter
+{
+public:
+    static constexpr double kMaxLookaheadMs = 5.0;
+
+    struct Settings
+    {
+        double thresholdDb = 0.0;
+        double releaseMs = 50.0;
+        double lookaheadMs = 0.0;
+
+        bool isActive() const { return thresholdDb < 0.0; }
+        bool operator== (const Settings&) const = default;
+    };
+
+    /** Works with MasterMixState. */
+    template <typename MixState>
+    static Settings settingsFrom (const MixState& s)
+    {
+        return { s.limiterThreshold, s.limiterRelease, s.limiterLookahead };
+    }
+
+    /** Allocates the lookahead buffers: call off the audio thread. */
+    void prepare (double newSampleRate, bool shouldUseFixedLatency = false)
+    {
+        sampleRate = newSampleRate;
+        fixedLatency = shouldUseFixedLatency;
+        const auto capacity = static_cast<size_t> (getMaxLookaheadSamples (sampleRate)) + 1;
+        delayLeft.assign (capacity, 0.0f);
+        delayRight.assign (capacity, 0.0f);
+        averageRing.assign (capacity, 1.0f);
+        minValues.assign (capacity + 1, 1.0f);
+        minPositions.assign (capacity + 1, 0);
+        padLeft.assign (fixedLatency ? capacity : 0, 0.0f);
+        padRight.assign (fixedLatency ? capacity : 0, 0.0f);
+
+        primed = false;
+        lookaheadSamples = 0;
+        reset();
+    }
+
+    void reset() noexcept
+    {
+        std::fill (padLeft.begin(), padLeft.end(), 0.0f);
+        std::fill (padRight.begin(), padRight.end(), 0.0f);
+        padPos = 0;
+        resetLookahead();
+    }
+
+    /** Cheap when nothing changed; call once per block with the latest mix state. */
+    void setSettings (const Settings& newSettings) noexcept
+    {
+        if (primed && newSettings == settings)
+            return;
+
+        settings = newSettings;
+        primed = true;
+
+        threshold = static_cast<float> (std::pow (10.0, settings.thresholdDb * 0.05));
+        releaseCoeff = timeConstantCoeff (settings.releaseMs, sampleRate);
+
+        const int capacity = juce::jmax (0, static_cast<int> (delayLeft.size()) - 1);
+        const int newLookahead = juce::jmin (capacity, clampedLookahead (settings.lookaheadMs, sampleRate));
+        if (newLookahead != lookaheadSamples)
+        {
+            lookaheadSamples = newLookahead;
+            resetLookahead();
+        }
+    }
+
+    bool isActive() const noexcept { return settings.isActive(); }
+
+    /** The lookahead window (0 without lookahead). */
+    int getLookaheadSamples() const noexcept { return isActive() ? lookaheadSamples : 0; }
+
+    /** Delay added to the signal: the lookahead, or always the maximum with a fixed latency. */
+    int getLatencySamples() const noexcept
+    {
+        return fixedLatency ? static_cast<int> (padLeft.size()) - 1 : getLookaheadSamples();
+    }
+
+    /** The longest lookahead at this rate, which is the fixed latency. */
+    static int getMaxLookaheadSamples (double rate) noexcept
+    {
+        return static_cast<int> (std::ceil (kMaxLookaheadMs * 0.001 * rate));
+    }
+
+    /** Processes in place. right may be nullptr for mono. */
+    void process (float* left, float* right, int numSamples) noexcept
+    {
+        if (fixedLatency)
+            pad (left, right, numSamples, getLatencySamples() - getLookaheadSamples());
+
+        if (! isActive())
+            return;
+
+        float target[kChunk];
+        float scratch[kChunk];
+
+        while (numSamples > 0)
+        {
+            const int n = juce::jmin (numSamples, kChunk);
+
+            // Gain each sample needs to sit at the threshold: min (1, threshold / peak)
+            linkedPeak (target, left, right, scratch, n);
+            juce::FloatVectorOperations::max (target, target, threshold, n);
+            for (int i = 0; i < n; ++i)
+                target[i] = threshold / target[i];
+
+            if (lookaheadSamples > 0)
+                processLookahead (left, right, target, n);
+            else
+                processInstant (left, right, target, n);
+
+            left += n;
+            if (right != nullptr)
+                right += n;
+            numSamples -= n;
+        }
+    }
+
+    void process (juce::AudioBuffer<float>& buffer, int startSample, int numSamples) noexcept
+    {
+        if (buffer.getNumChannels() >= 2)
+            process (buffer.getWritePointer (0, startSample), buffer.getWritePointer (1, startSample), numSamples);
+        else if (buffer.getNumChannels() == 1)
+            process (buffer.getWritePointer (0, startSample), nullptr, numSamples);
+    }
+
+private:
+    static int clampedLookahead (double lookaheadMs, double rate) noexcept
+    {
+        return juce::jlimit (0, getMaxLookaheadSamples (rate), juce::roundToInt (lookaheadMs * 0.001 * rate));
+    }
+
+    double sampleRate = 44100.0;
+    Settings settings;
+    bool primed = false;
+    bool fixedLatency = false;
+
+    float threshold = 1.0f;
+    float releaseCoeff = 0.0f;
+    float envelope = 1.0f;
+    int lookaheadSamples = 0;
+
+    // Lookahead state, sized for kMaxLookaheadMs in prepare()
+    std::vector<float> delayLeft, delayRight, averageRing;
+    double averageSum = 0.0;
+    int ringPos = 0;
+
+    // Running minimum of the targets over the window (monotonic queue)
+    std::vector<float> minValues;
+    std::vector<juce::int64> minPositions;
+    int minHead = 0, minTail = 0;   // minTail is one past the newest
+    juce::int64 position = 0;
+
+    void resetLookahead() noexcept
+    {
+        envelope = 1.0f;
+        std::fill (delayLeft.begin(), delayLeft.end(), 0.0f);
+        std::fill (delayRight.begin(), delayRight.end(), 0.0f);
+        std::fill (averageRing.begin(), averageRing.end(), 1.0f);
+        averageSum = static_cast<double> (lookaheadSamples);
+        ringPos = 0;
+        minHead = minTail = 0;
+        position = 0;
+    }
+
+    // Fixed latency: the delay that tops the lookahead up to the maximum
+    std::vector<float> padLeft, padRight;
+    int padPos = 0;
+
+    void pad (float* left, float* right, int n, int delay) noexcept
+    {
+        const int size = static_cast<int> (padLeft.size());
+        if (size == 0)
+            return;
+
+        for (int i = 0; i < n; ++i)
+        {
+            const auto in = static_cast<size_t> (padPos);
+            const auto out = static_cast<size_t> (padPos >= delay ? padPos - delay : padPos - delay + size);
+            padLeft[in] = left[i];
+            left[i] = padLeft[out];
+
+            if (right != nullptr)
+            {
+                padRight[in] = right[i];
+                right[i] = padRight[out];
+            }
+
+            if (++padPos == size)
+                padPos = 0;
+        }
+    }
+
+    float follow (float gainTarget) noexcept
+    {
+        envelope = gainTarget < envelope ? gainTarget
+                                         : gainTarget + releaseCoeff * (envelope - gainTarget);
+        return envelope;
+    }
+
+    void processInstant (float* left, float* right, float* gain, int n) noexcept
+    {
+        for (int i = 0; i < n; ++i)
+            gain[i] = follow (gain[i]);
+
+        juce::FloatVectorOperations::multiply (left, gain, n);
+        if (right != nullptr)
+            juce::FloatVectorOperations::multiply (right, gain, n);
+    }
+
+    void processLookahead (float* left, float* right, const float* target, int n) noexcept
+    {
+        const juce::int64 window = lookaheadSamples + 1;
+        const int capacity = static_cast<int> (minValues.size());
+        const double averageScale = 1.0 / static_cast<double> (lookaheadSamples);
+        auto previous = [capacity] (int index) { return index == 0 ? capacity - 1 : index - 1; };
+        auto next = [capacity] (int index) { return index + 1 == capacity ? 0 : index + 1; };
+
+        for (int i = 0; i < n; ++i, ++position)
+        {
+            // Lowest target over the last lookahead + 1 samples
+            while (minHead != minTail && minValues[static_cast<size_t> (previous (minTail))] >= target[i])
+                minTail = previous (minTail);
+            minValues[static_cast<size_t> (minTail)] = target[i];
+            minPositions[static_cast<size_t> (minTail)] = position;
+            minTail = next (minTail);
+            while (minPositions[static_cast<size_t> (minHead)] <= position - window)
+                minHead = next (minHead);
+
+            // Averaging lookahead samples of a gain that's already down
+            // window samples before the peak lands at or under its target
+            const float env = follow (minValues[static_cast<size_t> (minHead)]);
+            const auto pos = static_cast<size_t> (ringPos);
+            averageSum += static_cast<double> (env) - static_cast<double> (averageRing[pos]);
+            averageRing[pos] = env;
+            const auto gain = static_cast<float> (averageSum * averageScale);
+
+            const float inLeft = left[i];
+            left[i] = delayLeft[pos] * gain;
+            delayLeft[pos] = inLeft;
+
+            if (right != nullptr)
+            {
+                const float inRight = right[i];
+                right[i] = delayRight[pos] * gain;
+                delayRight[pos] = inRight;
+            }
+
+            if (++ringPos == lookaheadSamples)
+                ringPos = 0;
+        }
+    }
+};
+} // namespace Dynamics
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <JuceHeader.h>
+#include <tracktion_engine/tracktion_engine.h>
+
+namespace te = tracktion;
+
+/**
+ * A built-in track plugin that the track's sampler can run for it.
+ *
+ * On a fused track (see FusedTrackChain) the sampler renders its voices and
+ * then runs the effects, channel strip and output stages straight after on
+ * the same block, while it is still in cache. Each stage's own graph node
+ * then finds that block already done and passes it through. The sampler
+ * tags the run with the block's edit time, so a tag left over from a block
+ * the node never saw can't make it skip a later one.
+ */
+class FusedChainStage
+{
+public:
+    virtual ~FusedChainStage() = default;
+
+    /** True once the plugin is initialised for playback. */
+    bool isReadyForChain() const noexcept { return readyForChain.load (std::memory_order_acquire); }
+
+    /** Sampler side: runs the stage on the sampler's block. */
+    void processInChain (const te::PluginRenderContext& fc)
+    {
+        processStage (fc);
+        ranInChainAt.store (fc.editTime.getStart().inSeconds(), std::memory_order_release);
+    }
+
+protected:
+    void setReadyForChain (bool ready) noexcept { readyForChain.store (ready, std::memory_order_release); }
+
+    /** Own node side: true (once) if the sampler already ran the stage for this block. */
+    bool takeRanInChain (const te::PluginRenderContext& fc) noexcept
+    {
+        return ranInChainAt.exchange (kNotRun, std::memory_order_acq_rel) == fc.editTime.getStart().inSeconds();
+    }
+
+    /** The stage's processing, the same whether run by its node or the sampler. */
+    virtual void processStage (const te::PluginRenderContext& fc) = 0;
+
+private:
+    static constexpr double kNotRun = -std::numeric_limits<double>::infinity();
+
+    std::atomic<bool> readyForChain { false };
+    std::atomic<double> ranInChainAt { kNotRun };   // edit time of the block the sampler ran it on
+};
+
+/**
+ * The stages a track's sampler runs after itself, in chain order
+ * (InstrumentEffects -> ChannelStrip -> TrackOutput).
+ *
+ * TrackerEngine only publishes one while the four built-in plugins sit back
+ * to back on the track; inserts or a plugin instrument in between put the
+ * track back on the plain plugin chain. A stage bypassed since then does the
+ * same from the next block, as the chain is checked on every one. Holds a
+ * reference to each plugin so they outlive any block the sampler is running
+ * them in.
+ */
+struct FusedTrackChain : public std::enable_shared_from_this<FusedTrackChain>
+{
+    static constexpr int kNumStages = 3;
+
+    std::array<te::Plugin::Ptr, kNumStages> plugins;
+    std::array<FusedChainStage*, kNumStages> stages {};
+
+    bool isReady() const noexcept
+    {
+        for (size_t i = 0; i < stages.size(); ++i)
+            if (stages[i] == nullptr || ! stages[i]->isReadyForChain() || ! plugins[i]->isEnabled())
+                return false;
+        return true;
+    }
+};
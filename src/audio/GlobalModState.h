@@ -0,0 +1,179 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <limits>
+#include <JuceHeader.h>
+#include "ControlRate.h"
+#include "InstrumentParams.h"
+
+// Shared global modulation state for an instrument (used when ModMode == Global)
+//
+// The envelopes step on the control-rate grid, in one place per block
+// (SimpleSampler::advanceGlobalModulation, run by the send bus once every
+// track has rendered). Tracks only read it: each copies the envelopes at
+// the start of its block and steps that copy tick by tick, the same way,
+// so the shared state it picks up next block is where its copy ended.
+// Note starts and releases are queued at their edit sample and applied
+// between the ticks they fall between, so neither side depends on where
+// the host's blocks start and end.
+struct GlobalModState
+{
+    enum Stage { Idle = 0, Attack, Decay, Sustain, Release };
+
+    // One envelope's position
+    struct EnvValue
+    {
+        int stage = Idle;
+        float level = 0.0f;
+    };
+
+    // Per-destination envelope state (atomic for audio-thread safety)
+    struct AtomicEnvState
+    {
+        std::atomic<int> stage { Idle };
+        std::atomic<float> level { 0.0f };
+    };
+    std::array<AtomicEnvState, InstrumentParams::kNumModDests> envStates {};
+
+    // Track how many notes are active across all tracks using this instrument
+    std::atomic<int> activeNoteCount { 0 };
+
+    // Events queued by the tracks since the last advance (edit sample, -1 = none)
+    std::atomic<juce::int64> pendingTrigger { -1 };   // first note on: every envelope restarts
+    std::atomic<juce::int64> pendingRelease { -1 };   // last note off
+    std::atomic<juce::int64> pendingKill { -1 };      // KILL: straight to idle
+
+    EnvValue load (int dest) const noexcept
+    {
+        const auto& es = envStates[static_cast<size_t> (dest)];
+        return { es.stage.load (std::memory_order_relaxed), es.level.load (std::memory_order_relaxed) };
+    }
+
+    static bool isGlobalEnvelope (const InstrumentParams::Modulation& mod) noexcept
+    {
+        return mod.type == InstrumentParams::Modulation::Type::Envelope
+            && mod.modMode == InstrumentParams::Modulation::ModMode::Global;
+    }
+
+    static void trigger (EnvValue& env) noexcept  { env = { Attack, 0.0f }; }
+    static void release (EnvValue& env) noexcept  { if (env.stage != Idle) env.stage = Release; }
+    static void kill (EnvValue& env) noexcept     { env = { Idle, 0.0f }; }
+
+    // Steps one envelope by one tick of the control-rate grid
+    static void step (EnvValue& env, const InstrumentParams::Modulation& mod, double sampleRate) noexcept
+    {
+        const double tickDuration = static_cast<double> (ControlRate::kInterval) / sampleRate;
+
+        switch (env.stage)
+        {
+            case Idle:
+                env.level = 0.0f;
+                break;
+            case Attack:
+            {
+                double attackTime = juce::jmax (0.001, mod.attackS);
+                env.level += static_cast<float> (tickDuration / attackTime);
+                if (env.level >= 1.0f)
+                {
+                    env.level = 1.0f;
+                    env.stage = Decay;
+                }
+                break;
+            }
+            case Decay:
+            {
+                double decayTime = juce::jmax (0.001, mod.decayS);
+                float susLevel = static_cast<float> (mod.sustain) / 100.0f;
+                env.level -= static_cast<float> (tickDuration / decayTime) * (1.0f - susLevel);
+                if (env.level <= susLevel)
+                {
+                    env.level = susLevel;
+                    env.stage = Sustain;
+                }
+                break;
+            }
+            case Sustain:
+                env.level = static_cast<float> (mod.sustain) / 100.0f;
+                break;
+            case Release:
+            {
+                double releaseTime = juce::jmax (0.001, mod.releaseS);
+                env.level -= static_cast<float> (tickDuration / releaseTime) * env.level;
+                if (env.level < 0.001f)
+                {
+                    env.level = 0.0f;
+                    env.stage = Idle;
+                }
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
+    // Steps every global-mode envelope in params through the ticks of the
+    // block starting at edit sample blockStart, applying the queued events
+    // in between. An event on a tick's sample lands after that tick, as it
+    // does on the tracks.
+    void advance (const InstrumentParams& params, juce::int64 blockStart, int numSamples, double sampleRate) noexcept
+    {
+        if (numSamples <= 0 || sampleRate <= 0.0)
+            return;
+
+        std::array<EnvValue, InstrumentParams::kNumModDests> envs;
+        for (int d = 0; d < InstrumentParams::kNumModDests; ++d)
+            envs[static_cast<size_t> (d)] = load (d);
+
+        juce::int64 triggerAt = pendingTrigger.exchange (-1, std::memory_order_relaxed);
+        juce::int64 releaseAt = pendingRelease.exchange (-1, std::memory_order_relaxed);
+        juce::int64 killAt = pendingKill.exchange (-1, std::memory_order_relaxed);
+
+        // Applies the queued events before sample `limit`, earliest first
+        auto applyEventsBefore = [&] (juce::int64 limit)
+        {
+            for (;;)
+            {
+                juce::int64* next = nullptr;
+                for (auto* at : { &triggerAt, &releaseAt, &killAt })
+                    if (*at >= 0 && *at < limit && (next == nullptr || *at < *next))
+                        next = at;
+
+                if (next == nullptr)
+                    return;
+
+                for (auto& env : envs)
+                {
+                    if (next == &triggerAt)      trigger (env);
+                    else if (next == &releaseAt) release (env);
+                    else                         kill (env);
+                }
+                *next = -1;
+            }
+        };
+
+        const auto blockEnd = blockStart + numSamples;
+        for (auto tick = blockStart + ControlRate::samplesToNextTick (blockStart) % ControlRate::kInterval;
+             tick < blockEnd; tick += ControlRate::kInterval)
+        {
+            applyEventsBefore (tick);
+
+            for (int d = 0; d < InstrumentParams::kNumModDests; ++d)
+            {
+                const auto& mod = params.modulations[static_cast<size_t> (d)];
+                if (isGlobalEnvelope (mod))
+                    step (envs[static_cast<size_t> (d)], mod, sampleRate);
+            }
+        }
+
+        // Whatever else happened in the block lands before the next tick
+        applyEventsBefore (std::numeric_limits<juce::int64>::max());
+
+        for (int d = 0; d < InstrumentParams::kNumModDests; ++d)
+        {
+            auto& es = envStates[static_cast<size_t> (d)];
+            es.stage.store (envs[static_cast<size_t> (d)].stage, std::memory_order_relaxed);
+            es.level.store (envs[static_cast<size_t> (d)].level, std::memory_order_relaxed);
+        }
+    }
+};
@@ -0,0 +1,216 @@
+#include "GranularCloud.h"
+#include "SampleResampler.h"
+
+//==============================================================================
+// Windows
+//==============================================================================
+
+GrainWindows::GrainWindows()
+{
+    for (int i = 0; i <= kSize; ++i)
+    {
+        const float t = static_cast<float> (i) / static_cast<float> (kSize);
+        const float x = (t - 0.5f) * 4.0f;
+
+        tables[static_cast<size_t> (InstrumentParams::GranShape::Square)][static_cast<size_t> (i)] = 1.0f;
+        tables[static_cast<size_t> (InstrumentParams::GranShape::Triangle)][static_cast<size_t> (i)] =
+            (t < 0.5f) ? (t * 2.0f) : (2.0f - t * 2.0f);
+        tables[static_cast<size_t> (InstrumentParams::GranShape::Gauss)][static_cast<size_t> (i)] = std::exp (-x * x);
+    }
+}
+
+const GrainWindows& GrainWindows::get()
+{
+    static const GrainWindows windows;
+    return windows;
+}
+
+void GrainWindows::fill (InstrumentParams::GranShape shape, int pos, int length, float* out, int n) const noexcept
+{
+    if (shape == InstrumentParams::GranShape::Square)
+    {
+        juce::FloatVectorOperations::fill (out, 1.0f, n);
+        return;
+    }
+
+    const float* table = tables[static_cast<size_t> (shape)].data();
+    const float scale = static_cast<float> (kSize) / static_cast<float> (juce::jmax (1, length));
+    const float maxX = static_cast<float> (kSize);
+
+    for (int i = 0; i < n; ++i)
+    {
+        const float x = juce::jmin (maxX, static_cast<float> (pos + i) * scale);
+        const int i0 = juce::jmin (static_cast<int> (x), kSize - 1);
+        const float f = x - static_cast<float> (i0);
+        out[i] = table[i0] + (table[i0 + 1] - table[i0]) * f;
+    }
+}
+
+//==============================================================================
+// Cloud
+//==============================================================================
+
+void GranularCloud::start (const Settings& newSettings, bool forward, uint32_t seed) noexcept
+{
+    settings = newSettings;
+    settings.grainLength = juce::jmax (1, settings.grainLength);
+    settings.density = juce::jlimit (1, kMaxGrains, settings.density);
+    settings.spray = juce::jlimit (0.0, 1.0, settings.spray);
+
+    // Rounding up keeps at most density grains alive at once
+    interval = (settings.grainLength + settings.density - 1) / settings.density;
+    grainGain = settings.density > 1 ? 1.0f / std::sqrt (static_cast<float> (settings.density)) : 1.0f;
+    rng = seed != 0 ? seed : 0x9e3779b9u;
+
+    for (auto& g : grains)
+        g.active = false;
+
+    newest = -1;
+    direction = forward;
+    spawnGrain();
+    samplesToNextGrain = interval;
+}
+
+void GranularCloud::stop() noexcept
+{
+    for (auto& g : grains)
+        g.active = false;
+    newest = -1;
+}
+
+float GranularCloud::nextRandom() noexcept
+{
+    // xorshift32
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return static_cast<float> (rng >> 8) * (2.0f / 16777216.0f) - 1.0f;
+}
+
+void GranularCloud::spawnGrain() noexcept
+{
+    // The first grain keeps the direction it was started with; later ones
+    // follow the grain loop mode
+    if (newest >= 0)
+    {
+        switch (settings.loop)
+        {
+            case InstrumentParams::GranLoop::Forward:   direction = true; break;
+            case InstrumentParams::GranLoop::Reverse:   direction = false; break;
+            case InstrumentParams::GranLoop::Pingpong:  direction = ! direction; break;
+        }
+    }
+
+    double pos = direction ? settings.grainStart : juce::jmax (settings.grainStart, settings.grainEnd - 1.0);
+
+    if (settings.spray > 0.0)
+    {
+        const double regionLen = settings.regionEnd - settings.regionStart;
+        pos += static_cast<double> (nextRandom()) * settings.spray * regionLen * 0.5;
+        pos = juce::jlimit (settings.regionStart, juce::jmax (settings.regionStart, settings.regionEnd - 1.0), pos);
+    }
+
+    double pitchScale = 1.0;
+    if (settings.pitchSprayCents > 0.0)
+        pitchScale = SampleResampler::semitonesToRatio (static_cast<double> (nextRandom()) * settings.pitchSprayCents / 100.0);
+
+    // A free slot, else the oldest grain (only if density was lowered mid-cloud)
+    int slot = 0;
+    for (int i = 0; i < kMaxGrains; ++i)
+    {
+        if (! grains[static_cast<size_t> (i)].active)
+        {
+            slot = i;
+            break;
+        }
+
+        if (grains[static_cast<size_t> (i)].age > grains[static_cast<size_t> (slot)].age)
+            slot = i;
+    }
+
+    auto& g = grains[static_cast<size_t> (slot)];
+    g.pos = pos;
+    g.pitchScale = pitchScale;
+    g.age = 0;
+    g.forward = direction;
+    g.active = true;
+    newest = slot;
+}
+
+void GranularCloud::render (const SampleBank& bank, InstrumentParams::Interpolation quality, double baseStep,
+                            float gain, juce::AudioBuffer<float>& dest, int destStart, int numSamples,
+                            bool& forward) noexcept
+{
+    if (forward != direction)
+    {
+        direction = forward;
+        for (auto& g : grains)
+            g.forward = forward;
+    }
+
+    for (int done = 0; done < numSamples;)
+    {
+        if (samplesToNextGrain <= 0)
+        {
+            spawnGrain();
+            samplesToNextGrain += interval;
+        }
+
+        // Grains due within the block start on their own sample
+        const int n = juce::jmin (numSamples - done, samplesToNextGrain);
+
+        for (auto& g : grains)
+            if (g.active)
+                renderGrain (g, bank, quality, baseStep, gain, dest, destStart + done, n);
+
+        samplesToNextGrain -= n;
+        done += n;
+    }
+
+    forward = direction;
+}
+
+void GranularCloud::renderGrain (Grain& grain, const SampleBank& bank, InstrumentParams::Interpolation quality,
+                                 double baseStep, float gain, juce::AudioBuffer<float>& dest, int destStart,
+                                 int numSamples) noexcept
+{
+    const auto& windows = GrainWindows::get();
+    const double step = baseStep * grain.pitchScale * (grain.forward ? 1.0 : -1.0);
+    float env[SampleResampler::kChunk];
+
+    for (int done = 0; done < numSamples && grain.active;)
+    {
+        const int n = juce::jmin (numSamples - done, SampleResampler::kChunk, settings.grainLength - grain.age);
+        windows.fill (settings.shape, grain.age, settings.grainLength, env, n);
+
+        SampleResampler::render (bank, quality, grain.pos, step, dest, destStart + done, n, gain * grainGain, env);
+
+        grain.pos += step * n;
+        grain.age += n;
+        done += n;
+
+        if (grain.age >= settings.grainLength)
+            grain.active = false;
+    }
+}
+
+double GranularCloud::getNewestPosition() const noexcept
+{
+    if (newest < 0 || ! grains[static_cast<size_t> (newest)].active)
+        return -1.0;
+    return grains[static_cast<size_t> (newest)].pos;
+}
+
+void GranularCloud::setNewestPosition (double position) noexcept
+{
+    if (newest >= 0 && grains[static_cast<size_t> (newest)].active)
+        grains[static_cast<size_t> (newest)].pos = position;
+}
+
+int GranularCloud::getNumActiveGrains() const noexcept
+{
+    int count = 0;
+    for (const auto& g : grains)
+        count += g.active ? 1 : 0;
+    return count;
+}
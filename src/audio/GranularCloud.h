@@ -0,0 +1,107 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <JuceHeader.h>
+#include "InstrumentParams.h"
+#include "SampleBank.h"
+
+/**
+ * Grain windows for every GranShape, tabulated once. A grain's envelope is
+ * read from its table by linear interpolation over a whole run, so the
+ * render loop has no per-sample std::exp or branches.
+ */
+struct GrainWindows
+{
+    static constexpr int kSize = 1024;
+
+    /** The shared tables (built on first use; TrackerSamplerPlugin warms them in initialise). */
+    static const GrainWindows& get();
+
+    /** out[i] = window at (pos + i) / length, for n samples. */
+    void fill (InstrumentParams::GranShape shape, int pos, int length, float* out, int n) const noexcept;
+
+private:
+    GrainWindows();
+
+    // kSize + 1 points over [0, 1], so reads interpolate up to the last one
+    static constexpr int kNumShapes = 3;
+    std::array<std::array<float, kSize + 1>, kNumShapes> tables;
+};
+
+//==============================================================================
+/**
+ * Grain cloud for the sampler's Granular play mode.
+ *
+ * Grains are started every grainLength / density output samples, so up to
+ * density grains overlap (density 1 is the classic looping single grain).
+ * Each grain gets its start position scattered by the spray amount and its
+ * own random detune, and follows the grain loop mode for its direction. The
+ * grain pool is a fixed array inside the voice, and the cloud renders grain
+ * by grain in chunked block passes through SampleResampler.
+ */
+class GranularCloud
+{
+public:
+    static constexpr int kMaxGrains = 16;
+
+    struct Settings
+    {
+        double regionStart = 0.0;       // sample frames grains may start in
+        double regionEnd = 0.0;
+        double grainStart = 0.0;        // the unsprayed grain
+        double grainEnd = 0.0;
+        int grainLength = 64;           // output samples
+        int density = 1;                // 1-kMaxGrains overlapping grains
+        double spray = 0.0;             // 0-1, start scatter as a fraction of the region
+        double pitchSprayCents = 0.0;   // per-grain random detune, +/-
+        InstrumentParams::GranShape shape = InstrumentParams::GranShape::Triangle;
+        InstrumentParams::GranLoop loop = InstrumentParams::GranLoop::Forward;
+    };
+
+    /** Starts a new cloud with its first grain playing in the given direction. */
+    void start (const Settings& settings, bool forward, uint32_t seed) noexcept;
+    void stop() noexcept;
+
+    /**
+     * Adds numSamples of the cloud into dest. baseStep is the voice's pitch
+     * ratio (source samples per output sample). forward is the voice's
+     * direction: a change made by the caller (Bxx) turns the sounding grains,
+     * and the cloud writes back the direction of its latest grain.
+     */
+    void render (const SampleBank& bank, InstrumentParams::Interpolation quality, double baseStep, float gain,
+                 juce::AudioBuffer<float>& dest, int destStart, int numSamples, bool& forward) noexcept;
+
+    /** Read position of the most recently started grain (-1 when silent). */
+    double getNewestPosition() const noexcept;
+
+    /** Moves the most recently started grain (Pxx). */
+    void setNewestPosition (double position) noexcept;
+
+    int getNumActiveGrains() const noexcept;
+
+private:
+    struct Grain
+    {
+        double pos = 0.0;
+        double pitchScale = 1.0;
+        int age = 0;
+        bool forward = true;
+        bool active = false;
+    };
+
+    std::array<Grain, kMaxGrains> grains {};
+    Settings settings;
+    int interval = 1;
+    int samplesToNextGrain = 0;
+    int newest = -1;
+    bool direction = true;
+    float grainGain = 1.0f;
+    uint32_t rng = 1;
+
+    float nextRandom() noexcept;   // [-1, 1)
+    void spawnGrain() noexcept;
+    void renderGrain (Grain& grain, const SampleBank& bank, InstrumentParams::Interpolation quality,
+                      double baseStep, float gain, juce::AudioBuffer<float>& dest, int destStart,
+                      int numSamples) noexcept;
+};
@@ -1,10 +1,8 @@
 #include "InstrumentEffectsPlugin.h"
 #include "SimpleSampler.h"
-#include "TrackerSamplerPlugin.h"
 #include "InstrumentRouting.h"
-#include "FxParamTransport.h"
 #include "PanMapping.h"
-#include <cstdint>
+#include "ControlRate.h"
 
 const char* InstrumentEffectsPlugin::xmlTypeName = "InstrumentEffects";
 
@@ -37,35 +35,40 @@ void InstrumentEffectsPlugin::initialise (const te::PluginInitialisationInfo& in
     smoothedCutoffHz.reset (sampleRate, rampSeconds);
 
     resetModulationState();
+    silenceGate.reset();
+    setReadyForChain (true);
 }
 
 void InstrumentEffectsPlugin::deinitialise()
 {
+    setReadyForChain (false);
     svfFilter.reset();
     filterInitialized = false;
 }
 
 void InstrumentEffectsPlugin::resetModulationState()
 {
-    for (auto& lfo : lfoStates)
-    {
-        lfo.phase = 0.0;
-        lfo.currentValue = 0.0f;
-        lfo.randomHoldValue = 0.0f;
-        lfo.randomNeedsNew = true;
-    }
-    for (auto& env : envStates)
-    {
-        env.stage = EnvState::Stage::Idle;
-        env.level = 0.0f;
-    }
-    noteActive = false;
+    noteModulators.reset();
+    controls = Controls();
+    heldNotes.reset();
     currentInstrument = -1;
     lastFilterType = InstrumentParams::FilterType::Disabled;
     overrides = TrackOverrides();
     fxState.reset();
 }
 
+juce::int64 InstrumentEffectsPlugin::getTailSamples (const InstrumentParams& params) const
+{
+    if (params.filterType == InstrumentParams::FilterType::Disabled)
+        return 0;
+
+    // The SVF rings out with a time constant of Q / (pi * cutoff)
+    const float cutoffHz = juce::jmax (20.0f, juce::jmin (smoothedCutoffHz.getCurrentValue(),
+                                                          smoothedCutoffHz.getTargetValue()));
+    const double q = resonancePercentToQ (params.resonance);
+    return SilenceGate::tailForTimeConstant (q / (juce::MathConstants<double>::pi * cutoffHz) * sampleRate);
+}
+
 //==============================================================================
 // Cutoff: 0-100% → 20Hz-20kHz (logarithmic)
 //==============================================================================
@@ -82,152 +85,6 @@ float InstrumentEffectsPlugin::resonancePercentToQ (int percent)
     return 0.5f + p * 4.5f; // 0.5 to 5.0 (capped for speaker safety)
 }
 
-//==============================================================================
-// LFO computation
-//==============================================================================
-
-float InstrumentEffectsPlugin::computeLFO (LFOState& state, const InstrumentParams::Modulation& mod,
-                                            double bpm, int numSamples)
-{
-    if (mod.type != InstrumentParams::Modulation::Type::LFO || mod.amount == 0)
-        return 0.0f;
-
-    double lfoHz;
-    if (mod.lfoSpeedMode == InstrumentParams::Modulation::LFOSpeedMode::MS)
-    {
-        // BPM-independent: period in milliseconds
-        lfoHz = 1000.0 / static_cast<double> (juce::jmax (1, mod.lfoSpeedMs));
-    }
-    else
-    {
-        // LFO Hz = bpm / 60.0 * rowsPerBeat / speedInSteps
-        double stepsPerBeat = static_cast<double> (juce::jmax (1, rowsPerBeat));
-        double speedInSteps = static_cast<double> (juce::jmax (1, mod.lfoSpeed));
-        lfoHz = (bpm / 60.0) * stepsPerBeat / speedInSteps;
-    }
-
-    double phaseInc = lfoHz / sampleRate * static_cast<double> (numSamples);
-    state.phase += phaseInc;
-    if (state.phase >= 1.0)
-    {
-        state.phase -= std::floor (state.phase);
-        state.randomNeedsNew = true;
-    }
-
-    float value = 0.0f;
-    float p = static_cast<float> (state.phase);
-
-    switch (mod.lfoShape)
-    {
-        case InstrumentParams::Modulation::LFOShape::RevSaw:
-            value = 1.0f - 2.0f * p;
-            break;
-        case InstrumentParams::Modulation::LFOShape::Saw:
-            value = -1.0f + 2.0f * p;
-            break;
-        case InstrumentParams::Modulation::LFOShape::Triangle:
-            value = (p < 0.5f) ? (-1.0f + 4.0f * p) : (3.0f - 4.0f * p);
-            break;
-        case InstrumentParams::Modulation::LFOShape::Square:
-            value = (p < 0.5f) ? 1.0f : -1.0f;
-            break;
-        case InstrumentParams::Modulation::LFOShape::Random:
-            if (state.randomNeedsNew)
-            {
-                state.randomHoldValue = juce::Random::getSystemRandom().nextFloat() * 2.0f - 1.0f;
-                state.randomNeedsNew = false;
-            }
-            value = state.randomHoldValue;
-            break;
-    }
-
-    state.currentValue = value * (static_cast<float> (mod.amount) / 100.0f);
-    return state.currentValue;
-}
-
-//==============================================================================
-// Envelope computation
-//==============================================================================
-
-float InstrumentEffectsPlugin::advanceEnvelope (EnvState& state, const InstrumentParams::Modulation& mod,
-                                                 int numSamples)
-{
-    if (mod.type != InstrumentParams::Modulation::Type::Envelope)
-        return 0.0f;
-
-    double blockDuration = static_cast<double> (numSamples) / sampleRate;
-
-    switch (state.stage)
-    {
-        case EnvState::Stage::Idle:
-            state.level = 0.0f;
-            break;
-
-        case EnvState::Stage::Attack:
-        {
-            double attackTime = juce::jmax (0.001, mod.attackS);
-            state.level += static_cast<float> (blockDuration / attackTime);
-            if (state.level >= 1.0f)
-            {
-                state.level = 1.0f;
-                state.stage = EnvState::Stage::Decay;
-            }
-            break;
-        }
-
-        case EnvState::Stage::Decay:
-        {
-            double decayTime = juce::jmax (0.001, mod.decayS);
-            float susLevel = static_cast<float> (mod.sustain) / 100.0f;
-            state.level -= static_cast<float> (blockDuration / decayTime) * (1.0f - susLevel);
-            if (state.level <= susLevel)
-            {
-                state.level = susLevel;
-                state.stage = EnvState::Stage::Sustain;
-            }
-            break;
-        }
-
-        case EnvState::Stage::Sustain:
-            state.level = static_cast<float> (mod.sustain) / 100.0f;
-            break;
-
-        case EnvState::Stage::Release:
-        {
-            double releaseTime = juce::jmax (0.001, mod.releaseS);
-            state.level -= static_cast<float> (blockDuration / releaseTime) * state.level;
-            if (state.level < 0.001f)
-            {
-                state.level = 0.0f;
-                state.stage = EnvState::Stage::Idle;
-            }
-            break;
-        }
-    }
-
-    return state.level * (static_cast<float> (mod.amount) / 100.0f);
-}
-
-void InstrumentEffectsPlugin::triggerEnvelopes()
-{
-    for (auto& env : envStates)
-    {
-        env.stage = EnvState::Stage::Attack;
-        env.level = 0.0f;
-    }
-    noteActive = true;
-}
-
-void InstrumentEffectsPlugin::releaseEnvelopes()
-{
-    for (auto& env : envStates)
-    {
-        if (env.stage != EnvState::Stage::Idle)
-            env.stage = EnvState::Stage::Release;
-    }
-    noteActive = false;
-}
-
 //==============================================================================
 // Global modulation helpers
 //==============================================================================
@@ -318,97 +175,24 @@ float InstrumentEffectsPlugin::readGlobalEnvelope (int destIndex, const Instrume
     if (mod.type != InstrumentParams::Modulation::Type::Envelope || globalModState == nullptr)
         return 0.0f;
 
-    float level = globalModState->envStates[static_cast<size_t> (destIndex)].level.load (std::memory_order_relaxed);
-    return level * (static_cast<float> (mod.amount) / 100.0f);
+    // This track's copy, stepped on the same ticks as the shared state
+    return globalEnvs[static_cast<size_t> (destIndex)].level * (static_cast<float> (mod.amount) / 100.0f);
 }
 
-void InstrumentEffectsPlugin::advanceGlobalEnvelopes (const InstrumentParams& params,
-                                                      juce::int64 blockStartSample,
-                                                      int numSamples)
+void InstrumentEffectsPlugin::syncGlobalEnvelopes()
 {
-    if (globalModState == nullptr || numSamples <= 0)
-        return;
-
-    const auto blockTag = static_cast<uint64_t> (juce::jmax<juce::int64> (0, blockStartSample));
-    uint64_t expected = globalModState->lastProcessedBlock.load (std::memory_order_relaxed);
-    if (expected == blockTag)
+    if (globalModState == nullptr)
         return;
 
-    if (! globalModState->lastProcessedBlock.compare_exchange_strong (
-            expected, blockTag, std::memory_order_relaxed))
-    {
-        return;
-    }
-
-    const double blockDuration = static_cast<double> (numSamples) / sampleRate;
-
     for (int d = 0; d < InstrumentParams::kNumModDests; ++d)
-    {
-        auto& mod = params.modulations[static_cast<size_t> (d)];
-        if (mod.type != InstrumentParams::Modulation::Type::Envelope)
-            continue;
-        if (mod.modMode != InstrumentParams::Modulation::ModMode::Global)
-            continue;
-
-        auto& es = globalModState->envStates[static_cast<size_t> (d)];
-        int stage = es.stage.load (std::memory_order_relaxed);
-        float level = es.level.load (std::memory_order_relaxed);
-
-        switch (stage)
-        {
-            case 0: // Idle
-                level = 0.0f;
-                break;
-            case 1: // Attack
-            {
-                double attackTime = juce::jmax (0.001, mod.attackS);
-                level += static_cast<float> (blockDuration / attackTime);
-                if (level >= 1.0f)
-                {
-                    level = 1.0f;
-                    stage = 2; // Decay
-                }
-                break;
-            }
-            case 2: // Decay
-            {
-                double decayTime = juce::jmax (0.001, mod.decayS);
-                float susLevel = static_cast<float> (mod.sustain) / 100.0f;
-                level -= static_cast<float> (blockDuration / decayTime) * (1.0f - susLevel);
-                if (level <= susLevel)
-                {
-                    level = susLevel;
-                    stage = 3; // Sustain
-                }
-                break;
-            }
-            case 3: // Sustain
-                level = static_cast<float> (mod.sustain) / 100.0f;
-                break;
-            case 4: // Release
-            {
-                double releaseTime = juce::jmax (0.001, mod.releaseS);
-                level -= static_cast<float> (blockDuration / releaseTime) * level;
-                if (level < 0.001f)
-                {
-                    level = 0.0f;
-                    stage = 0; // Idle
-                }
-                break;
-            }
-        }
-
-        es.stage.store (stage, std::memory_order_relaxed);
-        es.level.store (level, std::memory_order_relaxed);
-    }
+        globalEnvs[static_cast<size_t> (d)] = globalModState->load (d);
 }
 
 //==============================================================================
 // Get combined modulation for a destination
 //==============================================================================
 
-float InstrumentEffectsPlugin::getModulationValue (int destIndex, const InstrumentParams& params,
-                                                    double bpm, int numSamples)
+float InstrumentEffectsPlugin::getModulationValue (int destIndex, const InstrumentParams& params)
 {
     if (destIndex < 0 || destIndex >= InstrumentParams::kNumModDests)
         return 0.0f;
@@ -429,16 +213,41 @@ float InstrumentEffectsPlugin::getModulationValue (int destIndex, const Instrume
         }
     }
 
-    // Per-note modulation (existing behavior)
-    switch (mod.type)
+    return noteModulators.getValue (destIndex);
+}
+
+void InstrumentEffectsPlugin::updateControls (const InstrumentParams& params, int numSamples)
+{
+    noteModulators.advance (params, modTiming, numSamples);
+
+    if (numSamples > 0 && globalModState != nullptr)
     {
-        case InstrumentParams::Modulation::Type::LFO:
-            return computeLFO (lfoStates[static_cast<size_t> (destIndex)], mod, bpm, numSamples);
-        case InstrumentParams::Modulation::Type::Envelope:
-            return advanceEnvelope (envStates[static_cast<size_t> (destIndex)], mod, numSamples);
-        default:
-            return 0.0f;
+        for (int d = 0; d < InstrumentParams::kNumModDests; ++d)
+        {
+            const auto& mod = params.modulations[static_cast<size_t> (d)];
+            if (GlobalModState::isGlobalEnvelope (mod))
+                GlobalModState::step (globalEnvs[static_cast<size_t> (d)], mod, sampleRate);
+        }
     }
+
+    // Volume and Cutoff use subtractive modulation (never louder / never above set cutoff)
+    // Pan uses additive modulation (swings both directions)
+    auto subtractive = [this, &params] (InstrumentParams::ModDest dest)
+    {
+        auto& mod = params.modulations[static_cast<size_t> (dest)];
+        const float amount = static_cast<float> (mod.amount) / 100.0f;
+        const float scaled = getModulationValue (static_cast<int> (dest), params);
+
+        if (mod.type == InstrumentParams::Modulation::Type::Envelope)
+            return juce::jlimit (0.0f, 1.0f, 1.0f - amount + scaled);
+        if (mod.type == InstrumentParams::Modulation::Type::LFO)
+            return juce::jlimit (0.0f, 1.0f, 1.0f - amount * 0.5f + scaled * 0.5f);
+        return 1.0f;
+    };
+
+    controls.volumeGainMult = subtractive (InstrumentParams::ModDest::Volume) * getFxVolumeGain();
+    controls.panMod = getModulationValue (static_cast<int> (InstrumentParams::ModDest::Panning), params);
+    controls.cutoffMult = subtractive (InstrumentParams::ModDest::Cutoff);
 }
 
 //==============================================================================
@@ -446,7 +255,8 @@ float InstrumentEffectsPlugin::getModulationValue (int destIndex, const Instrume
 //==============================================================================
 
 void InstrumentEffectsPlugin::processFilter (juce::AudioBuffer<float>& buffer, int startSample,
-                                              int numSamples, const InstrumentParams& params, float cutoffMult)
+                                              int numSamples, const InstrumentParams& params, float cutoffMult,
+                                              bool atTick)
 {
     if (! filterInitialized)
         return;
@@ -461,6 +271,7 @@ void InstrumentEffectsPlugin::processFilter (juce::AudioBuffer<float>& buffer, i
         int modCutoff = static_cast<int> (static_cast<float> (params.cutoff) * cutoffMult);
         modCutoff = juce::jlimit (0, 100, modCutoff);
         smoothedCutoffHz.setCurrentAndTargetValue (cutoffPercentToHz (modCutoff));
+        atTick = true;
     }
 
     if (params.filterType == InstrumentParams::FilterType::Disabled)
@@ -495,28 +306,18 @@ void InstrumentEffectsPlugin::processFilter (juce::AudioBuffer<float>& buffer, i
             return;
     }
 
-    // Process in sub-blocks of 32 samples, advancing smoothed cutoff between them
-    constexpr int subBlockSize = 32;
-    int samplesRemaining = numSamples;
-    int offset = startSample;
-
-    while (samplesRemaining > 0)
+    // The cutoff moves once per control tick; segments never cross a tick
+    if (atTick)
     {
-        int chunkSize = juce::jmin (subBlockSize, samplesRemaining);
-
         svfFilter.setCutoffFrequency (smoothedCutoffHz.getNextValue());
-        smoothedCutoffHz.skip (chunkSize - 1);
-
-        auto block = juce::dsp::AudioBlock<float> (buffer)
-                         .getSubBlock (static_cast<size_t> (offset),
-                                       static_cast<size_t> (chunkSize));
-        auto context = juce::dsp::ProcessContextReplacing<float> (block);
-        svfFilter.process (context);
-
-        offset += chunkSize;
-        samplesRemaining -= chunkSize;
+        smoothedCutoffHz.skip (ControlRate::kInterval - 1);
     }
 
+    auto block = juce::dsp::AudioBlock<float> (buffer)
+                     .getSubBlock (static_cast<size_t> (startSample), static_cast<size_t> (numSamples));
+    auto context = juce::dsp::ProcessContextReplacing<float> (block);
+    svfFilter.process (context);
+
     // NaN/Inf protection: if the filter produced bad values, clear them and reset
     for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
     {
@@ -618,51 +419,15 @@ void InstrumentEffectsPlugin::processVolumeAndPan (juce::AudioBuffer<float>& buf
 }
 
 //==============================================================================
-// FX command processing (per block)
+// FX command processing
 //==============================================================================
 
-void InstrumentEffectsPlugin::processFxCommands (int numSamples, float& pitchMod, float& fxVolumeMod)
+float InstrumentEffectsPlugin::getFxVolumeGain() const
 {
-    pitchMod = 0.0f;
-    fxVolumeMod = 1.0f;
-
-    double blockDuration = static_cast<double> (numSamples) / sampleRate;
-    double bpm = edit.tempoSequence.getTempos()[0]->getBpm();
-    const double rowsPerSecond = static_cast<double> (juce::jmax (1, rowsPerBeat)) * bpm / 60.0;
-    const double rowsThisBlock = rowsPerSecond * blockDuration;
-
-    // Sxy/Dxy: slide in tracker steps.
-    if (fxState.stepSlideActive && fxState.stepSlideSteps > 0)
-    {
-        fxState.stepSlideRowsProgress += rowsThisBlock;
-        const float t = juce::jlimit (0.0f, 1.0f,
-            static_cast<float> (fxState.stepSlideRowsProgress / static_cast<double> (fxState.stepSlideSteps)));
-        fxState.stepSlideOffset = juce::jmap (t, fxState.stepSlideStart, fxState.stepSlideTarget);
-        if (t >= 1.0f)
-            fxState.stepSlideActive = false;
-    }
-
-    // Gxx + portamento target CC28.
-    if (fxState.portaActive && fxState.portaSteps > 0 && fxState.portaTarget >= 0 && fxState.currentNote >= 0)
-    {
-        fxState.portaRowsProgress += rowsThisBlock;
-        const float t = juce::jlimit (0.0f, 1.0f,
-            static_cast<float> (fxState.portaRowsProgress / static_cast<double> (fxState.portaSteps)));
-        fxState.portaPitch = fxState.portaTargetOffset * t;
-
-        if (t >= 1.0f)
-        {
-            fxState.currentNote = fxState.portaTarget;
-            fxState.portaPitch = 0.0f;
-            fxState.portaActive = false;
-            fxState.portaRowsProgress = 0.0;
-        }
-    }
-
-    pitchMod = fxState.tuneOffset + fxState.stepSlideOffset + fxState.portaPitch;
+    float gain = 1.0f;
 
     if (overrides.volumeOverride >= 0)
-        fxVolumeMod *= static_cast<float> (overrides.volumeOverride) / 127.0f;
+        gain *= static_cast<float> (overrides.volumeOverride) / 127.0f;
 
     // Vxx volume FX: 00=silence, 7F=unity, FF=+10dB (~3.16 linear)
     if (overrides.volumeFxRaw >= 0)
@@ -673,364 +438,179 @@ void InstrumentEffectsPlugin::processFxCommands (int numSamples, float& pitchMod
             vGain = static_cast<float> (v) / 127.0f;
         else
             vGain = 1.0f + static_cast<float> (v - 0x80) * (std::pow (10.0f, 10.0f / 20.0f) - 1.0f) / 127.0f;
-        fxVolumeMod *= vGain;
+        gain *= vGain;
     }
-}
 
-//==============================================================================
-// Main processing
-//==============================================================================
+    return gain;
+}
 
-void InstrumentEffectsPlugin::applyToBuffer (const te::PluginRenderContext& fc)
+// The track's note lanes share these envelopes, so they only release
+// with the last held note. The global count is kept per note.
+void InstrumentEffectsPlugin::handleNoteRelease (bool lastHeldNote)
 {
-    if (fc.destBuffer == nullptr) return;
-
-    auto& buffer = *fc.destBuffer;
-    int startSample = fc.bufferStartSample;
-    int numSamples = fc.bufferNumSamples;
+    if (lastHeldNote)
+        noteModulators.release();
 
-    const auto blockStartTime = fc.editTime.getStart();
-    const auto blockStartSample = static_cast<juce::int64> (std::llround (blockStartTime.inSeconds() * sampleRate));
-    currentTransportBeat = edit.tempoSequence.toBeats (blockStartTime).inBeats();
+    if (globalModState != nullptr)
+    {
+        int count = globalModState->activeNoteCount.fetch_sub (1, std::memory_order_relaxed) - 1;
+        if (count <= 0)
+        {
+            globalModState->activeNoteCount.store (0, std::memory_order_relaxed);
+            globalModState->pendingRelease.store (currentEventSample, std::memory_order_relaxed);
+            for (auto& env : globalEnvs)
+                GlobalModState::release (env);
+        }
+    }
+}
 
-    auto handleNoteRelease = [this]()
+void InstrumentEffectsPlugin::handleMidiMessage (const juce::MidiMessage& m)
+{
+    if (m.isProgramChange())
     {
-        // Clear portamento target on release-style events.
-        fxState.portaTarget = -1;
-        releaseEnvelopes();
+        // Multi-instrument support: update current instrument on program change
+        const int program = m.getProgramChangeNumber();
+        currentInstrument = InstrumentRouting::decodeInstrumentFromBankAndProgram (bankSelectMsb, program);
 
-        if (globalModState != nullptr)
+        // Use preloaded per-instrument global modulation state for this track.
+        GlobalModState* switchedState = nullptr;
         {
-            int count = globalModState->activeNoteCount.fetch_sub (1, std::memory_order_relaxed) - 1;
-            if (count <= 0)
+            const juce::SpinLock::ScopedTryLockType lock (globalStateLock);
+            if (lock.isLocked())
             {
-                globalModState->activeNoteCount.store (0, std::memory_order_relaxed);
-                for (auto& es : globalModState->envStates)
+                auto it = globalStatesByInstrument.find (currentInstrument);
+                if (it != globalStatesByInstrument.end())
+                    switchedState = it->second;
+                else
                 {
-                    int stage = es.stage.load (std::memory_order_relaxed);
-                    if (stage != 0) // not Idle
-                        es.stage.store (4, std::memory_order_relaxed); // Release
+                    // Legacy fallback for old sessions using 7-bit instrument indices.
+                    auto legacyIt = globalStatesByInstrument.find (program);
+                    if (legacyIt != globalStatesByInstrument.end())
+                        switchedState = legacyIt->second;
                 }
             }
         }
-    };
-
-    // Process MIDI to track current instrument and handle CCs/global notes
-    auto decodeFxParam = [this] (int ccValue)
+        if (switchedState != nullptr && switchedState != globalModState)
+        {
+            globalModState = switchedState;
+            syncGlobalEnvelopes();
+        }
+    }
+    else if (m.isController())
     {
-        return FxParamTransport::consumeByteFromController (ccValue, fxState.pendingParamHighBit);
-    };
+        int ccNum = m.getControllerNumber();
+        int ccVal = m.getControllerValue();
 
-    if (fc.bufferForMidiMessages != nullptr)
-    {
-        bool handledAllNotesOffFlag = false;
-        if (fc.bufferForMidiMessages->isAllNotesOff)
+        if (ccNum == 0) // Bank Select MSB
         {
-            handleNoteRelease();
-            handledAllNotesOffFlag = true;
+            bankSelectMsb = ccVal & 0x7F;
         }
-
-        for (auto& m : *fc.bufferForMidiMessages)
+        else if (ccNum == 7) // Explicit volume override
         {
-            if (m.isProgramChange())
-            {
-                // Multi-instrument support: update current instrument on program change
-                const int program = m.getProgramChangeNumber();
-                currentInstrument = InstrumentRouting::decodeInstrumentFromBankAndProgram (bankSelectMsb, program);
-
-                // Use preloaded per-instrument global modulation state for this track.
-                GlobalModState* switchedState = nullptr;
-                {
-                    const juce::SpinLock::ScopedTryLockType lock (globalStateLock);
-                    if (lock.isLocked())
-                    {
-                        auto it = globalStatesByInstrument.find (currentInstrument);
-                        if (it != globalStatesByInstrument.end())
-                            switchedState = it->second;
-                        else
-                        {
-                            // Legacy fallback for old sessions using 7-bit instrument indices.
-                            auto legacyIt = globalStatesByInstrument.find (program);
-                            if (legacyIt != globalStatesByInstrument.end())
-                                switchedState = legacyIt->second;
-                        }
-                    }
-                }
-                if (switchedState != nullptr)
-                    globalModState = switchedState;
-            }
-            else if (m.isController())
-            {
-                int ccNum = m.getControllerNumber();
-                int ccVal = m.getControllerValue();
+            overrides.volumeOverride = ccVal;
+        }
+        else if (ccNum == 10) // Explicit panning override
+        {
+            overrides.panningOverride = ccVal;
+        }
+        else if (ccNum == 85) // Mod mode override (from Exy effect, encoded as dest*2+mode)
+        {
+            int dest = ccVal / 2;
+            int mode = ccVal % 2;
 
-                if (ccNum == 0) // Bank Select MSB
-                {
-                    bankSelectMsb = ccVal & 0x7F;
-                }
-                else if (ccNum == FxParamTransport::kParamHighBitCc) // FX parameter bit 7 extension
-                {
-                    fxState.pendingParamHighBit = ccVal & 0x1;
-                }
-                else if (ccNum == 39) // Row note reset
-                {
-                    fxState.tuneOffset = 0.0f;
-                    fxState.stepSlideOffset = 0.0f;
-                    fxState.stepSlideActive = false;
-                    fxState.stepSlideStart = 0.0f;
-                    fxState.stepSlideTarget = 0.0f;
-                    fxState.stepSlideSteps = 0;
-                    fxState.stepSlideRowsProgress = 0.0;
-                    fxState.portaSteps = 0;
-                    fxState.portaActive = false;
-                    fxState.portaTarget = -1;
-                    fxState.portaPitch = 0.0f;
-                    fxState.portaRowsProgress = 0.0;
-                    fxState.portaTargetOffset = 0.0f;
-                    overrides.delaySendOverride = -1;
-                    overrides.reverbSendOverride = -1;
-                    fxState.pendingParamHighBit = 0;
-                }
-                else if (ccNum == 28) // Portamento target note (don't retrigger)
-                {
-                    fxState.portaTarget = ccVal;
-                    if (fxState.portaSteps > 0 && fxState.currentNote >= 0)
-                    {
-                        fxState.portaActive = true;
-                        fxState.portaRowsProgress = 0.0;
-                        fxState.portaTargetOffset = static_cast<float> (fxState.portaTarget - fxState.currentNote);
-                        fxState.portaPitch = 0.0f;
-                    }
-                }
-                else if (ccNum == 7) // Explicit volume override
-                {
-                    overrides.volumeOverride = ccVal;
-                }
-                else if (ccNum == 10) // Explicit panning override
-                {
-                    overrides.panningOverride = ccVal;
-                }
-                else if (ccNum == 31) // Txx tune (signed two's complement)
-                {
-                    const int fxParam = decodeFxParam (ccVal);
-                    fxState.tuneOffset = static_cast<float> (static_cast<int8_t> (fxParam & 0xFF));
-                }
-                else if (ccNum == 32) // Gxx portamento speed in steps
-                {
-                    const int fxParam = decodeFxParam (ccVal);
-                    if (fxParam > 0)
-                        fxState.portaSteps = fxParam;
-                }
-                else if (ccNum == 33 || ccNum == 34) // Sxy/Dxy step slide
-                {
-                    const int fxParam = decodeFxParam (ccVal);
-                    const float semitones = static_cast<float> ((fxParam >> 4) & 0xF);
-                    const int steps = fxParam & 0xF;
-                    const float signedDelta = (ccNum == 33) ? semitones : -semitones;
-
-                    if (steps <= 0)
-                    {
-                        fxState.stepSlideOffset += signedDelta;
-                        fxState.stepSlideActive = false;
-                    }
-                    else
-                    {
-                        fxState.stepSlideActive = true;
-                        fxState.stepSlideStart = fxState.stepSlideOffset;
-                        fxState.stepSlideTarget = fxState.stepSlideOffset + signedDelta;
-                        fxState.stepSlideSteps = steps;
-                        fxState.stepSlideRowsProgress = 0.0;
-                    }
-                }
-                else if (ccNum == 35) // Yxx delay send override
-                {
-                    overrides.delaySendOverride = decodeFxParam (ccVal);
-                }
-                else if (ccNum == 36) // Rxx reverb send override
-                {
-                    overrides.reverbSendOverride = decodeFxParam (ccVal);
-                }
-                else if (ccNum == 40) // Vxx volume FX override
-                {
-                    overrides.volumeFxRaw = decodeFxParam (ccVal);
-                }
-                else if (ccNum == 85) // Mod mode override (from Exy effect, encoded as dest*2+mode)
-                {
-                    int dest = ccVal / 2;
-                    int mode = ccVal % 2;
-
-                    if (dest == 0xF) // F = all destinations
-                    {
-                        for (auto& ov : overrides.modModeOverride)
-                            ov = mode;
-                    }
-                    else if (dest < InstrumentParams::kNumModDests)
-                    {
-                        overrides.modModeOverride[static_cast<size_t> (dest)] = mode;
-                    }
-                }
-            }
-            else if (m.isNoteOn())
-            {
-                // Note-on: this is an actual retrigger (porta targets come via CC#28)
-                fxState.currentNote = m.getNoteNumber();
-                fxState.portaTarget = -1;
-                fxState.portaPitch = 0.0f;
-                fxState.pitchSlide = 0.0f;
-                fxState.volumeSlide = 0.0f;
-
-                triggerEnvelopes();
-                for (auto& lfo : lfoStates)
-                    lfo.phase = 0.0;
-
-                // Global envelope: increment note count, trigger if first note
-                if (globalModState != nullptr)
-                {
-                    int prevCount = globalModState->activeNoteCount.fetch_add (1, std::memory_order_relaxed);
-                    if (prevCount <= 0)
-                    {
-                        // First note — trigger all global envelopes
-                        for (auto& es : globalModState->envStates)
-                        {
-                            es.stage.store (1, std::memory_order_relaxed); // Attack
-                            es.level.store (0.0f, std::memory_order_relaxed);
-                        }
-                    }
-                }
-            }
-            else if (m.isNoteOff() || m.isAllNotesOff())
+            if (dest == 0xF) // F = all destinations
             {
-                if (m.isAllNotesOff())
-                {
-                    if (! handledAllNotesOffFlag)
-                        handleNoteRelease();
-                }
-                else
-                {
-                    handleNoteRelease();
-                }
+                for (auto& ov : overrides.modModeOverride)
+                    ov = mode;
             }
-            else if (m.isAllSoundOff())
+            else if (dest < InstrumentParams::kNumModDests)
             {
-                // Hard cut (KILL) — immediate silence, no release tail
-                for (auto& env : envStates)
-                {
-                    env.stage = EnvState::Stage::Idle;
-                    env.level = 0.0f;
-                }
-                noteActive = false;
-
-                // Global: hard reset
-                if (globalModState != nullptr)
-                {
-                    globalModState->activeNoteCount.store (0, std::memory_order_relaxed);
-                    for (auto& es : globalModState->envStates)
-                    {
-                        es.stage.store (0, std::memory_order_relaxed); // Idle
-                        es.level.store (0.0f, std::memory_order_relaxed);
-                    }
-                }
+                overrides.modModeOverride[static_cast<size_t> (dest)] = mode;
             }
         }
     }
-
-    // Look up current instrument params from sampler
-    InstrumentParams params;
-    bool hasParams = false;
-
-    if (sampler != nullptr && currentInstrument >= 0)
-    {
-        hasParams = sampler->getParamsIfPresent (currentInstrument, params);
-    }
-
-    if (! hasParams)
+    else if (m.isNoteOn())
     {
-        if (auto* track = dynamic_cast<te::AudioTrack*> (getOwnerTrack()))
-            if (auto* samplerPlugin = track->pluginList.findFirstPluginOfType<TrackerSamplerPlugin>())
-                samplerPlugin->setPitchOffset (0.0f);
-        return;
-    }
+        heldNotes.set (static_cast<size_t> (m.getNoteNumber()));
+        fxState.pitchSlide = 0.0f;
+        fxState.volumeSlide = 0.0f;
 
-    // Advance global envelopes once per rendered block start position.
-    advanceGlobalEnvelopes (params, blockStartSample, numSamples);
+        noteModulators.trigger();
 
-    // Get tempo for LFO sync
-    double bpm = edit.tempoSequence.getTempos()[0]->getBpm();
-
-    // Compute modulation values for this block
-    // Volume and Cutoff use subtractive modulation (never louder / never above set cutoff)
-    // Pan uses additive modulation (swings both directions)
-
-    // --- Volume: subtractive gain multiplier (0.0 = silence, 1.0 = configured volume) ---
-    float volumeGainMult = 1.0f;
-    {
-        auto& volMod = params.modulations[static_cast<size_t> (InstrumentParams::ModDest::Volume)];
-        float volAmount = static_cast<float> (volMod.amount) / 100.0f;
-        float volScaled = getModulationValue (static_cast<int> (InstrumentParams::ModDest::Volume),
-                                               params, bpm, numSamples);
-
-        if (volMod.type == InstrumentParams::Modulation::Type::Envelope)
-            volumeGainMult = juce::jlimit (0.0f, 1.0f, 1.0f - volAmount + volScaled);
-        else if (volMod.type == InstrumentParams::Modulation::Type::LFO)
-            volumeGainMult = juce::jlimit (0.0f, 1.0f, 1.0f - volAmount * 0.5f + volScaled * 0.5f);
-    }
-
-    // --- Pan: additive (swing both directions) ---
-    float panMod = getModulationValue (static_cast<int> (InstrumentParams::ModDest::Panning),
-                                        params, bpm, numSamples);
-
-    // --- Cutoff: subtractive multiplier (0.0 = fully closed, 1.0 = set cutoff) ---
-    float cutoffMult = 1.0f;
-    {
-        auto& cutMod = params.modulations[static_cast<size_t> (InstrumentParams::ModDest::Cutoff)];
-        float cutAmount = static_cast<float> (cutMod.amount) / 100.0f;
-        float cutScaled = getModulationValue (static_cast<int> (InstrumentParams::ModDest::Cutoff),
-                                               params, bpm, numSamples);
-
-        if (cutMod.type == InstrumentParams::Modulation::Type::Envelope)
-            cutoffMult = juce::jlimit (0.0f, 1.0f, 1.0f - cutAmount + cutScaled);
-        else if (cutMod.type == InstrumentParams::Modulation::Type::LFO)
-            cutoffMult = juce::jlimit (0.0f, 1.0f, 1.0f - cutAmount * 0.5f + cutScaled * 0.5f);
+        // Global envelope: increment note count, trigger if first note
+        if (globalModState != nullptr)
+        {
+            int prevCount = globalModState->activeNoteCount.fetch_add (1, std::memory_order_relaxed);
+            if (prevCount <= 0)
+            {
+                // First note — trigger all global envelopes
+                globalModState->pendingTrigger.store (currentEventSample, std::memory_order_relaxed);
+                for (auto& env : globalEnvs)
+                    GlobalModState::trigger (env);
+            }
+        }
     }
-
-    // Advance other modulators even if not directly used here
-    getModulationValue (static_cast<int> (InstrumentParams::ModDest::GranularPos),
-                        params, bpm, numSamples);
-    getModulationValue (static_cast<int> (InstrumentParams::ModDest::Finetune),
-                        params, bpm, numSamples);
-
-    // Process FX commands (arpeggio, slides, vibrato, tremolo, volume slide)
-    float fxPitchMod = 0.0f;
-    float fxVolumeMod = 1.0f;
-    processFxCommands (numSamples, fxPitchMod, fxVolumeMod);
-
-    // Apply pitch mod to sampler if present (pitch bend via sampler plugin)
-    if (std::abs (fxPitchMod) > 0.001f && sampler != nullptr)
+    else if (m.isNoteOff() || m.isAllNotesOff())
     {
-        // Apply pitch bend: find TrackerSamplerPlugin on same track and set pitch offset
-        auto* track = dynamic_cast<te::AudioTrack*> (getOwnerTrack());
-        if (track != nullptr)
+        if (m.isAllNotesOff())
+        {
+            heldNotes.reset();
+            if (! allNotesOffHandled)
+                handleNoteRelease (true);
+        }
+        else
         {
-            if (auto* samplerPlugin = track->pluginList.findFirstPluginOfType<TrackerSamplerPlugin>())
-                samplerPlugin->setPitchOffset (fxPitchMod);
+            heldNotes.reset (static_cast<size_t> (m.getNoteNumber()));
+            handleNoteRelease (heldNotes.none());
         }
     }
-    else if (sampler != nullptr)
+    else if (m.isAllSoundOff())
     {
-        auto* track = dynamic_cast<te::AudioTrack*> (getOwnerTrack());
-        if (track != nullptr)
+        // Hard cut (KILL) — immediate silence, no release tail
+        noteModulators.kill();
+        heldNotes.reset();
+
+        // Global: hard reset
+        if (globalModState != nullptr)
         {
-            if (auto* samplerPlugin = track->pluginList.findFirstPluginOfType<TrackerSamplerPlugin>())
-                samplerPlugin->setPitchOffset (0.0f);
+            globalModState->activeNoteCount.store (0, std::memory_order_relaxed);
+            globalModState->pendingKill.store (currentEventSample, std::memory_order_relaxed);
+            for (auto& env : globalEnvs)
+                GlobalModState::kill (env);
         }
     }
+}
+
+void InstrumentEffectsPlugin::handleTrackerEvent (const TrackerEvent& e)
+{
+    // Pitch, direction and position commands are the sampler's
+    switch (e.command)
+    {
+        case TrackerEvent::Command::RowReset:
+            overrides.delaySendOverride = -1;
+            overrides.reverbSendOverride = -1;
+            break;
+
+        case TrackerEvent::Command::DelaySend:   overrides.delaySendOverride = e.param; break;
+        case TrackerEvent::Command::ReverbSend:  overrides.reverbSendOverride = e.param; break;
+        case TrackerEvent::Command::Volume:      overrides.volumeFxRaw = e.param; break;
+        case TrackerEvent::Command::PortaVolume: overrides.volumeOverride = e.param; break;
+
+        default:
+            break;
+    }
+}
 
-    // Apply FX volume modifier
-    volumeGainMult *= fxVolumeMod;
+//==============================================================================
+// Main processing
+//==============================================================================
 
+void InstrumentEffectsPlugin::processSegment (juce::AudioBuffer<float>& buffer, int startSample, int numSamples,
+                                              const InstrumentParams& params, bool atTick)
+{
     // DSP chain: Volume/Pan → Filter → Overdrive → BitDepth → Safety Limiter
-    processVolumeAndPan (buffer, startSample, numSamples, params, volumeGainMult, panMod);
-    processFilter (buffer, startSample, numSamples, params, cutoffMult);
+    processVolumeAndPan (buffer, startSample, numSamples, params, controls.volumeGainMult, controls.panMod);
+    processFilter (buffer, startSample, numSamples, params, controls.cutoffMult, atTick);
     processOverdrive (buffer, startSample, numSamples, params.overdrive);
     processBitDepth (buffer, startSample, numSamples, params.bitDepth);
 
@@ -1072,17 +652,140 @@ void InstrumentEffectsPlugin::applyToBuffer (const te::PluginRenderContext& fc)
         if (reverbSendDb > -99.0f)
         {
             float reverbGain = juce::Decibels::decibelsToGain (reverbSendDb);
-            sendBuffers->addToReverb (buffer, startSample, numSamples, reverbGain);
+            sendBuffers->addToReverb (sendSlot, buffer, startSample, numSamples, reverbGain);
         }
 
         if (delaySendDb > -99.0f)
         {
             float delayGain = juce::Decibels::decibelsToGain (delaySendDb);
-            sendBuffers->addToDelay (buffer, startSample, numSamples, delayGain);
+            sendBuffers->addToDelay (sendSlot, buffer, startSample, numSamples, delayGain);
         }
     }
 }
 
+void InstrumentEffectsPlugin::applyToBuffer (const te::PluginRenderContext& fc)
+{
+    // Already run by the track's sampler (fused chain)
+    if (takeRanInChain (fc))
+        return;
+
+    processStage (fc);
+}
+
+void InstrumentEffectsPlugin::processStage (const te::PluginRenderContext& fc)
+{
+    if (fc.destBuffer == nullptr) return;
+
+    auto& buffer = *fc.destBuffer;
+    const int startSample = fc.bufferStartSample;
+    const int numSamples = fc.bufferNumSamples;
+
+    const auto blockStartTime = fc.editTime.getStart();
+    const auto blockStartSample = static_cast<juce::int64> (std::llround (blockStartTime.inSeconds() * sampleRate));
+    const double blockStartBeat = edit.tempoSequence.toBeats (blockStartTime).inBeats();
+    currentTransportBeat = blockStartBeat;
+
+    const double bpm = edit.tempoSequence.getTempos()[0]->getBpm();
+    modTiming = { sampleRate, bpm, rowsPerBeat };
+
+    // Pick up the shared envelopes where the send bus left them
+    syncGlobalEnvelopes();
+    currentEventSample = blockStartSample;
+
+    allNotesOffHandled = false;
+    if (fc.bufferForMidiMessages != nullptr && fc.bufferForMidiMessages->isAllNotesOff)
+    {
+        heldNotes.reset();
+        handleNoteRelease (true);
+        allNotesOffHandled = true;
+    }
+
+    // Look up current instrument params from sampler (published snapshot, no
+    // lock or copy); looked up again whenever a program change switches it
+    InstrumentSnapshotPtr paramsSnapshot;
+    int snapshotInstrument = -2;
+
+    auto currentParams = [&]() -> const InstrumentParams*
+    {
+        if (snapshotInstrument != currentInstrument)
+        {
+            snapshotInstrument = currentInstrument;
+            paramsSnapshot = (sampler != nullptr && currentInstrument >= 0)
+                               ? sampler->getParamsSnapshotIfPresent (currentInstrument)
+                               : nullptr;
+        }
+        return paramsSnapshot != nullptr ? &paramsSnapshot->params : nullptr;
+    };
+
+    // The pattern's FX, or a cued pattern's from the loop wrap on
+    std::shared_ptr<const TrackerEventList> events;
+    if (fc.isPlaying)
+    {
+        bool tookCue = false;
+        events = trackerEventsCue.select (trackerEvents, blockStartSample, numSamples, tookCue);
+    }
+    else
+    {
+        trackerEventsCue.reset();
+    }
+
+    const auto blockEvents = events != nullptr
+                                 ? events->getRange (blockStartSample, numSamples, sampleRate)
+                                 : TrackerEventList::Range {};
+
+    // Idle track: the input is silent and the filter has rung out. Events and
+    // modulators keep running so the next note starts from the right state;
+    // only the per-sample chain and its NaN/limiter scan are skipped.
+    if (auto* params = currentParams())
+        silenceGate.setTailSamples (getTailSamples (*params));
+
+    const bool wasSleeping = silenceGate.isSleeping();
+    const bool sleeping = silenceGate.update (SilenceGate::isSilent (buffer, startSample, numSamples), numSamples);
+    if (sleeping)
+    {
+        if (! wasSleeping)
+            svfFilter.reset();
+        buffer.clear (startSample, numSamples);
+    }
+
+    int lastTick = -1;
+
+    ControlRate::process (blockStartSample, numSamples, sampleRate, blockEvents, fc.bufferForMidiMessages,
+        [&] (int offset)
+        {
+            lastTick = offset;
+            currentTransportBeat = blockStartBeat + static_cast<double> (offset) / sampleRate * bpm / 60.0;
+
+            if (auto* params = currentParams())
+                updateControls (*params, ControlRate::kInterval);
+        },
+        [&] (const TrackerEvent& e)
+        {
+            handleTrackerEvent (e);
+
+            if (auto* params = currentParams())
+                updateControls (*params, 0);
+        },
+        [&] (const juce::MidiMessage& m)
+        {
+            currentEventSample = blockStartSample
+                               + juce::jlimit (0, juce::jmax (0, numSamples - 1), juce::roundToInt (m.getTimeStamp() * sampleRate));
+            handleMidiMessage (m);
+
+            // Triggers, releases and overrides take effect from this sample
+            if (auto* params = currentParams())
+                updateControls (*params, 0);
+        },
+        [&] (int offset, int n)
+        {
+            if (sleeping)
+                return;
+
+            if (auto* params = currentParams())
+                processSegment (buffer, startSample + offset, n, *params, offset == lastTick);
+        });
+}
+
 void InstrumentEffectsPlugin::setInstrumentIndex (int index)
 {
     currentInstrument = InstrumentRouting::clampInstrumentIndex (index);
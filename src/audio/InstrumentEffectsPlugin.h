@@ -1,18 +1,26 @@
 #pragma once
 
 #include <atomic>
+#include <bitset>
 #include <map>
 #include <JuceHeader.h>
 #include <tracktion_engine/tracktion_engine.h>
+#include "AtomicSharedPtrTable.h"
+#include "FusedTrackChain.h"
+#include "GlobalModState.h"
 #include "InstrumentParams.h"
+#include "LoopCue.h"
+#include "NoteModulators.h"
 #include "SendBuffers.h"
+#include "SilenceGate.h"
+#include "TrackerEvent.h"
 
 namespace te = tracktion;
 
 class SimpleSampler;
-struct GlobalModState;
 
-class InstrumentEffectsPlugin : public te::Plugin
+class InstrumentEffectsPlugin : public te::Plugin,
+                                public FusedChainStage
 {
 public:
     InstrumentEffectsPlugin (te::PluginCreationInfo);
@@ -41,15 +49,21 @@ public:
     void setGlobalModState (GlobalModState* state) { globalModState = state; }
     void setGlobalModStates (const std::map<int, GlobalModState*>& states);
     void setRowsPerBeat (int rpb) { rowsPerBeat = rpb; }
-    void setSendBuffers (SendBuffers* buffers) { sendBuffers = buffers; }
+    void setSendBuffers (SendBuffers* buffers, int slot = SendBuffers::kSharedSlot) { sendBuffers = buffers; sendSlot = slot; }
+    void setTrackerEvents (std::shared_ptr<const TrackerEventList> events) { trackerEvents.publish (LoopCueFollower<TrackerEventList>::kCurrentSlot, std::move (events)); }
+    void setCuedTrackerEvents (std::shared_ptr<const TrackerEventList> events) { trackerEvents.publish (LoopCueFollower<TrackerEventList>::kCuedSlot, std::move (events)); }
     void setOutputGainLinear (float gain) { outputGainLinear.store (juce::jlimit (0.0f, 1.0f, gain), std::memory_order_relaxed); }
 
+    // True while the track is idle and its filter has rung out
+    bool isSleeping() const { return silenceGate.isSleeping(); }
+
     // Callback for Fxx (Set Speed/Tempo) — called on audio thread
     std::function<void (int)> onTempoChange;
 
 private:
     SimpleSampler* sampler = nullptr;
     SendBuffers* sendBuffers = nullptr;
+    int sendSlot = SendBuffers::kSharedSlot;
     int blockSize = 512;
 
     // Current instrument state
@@ -69,7 +83,7 @@ private:
     };
     TrackOverrides overrides;
 
-    // FX command state (per-track, updated via CC messages)
+    // FX command state (per-track, updated by pattern FX events)
     struct FxState
     {
         // Arpeggio (0xy): cycle base, +x, +y semitones
@@ -81,13 +95,8 @@ private:
         int slideUpSpeed = 0;
         int slideDownSpeed = 0;
 
-        // Tone portamento (3xx)
+        // Tone portamento (3xx); Gxx, Sxy/Dxy and Txx are TrackerPitchFx in the sampler
         int portaSpeed = 0;
-        int portaTarget = -1;     // target MIDI note
-        float portaPitch = 0.0f;  // current pitch offset
-        int portaSteps = 0;
-        double portaRowsProgress = 0.0;
-        float portaTargetOffset = 0.0f;
 
         // Vibrato (4xy)
         int vibratoSpeed = 0;
@@ -111,23 +120,7 @@ private:
         int lastSpeedTempo = 0;
         int trackerSpeed = 6; // ticks per row
 
-        // 8-bit FX parameter transport helper (high bit from CC#118)
-        int pendingParamHighBit = 0;
-
-        // Current base MIDI note for pitch effects
-        int currentNote = -1;
-
-        // New symbolic command pitch state.
-        float tuneOffset = 0.0f;
-        float stepSlideOffset = 0.0f;
-        bool stepSlideActive = false;
-        float stepSlideStart = 0.0f;
-        float stepSlideTarget = 0.0f;
-        int stepSlideSteps = 0;
-        double stepSlideRowsProgress = 0.0;
-
-        // Active flags for memory effects (cleared per row, re-set by CC)
-        bool portaActive = false;
+        // Active flags for memory effects (cleared per row, re-set by events)
         bool vibratoActive = false;
         bool tremoloActive = false;
         double arpTickAccum = 0.0;
@@ -137,24 +130,12 @@ private:
             arpParam = 0; arpPhase = 0; arpTickAccum = 0.0;
             pitchSlide = 0.0f;
             slideUpSpeed = 0; slideDownSpeed = 0;
-            portaSpeed = 0; portaTarget = -1; portaPitch = 0.0f; portaActive = false;
+            portaSpeed = 0;
             vibratoSpeed = 0; vibratoDepth = 0; vibratoPhase = 0.0; vibratoActive = false;
             tremoloSpeed = 0; tremoloDepth = 0; tremoloPhase = 0.0; tremoloActive = false;
             volumeSlide = 0.0f; volSlideUp = 0; volSlideDown = 0;
             sampleOffset = 0; lastSpeedTempo = 0;
             trackerSpeed = 6;
-            pendingParamHighBit = 0;
-            currentNote = -1;
-            tuneOffset = 0.0f;
-            stepSlideOffset = 0.0f;
-            stepSlideActive = false;
-            stepSlideStart = 0.0f;
-            stepSlideTarget = 0.0f;
-            stepSlideSteps = 0;
-            stepSlideRowsProgress = 0.0;
-            portaSteps = 0;
-            portaRowsProgress = 0.0;
-            portaTargetOffset = 0.0f;
         }
     };
     FxState fxState;
@@ -164,6 +145,11 @@ private:
     juce::SpinLock globalStateLock;
     std::map<int, GlobalModState*> globalStatesByInstrument;
     double currentTransportBeat = 0.0;
+    // The shared envelopes as this track steps them through its block, and
+    // the edit sample of the MIDI event being handled (where its start or
+    // release is queued on the shared state)
+    std::array<GlobalModState::EnvValue, InstrumentParams::kNumModDests> globalEnvs {};
+    juce::int64 currentEventSample = 0;
     int rowsPerBeat = 4;
     int bankSelectMsb = 0;
     std::atomic<float> outputGainLinear { 1.0f };
@@ -175,33 +161,32 @@ private:
 
     // Filter
     juce::dsp::StateVariableTPTFilter<float> svfFilter;
+
+    // Skips the per-sample chain while the sampler is idle
+    SilenceGate silenceGate;
+    juce::int64 getTailSamples (const InstrumentParams& params) const;
     bool filterInitialized = false;
     InstrumentParams::FilterType lastFilterType = InstrumentParams::FilterType::Disabled;
 
-    // LFO state per destination
-    struct LFOState
-    {
-        double phase = 0.0;
-        float currentValue = 0.0f;
-        float randomHoldValue = 0.0f;
-        bool randomNeedsNew = true;
-    };
-    std::array<LFOState, InstrumentParams::kNumModDests> lfoStates {};
+    // Per-note LFOs and envelopes, stepped on the control-rate grid
+    NoteModulators noteModulators;
+    NoteModulators::Timing modTiming;
 
-    // Envelope state per destination
-    struct EnvState
+    // Control values for the current tick (recomputed at every tick and event)
+    struct Controls
     {
-        enum class Stage { Idle, Attack, Decay, Sustain, Release };
-        Stage stage = Stage::Idle;
-        float level = 0.0f;
+        float volumeGainMult = 1.0f;   // subtractive: 0 = silence, 1 = configured volume
+        float panMod = 0.0f;           // additive
+        float cutoffMult = 1.0f;       // subtractive: 0 = closed, 1 = set cutoff
     };
-    std::array<EnvState, InstrumentParams::kNumModDests> envStates {};
+    Controls controls;
 
-    bool noteActive = false;
+    std::bitset<128> heldNotes;   // notes sounding on the track, across its note lanes
+    bool allNotesOffHandled = false;
 
     // DSP helpers
     void processFilter (juce::AudioBuffer<float>& buffer, int startSample, int numSamples,
-                        const InstrumentParams& params, float cutoffMod);
+                        const InstrumentParams& params, float cutoffMod, bool atTick);
     void processOverdrive (juce::AudioBuffer<float>& buffer, int startSample, int numSamples,
                            int overdrive);
     void processBitDepth (juce::AudioBuffer<float>& buffer, int startSample, int numSamples,
@@ -209,22 +194,35 @@ private:
     void processVolumeAndPan (juce::AudioBuffer<float>& buffer, int startSample, int numSamples,
                               const InstrumentParams& params, float volumeMod, float panMod);
 
-    // Modulation (per-note)
-    float computeLFO (LFOState& state, const InstrumentParams::Modulation& mod, double bpm, int numSamples);
-    float advanceEnvelope (EnvState& state, const InstrumentParams::Modulation& mod, int numSamples);
-    float getModulationValue (int destIndex, const InstrumentParams& params, double bpm, int numSamples);
+    // Modulation: per-note or global value for a destination at the current tick
+    float getModulationValue (int destIndex, const InstrumentParams& params);
+    void updateControls (const InstrumentParams& params, int numSamples);
 
     // Global modulation
     float computeGlobalLFO (const InstrumentParams::Modulation& mod);
     float readGlobalEnvelope (int destIndex, const InstrumentParams::Modulation& mod);
-    void advanceGlobalEnvelopes (const InstrumentParams& params, juce::int64 blockStartSample, int numSamples);
     bool isModModeGlobal (int destIndex, const InstrumentParams& params) const;
+    void syncGlobalEnvelopes();
 
-    void triggerEnvelopes();
-    void releaseEnvelopes();
     void resetModulationState();
 
-    void processFxCommands (int numSamples, float& pitchMod, float& fxVolumeMod);
+    // Pattern FX of the track, compiled alongside its MIDI clip, and a cued
+    // pattern's taking over at the loop wrap
+    LoopCueFollower<TrackerEventList>::Table trackerEvents;
+    LoopCueFollower<TrackerEventList> trackerEventsCue;
+
+    void processStage (const te::PluginRenderContext&) override;
+
+    // Track events, applied at their sample
+    void handleTrackerEvent (const TrackerEvent& e);
+    void handleMidiMessage (const juce::MidiMessage& m);
+    void handleNoteRelease (bool lastHeldNote);
+
+    // Render one stretch of the block with the current controls
+    void processSegment (juce::AudioBuffer<float>& buffer, int startSample, int numSamples,
+                         const InstrumentParams& params, bool atTick);
+
+    float getFxVolumeGain() const;
 
     static float cutoffPercentToHz (int percent);
     static float resonancePercentToQ (int percent);
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <JuceHeader.h>
+#include "AtomicSharedPtrTable.h"
+#include "InstrumentParams.h"
+#include "InstrumentRouting.h"
+#include "SamplePlaybackLayout.h"
+
+// Immutable copy of an instrument's params as seen by the audio thread.
+// Anything derived from the params that would otherwise be recomputed (and
+// allocated) per note-on is baked in here when the snapshot is published.
+struct InstrumentSnapshot : public std::enable_shared_from_this<InstrumentSnapshot>
+{
+    explicit InstrumentSnapshot (const InstrumentParams& p)
+        : params (p),
+          sliceBoundariesNorm (SamplePlaybackLayout::getSliceBoundariesNorm (p))
+    {
+    }
+
+    const InstrumentParams params;
+
+    // Normalised slice region boundaries (see SamplePlaybackLayout::getSliceBoundariesNorm)
+    const std::vector<double> sliceBoundariesNorm;
+
+    int getNumSliceRegions() const { return static_cast<int> (sliceBoundariesNorm.size()) - 1; }
+};
+
+using InstrumentSnapshotPtr = std::shared_ptr<const InstrumentSnapshot>;
+
+// Fixed table of published instrument snapshots, one slot per instrument index
+// (see AtomicSharedPtrTable for the publication and reclamation scheme).
+class InstrumentSnapshotTable
+{
+public:
+    static constexpr int kNumSlots = InstrumentRouting::kMaxInstrument + 1;
+
+    InstrumentSnapshotTable()
+        : defaultSnapshot (std::make_shared<const InstrumentSnapshot> (InstrumentParams {}))
+    {
+    }
+
+    //==============================================================================
+    // Writer side (message thread / loader threads)
+
+    void publish (int instrument, const InstrumentParams& params)
+    {
+        if (! Table::isValidSlot (instrument))
+            return;
+
+        table.publish (instrument, std::make_shared<const InstrumentSnapshot> (params));
+    }
+
+    void remove (int instrument) { table.remove (instrument); }
+    void clear()                 { table.clear(); }
+
+    // Frees retired snapshots that no reader holds any more.
+    // Returns the number of snapshots still waiting to be freed.
+    int collectGarbage() { return table.collectGarbage(); }
+
+    //==============================================================================
+    // Reader side (any thread, real-time safe)
+
+    // Returns the published snapshot, or nullptr if the instrument has none.
+    InstrumentSnapshotPtr acquire (int instrument) const noexcept
+    {
+        return table.acquire (instrument);
+    }
+
+    // Same as acquire(), but falls back to a shared default-params snapshot.
+    InstrumentSnapshotPtr acquireOrDefault (int instrument) const noexcept
+    {
+        if (auto snapshot = acquire (instrument))
+            return snapshot;
+        return defaultSnapshot;
+    }
+
+    const InstrumentSnapshotPtr& getDefaultSnapshot() const noexcept { return defaultSnapshot; }
+
+private:
+    using Table = AtomicSharedPtrTable<InstrumentSnapshot, kNumSlots>;
+
+    Table table;
+    const InstrumentSnapshotPtr defaultSnapshot;
+
+    JUCE_DECLARE_NON_COPYABLE (InstrumentSnapshotTable)
+};
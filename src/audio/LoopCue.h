@@ -0,0 +1,78 @@
+#pragma once
+
+#include <memory>
+#include <JuceHeader.h>
+#include "AtomicSharedPtrTable.h"
+
+/**
+ * Lets a cued entry take over from the playing one exactly at the loop wrap.
+ *
+ * The writer keeps what plays now in kCurrentSlot and parks what should play
+ * next in kCuedSlot. The audio thread switches to the cued entry on the first
+ * block that jumps back to the start of the edit (the pattern loop wrapping)
+ * and keeps playing it until the writer publishes a new current entry, which
+ * it does once it has caught up with the switch. Every plugin following the
+ * same cue sees the same wrap, so all tracks change pattern on one block.
+ *
+ * Audio thread only; holds no references, so it never frees anything.
+ */
+template <typename T>
+class LoopCueFollower
+{
+public:
+    static constexpr int kCurrentSlot = 0;
+    static constexpr int kCuedSlot = 1;
+    using Table = AtomicSharedPtrTable<T, 2>;
+
+    /**
+     * What to play for the block at blockStart (edit samples). tookCue is set
+     * on the block the cued entry takes over.
+     */
+    std::shared_ptr<const T> select (const Table& table, juce::int64 blockStart, int numSamples, bool& tookCue) noexcept
+    {
+        tookCue = false;
+        auto current = table.acquire (kCurrentSlot);
+
+        // The writer has moved on from the cue it parked
+        if (onCue && current.get() != cuedOver)
+            onCue = false;
+
+        const bool wrapped = nextBlockStart > 0 && blockStart < nextBlockStart && blockStart <= 0;
+        nextBlockStart = blockStart + numSamples;
+
+        if (wrapped && ! onCue)
+        {
+            if (auto cued = table.acquire (kCuedSlot))
+            {
+                onCue = true;
+                cuedOver = current.get();
+                tookCue = true;
+                return cued;
+            }
+        }
+
+        if (onCue)
+        {
+            if (auto cued = table.acquire (kCuedSlot))
+                return cued;
+
+            // Withdrawn without a new current entry (the cue matched it)
+            onCue = false;
+        }
+
+        return current;
+    }
+
+    /** Transport stopped: the next block isn't a wrap. */
+    void reset() noexcept
+    {
+        onCue = false;
+        cuedOver = nullptr;
+        nextBlockStart = -1;
+    }
+
+private:
+    const T* cuedOver = nullptr;   // the current entry when the cue took over
+    bool onCue = false;
+    juce::int64 nextBlockStart = -1;
+};
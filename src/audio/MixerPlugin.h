@@ -3,6 +3,8 @@
 #include <JuceHeader.h>
 #include <tracktion_engine/tracktion_engine.h>
 #include "MixerState.h"
+#include "ThreeBandEQ.h"
+#include "Dynamics.h"
 #include "SendBuffers.h"
 
 namespace te = tracktion;
@@ -32,7 +34,7 @@ public:
     bool needsConstantBufferSize() override             { return false; }
 
     void setMixState (const TrackMixState& s);
-    void setSendBuffers (SendBuffers* b) { sendBuffers = b; }
+    void setSendBuffers (SendBuffers* b, int slot = SendBuffers::kSharedSlot) { sendBuffers = b; sendSlot = slot; }
 
     // Peak level metering (audio thread writes, UI thread reads)
     float getPeakLevel() const { return peakLevel.load (std::memory_order_relaxed); }
@@ -43,14 +45,13 @@ private:
     TrackMixState sharedMixState;
     TrackMixState localMixState;
     SendBuffers* sendBuffers = nullptr;
+    int sendSlot = SendBuffers::kSharedSlot;
 
-    // EQ filters (3-band)
-    juce::dsp::IIR::Filter<float> eqLowL, eqLowR;
-    juce::dsp::IIR::Filter<float> eqMidL, eqMidR;
-    juce::dsp::IIR::Filter<float> eqHighL, eqHighR;
+    // EQ (3-band)
+    ThreeBandEQ eq;
 
-    // Compressor state
-    float compEnvelope = 0.0f;
+    // Compressor
+    Dynamics::Compressor compressor;
 
     // Smoothed gain
     juce::SmoothedValue<float, juce::ValueSmoothingTypes::Linear> smoothedGainL { 1.0f };
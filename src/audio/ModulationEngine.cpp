@@ -1,5 +1,5 @@
 #include "ModulationEngine.h"
-#include "SimpleSampler.h"   // GlobalModState
+#include "GlobalModState.h"
 #include <cstdint>
 
 //==============================================================================
@@ -258,87 +258,6 @@ float ModulationEngine::readGlobalEnvelope (int destIndex,
     return level * (static_cast<float> (mod.amount) / 100.0f);
 }
 
-void ModulationEngine::advanceGlobalEnvelopes (const InstrumentParams& params,
-                                                juce::int64 blockStartSample,
-                                                int numSamples)
-{
-    if (globalModState == nullptr || numSamples <= 0)
-        return;
-
-    const auto blockTag = static_cast<uint64_t> (juce::jmax<juce::int64> (0, blockStartSample));
-    uint64_t expected = globalModState->lastProcessedBlock.load (std::memory_order_relaxed);
-    if (expected == blockTag)
-        return;
-
-    if (! globalModState->lastProcessedBlock.compare_exchange_strong (
-            expected, blockTag, std::memory_order_relaxed))
-    {
-        return;
-    }
-
-    const double blockDuration = static_cast<double> (numSamples) / sampleRate;
-
-    for (int d = 0; d < InstrumentParams::kNumModDests; ++d)
-    {
-        auto& mod = params.modulations[static_cast<size_t> (d)];
-        if (mod.type != InstrumentParams::Modulation::Type::Envelope)
-            continue;
-        if (mod.modMode != InstrumentParams::Modulation::ModMode::Global)
-            continue;
-
-        auto& es = globalModState->envStates[static_cast<size_t> (d)];
-        int stage = es.stage.load (std::memory_order_relaxed);
-        float level = es.level.load (std::memory_order_relaxed);
-
-        switch (stage)
-        {
-            case 0: // Idle
-                level = 0.0f;
-                break;
-            case 1: // Attack
-            {
-                double attackTime = juce::jmax (0.001, mod.attackS);
-                level += static_cast<float> (blockDuration / attackTime);
-                if (level >= 1.0f)
-                {
-                    level = 1.0f;
-                    stage = 2;
-                }
-                break;
-            }
-            case 2: // Decay
-            {
-                double decayTime = juce::jmax (0.001, mod.decayS);
-                float susLevel = static_cast<float> (mod.sustain) / 100.0f;
-                level -= static_cast<float> (blockDuration / decayTime) * (1.0f - susLevel);
-                if (level <= susLevel)
-                {
-                    level = susLevel;
-                    stage = 3;
-                }
-                break;
-            }
-            case 3: // Sustain
-                level = static_cast<float> (mod.sustain) / 100.0f;
-                break;
-            case 4: // Release
-            {
-                double releaseTime = juce::jmax (0.001, mod.releaseS);
-                level -= static_cast<float> (blockDuration / releaseTime) * level;
-                if (level < 0.001f)
-                {
-                    level = 0.0f;
-                    stage = 0;
-                }
-                break;
-            }
-        }
-
-        es.stage.store (stage, std::memory_order_relaxed);
-        es.level.store (level, std::memory_order_relaxed);
-    }
-}
-
 //==============================================================================
 // Combined modulation value
 //==============================================================================
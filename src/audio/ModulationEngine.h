@@ -70,15 +70,11 @@ public:
     float computeGlobalLFO (const InstrumentParams::Modulation& mod,
                             double bpm);
 
-    /** Read a global envelope value (written by advanceGlobalEnvelopes). */
+    /** Read a global envelope value (advanced once per block by
+        SimpleSampler::advanceGlobalModulation). */
     float readGlobalEnvelope (int destIndex,
                               const InstrumentParams::Modulation& mod);
 
-    /** Advance all global envelopes once per audio block (deduplicated). */
-    void advanceGlobalEnvelopes (const InstrumentParams& params,
-                                 juce::int64 blockStartSample,
-                                 int numSamples);
-
     /** Check whether a destination is using global mode, considering
         per-track overrides. */
     bool isModModeGlobal (int destIndex,
@@ -0,0 +1,150 @@
+#include "NoteModulators.h"
+
+void NoteModulators::reset()
+{
+    lfoPhase.fill (0.0);
+    randomHold.fill (0.0f);
+    randomNeedsNew.fill (true);
+    envStage.fill (Stage::Idle);
+    envLevel.fill (0.0f);
+    values.fill (0.0f);
+    random.setSeed (0x5eed);
+}
+
+void NoteModulators::trigger()
+{
+    envStage.fill (Stage::Attack);
+    envLevel.fill (0.0f);
+    lfoPhase.fill (0.0);
+}
+
+void NoteModulators::release()
+{
+    for (auto& stage : envStage)
+        if (stage != Stage::Idle)
+            stage = Stage::Release;
+}
+
+void NoteModulators::kill()
+{
+    envStage.fill (Stage::Idle);
+    envLevel.fill (0.0f);
+}
+
+float NoteModulators::lfoShape (InstrumentParams::Modulation::LFOShape shape, float p) noexcept
+{
+    using Shape = InstrumentParams::Modulation::LFOShape;
+
+    switch (shape)
+    {
+        case Shape::RevSaw:   return 1.0f - 2.0f * p;
+        case Shape::Saw:      return -1.0f + 2.0f * p;
+        case Shape::Triangle: return (p < 0.5f) ? (-1.0f + 4.0f * p) : (3.0f - 4.0f * p);
+        case Shape::Square:   return (p < 0.5f) ? 1.0f : -1.0f;
+        case Shape::Random:   break;
+    }
+    return 0.0f;
+}
+
+void NoteModulators::advance (const InstrumentParams& params, const Timing& timing, int numSamples)
+{
+    using Mod = InstrumentParams::Modulation;
+
+    const double duration = static_cast<double> (numSamples) / timing.sampleRate;
+    const double stepsPerSecond = timing.bpm / 60.0 * static_cast<double> (juce::jmax (1, timing.rowsPerBeat));
+
+    for (size_t d = 0; d < static_cast<size_t> (kNumDests); ++d)
+    {
+        const auto& mod = params.modulations[d];
+        const float amount = static_cast<float> (mod.amount) / 100.0f;
+
+        if (mod.type == Mod::Type::LFO)
+        {
+            if (mod.amount == 0)
+            {
+                values[d] = 0.0f;
+                continue;
+            }
+
+            // Steps mode follows the tempo; MS mode is a fixed period
+            const double lfoHz = mod.lfoSpeedMode == Mod::LFOSpeedMode::MS
+                                   ? 1000.0 / static_cast<double> (juce::jmax (1, mod.lfoSpeedMs))
+                                   : stepsPerSecond / static_cast<double> (juce::jmax (1, mod.lfoSpeed));
+
+            lfoPhase[d] += lfoHz * duration;
+            if (lfoPhase[d] >= 1.0)
+            {
+                lfoPhase[d] -= std::floor (lfoPhase[d]);
+                randomNeedsNew[d] = true;
+            }
+
+            float value;
+            if (mod.lfoShape == Mod::LFOShape::Random)
+            {
+                if (randomNeedsNew[d])
+                {
+                    randomHold[d] = random.nextFloat() * 2.0f - 1.0f;
+                    randomNeedsNew[d] = false;
+                }
+                value = randomHold[d];
+            }
+            else
+            {
+                value = lfoShape (mod.lfoShape, static_cast<float> (lfoPhase[d]));
+            }
+
+            values[d] = value * amount;
+        }
+        else if (mod.type == Mod::Type::Envelope)
+        {
+            auto& level = envLevel[d];
+
+            switch (envStage[d])
+            {
+                case Stage::Idle:
+                    level = 0.0f;
+                    break;
+
+                case Stage::Attack:
+                    level += static_cast<float> (duration / juce::jmax (0.001, mod.attackS));
+                    if (level >= 1.0f)
+                    {
+                        level = 1.0f;
+                        envStage[d] = Stage::Decay;
+                    }
+                    break;
+
+                case Stage::Decay:
+                {
+                    const float susLevel = static_cast<float> (mod.sustain) / 100.0f;
+                    level -= static_cast<float> (duration / juce::jmax (0.001, mod.decayS)) * (1.0f - susLevel);
+                    if (level <= susLevel)
+                    {
+                        level = susLevel;
+                        envStage[d] = Stage::Sustain;
+                    }
+                    break;
+                }
+
+                case Stage::Sustain:
+                    level = static_cast<float> (mod.sustain) / 100.0f;
+                    break;
+
+                case Stage::Release:
+                    level -= static_cast<float> (duration / juce::jmax (0.001, mod.releaseS)) * level;
+                    if (level < 0.001f)
+                    {
+                        level = 0.0f;
+                        envStage[d] = Stage::Idle;
+                    }
+                    break;
+            }
+
+            values[d] = level * amount;
+        }
+        else
+        {
+            values[d] = 0.0f;
+        }
+    }
+}
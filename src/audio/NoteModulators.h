@@ -0,0 +1,59 @@
+#pragma once
+
+#include <array>
+#include <JuceHeader.h>
+#include "InstrumentParams.h"
+
+/**
+ * The per-note LFO and envelope of every modulation destination on a track.
+ *
+ * InstrumentEffectsPlugin steps them once per control tick (ControlRate.h):
+ * advance() moves all destinations on together, from flat per-destination
+ * arrays, and leaves each one's value ready for the tick. Random LFOs draw
+ * from a seeded generator, so a render is repeatable.
+ */
+class NoteModulators
+{
+public:
+    static constexpr int kNumDests = InstrumentParams::kNumModDests;
+
+    struct Timing
+    {
+        double sampleRate = 44100.0;
+        double bpm = 120.0;
+        int rowsPerBeat = 4;
+    };
+
+    void reset();
+
+    /** Note-on: envelopes restart from their attack and LFOs from phase 0. */
+    void trigger();
+
+    /** Note released: running envelopes go into their release. */
+    void release();
+
+    /** Hard cut: envelopes drop to silence at once. */
+    void kill();
+
+    /** Moves every modulator on by numSamples (0 only refreshes the values). */
+    void advance (const InstrumentParams& params, const Timing& timing, int numSamples);
+
+    /**
+     * Value for a destination after the last advance: an LFO swings
+     * -amount..amount, an envelope runs 0..amount (amount as 0-1).
+     */
+    float getValue (int dest) const noexcept { return values[static_cast<size_t> (dest)]; }
+
+private:
+    enum class Stage { Idle, Attack, Decay, Sustain, Release };
+
+    std::array<double, kNumDests> lfoPhase {};
+    std::array<float, kNumDests> randomHold {};
+    std::array<bool, kNumDests> randomNeedsNew {};
+    std::array<Stage, kNumDests> envStage {};
+    std::array<float, kNumDests> envLevel {};
+    std::array<float, kNumDests> values {};
+    juce::Random random { 0x5eed };
+
+    static float lfoShape (InstrumentParams::Modulation::LFOShape shape, float phase) noexcept;
+};
@@ -0,0 +1,284 @@
+#include "OfflineRenderer.h"
+
+namespace
+{
+bool trackHasNotes (te::AudioTrack& track)
+{
+    for (auto* clip : track.getClips())
+        if (auto* midiClip = dynamic_cast<te::MidiClip*> (clip))
+            if (midiClip->getSequence().getNumNotes() > 0)
+                return true;
+
+    return false;
+}
+}
+
+OfflineRenderer::OfflineRenderer (TrackerEngine& engine)
+    : trackerEngine (engine)
+{
+}
+
+OfflineRenderer::~OfflineRenderer()
+{
+    onFinished = nullptr;
+    cancel();
+}
+
+juce::String OfflineRenderer::getStemFileName (int trackIndex, const juce::String& trackName)
+{
+    auto name = trackName.trim().isNotEmpty() ? trackName.trim()
+                                              : "Track " + juce::String (trackIndex + 1);
+    return juce::String::formatted ("%02d ", trackIndex + 1)
+           + juce::File::createLegalFileName (name) + ".wav";
+}
+
+float OfflineRenderer::getProgress() const
+{
+    if (jobs.empty())
+        return rendering ? 0.0f : 1.0f;
+
+    const float done = static_cast<float> (currentJob) + taskProgress.load (std::memory_order_relaxed);
+    return juce::jlimit (0.0f, 1.0f, done / static_cast<float> (jobs.size()));
+}
+
+//==============================================================================
+// Job setup
+//==============================================================================
+
+juce::String OfflineRenderer::prepareJobs (const Settings& newSettings)
+{
+    jobs.clear();
+    currentJob = 0;
+    result = {};
+    taskProgress.store (0.0f);
+
+    auto* edit = trackerEngine.getEdit();
+    if (edit == nullptr)
+        return "Audio engine is not initialised";
+
+    if (newSettings.outputFile == juce::File())
+        return "No output file specified";
+
+    if (trackerEngine.getSyncedContentRange().isEmpty())
+        return "Nothing to render";
+
+    settings = newSettings;
+
+    // Renderer track bits index into getAllTracks(), which includes the
+    // folder/tempo/marker tracks ahead of the audio tracks.
+    auto allTracks = te::getAllTracks (*edit);
+    auto* sendTrack = trackerEngine.getSendEffectsTrack();
+
+    Job master;
+    master.description = "Rendering master";
+    master.file = settings.outputFile;
+    master.useMasterPlugins = true;
+
+    for (int t = 0; t < kNumTracks; ++t)
+        if (auto* track = trackerEngine.getTrack (t))
+            master.tracks.setBit (allTracks.indexOf (track));
+
+    if (sendTrack != nullptr)
+        master.tracks.setBit (allTracks.indexOf (sendTrack));
+
+    if (auto dirResult = settings.outputFile.getParentDirectory().createDirectory(); dirResult.failed())
+        return dirResult.getErrorMessage();
+
+    jobs.push_back (std::move (master));
+
+    if (settings.stemsDirectory != juce::File())
+    {
+        if (auto dirResult = settings.stemsDirectory.createDirectory(); dirResult.failed())
+            return dirResult.getErrorMessage();
+
+        for (int t = 0; t < kNumTracks; ++t)
+        {
+            auto* track = trackerEngine.getTrack (t);
+            if (track == nullptr || track->isMuted (false) || ! trackHasNotes (*track))
+                continue;
+
+            const auto& name = settings.trackNames[static_cast<size_t> (t)];
+
+            // Each stem carries the track's own sends through the send bus
+            Job stem;
+            stem.description = "Rendering stem " + juce::String (t + 1);
+            stem.file = settings.stemsDirectory.getChildFile (getStemFileName (t, name));
+            stem.tracks.setBit (allTracks.indexOf (track));
+            if (sendTrack != nullptr)
+                stem.tracks.setBit (allTracks.indexOf (sendTrack));
+
+            jobs.push_back (std::move (stem));
+        }
+    }
+
+    return {};
+}
+
+std::unique_ptr<te::Renderer::RenderTask> OfflineRenderer::createTask (const Job& job)
+{
+    auto& edit = *trackerEngine.getEdit();
+    const auto contentRange = trackerEngine.getSyncedContentRange();
+
+    te::Renderer::Parameters params (edit);
+    params.destFile = job.file;
+    params.audioFormat = trackerEngine.getEngine().getAudioFileFormatManager().getWavFormat();
+    params.bitDepth = settings.bitDepth;
+    params.blockSizeForAudio = settings.blockSize;
+    params.sampleRateForAudio = settings.sampleRate;
+    params.time = { contentRange.getStart(),
+                    contentRange.getEnd() + te::TimeDuration::fromSeconds (juce::jmax (0.0, settings.tailSeconds)) };
+    params.tracksToDo = job.tracks;
+    params.usePlugins = true;
+    params.useMasterPlugins = job.useMasterPlugins;
+    params.realTimeRender = false;
+    params.checkNodesForAudio = false;   // silent stems/tails still produce a file
+
+    job.file.deleteFile();
+    taskProgress.store (0.0f);
+
+    return std::make_unique<te::Renderer::RenderTask> (job.description, params, &taskProgress, nullptr);
+}
+
+void OfflineRenderer::collectTaskResult()
+{
+    if (currentTask == nullptr)
+        return;
+
+    const auto& job = jobs[currentJob];
+
+    if (currentTask->errorMessage.isNotEmpty())
+        result.error = currentTask->errorMessage;
+    else if (! job.file.existsAsFile())
+        result.error = "Render produced no output: " + job.file.getFullPathName();
+    else
+        result.writtenFiles.add (job.file);
+
+    currentTask = nullptr;
+}
+
+//==============================================================================
+// Blocking render
+//==============================================================================
+
+OfflineRenderer::Result OfflineRenderer::renderNow (const Settings& newSettings,
+                                                    std::function<bool (float)> progressCallback)
+{
+    if (rendering)
+        return { false, "A render is already running", {} };
+
+    if (auto error = prepareJobs (newSettings); error.isNotEmpty())
+    {
+        result.error = error;
+        return result;
+    }
+
+    trackerEngine.stop();
+    rendering = true;
+
+    {
+        // Frees the live playback graph so the shared plugins only run in the render graph
+        const te::Edit::ScopedRenderStatus renderScope (*trackerEngine.getEdit(), true);
+
+        for (currentJob = 0; currentJob < jobs.size(); ++currentJob)
+        {
+            currentTask = createTask (jobs[currentJob]);
+
+            while (currentTask->runJob() == juce::ThreadPoolJob::jobNeedsRunningAgain)
+            {
+                if (progressCallback != nullptr && ! progressCallback (getProgress()))
+                {
+                    result.cancelled = true;
+                    break;
+                }
+            }
+
+            if (result.cancelled)
+            {
+                currentTask = nullptr;
+                jobs[currentJob].file.deleteFile();
+                break;
+            }
+
+            collectTaskResult();
+            if (result.error.isNotEmpty())
+                break;
+
+            if (progressCallback != nullptr)
+                progressCallback (getProgress());
+        }
+    }
+
+    jobs.clear();
+    rendering = false;
+    return result;
+}
+
+//==============================================================================
+// Asynchronous render
+//==============================================================================
+
+juce::String OfflineRenderer::start (const Settings& newSettings)
+{
+    if (rendering)
+        return "A render is already running";
+
+    if (auto error = prepareJobs (newSettings); error.isNotEmpty())
+        return error;
+
+    trackerEngine.stop();
+    renderStatus = std::make_unique<te::Edit::ScopedRenderStatus> (*trackerEngine.getEdit(), true);
+    rendering = true;
+
+    currentTask = createTask (jobs[currentJob]);
+    pool.addJob (currentTask.get(), false);
+    startTimerHz (30);
+    return {};
+}
+
+void OfflineRenderer::cancel()
+{
+    if (! rendering)
+        return;
+
+    pool.removeAllJobs (true, 10000);
+
+    if (currentTask != nullptr)
+    {
+        currentTask = nullptr;
+        jobs[currentJob].file.deleteFile();
+    }
+
+    finishRender (true);
+}
+
+void OfflineRenderer::timerCallback()
+{
+    // Tasks are created on the message thread (graph building touches the
+    // Edit) and only run on the pool thread.
+    if (currentTask != nullptr && pool.contains (currentTask.get()))
+        return;
+
+    collectTaskResult();
+
+    if (result.error.isNotEmpty() || ++currentJob >= jobs.size())
+    {
+        finishRender (false);
+        return;
+    }
+
+    currentTask = createTask (jobs[currentJob]);
+    pool.addJob (currentTask.get(), false);
+}
+
+void OfflineRenderer::finishRender (bool cancelled)
+{
+    stopTimer();
+    result.cancelled = cancelled;
+    renderStatus = nullptr;
+    rendering = false;
+    jobs.clear();
+    currentJob = 0;
+
+    if (onFinished != nullptr)
+        onFinished (result);
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <tracktion_engine/tracktion_engine.h>
+#include "TrackerEngine.h"
+
+namespace te = tracktion;
+
+/**
+ * Bounces whatever the engine last synced (pattern or arrangement) to WAV,
+ * faster than realtime, through the same Edit graph used for playback:
+ *   Sampler -> InstrumentEffects -> ChannelStrip -> [Inserts] -> TrackOutput -> Send bus
+ *
+ * The master mix is always written; optionally one stem per track that has
+ * notes (each stem includes that track's own delay/reverb sends).
+ *
+ * start() renders on a background thread and reports progress/completion on
+ * the message thread; renderNow() does the same work synchronously for the
+ * headless command-line path.
+ */
+class OfflineRenderer : private juce::Timer
+{
+public:
+    struct Settings
+    {
+        juce::File outputFile;                              // master mix (.wav)
+        juce::File stemsDirectory;                          // empty = no stems
+        std::array<juce::String, kNumTracks> trackNames;    // used for stem file names
+        double sampleRate = 44100.0;
+        int bitDepth = 24;
+        int blockSize = 512;
+        double tailSeconds = 2.0;                           // rendered past the last row for release/FX tails
+    };
+
+    struct Result
+    {
+        bool cancelled = false;
+        juce::String error;
+        juce::Array<juce::File> writtenFiles;
+
+        bool wasSuccessful() const { return ! cancelled && error.isEmpty(); }
+    };
+
+    explicit OfflineRenderer (TrackerEngine& engine);
+    ~OfflineRenderer() override;
+
+    //==============================================================================
+    // Asynchronous render (message thread)
+
+    /** Stops the transport and starts rendering. Returns an error message, or empty on success. */
+    juce::String start (const Settings& settings);
+
+    /** Aborts the render; the file being written is deleted, finished ones are kept. */
+    void cancel();
+
+    bool isRendering() const { return rendering; }
+
+    /** Overall progress across the master and all stems (0-1). */
+    float getProgress() const;
+
+    /** Called on the message thread when the render finishes, fails or is cancelled. */
+    std::function<void (const Result&)> onFinished;
+
+    //==============================================================================
+    /** Blocking render (headless use). progressCallback may return false to cancel. */
+    Result renderNow (const Settings& settings, std::function<bool (float progress)> progressCallback = {});
+
+    /** Stem file name for a track, e.g. "03 Bass.wav". */
+    static juce::String getStemFileName (int trackIndex, const juce::String& trackName);
+
+private:
+    struct Job
+    {
+        juce::String description;
+        juce::File file;
+        juce::BigInteger tracks;
+        bool useMasterPlugins = false;
+    };
+
+    TrackerEngine& trackerEngine;
+    Settings settings;
+    std::vector<Job> jobs;
+    size_t currentJob = 0;
+    Result result;
+    bool rendering = false;
+
+    juce::ThreadPool pool { 1 };
+    std::unique_ptr<te::Renderer::RenderTask> currentTask;
+    std::atomic<float> taskProgress { 0.0f };
+    std::unique_ptr<te::Edit::ScopedRenderStatus> renderStatus;
+
+    juce::String prepareJobs (const Settings& newSettings);
+    std::unique_ptr<te::Renderer::RenderTask> createTask (const Job& job);
+    void collectTaskResult();
+    void finishRender (bool cancelled);
+
+    void timerCallback() override;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (OfflineRenderer)
+};
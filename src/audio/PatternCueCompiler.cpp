@@ -0,0 +1,71 @@
+#include "PatternCueCompiler.h"
+
+PatternCueCompiler::PatternCueCompiler()
+{
+}
+
+PatternCueCompiler::~PatternCueCompiler()
+{
+    cancel();
+    pool.removeAllJobs (true, 5000);
+    cancelPendingUpdate();
+}
+
+//==============================================================================
+void PatternCueCompiler::cue (CompileFunction compile)
+{
+    cancel();
+
+    auto request = std::make_shared<Request>();
+    request->compile = std::move (compile);
+    pending = request;
+
+    pool.addJob ([this, request] { run (request); });
+}
+
+void PatternCueCompiler::cancel()
+{
+    if (pending == nullptr)
+        return;
+
+    pending->cancelled.store (true, std::memory_order_relaxed);
+    pending = nullptr;
+}
+
+//==============================================================================
+void PatternCueCompiler::run (const std::shared_ptr<Request>& request)
+{
+    // Rapid cueing: only the newest request is worth compiling
+    if (request->cancelled.load (std::memory_order_relaxed))
+        return;
+
+    request->result = request->compile();
+
+    if (request->cancelled.load (std::memory_order_relaxed))
+        return;
+
+    {
+        const std::lock_guard<std::mutex> lock (finishedMutex);
+        finished = request;
+    }
+
+    triggerAsyncUpdate();
+}
+
+void PatternCueCompiler::handleAsyncUpdate()
+{
+    std::shared_ptr<Request> done;
+    {
+        const std::lock_guard<std::mutex> lock (finishedMutex);
+        done.swap (finished);
+    }
+
+    // Superseded or cancelled after the worker finished
+    if (done == nullptr || done != pending)
+        return;
+
+    pending = nullptr;
+
+    if (onCompiled != nullptr)
+        onCompiled (std::move (done->result));
+}
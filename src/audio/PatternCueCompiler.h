@@ -0,0 +1,71 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <JuceHeader.h>
+#include "PatternData.h"
+#include "PatternSequencer.h"
+#include "TrackerEvent.h"
+
+/**
+ * Compiles a cued pattern on a worker thread while the current one plays.
+ *
+ * The compile function gets nothing but what it captured (a copy of the
+ * pattern and the timing it plays at), so it never touches the Edit or the
+ * engine's caches. Its result is handed to onCompiled on the message thread,
+ * ready to publish. A newer cue() or cancel() abandons the older request;
+ * only the latest cue ever arrives.
+ */
+class PatternCueCompiler : private juce::AsyncUpdater
+{
+public:
+    /** Everything playback needs to switch to the pattern. */
+    struct Compiled
+    {
+        std::shared_ptr<const PatternSequence> sequence;
+        std::array<std::shared_ptr<const TrackerEventList>, kNumTracks> trackerEvents {};
+        std::array<std::vector<int>, kNumTracks> instrumentsByTrack {};
+    };
+
+    using CompileFunction = std::function<Compiled()>;
+
+    PatternCueCompiler();
+    ~PatternCueCompiler() override;
+
+    //==============================================================================
+    // Message thread
+
+    /** Queues compile on the worker, replacing any cue still compiling or waiting. */
+    void cue (CompileFunction compile);
+    void cancel();
+
+    bool isCompiling() const { return pending != nullptr; }
+
+    /** The latest cue is compiled. */
+    std::function<void (Compiled)> onCompiled;
+
+private:
+    struct Request
+    {
+        CompileFunction compile;
+        std::atomic<bool> cancelled { false };
+
+        // Written by the worker before the request is queued as finished
+        Compiled result;
+    };
+
+    juce::ThreadPool pool { 1 };
+    std::shared_ptr<Request> pending;   // message thread only
+
+    std::mutex finishedMutex;
+    std::shared_ptr<Request> finished;
+
+    void run (const std::shared_ptr<Request>& request);
+    void handleAsyncUpdate() override;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PatternCueCompiler)
+};
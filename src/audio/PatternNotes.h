@@ -0,0 +1,181 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "InstrumentRouting.h"
+#include "PatternTrackBlock.h"
+
+/**
+ * The MIDI a pattern's note lanes turn into, shared by the clip path
+ * (TrackerEngine writing MIDI clips) and the realtime PatternSequencer so
+ * both play a pattern identically.
+ *
+ * Emitters write to any Sink with addEvent (const juce::MidiMessage&, double
+ * editSeconds), juce::MidiMessageSequence included.
+ */
+namespace PatternNotes
+{
+/** Multi-lane tracks send the lane ahead of each note-on, and in kill mode
+    cut a single lane rather than every voice. */
+constexpr int kCcNoteLane = 41;
+constexpr int kCcLaneCut = 42;
+
+// Tracks with more than one note lane play every lane through the sampler's
+// voice pool. Each note-on then carries its own lane and bank/program, and a
+// lane's events are shifted by laneIdx * kLaneEventSpacing so the lanes of a
+// row arrive one after another rather than interleaved.
+constexpr double kLaneEventSpacing = 0.00001;
+
+/** What a note lane carries from one row (and one block) to the next. */
+struct LanePlayState
+{
+    int lastPlayingNote = -1;
+    int currentInst = -1;
+    bool portaPending = false;
+};
+
+template <typename Sink>
+void appendNoteStart (Sink& sink, int laneIdx, bool multiLane,
+                      int instrument, bool instrumentChanged, int note, int velocity, double rowTime)
+{
+    const auto noteOn = juce::MidiMessage::noteOn (1, note, static_cast<juce::uint8> (velocity));
+
+    if (! multiLane)
+    {
+        if (instrumentChanged)
+        {
+            const double bankTime = juce::jmax (0.0, rowTime - 0.00012);
+            const double progTime = juce::jmax (0.0, rowTime - 0.0001);
+            sink.addEvent (juce::MidiMessage::controllerEvent (1, 0,
+                           InstrumentRouting::getBankMsbForInstrument (instrument)), bankTime);
+            sink.addEvent (juce::MidiMessage::programChange (1,
+                           InstrumentRouting::getProgramForInstrument (instrument)), progTime);
+        }
+
+        sink.addEvent (noteOn, rowTime);
+        return;
+    }
+
+    const double noteTime = rowTime + laneIdx * kLaneEventSpacing;
+    sink.addEvent (juce::MidiMessage::controllerEvent (1, kCcNoteLane, laneIdx & 0x7F),
+                   juce::jmax (0.0, noteTime - 0.000003));
+
+    if (instrument >= 0)
+    {
+        sink.addEvent (juce::MidiMessage::controllerEvent (1, 0,
+                       InstrumentRouting::getBankMsbForInstrument (instrument)),
+                       juce::jmax (0.0, noteTime - 0.0000025));
+        sink.addEvent (juce::MidiMessage::programChange (1,
+                       InstrumentRouting::getProgramForInstrument (instrument)),
+                       juce::jmax (0.0, noteTime - 0.000002));
+    }
+
+    sink.addEvent (noteOn, noteTime);
+}
+
+/** KILL: hard-cuts the track, or only this lane when the track has several. */
+template <typename Sink>
+void appendLaneKill (Sink& sink, int laneIdx, bool multiLane, double time)
+{
+    if (multiLane)
+        sink.addEvent (juce::MidiMessage::controllerEvent (1, kCcLaneCut, laneIdx & 0x7F), time);
+    else
+        sink.addEvent (juce::MidiMessage::allSoundOff (1), time);
+}
+
+template <typename Sink>
+void appendNoteEnd (Sink& sink, int laneIdx, bool multiLane, bool isKill, int note, double noteEnd)
+{
+    // The lane cut goes just ahead of the lane's next note (see appendNoteStart)
+    if (isKill)
+        appendLaneKill (sink, laneIdx, multiLane, multiLane ? juce::jmax (0.0, noteEnd - 0.000004) : noteEnd);
+
+    sink.addEvent (juce::MidiMessage::noteOff (1, note), noteEnd);
+}
+
+/** What playing a lane op did; the caller handles a note's end and a glide's target. */
+enum class OpResult
+{
+    released,    // OFF or KILL
+    glide,       // portamento onto the playing note, no MIDI
+    noteStarted
+};
+
+/** What an op does to its lane, before anything is played. */
+struct OpStep
+{
+    OpResult result = OpResult::noteStarted;
+    int releasedNote = -1;          // OFF: the note it ends (-1: none was playing)
+    bool instrumentChanged = false; // note start: a program change goes ahead of it
+};
+
+/** Applies one op to the lane's state; how a lane catches up on rows it doesn't play. */
+inline OpStep stepNoteOp (const PatternTrackBlock::NoteOp& op, LanePlayState& state) noexcept
+{
+    // Shared FX portamento affects all lanes and stays armed until the next note
+    if (op.portaArmed)
+        state.portaPending = true;
+
+    // OFF (255) and KILL (254)
+    if (op.note == 255 || op.note == 254)
+    {
+        const int releasedNote = state.lastPlayingNote;
+        state.lastPlayingNote = -1;
+        state.portaPending = false;
+        return { OpResult::released, releasedNote, false };
+    }
+
+    // Portamento
+    if (state.portaPending && state.lastPlayingNote >= 0)
+    {
+        state.portaPending = false;
+        return { OpResult::glide, -1, false };
+    }
+
+    const bool instrumentChanged = op.instrument >= 0 && op.instrument != state.currentInst;
+    if (instrumentChanged)
+        state.currentInst = InstrumentRouting::clampInstrumentIndex (op.instrument);
+
+    state.lastPlayingNote = op.note;
+    state.portaPending = false;
+    return { OpResult::noteStarted, -1, instrumentChanged };
+}
+
+/** Plays one op of a lane at rowTime, updating the lane's state. */
+template <typename Sink>
+OpResult playNoteOp (Sink& sink, const PatternTrackBlock::NoteOp& op, int laneIdx, bool multiLane,
+                     double rowTime, LanePlayState& state)
+{
+    const auto step = stepNoteOp (op, state);
+
+    switch (step.result)
+    {
+        case OpResult::released:
+            if (op.note == 254)
+                appendLaneKill (sink, laneIdx, multiLane, rowTime);
+            else if (step.releasedNote >= 0)
+                sink.addEvent (juce::MidiMessage::noteOff (1, step.releasedNote), rowTime);
+            else
+                sink.addEvent (juce::MidiMessage::allNotesOff (1), rowTime);
+            break;
+
+        case OpResult::noteStarted:
+            appendNoteStart (sink, laneIdx, multiLane, state.currentInst, step.instrumentChanged,
+                             op.note, op.volume >= 0 ? op.volume : 127, rowTime);
+            break;
+
+        case OpResult::glide:
+            break;
+    }
+
+    return step.result;
+}
+
+/** Carries portamento armed after a block's last op on the lane into what follows. */
+inline void finishBlock (const PatternTrackBlock& block, int laneIdx, LanePlayState& state) noexcept
+{
+    // Lanes the block has no cells on are still armed by its shared FX column
+    if (laneIdx >= block.numNoteLanes ? block.hasPortamento
+                                      : block.lanes[static_cast<size_t> (laneIdx)].portaArmedAtEnd)
+        state.portaPending = true;
+}
+} // namespace PatternNotes
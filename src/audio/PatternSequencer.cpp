@@ -0,0 +1,58 @@
+#include "PatternSequencer.h"
+
+size_t PatternSequence::findPlacement (size_t row) const noexcept
+{
+    if (placements.empty())
+        return 0;
+
+    const auto it = std::upper_bound (placements.begin(), placements.end(), row,
+                                      [] (size_t r, const Placement& p) { return r < p.firstRow; });
+    return it == placements.begin() ? 0 : static_cast<size_t> (it - placements.begin()) - 1;
+}
+
+void PatternSequencer::reset() noexcept
+{
+    lanes = {};
+    heldNotes = {};
+    nextRow = 0;
+    nextBlockStart = -1;
+}
+
+void PatternSequencer::locate (const PatternSequence& sequence, int trackIndex, int numLanes, size_t row)
+{
+    lanes = {};
+    heldNotes = {};
+    nextRow = row;
+
+    // Notes that started before the playhead aren't chased, but the lanes
+    // pick up their instrument, playing note and armed portamento
+    for (const auto& placement : sequence.placements)
+    {
+        if (placement.firstRow >= row)
+            break;
+
+        const auto* block = sequence.blocks[placement.patternIndex][static_cast<size_t> (trackIndex)].get();
+        if (block == nullptr)
+            continue;
+
+        const bool isWholeBlock = placement.firstRow + static_cast<size_t> (block->numRows) <= row;
+
+        for (int laneIdx = 0; laneIdx < numLanes; ++laneIdx)
+        {
+            auto& state = lanes[static_cast<size_t> (laneIdx)];
+
+            if (laneIdx < block->numNoteLanes)
+            {
+                for (const auto& op : block->lanes[static_cast<size_t> (laneIdx)].ops)
+                {
+                    if (placement.firstRow + static_cast<size_t> (op.row) >= row)
+                        break;
+                    PatternNotes::stepNoteOp (op, state);
+                }
+            }
+
+            if (isWholeBlock)
+                PatternNotes::finishBlock (*block, laneIdx, state);
+        }
+    }
+}
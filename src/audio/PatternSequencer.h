@@ -0,0 +1,226 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <vector>
+#include <JuceHeader.h>
+#include "PatternData.h"
+#include "PatternNotes.h"
+#include "PatternTrackBlock.h"
+
+/**
+ * What the realtime sequencer plays: the pattern, or the song's entries, as
+ * compiled blocks placed back to back. Each placement starts at its own edit
+ * time and times its rows from there with a row timing resolved once per
+ * distinct pattern and tempo span, so an entry repeated under the same tempo
+ * costs one placement. TrackerEngine builds one per sync and swaps it in
+ * atomically, or cues one to take over at the next loop wrap. Immutable
+ * once published (bar cueStarted).
+ */
+struct PatternSequence : public std::enable_shared_from_this<PatternSequence>
+{
+    struct Placement
+    {
+        size_t patternIndex = 0;
+        size_t firstRow = 0;     // song row of the block's first row
+        size_t timingIndex = 0;  // into rowTimings
+        double startTime = 0.0;  // edit seconds
+    };
+
+    struct Track
+    {
+        int numNoteLanes = 1;  // across every block the track plays
+        bool isKill = false;
+    };
+
+    // Start of each row in seconds from the start of its placement, plus the end of the last
+    std::vector<std::vector<double>> rowTimings;
+    std::vector<std::array<std::shared_ptr<const PatternTrackBlock>, kNumTracks>> blocks; // per distinct pattern
+    std::vector<Placement> placements; // back to back from row 0
+    std::array<Track, kNumTracks> tracks {};
+
+    /** Set by playback when this sequence, cued, takes over at the loop wrap. */
+    mutable std::atomic<bool> cueStarted { false };
+
+    size_t getNumRows() const noexcept
+    {
+        return placements.empty() ? 0 : placements.back().firstRow + rowTimings[placements.back().timingIndex].size() - 1;
+    }
+
+    /** The placement holding row (the last one for rows past the end). */
+    size_t findPlacement (size_t row) const noexcept;
+
+    /** When row starts in edit seconds; getNumRows() gives the end of the sequence. */
+    double getRowTime (size_t row) const noexcept
+    {
+        const auto& placement = placements[findPlacement (row)];
+        return placement.startTime + rowTimings[placement.timingIndex][row - placement.firstRow];
+    }
+};
+
+/**
+ * Plays one track of a PatternSequence on the audio thread.
+ *
+ * Called for every block while the transport plays. Each row's notes go out
+ * at the row's own sample as the playhead crosses it; a note's end is held
+ * until its end row comes round. When the playhead jumps (play, seek, loop
+ * wrap) held notes end at the jump and the lanes are brought up to the new
+ * position by replaying the rows before it silently. A newly published
+ * sequence takes over from the next row with the lanes' state carried
+ * across, so an edit is heard as soon as the playhead reaches it.
+ */
+class PatternSequencer
+{
+public:
+    static constexpr int kMaxNoteLanes = 16;
+
+    /**
+     * Plays the rows starting in [blockStart, blockStart + numSamples) (edit
+     * samples). Events go to sink.addEvent (message, editSeconds) in time order
+     * per lane; the caller sorts the block's events by time.
+     */
+    template <typename Sink>
+    void process (const PatternSequence& sequence, int trackIndex, juce::int64 blockStart, int numSamples,
+                  double sampleRate, Sink& sink)
+    {
+        const auto& track = sequence.tracks[static_cast<size_t> (trackIndex)];
+        const auto numRows = sequence.getNumRows();
+        const int numLanes = juce::jlimit (1, kMaxNoteLanes, track.numNoteLanes);
+        const bool multiLane = numLanes > 1;
+
+        auto rowSample = [&] (size_t row)
+        {
+            return static_cast<juce::int64> (std::llround (sequence.getRowTime (row) * sampleRate));
+        };
+
+        if (blockStart != nextBlockStart)
+        {
+            releaseHeldNotes (sink, numLanes, multiLane, track.isKill,
+                              static_cast<double> (blockStart) / sampleRate, juce::int64 (-1));
+
+            // First row at or after the playhead
+            size_t row = 0;
+            for (size_t count = numRows; count > 0;)
+            {
+                const size_t step = count / 2;
+                if (rowSample (row + step) < blockStart)
+                {
+                    row += step + 1;
+                    count -= step + 1;
+                }
+                else
+                {
+                    count = step;
+                }
+            }
+
+            locate (sequence, trackIndex, numLanes, row);
+        }
+        else if (nextRow > numRows)
+        {
+            // The sequence got shorter under the playhead
+            locate (sequence, trackIndex, numLanes, numRows);
+        }
+
+        const auto blockEnd = blockStart + numSamples;
+        nextBlockStart = blockEnd;
+
+        for (; nextRow < numRows && rowSample (nextRow) < blockEnd; ++nextRow)
+            playRow (sequence, trackIndex, numLanes, multiLane, track.isKill, nextRow, sink);
+
+        // Notes still held at the end of the sequence end with it
+        if (nextRow == numRows && numRows > 0 && rowSample (numRows) < blockEnd)
+            releaseHeldNotes (sink, numLanes, multiLane, track.isKill, sequence.getRowTime (numRows),
+                              static_cast<juce::int64> (numRows));
+    }
+
+    /** Transport stopped: forgets the position and the held notes. */
+    void reset() noexcept;
+
+private:
+    struct HeldNote
+    {
+        size_t endRow = 0;
+        int note = -1;
+    };
+
+    std::array<PatternNotes::LanePlayState, kMaxNoteLanes> lanes {};
+    std::array<HeldNote, kMaxNoteLanes> heldNotes {};
+    size_t nextRow = 0;
+    juce::int64 nextBlockStart = -1;
+
+    /** Moves to row, replaying the rows before it for the lanes' state without playing them. */
+    void locate (const PatternSequence& sequence, int trackIndex, int numLanes, size_t row);
+
+    /** Ends held notes due by row (every held note when row < 0). */
+    template <typename Sink>
+    void releaseHeldNotes (Sink& sink, int numLanes, bool multiLane, bool isKill, double time, juce::int64 row)
+    {
+        for (int laneIdx = 0; laneIdx < numLanes; ++laneIdx)
+        {
+            auto& held = heldNotes[static_cast<size_t> (laneIdx)];
+            if (held.note >= 0 && (row < 0 || held.endRow <= static_cast<size_t> (row)))
+            {
+                PatternNotes::appendNoteEnd (sink, laneIdx, multiLane, isKill, held.note, time);
+                held.note = -1;
+            }
+        }
+    }
+
+    template <typename Sink>
+    void playRow (const PatternSequence& sequence, int trackIndex, int numLanes, bool multiLane, bool isKill,
+                  size_t row, Sink& sink)
+    {
+        const auto& placement = sequence.placements[sequence.findPlacement (row)];
+        const auto* block = sequence.blocks[placement.patternIndex][static_cast<size_t> (trackIndex)].get();
+        if (block == nullptr)
+            return;
+
+        const int localRow = static_cast<int> (row - placement.firstRow);
+        const double rowTime = placement.startTime + sequence.rowTimings[placement.timingIndex][static_cast<size_t> (localRow)];
+        const bool isLastRow = localRow == block->numRows - 1;
+
+        // Lane by lane, each note's end ahead of what the lane plays next (as the clip path orders them)
+        for (int laneIdx = 0; laneIdx < numLanes; ++laneIdx)
+        {
+            auto& state = lanes[static_cast<size_t> (laneIdx)];
+            auto& held = heldNotes[static_cast<size_t> (laneIdx)];
+
+            if (held.note >= 0 && held.endRow <= row)
+            {
+                PatternNotes::appendNoteEnd (sink, laneIdx, multiLane, isKill, held.note, rowTime);
+                held.note = -1;
+            }
+
+            if (laneIdx < block->numNoteLanes)
+            {
+                const auto& ops = block->lanes[static_cast<size_t> (laneIdx)].ops;
+                const auto op = std::lower_bound (ops.begin(), ops.end(), localRow,
+                                                  [] (const PatternTrackBlock::NoteOp& o, int r) { return o.row < r; });
+
+                if (op != ops.end() && op->row == localRow)
+                {
+                    // A note held past here (the sequence changed under it) ends
+                    // unless this op glides it
+                    const bool glides = op->note < 254 && state.lastPlayingNote >= 0
+                                        && (state.portaPending || op->portaArmed);
+                    if (held.note >= 0 && ! glides)
+                    {
+                        PatternNotes::appendNoteEnd (sink, laneIdx, multiLane, isKill, held.note, rowTime);
+                        held.note = -1;
+                    }
+
+                    if (PatternNotes::playNoteOp (sink, *op, laneIdx, multiLane, rowTime, state)
+                            == PatternNotes::OpResult::noteStarted)
+                        held = { placement.firstRow + static_cast<size_t> (op->endRow), op->note };
+                }
+            }
+
+            if (isLastRow)
+                PatternNotes::finishBlock (*block, laneIdx, state);
+        }
+    }
+};
@@ -0,0 +1,70 @@
+#include "PatternSequencerPlugin.h"
+
+const char* PatternSequencerPlugin::xmlTypeName = "PatternSequencer";
+
+PatternSequencerPlugin::PatternSequencerPlugin (te::PluginCreationInfo info)
+    : te::Plugin (info)
+{
+}
+
+PatternSequencerPlugin::~PatternSequencerPlugin()
+{
+}
+
+void PatternSequencerPlugin::initialise (const te::PluginInitialisationInfo& info)
+{
+    sampleRate = info.sampleRate;
+    sequencer.reset();
+}
+
+void PatternSequencerPlugin::deinitialise()
+{
+}
+
+void PatternSequencerPlugin::applyToBuffer (const te::PluginRenderContext& fc)
+{
+    auto* midi = fc.bufferForMidiMessages;
+    const auto* table = sequences.load (std::memory_order_acquire);
+    const int track = trackIndex.load (std::memory_order_relaxed);
+
+    if (midi == nullptr || table == nullptr || ! fc.isPlaying || track < 0 || track >= kNumTracks)
+    {
+        sequenceCue.reset();
+        sequencer.reset();
+        return;
+    }
+
+    const double blockStartTime = fc.editTime.getStart().inSeconds();
+    const auto blockStart = static_cast<juce::int64> (std::llround (blockStartTime * sampleRate));
+
+    bool tookCue = false;
+    const auto sequence = sequenceCue.select (*table, blockStart, fc.bufferNumSamples, tookCue);
+    if (sequence == nullptr)
+    {
+        sequencer.reset();
+        return;
+    }
+
+    if (tookCue)
+        sequence->cueStarted.store (true, std::memory_order_release);
+
+    // Timestamps go in as seconds from the block start
+    struct BlockSink
+    {
+        te::MidiMessageArray& midi;
+        double blockStartTime;
+
+        void addEvent (const juce::MidiMessage& m, double time)
+        {
+            midi.addMidiMessage (m, juce::jmax (0.0, time - blockStartTime), te::MidiMessageArray::notMPE);
+        }
+    };
+
+    BlockSink sink { *midi, blockStartTime };
+    const int numBefore = midi->size();
+
+    sequencer.process (*sequence, track, blockStart, fc.bufferNumSamples, sampleRate, sink);
+
+    if (midi->size() != numBefore)
+        midi->sortByTimestamp();
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <atomic>
+#include <JuceHeader.h>
+#include <tracktion_engine/tracktion_engine.h>
+#include "AtomicSharedPtrTable.h"
+#include "LoopCue.h"
+#include "PatternSequencer.h"
+
+namespace te = tracktion;
+
+/**
+ * Realtime pattern playback for one track: plays the published
+ * PatternSequence into the track's MIDI, ahead of the sound source
+ * (sampler or plugin instrument). Audio passes through untouched.
+ *
+ * Only on tracks while TrackerEngine's realtime sequencing is on, which then
+ * publishes sequences instead of writing MIDI clips. TrackerEngine keeps it
+ * at the head of the chain. A cued sequence takes over on the block the
+ * loop wraps.
+ */
+class PatternSequencerPlugin : public te::Plugin
+{
+public:
+    PatternSequencerPlugin (te::PluginCreationInfo);
+    ~PatternSequencerPlugin() override;
+
+    static const char* getPluginName()  { return "PatternSequencer"; }
+    static const char* xmlTypeName;
+
+    juce::String getName() const override               { return getPluginName(); }
+    juce::String getPluginType() override               { return xmlTypeName; }
+    bool takesMidiInput() override                      { return true; }
+    bool takesAudioInput() override                     { return true; }
+    bool isSynth() override                             { return false; }
+    bool producesAudioWhenNoAudioInput() override       { return false; }
+    int getNumOutputChannelsGivenInputs (int numInputChannels) override { return juce::jmin (numInputChannels, 2); }
+
+    void initialise (const te::PluginInitialisationInfo&) override;
+    void deinitialise() override;
+    void applyToBuffer (const te::PluginRenderContext&) override;
+
+    juce::String getSelectableDescription() override    { return getName(); }
+    bool needsConstantBufferSize() override             { return false; }
+
+    /** The playing sequence, and a cued one taking over at the next loop wrap. */
+    using SequenceTable = LoopCueFollower<PatternSequence>::Table;
+
+    /** Where a track's sound source goes: right after the sequencer when the track has one. */
+    static int getSoundSourceIndex (const te::PluginList& list)
+    {
+        return list.size() > 0 && dynamic_cast<PatternSequencerPlugin*> (list[0]) != nullptr ? 1 : 0;
+    }
+
+    /** The engine's published sequence and which of its tracks this plays. */
+    void setSequenceSource (const SequenceTable* table, int track)
+    {
+        trackIndex.store (track, std::memory_order_relaxed);
+        sequences.store (table, std::memory_order_release);
+    }
+
+private:
+    std::atomic<const SequenceTable*> sequences { nullptr };
+    std::atomic<int> trackIndex { -1 };
+    double sampleRate = 44100.0;
+    LoopCueFollower<PatternSequence> sequenceCue;
+    PatternSequencer sequencer;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PatternSequencerPlugin)
+};
@@ -0,0 +1,240 @@
+#include <algorithm>
+#include "PatternTrackBlock.h"
+
+namespace
+{
+// 64-bit FNV-1a, fed one value at a time
+struct ContentHasher
+{
+    juce::uint64 hash = 14695981039346656037ull;
+
+    void add (juce::int64 value) noexcept
+    {
+        auto bits = static_cast<juce::uint64> (value);
+        for (int i = 0; i < 8; ++i)
+        {
+            hash ^= bits & 0xFF;
+            hash *= 1099511628211ull;
+            bits >>= 8;
+        }
+    }
+};
+
+int getTrackNoteLaneCount (const Pattern& pattern, int trackIdx)
+{
+    int numNoteLanes = 1;
+    pattern.forEachCell (trackIdx, [&] (int, CellView cell)
+    {
+        numNoteLanes = juce::jmax (numNoteLanes, cell.getNumNoteLanes());
+    });
+    return numNoteLanes;
+}
+
+// A portamento (Gxx, xx > 0) on the row glides the next note instead of retriggering
+bool cellHasPortamento (CellView cell)
+{
+    for (int fxi = 0; fxi < cell.getNumFxSlots(); ++fxi)
+    {
+        const auto slot = cell.getFxSlot (fxi);
+        if (slot.getCommandLetter() == 'G' && slot.fxParam > 0)
+            return true;
+    }
+    return false;
+}
+
+// The row's shared FX column events: a reset if any lane starts a note on
+// the row, then each slot's command in slot order
+void appendRowFxEvents (std::vector<PatternTrackBlock::FxEvent>& events, CellView cell, int row, int numNoteLanes)
+{
+    for (int nl = 0; nl < numNoteLanes; ++nl)
+    {
+        if (cell.getNoteLane (nl).note >= 0)
+        {
+            events.push_back ({ row, TrackerEvent::Command::RowReset, 0 });
+            break;
+        }
+    }
+
+    for (int fxi = 0; fxi < cell.getNumFxSlots(); ++fxi)
+    {
+        const auto slot = cell.getFxSlot (fxi);
+        TrackerEvent::Command command;
+        if (! slot.isEmpty() && getTrackerEventCommand (slot.getCommandLetter(), command))
+            events.push_back ({ row, command, static_cast<uint8_t> (juce::jlimit (0, 255, slot.fxParam)) });
+    }
+}
+} // namespace
+
+juce::uint64 PatternTrackBlock::hashTrack (const Pattern& pattern, int trackIdx)
+{
+    ContentHasher hasher;
+    const int numNoteLanes = getTrackNoteLaneCount (pattern, trackIdx);
+    hasher.add (pattern.numRows);
+    hasher.add (numNoteLanes);
+
+    pattern.forEachNonEmptyCell (trackIdx, [&] (int row, CellView cell)
+    {
+        hasher.add (row);
+        for (int nl = 0; nl < numNoteLanes; ++nl)
+        {
+            const auto slot = cell.getNoteLane (nl);
+            hasher.add (slot.note);
+            hasher.add (slot.instrument);
+            hasher.add (slot.volume);
+        }
+
+        for (int fxi = 0; fxi < cell.getNumFxSlots(); ++fxi)
+        {
+            const auto slot = cell.getFxSlot (fxi);
+            if (slot.isEmpty())
+                continue;
+            hasher.add (slot.getCommandLetter());
+            hasher.add (slot.fxParam);
+        }
+        hasher.add (-1); // end of row
+    });
+
+    return hasher.hash;
+}
+
+std::shared_ptr<const PatternTrackBlock> PatternTrackBlock::compile (const Pattern& pattern, int trackIdx)
+{
+    auto block = std::make_shared<PatternTrackBlock>();
+    block->contentHash = hashTrack (pattern, trackIdx);
+    block->numRows = pattern.numRows;
+    block->numNoteLanes = getTrackNoteLaneCount (pattern, trackIdx);
+    block->lanes.resize (static_cast<size_t> (block->numNoteLanes));
+
+    std::vector<char> rowHasPorta (static_cast<size_t> (pattern.numRows), 0);
+
+    // Shared FX column and the note lanes' ops, in row order. Tempo (F) goes
+    // to the master lane.
+    pattern.forEachNonEmptyCell (trackIdx, [&] (int row, CellView cell)
+    {
+        if (cellHasPortamento (cell))
+        {
+            rowHasPorta[static_cast<size_t> (row)] = 1;
+            block->hasPortamento = true;
+        }
+
+        for (int nl = 0; nl < block->numNoteLanes; ++nl)
+        {
+            const auto slot = cell.getNoteLane (nl);
+            if (slot.instrument >= 0
+                && std::find (block->instruments.begin(), block->instruments.end(), slot.instrument) == block->instruments.end())
+            {
+                block->instruments.push_back (slot.instrument);
+            }
+
+            if (slot.note >= 0)
+                block->lanes[static_cast<size_t> (nl)].ops.push_back ({ row, 0, slot.note, slot.instrument, slot.volume, false });
+        }
+
+        appendRowFxEvents (block->fxEvents, cell, row, block->numNoteLanes);
+    });
+
+    for (auto& lane : block->lanes)
+    {
+        // Walked backwards so each note's end (the lane's next note, OFF or
+        // KILL that isn't a portamento target) is known when it's reached
+        int nextEnd = pattern.numRows;
+        for (auto op = lane.ops.rbegin(); op != lane.ops.rend(); ++op)
+        {
+            op->endRow = nextEnd;
+
+            const bool isPortaTarget = op->note < 254 && rowHasPorta[static_cast<size_t> (op->row)] != 0;
+            if (! isPortaTarget)
+                nextEnd = op->row;
+        }
+
+        // Portamento stays armed from its row until the lane's next op
+        size_t opIdx = 0;
+        bool armed = false;
+        for (int row = 0; row < pattern.numRows; ++row)
+        {
+            armed = armed || rowHasPorta[static_cast<size_t> (row)] != 0;
+
+            if (opIdx < lane.ops.size() && lane.ops[opIdx].row == row)
+            {
+                lane.ops[opIdx++].portaArmed = armed;
+                armed = false;
+            }
+        }
+        lane.portaArmedAtEnd = armed;
+    }
+
+    return block;
+}
+
+bool PatternTrackBlock::matchesTrack (const Pattern& pattern, int trackIdx) const
+{
+    if (pattern.numRows != numRows || getTrackNoteLaneCount (pattern, trackIdx) != numNoteLanes)
+        return false;
+
+    // Walk every cell, consuming the block's ops and events in order: the
+    // block matches when the cells hold exactly what it was compiled from.
+    // Note ends and portamento arming follow from the notes and FX, so they
+    // needn't be compared.
+    std::vector<size_t> nextOp (static_cast<size_t> (numNoteLanes), 0);
+    std::vector<FxEvent> rowEvents;
+    size_t nextEvent = 0;
+    size_t nextInstrument = 0;
+
+    auto matchesRow = [&] (int row, CellView cell)
+    {
+        for (int nl = 0; nl < numNoteLanes; ++nl)
+        {
+            const auto slot = cell.getNoteLane (nl);
+            if (slot.instrument >= 0
+                && std::find (instruments.begin(), instruments.begin() + static_cast<std::ptrdiff_t> (nextInstrument),
+                              slot.instrument) == instruments.begin() + static_cast<std::ptrdiff_t> (nextInstrument))
+            {
+                if (nextInstrument >= instruments.size() || instruments[nextInstrument] != slot.instrument)
+                    return false;
+                ++nextInstrument;
+            }
+
+            if (slot.note < 0)
+                continue;
+
+            const auto& ops = lanes[static_cast<size_t> (nl)].ops;
+            auto& opIdx = nextOp[static_cast<size_t> (nl)];
+            if (opIdx >= ops.size())
+                return false;
+
+            const auto& op = ops[opIdx++];
+            if (op.row != row || op.note != slot.note || op.instrument != slot.instrument || op.volume != slot.volume)
+                return false;
+        }
+
+        rowEvents.clear();
+        appendRowFxEvents (rowEvents, cell, row, numNoteLanes);
+        for (const auto& event : rowEvents)
+        {
+            if (nextEvent >= fxEvents.size())
+                return false;
+
+            const auto& expected = fxEvents[nextEvent++];
+            if (expected.row != row || expected.command != event.command || expected.param != event.param)
+                return false;
+        }
+
+        return true;
+    };
+
+    bool matched = true;
+    pattern.forEachNonEmptyCell (trackIdx, [&] (int row, CellView cell)
+    {
+        matched = matchesRow (row, cell);
+        return matched;
+    });
+
+    if (! matched)
+        return false;
+
+    for (int nl = 0; nl < numNoteLanes; ++nl)
+        if (nextOp[static_cast<size_t> (nl)] != lanes[static_cast<size_t> (nl)].ops.size())
+            return false;
+
+    return nextEvent == fxEvents.size() && nextInstrument == instruments.size();
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <JuceHeader.h>
+#include "PatternData.h"
+#include "TrackerEvent.h"
+
+/**
+ * One track of one pattern, compiled once into row-relative events.
+ *
+ * The cells are reduced to what playback needs: the shared FX column as
+ * tracker events, and for each note lane the rows that hold a note, OFF or
+ * KILL, with each note's end row already resolved. Nothing in a block
+ * depends on where it plays, so TrackerEngine keys blocks by content and
+ * every arrangement entry (and every track) holding the same cells shares
+ * one. Placing a block in the song is a lookup of its rows in the song's
+ * row -> time table. Immutable once built.
+ */
+struct PatternTrackBlock
+{
+    /** A shared FX column command (RowReset included) on one row. */
+    struct FxEvent
+    {
+        int row = 0;
+        TrackerEvent::Command command = TrackerEvent::Command::RowReset;
+        uint8_t param = 0;
+    };
+
+    /** A note, OFF (255) or KILL (254) on one lane. */
+    struct NoteOp
+    {
+        int row = 0;
+        int endRow = 0;          // where a note starting here ends (numRows = pattern end)
+        int note = -1;
+        int instrument = -1;
+        int volume = -1;
+        bool portaArmed = false; // a portamento row since the lane's previous op, this row included
+    };
+
+    struct Lane
+    {
+        std::vector<NoteOp> ops;
+        bool portaArmedAtEnd = false; // a portamento row after the last op, still armed for what follows
+    };
+
+    juce::uint64 contentHash = 0;
+    int numRows = 0;
+    int numNoteLanes = 1;
+    bool hasPortamento = false;    // arms lanes past numNoteLanes too
+    std::vector<int> instruments;  // in order of first use
+    std::vector<FxEvent> fxEvents; // in row order, in the order they apply on the row
+    std::vector<Lane> lanes;
+
+    /** Hash of everything compile() reads from one track of the pattern. */
+    static juce::uint64 hashTrack (const Pattern& pattern, int trackIdx);
+
+    static std::shared_ptr<const PatternTrackBlock> compile (const Pattern& pattern, int trackIdx);
+
+    /** True when compiling this track would give this block: every cell is
+        compared against the ops, FX events and instruments it holds. Guards
+        the hash-keyed cache against collisions. */
+    bool matchesTrack (const Pattern& pattern, int trackIdx) const;
+};
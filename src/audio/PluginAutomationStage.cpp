@@ -0,0 +1,136 @@
+#include <algorithm>
+#include "PluginAutomationStage.h"
+
+//==============================================================================
+// Section
+//==============================================================================
+
+double PluginAutomationStage::Section::timeToRow (double time) const noexcept
+{
+    if (rowTimes.size() < 2)
+        return 0.0;
+
+    if (time <= rowTimes.front())
+        return 0.0;
+
+    const auto lastRow = static_cast<int> (rowTimes.size()) - 1;
+    if (time >= rowTimes.back())
+        return static_cast<double> (lastRow);
+
+    // Tempo only changes on row boundaries, so time is linear within a row
+    auto it = std::upper_bound (rowTimes.begin(), rowTimes.end(), time);
+    const auto row = static_cast<int> (std::distance (rowTimes.begin(), it)) - 1;
+    const double rowStart = rowTimes[static_cast<size_t> (row)];
+    const double rowEnd = rowTimes[static_cast<size_t> (row + 1)];
+    const double frac = rowEnd > rowStart ? (time - rowStart) / (rowEnd - rowStart) : 0.0;
+    return static_cast<double> (row) + frac;
+}
+
+//==============================================================================
+// Publishing (message thread)
+//==============================================================================
+
+void PluginAutomationStage::publish (std::shared_ptr<Program> program)
+{
+    if (program == nullptr)
+    {
+        clear();
+        return;
+    }
+
+    // One value slot per distinct parameter on each track, across sections
+    for (int t = 0; t < kNumTracks; ++t)
+    {
+        std::vector<juce::AudioProcessorParameter*> slotParameters;
+
+        for (auto& section : program->sections)
+        {
+            for (auto& target : section.targetsByTrack[static_cast<size_t> (t)])
+            {
+                auto it = std::find (slotParameters.begin(), slotParameters.end(), target.parameter);
+                if (it == slotParameters.end())
+                    it = slotParameters.insert (slotParameters.end(), target.parameter);
+
+                const auto slot = static_cast<int> (std::distance (slotParameters.begin(), it));
+                target.valueSlot = slot < kMaxValueSlots ? slot : -1;
+            }
+        }
+    }
+
+    program->generation = ++nextGeneration;
+    programs.publish (0, std::move (program));
+}
+
+//==============================================================================
+// Processing (audio thread)
+//==============================================================================
+
+const PluginAutomationStage::Section* PluginAutomationStage::findSection (const Program& program,
+                                                                          double time) noexcept
+{
+    const auto& sections = program.sections;
+    auto it = std::upper_bound (sections.begin(), sections.end(), time,
+                                [] (double t, const Section& s) { return t < s.endTime; });
+    if (it == sections.end())
+        return sections.empty() ? nullptr : &sections.back();
+    return &*it;
+}
+
+void PluginAutomationStage::process (int trackIndex, te::TimeRange editTime) noexcept
+{
+    if (trackIndex < 0 || trackIndex >= kNumTracks)
+        return;
+
+    const auto program = programs.acquire (0);
+    if (program == nullptr || program->isEmpty())
+        return;
+
+    auto& state = trackStates[static_cast<size_t> (trackIndex)];
+    if (state.generation != program->generation)
+    {
+        state.generation = program->generation;
+        state.lastValues.fill (-1.0f);
+    }
+
+    const double blockStart = editTime.getStart().inSeconds();
+    const double blockEnd = editTime.getEnd().inSeconds();
+
+    const auto* startSection = findSection (*program, blockStart);
+    const auto* endSection = findSection (*program, blockEnd);
+    if (startSection == nullptr || endSection == nullptr)
+        return;
+
+    const auto t = static_cast<size_t> (trackIndex);
+    const double startRow = startSection->timeToRow (blockStart);
+    const double endRow = endSection->timeToRow (blockEnd);
+
+    // Targets downstream of this stage get the value at the block start.
+    for (const auto& target : startSection->targetsByTrack[t])
+        if (! target.precedesStage)
+            applyTarget (target, startRow, state);
+
+    // Targets that already rendered this block are aimed at the next one.
+    for (const auto& target : endSection->targetsByTrack[t])
+        if (target.precedesStage)
+            applyTarget (target, endRow, state);
+}
+
+void PluginAutomationStage::applyTarget (const Target& target, double row, TrackState& state) noexcept
+{
+    if (target.parameter == nullptr)
+        return;
+
+    const float value = target.curve.evaluate (row, target.parameter->getValue());
+    if (target.valueSlot < 0)
+    {
+        target.parameter->setValue (value);
+        return;
+    }
+
+    auto& lastValue = state.lastValues[static_cast<size_t> (target.valueSlot)];
+    if (value != lastValue)
+    {
+        target.parameter->setValue (value);
+        lastValue = value;
+    }
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <array>
+#include <memory>
+#include <vector>
+#include <JuceHeader.h>
+#include <tracktion_engine/tracktion_engine.h>
+#include "AtomicSharedPtrTable.h"
+#include "PatternData.h"
+#include "AutomationCurve.h"
+
+namespace te = tracktion;
+
+/**
+ * Audio-thread plugin automation.
+ *
+ * The message thread compiles pattern automation lanes into an immutable
+ * Program (breakpoint tables plus the row -> edit-time map of each pattern
+ * section) and publishes it. Each track's ChannelStripPlugin then calls
+ * process() once per block, which evaluates the lanes that target plugins on
+ * that track against the transport position and pushes the values into the
+ * hosted plugins' parameters. No string lookups, no callback-lock polling,
+ * and no lock between publish() and process(): the program goes through an
+ * AtomicSharedPtrTable, so every block is automated.
+ */
+class PluginAutomationStage
+{
+public:
+    struct Target
+    {
+        te::Plugin::Ptr plugin;                              // keeps the parameter's owner alive
+        juce::AudioProcessorParameter* parameter = nullptr;
+        CompiledAutomationCurve curve;
+
+        // True when the plugin runs before the channel strip in its track
+        // (plugin instruments): the value is then aimed at the next block.
+        bool precedesStage = false;
+
+        // The parameter's index among the track's automated parameters
+        // (set by publish()); the stage keeps the last value sent there.
+        int valueSlot = -1;
+    };
+
+    // One pattern instance on the timeline (a whole pattern, or one repeat of
+    // an arrangement entry).
+    struct Section
+    {
+        double startTime = 0.0;
+        double endTime = 0.0;
+        std::vector<double> rowTimes;                        // numRows + 1 absolute edit times (seconds)
+        std::array<std::vector<Target>, kNumTracks> targetsByTrack;
+
+        double timeToRow (double time) const noexcept;
+    };
+
+    struct Program : public std::enable_shared_from_this<Program>
+    {
+        std::vector<Section> sections;
+        juce::uint64 generation = 0;                         // set by publish()
+        bool isEmpty() const { return sections.empty(); }
+    };
+
+    PluginAutomationStage() = default;
+
+    //==============================================================================
+    // Message thread: numbers the program's parameters, then publishes it
+    void publish (std::shared_ptr<Program> program);
+    void clear() { programs.remove (0); }
+
+    //==============================================================================
+    // Audio thread: apply automation for one track's block
+    void process (int trackIndex, te::TimeRange editTime) noexcept;
+
+    // Parameters per track whose last value is remembered (the rest are set every block)
+    static constexpr int kMaxValueSlots = 128;
+
+private:
+    // Replaced programs are freed on the message thread, so the audio thread
+    // never drops plugin references.
+    AtomicSharedPtrTable<Program, 1> programs;
+    juce::uint64 nextGeneration = 0;
+
+    // Each track's stage only touches its own entry, on whichever render
+    // thread runs that track.
+    struct TrackState
+    {
+        juce::uint64 generation = 0;                         // program the values were sent under
+        std::array<float, kMaxValueSlots> lastValues {};
+    };
+
+    std::array<TrackState, kNumTracks> trackStates {};
+
+    static const Section* findSection (const Program& program, double time) noexcept;
+    static void applyTarget (const Target& target, double row, TrackState& state) noexcept;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PluginAutomationStage)
+};
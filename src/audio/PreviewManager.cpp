@@ -99,21 +99,11 @@ void PreviewManager::previewAudioFile (const juce::File& file)
     stopPreview();
 
     // Load the audio file into a temporary bank
-    juce::AudioFormatManager formatManager;
-    formatManager.registerBasicFormats();
-
-    std::unique_ptr<juce::AudioFormatReader> reader (formatManager.createReaderFor (file));
-    if (reader == nullptr)
+    juce::String error;
+    auto bank = engine.getSampler().loadSampleBank (file, error);
+    if (bank == nullptr)
         return;
 
-    auto bank = std::make_shared<SampleBank>();
-    bank->sampleRate = reader->sampleRate;
-    bank->numChannels = static_cast<int> (reader->numChannels);
-    bank->totalSamples = static_cast<juce::int64> (reader->lengthInSamples);
-    bank->sourceFile = file;
-    bank->buffer.setSize (bank->numChannels, static_cast<int> (reader->lengthInSamples));
-    reader->read (&bank->buffer, 0, static_cast<int> (reader->lengthInSamples), 0, true, true);
-
     // Keep bank alive
     previewBank = bank;
 
@@ -0,0 +1,364 @@
+#include "SampleBank.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+
+// Blackman-windowed sinc lowpass for halving the sample rate, cut off a
+// little below the new Nyquist frequency and normalised to unity gain at DC
+struct DecimationFilter
+{
+    static constexpr int kHalfWidth = 16;
+    static constexpr int kTaps = kHalfWidth * 2 + 1;
+    static constexpr double kCutoff = 0.22;   // cycles per input sample
+
+    std::array<float, kTaps> coeffs {};
+
+    DecimationFilter()
+    {
+        double row[kTaps];
+        double sum = 0.0;
+
+        for (int k = 0; k < kTaps; ++k)
+        {
+            const double n = k - kHalfWidth;
+            const double x = juce::MathConstants<double>::twoPi * kCutoff * n;
+            const double sinc = n == 0 ? 1.0 : std::sin (x) / x;
+            const double u = static_cast<double> (k) / (kTaps - 1);
+            const double window = 0.42 - 0.5 * std::cos (juce::MathConstants<double>::twoPi * u)
+                                + 0.08 * std::cos (2.0 * juce::MathConstants<double>::twoPi * u);
+            row[k] = sinc * window;
+            sum += row[k];
+        }
+
+        for (int k = 0; k < kTaps; ++k)
+            coeffs[static_cast<size_t> (k)] = static_cast<float> (row[k] / sum);
+    }
+};
+
+// dest[i] = filtered src at 2 * i, with the sample's ends held past its edges
+void decimate (const float* src, int numSrc, float* dest, int numDest) noexcept
+{
+    static const DecimationFilter filter;
+    constexpr int halfWidth = DecimationFilter::kHalfWidth;
+
+    for (int i = 0; i < numDest; ++i)
+    {
+        const int centre = i * 2;
+        float acc = 0.0f;
+
+        if (centre >= halfWidth && centre + halfWidth < numSrc)
+        {
+            const float* x = src + centre - halfWidth;
+            for (int k = 0; k < DecimationFilter::kTaps; ++k)
+                acc += x[k] * filter.coeffs[static_cast<size_t> (k)];
+        }
+        else
+        {
+            for (int k = 0; k < DecimationFilter::kTaps; ++k)
+                acc += src[juce::jlimit (0, numSrc - 1, centre + k - halfWidth)] * filter.coeffs[static_cast<size_t> (k)];
+        }
+
+        dest[i] = acc;
+    }
+}
+
+} // namespace
+
+SampleBank::~SampleBank()
+{
+    if (mipMapBudget != nullptr)
+        mipMapBudget->release (mipMapReservedBytes);
+}
+
+//==============================================================================
+// Loading
+//==============================================================================
+
+void SampleBank::storeDecoded (const juce::AudioBuffer<float>& source, juce::int64 numSamples, bool use16Bit)
+{
+    ramSamples = numSamples;
+    ramIsInt16 = use16Bit;
+
+    const auto perChannel = static_cast<size_t> (numSamples);
+    const auto total = perChannel * static_cast<size_t> (numChannels);
+
+    if (use16Bit)
+    {
+        int16Data.resize (total);
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            const auto* src = source.getReadPointer (ch);
+            auto* dest = int16Data.data() + static_cast<size_t> (ch) * perChannel;
+            for (size_t i = 0; i < perChannel; ++i)
+                dest[i] = static_cast<int16_t> (juce::jlimit (-32768, 32767, juce::roundToInt (src[i] * 32768.0f)));
+        }
+    }
+    else
+    {
+        floatData.resize (total);
+        for (int ch = 0; ch < numChannels; ++ch)
+            std::copy (source.getReadPointer (ch), source.getReadPointer (ch) + perChannel,
+                       floatData.data() + static_cast<size_t> (ch) * perChannel);
+    }
+}
+
+std::shared_ptr<SampleBank> SampleBank::fromBuffer (const juce::AudioBuffer<float>& source, double sampleRate,
+                                                    bool use16Bit)
+{
+    auto bank = std::make_shared<SampleBank>();
+    bank->sampleRate = sampleRate;
+    bank->numChannels = juce::jmax (1, source.getNumChannels());
+    bank->totalSamples = source.getNumSamples();
+    bank->storage = use16Bit ? Storage::Int16 : Storage::Float32;
+
+    if (source.getNumChannels() > 0)
+    {
+        bank->storeDecoded (source, bank->totalSamples, use16Bit);
+    }
+    else
+    {
+        juce::AudioBuffer<float> silence (1, source.getNumSamples());
+        silence.clear();
+        bank->storeDecoded (silence, bank->totalSamples, use16Bit);
+    }
+
+    return bank;
+}
+
+std::shared_ptr<SampleBank> SampleBank::loadFromFile (const juce::File& file,
+                                                      juce::AudioFormatManager& formatManager,
+                                                      const LoadOptions& options,
+                                                      juce::String& error,
+                                                      const ProgressCallback& onProgress)
+{
+    if (! file.existsAsFile())
+    {
+        error = "File not found: " + file.getFullPathName();
+        return nullptr;
+    }
+
+    std::unique_ptr<juce::AudioFormatReader> reader (formatManager.createReaderFor (file));
+    if (reader == nullptr || reader->numChannels == 0)
+    {
+        error = "Failed to read audio file: " + file.getFullPathName();
+        return nullptr;
+    }
+
+    auto bank = std::make_shared<SampleBank>();
+    bank->sampleRate = reader->sampleRate;
+    bank->numChannels = static_cast<int> (reader->numChannels);
+    bank->totalSamples = static_cast<juce::int64> (reader->lengthInSamples);
+    bank->sourceFile = file;
+
+    // Long uncompressed files: decode a head, map the rest
+    const auto streamThreshold = static_cast<juce::int64> (options.streamAboveSeconds * reader->sampleRate);
+    if (options.streamAboveSeconds > 0.0 && bank->totalSamples > streamThreshold
+        && bank->numChannels <= kMaxStreamedChannels)
+    {
+        if (auto* format = formatManager.findFormatForFileExtension (file.getFileExtension()))
+        {
+            std::unique_ptr<juce::MemoryMappedAudioFormatReader> mapped (format->createMemoryMappedReader (file));
+            if (mapped != nullptr && mapped->mapEntireFile())
+            {
+                const auto head = juce::jlimit<juce::int64> (0, bank->totalSamples,
+                                                             static_cast<juce::int64> (options.headSeconds * reader->sampleRate));
+                juce::AudioBuffer<float> headBuffer (bank->numChannels, static_cast<int> (head));
+                reader->read (&headBuffer, 0, static_cast<int> (head), 0, true, true);
+
+                bank->storage = Storage::Streamed;
+                bank->storeDecoded (headBuffer, head, options.use16Bit);
+                bank->mappedReader = std::move (mapped);
+                return bank;
+            }
+        }
+    }
+
+    if (bank->totalSamples > std::numeric_limits<int>::max())
+    {
+        error = "Audio file is too long to load: " + file.getFullPathName();
+        return nullptr;
+    }
+
+    // Decode in chunks so a loader thread can report progress and bail out
+    constexpr int kDecodeChunk = 1 << 16;
+    const auto total = static_cast<int> (bank->totalSamples);
+    juce::AudioBuffer<float> decoded (bank->numChannels, total);
+
+    for (int pos = 0; pos < total; pos += kDecodeChunk)
+    {
+        const int n = juce::jmin (kDecodeChunk, total - pos);
+        reader->read (&decoded, pos, n, pos, true, true);
+
+        if (onProgress != nullptr && ! onProgress (static_cast<float> (pos + n) / static_cast<float> (total)))
+        {
+            error = "Loading cancelled";
+            return nullptr;
+        }
+    }
+
+    bank->storage = options.use16Bit ? Storage::Int16 : Storage::Float32;
+    bank->storeDecoded (decoded, bank->totalSamples, options.use16Bit);
+
+    if (options.buildMipMaps)
+    {
+        if (options.mipMapBudget != nullptr)
+            bank->buildMipMaps (options.mipMapBudget);
+        else
+            bank->buildMipMaps (MipMapBudget::kDefaultLimitBytes);
+    }
+
+    return bank;
+}
+
+size_t SampleBank::getMemoryUsage() const noexcept
+{
+    return floatData.size() * sizeof (float) + int16Data.size() * sizeof (int16_t) + getMipMapMemoryUsage();
+}
+
+//==============================================================================
+// Mip-maps
+//==============================================================================
+
+void SampleBank::buildMipMaps (size_t budgetBytes)
+{
+    buildMipMaps (std::make_shared<MipMapBudget> (budgetBytes));
+}
+
+void SampleBank::buildMipMaps (std::shared_ptr<MipMapBudget> budget)
+{
+    mipLevels.clear();
+    if (mipMapBudget != nullptr)
+        mipMapBudget->release (mipMapReservedBytes);
+
+    mipMapBudget = std::move (budget);
+    mipMapReservedBytes = 0;
+
+    if (storage == Storage::Streamed || ramSamples > std::numeric_limits<int>::max())
+        return;
+
+    // Each level is filtered from the one above it, kept as float in between
+    int length = static_cast<int> (ramSamples);
+    juce::AudioBuffer<float> current (numChannels, length);
+    for (int ch = 0; ch < numChannels; ++ch)
+        for (int i = 0; i < length; ++i)
+            current.setSample (ch, i, getSample (ch, i));
+
+    const size_t bytesPerSample = ramIsInt16 ? sizeof (int16_t) : sizeof (float);
+
+    for (int level = 1; level <= kMaxMipLevels; ++level)
+    {
+        const int halfLength = (length + 1) / 2;
+        const size_t bytes = static_cast<size_t> (halfLength) * static_cast<size_t> (numChannels) * bytesPerSample;
+        if (halfLength < kMinMipSamples || mipMapBudget == nullptr || ! mipMapBudget->tryReserve (bytes))
+            break;
+
+        juce::AudioBuffer<float> next (numChannels, halfLength);
+        for (int ch = 0; ch < numChannels; ++ch)
+            decimate (current.getReadPointer (ch), length, next.getWritePointer (ch), halfLength);
+
+        mipLevels.push_back (fromBuffer (next, sampleRate / static_cast<double> (1 << level), ramIsInt16));
+        mipMapReservedBytes += bytes;
+
+        current = std::move (next);
+        length = halfLength;
+    }
+}
+
+size_t SampleBank::getMipMapMemoryUsage() const noexcept
+{
+    size_t total = 0;
+    for (const auto& level : mipLevels)
+        total += level->getMemoryUsage();
+    return total;
+}
+
+//==============================================================================
+// Streaming
+//==============================================================================
+
+float SampleBank::readMapped (int channel, juce::int64 index) const noexcept
+{
+    if (mappedReader == nullptr)
+        return 0.0f;
+
+    float frame[kMaxStreamedChannels] {};
+    mappedReader->getSample (index, frame);
+    return frame[juce::jlimit (0, kMaxStreamedChannels - 1, channel)];
+}
+
+void SampleBank::prefetch (juce::int64 numSamplesAhead) const noexcept
+{
+    if (mappedReader == nullptr)
+        return;
+
+    const auto hint = playHint.load (std::memory_order_relaxed);
+    if (hint < 0)
+        return;
+
+    // Resume after the last touched range when playback moved forward within it
+    auto start = juce::jmax (hint, ramSamples);
+    if (lastPrefetchEnd > start && lastPrefetchEnd < hint + numSamplesAhead)
+        start = lastPrefetchEnd;
+
+    const auto end = juce::jmin (totalSamples, hint + numSamplesAhead);
+
+    // One touch per page is enough; 1024 frames covers >= 4 KB for any format
+    for (auto pos = start; pos < end; pos += 1024)
+        mappedReader->touchSample (pos);
+
+    lastPrefetchEnd = end;
+}
+
+//==============================================================================
+// SampleStreamPrefetcher
+//==============================================================================
+
+SampleStreamPrefetcher::SampleStreamPrefetcher()
+{
+    thread.addTimeSliceClient (this);
+}
+
+SampleStreamPrefetcher::~SampleStreamPrefetcher()
+{
+    thread.removeTimeSliceClient (this);
+    thread.stopThread (1000);
+}
+
+void SampleStreamPrefetcher::add (const std::shared_ptr<const SampleBank>& bank)
+{
+    if (bank == nullptr || bank->getStorage() != SampleBank::Storage::Streamed)
+        return;
+
+    {
+        const std::lock_guard<std::mutex> lock (banksMutex);
+        banks.push_back (bank);
+    }
+
+    if (! thread.isThreadRunning())
+        thread.startThread (juce::Thread::Priority::high);
+}
+
+int SampleStreamPrefetcher::useTimeSlice()
+{
+    std::vector<std::shared_ptr<const SampleBank>> live;
+    {
+        const std::lock_guard<std::mutex> lock (banksMutex);
+        banks.erase (std::remove_if (banks.begin(), banks.end(),
+                                     [] (const auto& weak) { return weak.expired(); }),
+                     banks.end());
+
+        for (auto& weak : banks)
+            if (auto bank = weak.lock())
+                live.push_back (std::move (bank));
+    }
+
+    for (auto& bank : live)
+        bank->prefetch (static_cast<juce::int64> (kReadAheadSeconds * bank->sampleRate));
+
+    return 20;
+}
@@ -0,0 +1,220 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <JuceHeader.h>
+
+// RAM shared by the mip-maps of every bank loaded against it. Each level
+// reserves its bytes before it is built and the bank gives them back when it
+// is freed, so the limit holds across all loaded samples. Loader threads
+// only; never touched by the audio thread.
+class MipMapBudget
+{
+public:
+    static constexpr size_t kDefaultLimitBytes = 64 << 20;
+
+    explicit MipMapBudget (size_t limit = kDefaultLimitBytes) : limitBytes (limit) {}
+
+    void setLimit (size_t bytes) noexcept    { limitBytes.store (bytes, std::memory_order_relaxed); }
+    size_t getLimit() const noexcept         { return limitBytes.load (std::memory_order_relaxed); }
+    size_t getUsed() const noexcept          { return usedBytes.load (std::memory_order_relaxed); }
+
+    /** Takes bytes from the budget, or returns false (and takes nothing) if they don't fit. */
+    bool tryReserve (size_t bytes) noexcept
+    {
+        auto used = usedBytes.load (std::memory_order_relaxed);
+        do
+        {
+            if (used + bytes > getLimit())
+                return false;
+        }
+        while (! usedBytes.compare_exchange_weak (used, used + bytes, std::memory_order_relaxed));
+
+        return true;
+    }
+
+    void release (size_t bytes) noexcept     { usedBytes.fetch_sub (bytes, std::memory_order_relaxed); }
+
+private:
+    std::atomic<size_t> limitBytes;
+    std::atomic<size_t> usedBytes { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE (MipMapBudget)
+};
+
+//==============================================================================
+// Sample data for one instrument, shared (const) between the message thread
+// and every sampler voice playing it.
+//
+// Short samples are decoded into RAM, as float or optionally as 16-bit
+// integers (half the footprint), optionally together with octave-decimated
+// mip-map copies that SampleResampler reads when a note is transposed up an
+// octave or more. Long uncompressed files (WAV/AIFF) are
+// memory-mapped instead: only a head is decoded up front and the rest is read
+// from the mapping, with SampleStreamPrefetcher touching the pages just ahead
+// of where the voices are playing so the audio thread rarely faults.
+//
+// Banks are always owned by a shared_ptr, so they can be published through
+// an AtomicSharedPtrTable for lock-free lookup on the audio thread.
+struct SampleBank : public std::enable_shared_from_this<SampleBank>
+{
+    enum class Storage { Float32, Int16, Streamed };
+
+    struct LoadOptions
+    {
+        bool use16Bit = false;              // keep decoded samples as 16-bit integers
+        double streamAboveSeconds = 60.0;   // map WAV/AIFF files longer than this (<= 0 disables)
+        double headSeconds = 2.0;           // decoded part of a streamed file
+        bool buildMipMaps = false;          // band-limited octave copies of RAM samples (about 1x more RAM)
+        std::shared_ptr<MipMapBudget> mipMapBudget;   // shared across banks; levels that don't fit are skipped
+    };
+
+    double sampleRate = 44100.0;
+    int numChannels = 1;
+    juce::int64 totalSamples = 0;
+    juce::File sourceFile;
+
+    /** Reports decode progress (0-1); return false to abandon the load. */
+    using ProgressCallback = std::function<bool (float progress)>;
+
+    /** Decodes (or maps) an audio file. Returns nullptr with error set on failure. */
+    static std::shared_ptr<SampleBank> loadFromFile (const juce::File& file,
+                                                     juce::AudioFormatManager& formatManager,
+                                                     const LoadOptions& options,
+                                                     juce::String& error,
+                                                     const ProgressCallback& onProgress = nullptr);
+
+    /** Wraps already decoded audio, optionally converting it to 16-bit. */
+    static std::shared_ptr<SampleBank> fromBuffer (const juce::AudioBuffer<float>& source, double sampleRate,
+                                                   bool use16Bit = false);
+
+    //==============================================================================
+    /** Realtime-safe read; index must be within [0, totalSamples). */
+    float getSample (int channel, juce::int64 index) const noexcept
+    {
+        if (index < ramSamples)
+        {
+            const auto offset = static_cast<size_t> (channel) * static_cast<size_t> (ramSamples) + static_cast<size_t> (index);
+            return ramIsInt16 ? static_cast<float> (int16Data[offset]) * kInt16ToFloat
+                              : floatData[offset];
+        }
+
+        return readMapped (channel, index);
+    }
+
+    Storage getStorage() const noexcept { return storage; }
+
+    /** Samples per channel held in RAM (all of them unless streamed). */
+    juce::int64 getNumPreloadedSamples() const noexcept { return ramSamples; }
+
+    /** RAM data for a channel (getNumPreloadedSamples() long), or nullptr if it isn't held as float. */
+    const float* getFloatChannel (int channel) const noexcept
+    {
+        return ramIsInt16 || floatData.empty() ? nullptr
+                                               : floatData.data() + static_cast<size_t> (channel) * static_cast<size_t> (ramSamples);
+    }
+
+    /** RAM data for a channel (getNumPreloadedSamples() long), or nullptr if it isn't held as 16-bit. */
+    const int16_t* getInt16Channel (int channel) const noexcept
+    {
+        return ! ramIsInt16 || int16Data.empty() ? nullptr
+                                                 : int16Data.data() + static_cast<size_t> (channel) * static_cast<size_t> (ramSamples);
+    }
+
+    /** Bytes of decoded sample data held in RAM, mip-maps included (excludes the mapping). */
+    size_t getMemoryUsage() const noexcept;
+
+    //==============================================================================
+    // Mip-maps
+
+    static constexpr int kMaxMipLevels = 5;
+    static constexpr int kMinMipSamples = 64;
+
+    /**
+     * Builds band-limited copies of the sample at 1/2, 1/4, ... of its rate,
+     * in the same format as the RAM data, until a level would be shorter than
+     * kMinMipSamples or no longer fit in the budget. The levels' bytes stay
+     * reserved in the budget until the bank is freed. Streamed banks get
+     * none. Loader thread only, before the bank is shared.
+     */
+    void buildMipMaps (std::shared_ptr<MipMapBudget> budget);
+
+    /** Same, against a budget of this bank's own. */
+    void buildMipMaps (size_t budgetBytes);
+
+    int getNumMipLevels() const noexcept { return static_cast<int> (mipLevels.size()); }
+
+    /** Level 1 is half rate, level 2 quarter rate, ...; sample i of level k lines up with sample i * 2^k. */
+    const SampleBank& getMipLevel (int level) const noexcept { return *mipLevels[static_cast<size_t> (level - 1)]; }
+
+    /** Bytes held by the mip-map levels. */
+    size_t getMipMapMemoryUsage() const noexcept;
+
+    //==============================================================================
+    // Streaming
+
+    /** Called by voices after each block; read by the prefetcher. */
+    void notePlayPosition (juce::int64 position) const noexcept
+    {
+        if (storage == Storage::Streamed)
+            playHint.store (position, std::memory_order_relaxed);
+    }
+
+    /** Touches the mapped pages from the last play position onwards (background thread). */
+    void prefetch (juce::int64 numSamplesAhead) const noexcept;
+
+    SampleBank() = default;
+    ~SampleBank();
+
+    static constexpr float kInt16ToFloat = 1.0f / 32768.0f;
+
+private:
+    static constexpr int kMaxStreamedChannels = 8;
+
+    Storage storage = Storage::Float32;
+    bool ramIsInt16 = false;                      // Int16, or Streamed with a 16-bit head
+    juce::int64 ramSamples = 0;
+    std::vector<float> floatData;                 // channel-major, ramSamples per channel
+    std::vector<int16_t> int16Data;
+    std::vector<std::shared_ptr<const SampleBank>> mipLevels;
+    std::shared_ptr<MipMapBudget> mipMapBudget;   // holds mipMapReservedBytes of it
+    size_t mipMapReservedBytes = 0;
+    std::unique_ptr<juce::MemoryMappedAudioFormatReader> mappedReader;
+    mutable std::atomic<juce::int64> playHint { -1 };
+    mutable juce::int64 lastPrefetchEnd = -1;     // prefetch thread only
+
+    float readMapped (int channel, juce::int64 index) const noexcept;
+    void storeDecoded (const juce::AudioBuffer<float>& source, juce::int64 numSamples, bool use16Bit);
+
+    JUCE_DECLARE_NON_COPYABLE (SampleBank)
+};
+
+//==============================================================================
+/**
+ * Background thread that keeps the pages ahead of every playing streamed
+ * bank resident. Banks register themselves on load; expired ones drop out.
+ */
+class SampleStreamPrefetcher : private juce::TimeSliceClient
+{
+public:
+    SampleStreamPrefetcher();
+    ~SampleStreamPrefetcher() override;
+
+    /** Message/loader thread. Non-streamed banks are ignored. */
+    void add (const std::shared_ptr<const SampleBank>& bank);
+
+    static constexpr double kReadAheadSeconds = 4.0;
+
+private:
+    juce::TimeSliceThread thread { "Sample Streaming" };
+    std::mutex banksMutex;
+    std::vector<std::weak_ptr<const SampleBank>> banks;
+
+    int useTimeSlice() override;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SampleStreamPrefetcher)
+};
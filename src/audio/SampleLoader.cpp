@@ -0,0 +1,146 @@
+#include "SampleLoader.h"
+
+SampleLoader::SampleLoader (SimpleSampler& s, int numThreads)
+    : sampler (s),
+      pool (numThreads > 0 ? numThreads : defaultNumThreads())
+{
+}
+
+SampleLoader::~SampleLoader()
+{
+    cancelAll();
+    pool.removeAllJobs (true, 5000);
+    cancelPendingUpdate();
+}
+
+int SampleLoader::defaultNumThreads()
+{
+    return juce::jlimit (1, 4, juce::SystemStats::getNumCpus() - 1);
+}
+
+//==============================================================================
+void SampleLoader::load (int instrumentIndex, const juce::File& file, Completion onLoaded)
+{
+    cancel (instrumentIndex);
+
+    auto request = std::make_shared<Request>();
+    request->instrumentIndex = instrumentIndex;
+    request->file = file;
+    request->onLoaded = std::move (onLoaded);
+    pending[instrumentIndex] = request;
+
+    pool.addJob ([this, request] { run (request); });
+
+    if (onProgressChanged != nullptr)
+        onProgressChanged();
+}
+
+void SampleLoader::cancel (int instrumentIndex)
+{
+    auto it = pending.find (instrumentIndex);
+    if (it == pending.end())
+        return;
+
+    it->second->cancelled.store (true, std::memory_order_relaxed);
+    pending.erase (it);
+
+    if (onProgressChanged != nullptr)
+        onProgressChanged();
+}
+
+void SampleLoader::cancelAll()
+{
+    if (pending.empty())
+        return;
+
+    for (auto& [index, request] : pending)
+        request->cancelled.store (true, std::memory_order_relaxed);
+
+    pending.clear();
+
+    if (onProgressChanged != nullptr)
+        onProgressChanged();
+}
+
+std::map<int, float> SampleLoader::getProgress() const
+{
+    std::map<int, float> result;
+    for (auto& [index, request] : pending)
+        result[index] = request->progress.load (std::memory_order_relaxed);
+    return result;
+}
+
+std::map<int, juce::File> SampleLoader::getPendingFiles() const
+{
+    std::map<int, juce::File> result;
+    for (auto& [index, request] : pending)
+        result[index] = request->file;
+    return result;
+}
+
+//==============================================================================
+void SampleLoader::run (const std::shared_ptr<Request>& request)
+{
+    if (request->cancelled.load (std::memory_order_relaxed))
+        return;
+
+    // Wake the message thread every 5% so the panel can redraw progress bars
+    float lastReported = 0.0f;
+    auto onProgress = [this, &request, &lastReported] (float progress)
+    {
+        request->progress.store (progress, std::memory_order_relaxed);
+
+        if (progress - lastReported >= 0.05f)
+        {
+            lastReported = progress;
+            triggerAsyncUpdate();
+        }
+
+        return ! request->cancelled.load (std::memory_order_relaxed);
+    };
+
+    request->bank = sampler.loadSampleBank (request->file, request->error, onProgress);
+
+    if (request->cancelled.load (std::memory_order_relaxed))
+        return;
+
+    {
+        const std::lock_guard<std::mutex> lock (finishedMutex);
+        finished.push_back (request);
+    }
+
+    triggerAsyncUpdate();
+}
+
+void SampleLoader::handleAsyncUpdate()
+{
+    std::vector<std::shared_ptr<Request>> done;
+    {
+        const std::lock_guard<std::mutex> lock (finishedMutex);
+        done.swap (finished);
+    }
+
+    for (auto& request : done)
+    {
+        // Superseded or cancelled after the worker finished
+        auto it = pending.find (request->instrumentIndex);
+        if (it == pending.end() || it->second != request)
+            continue;
+
+        pending.erase (it);
+
+        if (request->bank != nullptr)
+        {
+            sampler.installSampleBank (request->instrumentIndex, request->file, std::move (request->bank));
+
+            if (onBankInstalled != nullptr)
+                onBankInstalled (request->instrumentIndex);
+        }
+
+        if (request->onLoaded != nullptr)
+            request->onLoaded (request->error);
+    }
+
+    if (onProgressChanged != nullptr)
+        onProgressChanged();
+}
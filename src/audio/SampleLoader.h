@@ -0,0 +1,84 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <JuceHeader.h>
+#include "SimpleSampler.h"
+
+/**
+ * Decodes instrument samples on a small thread pool so project loads and
+ * browser drops don't block the message thread.
+ *
+ * Each finished bank is installed into the SimpleSampler on the message
+ * thread, in one step, and then announced via onBankInstalled so the engine
+ * can hand it to the track plugins. Until then the instrument simply has no
+ * bank and its notes are silent, so playback can start while loads are still
+ * running. A newer load for the same instrument, cancel() or cancelAll()
+ * abandons the older request (mid-decode where possible).
+ */
+class SampleLoader : private juce::AsyncUpdater
+{
+public:
+    using Completion = std::function<void (const juce::String& error)>;
+
+    /** numThreads <= 0 picks one per spare core, up to four. */
+    explicit SampleLoader (SimpleSampler& sampler, int numThreads = 0);
+    ~SampleLoader() override;
+
+    //==============================================================================
+    // Message thread
+
+    /** Queues a load; onLoaded runs on the message thread after the bank is installed (or on failure). */
+    void load (int instrumentIndex, const juce::File& file, Completion onLoaded = nullptr);
+    void cancel (int instrumentIndex);
+    void cancelAll();
+
+    bool isLoading (int instrumentIndex) const { return pending.find (instrumentIndex) != pending.end(); }
+    int getNumPending() const { return static_cast<int> (pending.size()); }
+
+    /** Instruments still loading, with their decode progress (0-1). */
+    std::map<int, float> getProgress() const;
+
+    /** Files of the instruments still loading. */
+    std::map<int, juce::File> getPendingFiles() const;
+
+    /** A bank was installed in the sampler for this instrument. */
+    std::function<void (int instrumentIndex)> onBankInstalled;
+
+    /** Progress moved, or loads were queued/finished/cancelled. */
+    std::function<void()> onProgressChanged;
+
+private:
+    struct Request
+    {
+        int instrumentIndex = -1;
+        juce::File file;
+        Completion onLoaded;
+
+        std::atomic<float> progress { 0.0f };
+        std::atomic<bool> cancelled { false };
+
+        // Written by the worker before the request is queued as finished
+        std::shared_ptr<SampleBank> bank;
+        juce::String error;
+    };
+
+    SimpleSampler& sampler;
+    juce::ThreadPool pool;
+
+    std::map<int, std::shared_ptr<Request>> pending;   // message thread only
+
+    std::mutex finishedMutex;
+    std::vector<std::shared_ptr<Request>> finished;
+
+    void run (const std::shared_ptr<Request>& request);
+    void handleAsyncUpdate() override;
+
+    static int defaultNumThreads();
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SampleLoader)
+};
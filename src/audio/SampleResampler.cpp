@@ -0,0 +1,336 @@
+#include "SampleResampler.h"
+
+#include <array>
+#include <cmath>
+
+namespace
+{
+
+//==============================================================================
+// Lookup tables (built at static-init time, never on the audio thread)
+//==============================================================================
+
+constexpr int kSemitoneRange = 256;   // whole semitones covered either side of 0
+constexpr int kFineSteps = 256;       // fine table steps per semitone
+
+struct PitchTables
+{
+    std::array<double, 2 * kSemitoneRange + 1> semitones {};
+    std::array<double, kFineSteps + 1> fine {};
+
+    PitchTables()
+    {
+        for (int i = 0; i < static_cast<int> (semitones.size()); ++i)
+            semitones[static_cast<size_t> (i)] = std::pow (2.0, (i - kSemitoneRange) / 12.0);
+
+        for (int i = 0; i <= kFineSteps; ++i)
+            fine[static_cast<size_t> (i)] = std::pow (2.0, (static_cast<double> (i) / kFineSteps) / 12.0);
+    }
+};
+
+// Row p holds the taps for a read position p / kSincPhases past a sample;
+// tap k weights the source sample at offset k - 3.
+struct SincTable
+{
+    static constexpr int kTaps = SampleResampler::kSincTaps;
+    static constexpr int kPhases = SampleResampler::kSincPhases;
+    static constexpr int kTapsBefore = kTaps / 2 - 1;
+
+    std::array<float, (kPhases + 1) * kTaps> coeffs {};
+
+    SincTable()
+    {
+        const double halfWidth = kTaps / 2;
+
+        for (int p = 0; p <= kPhases; ++p)
+        {
+            const double frac = static_cast<double> (p) / kPhases;
+            double row[kTaps];
+            double sum = 0.0;
+
+            for (int k = 0; k < kTaps; ++k)
+            {
+                const double x = (k - kTapsBefore) - frac;
+                const double sinc = std::abs (x) < 1.0e-9 ? 1.0
+                                                          : std::sin (juce::MathConstants<double>::pi * x)
+                                                                / (juce::MathConstants<double>::pi * x);
+                const double u = juce::jlimit (-1.0, 1.0, x / halfWidth);
+                const double window = 0.42 + 0.5 * std::cos (juce::MathConstants<double>::pi * u)
+                                    + 0.08 * std::cos (juce::MathConstants<double>::twoPi * u);
+                row[k] = sinc * window;
+                sum += row[k];
+            }
+
+            // Unity gain at DC for every phase
+            for (int k = 0; k < kTaps; ++k)
+                coeffs[static_cast<size_t> (p * kTaps + k)] = static_cast<float> (row[k] / sum);
+        }
+    }
+};
+
+const PitchTables pitchTables;
+const SincTable sincTable;
+
+//==============================================================================
+// Tap readers. Each fetches N consecutive source samples starting at first.
+//==============================================================================
+
+// Float RAM data, chunk known to be in range
+struct FloatTaps
+{
+    const float* data;
+
+    template <int N>
+    void fetch (juce::int64 first, float* dst) const noexcept
+    {
+        const float* src = data + first;
+        for (int k = 0; k < N; ++k)
+            dst[k] = src[k];
+    }
+};
+
+// 16-bit RAM data, chunk known to be in range
+struct Int16Taps
+{
+    const int16_t* data;
+
+    template <int N>
+    void fetch (juce::int64 first, float* dst) const noexcept
+    {
+        const int16_t* src = data + first;
+        for (int k = 0; k < N; ++k)
+            dst[k] = static_cast<float> (src[k]) * SampleBank::kInt16ToFloat;
+    }
+};
+
+// Sample edges and streamed data: clamped reads through the bank
+struct ClampedTaps
+{
+    const SampleBank& bank;
+    int channel;
+    juce::int64 maxIndex;
+
+    template <int N>
+    void fetch (juce::int64 first, float* dst) const noexcept
+    {
+        for (int k = 0; k < N; ++k)
+            dst[k] = bank.getSample (channel, juce::jlimit<juce::int64> (0, maxIndex, first + k));
+    }
+};
+
+//==============================================================================
+// Kernels: out[i] = interpolated sample at idx[i] + frac[i]
+//==============================================================================
+
+template <typename Taps>
+void interpolateLinear (const Taps& taps, const juce::int64* idx, const float* frac, float* out, int n) noexcept
+{
+    float x0[SampleResampler::kChunk], delta[SampleResampler::kChunk];
+
+    for (int i = 0; i < n; ++i)
+    {
+        float x[2];
+        taps.template fetch<2> (idx[i], x);
+        x0[i] = x[0];
+        delta[i] = x[1] - x[0];
+    }
+
+    juce::FloatVectorOperations::multiply (delta, frac, n);
+    juce::FloatVectorOperations::add (out, x0, delta, n);
+}
+
+template <typename Taps>
+void interpolateHermite (const Taps& taps, const juce::int64* idx, const float* frac, float* out, int n) noexcept
+{
+    float xm1[SampleResampler::kChunk], x0[SampleResampler::kChunk];
+    float x1[SampleResampler::kChunk], x2[SampleResampler::kChunk];
+
+    for (int i = 0; i < n; ++i)
+    {
+        float x[4];
+        taps.template fetch<4> (idx[i] - 1, x);
+        xm1[i] = x[0];
+        x0[i] = x[1];
+        x1[i] = x[2];
+        x2[i] = x[3];
+    }
+
+    for (int i = 0; i < n; ++i)
+    {
+        const float t = frac[i];
+        const float c1 = 0.5f * (x1[i] - xm1[i]);
+        const float c2 = xm1[i] - 2.5f * x0[i] + 2.0f * x1[i] - 0.5f * x2[i];
+        const float c3 = 0.5f * (x2[i] - xm1[i]) + 1.5f * (x0[i] - x1[i]);
+        out[i] = ((c3 * t + c2) * t + c1) * t + x0[i];
+    }
+}
+
+template <typename Taps>
+void interpolateSinc (const Taps& taps, const juce::int64* idx, const float* frac, float* out, int n) noexcept
+{
+    constexpr int kTaps = SincTable::kTaps;
+    const float* table = sincTable.coeffs.data();
+
+    for (int i = 0; i < n; ++i)
+    {
+        float x[kTaps];
+        taps.template fetch<kTaps> (idx[i] - SincTable::kTapsBefore, x);
+
+        const float phase = frac[i] * static_cast<float> (SincTable::kPhases);
+        const int row = juce::jmin (SincTable::kPhases - 1, static_cast<int> (phase));
+        const float t = phase - static_cast<float> (row);
+        const float* c0 = table + row * kTaps;
+        const float* c1 = c0 + kTaps;
+
+        float acc = 0.0f;
+        for (int k = 0; k < kTaps; ++k)
+            acc += x[k] * (c0[k] + (c1[k] - c0[k]) * t);
+
+        out[i] = acc;
+    }
+}
+
+template <typename Taps>
+void interpolate (SampleResampler::Quality quality, const Taps& taps,
+                  const juce::int64* idx, const float* frac, float* out, int n) noexcept
+{
+    switch (quality)
+    {
+        case SampleResampler::Quality::Linear:  interpolateLinear (taps, idx, frac, out, n); break;
+        case SampleResampler::Quality::Hermite: interpolateHermite (taps, idx, frac, out, n); break;
+        case SampleResampler::Quality::Sinc:    interpolateSinc (taps, idx, frac, out, n); break;
+    }
+}
+
+// Source samples read before / after the integer read position
+struct Reach
+{
+    int before, after;
+};
+
+Reach getReach (SampleResampler::Quality quality) noexcept
+{
+    switch (quality)
+    {
+        case SampleResampler::Quality::Linear:  return { 0, 1 };
+        case SampleResampler::Quality::Hermite: return { 1, 2 };
+        case SampleResampler::Quality::Sinc:    return { SincTable::kTapsBefore, SincTable::kTaps - SincTable::kTapsBefore - 1 };
+    }
+    return { 0, 1 };
+}
+
+} // namespace
+
+//==============================================================================
+
+double SampleResampler::semitonesToRatio (double semitones) noexcept
+{
+    semitones = juce::jlimit (static_cast<double> (-kSemitoneRange), static_cast<double> (kSemitoneRange), semitones);
+
+    const double whole = std::floor (semitones);
+    const double fineSteps = (semitones - whole) * kFineSteps;
+    const int fineIndex = juce::jlimit (0, kFineSteps - 1, static_cast<int> (fineSteps));
+    const double t = fineSteps - fineIndex;
+
+    const double f0 = pitchTables.fine[static_cast<size_t> (fineIndex)];
+    const double f1 = pitchTables.fine[static_cast<size_t> (fineIndex + 1)];
+
+    return pitchTables.semitones[static_cast<size_t> (static_cast<int> (whole) + kSemitoneRange)]
+         * (f0 + (f1 - f0) * t);
+}
+
+void SampleResampler::render (const SampleBank& bank, Quality quality, double pos, double step,
+                              juce::AudioBuffer<float>& dest, int destStart, int numSamples,
+                              float gain, const float* gains) noexcept
+{
+    const int numDestChannels = dest.getNumChannels();
+    if (bank.totalSamples <= 0 || bank.numChannels <= 0 || numDestChannels <= 0 || numSamples <= 0)
+        return;
+
+    // An octave or more up: read the band-limited copy, at a stride below 2
+    if (const int level = chooseMipLevel (step, bank.getNumMipLevels()); level > 0)
+    {
+        const double scale = std::ldexp (1.0, -level);
+        render (bank.getMipLevel (level), quality, pos * scale, step * scale, dest, destStart, numSamples, gain, gains);
+        return;
+    }
+
+    const auto reach = getReach (quality);
+    const auto maxIndex = bank.totalSamples - 1;
+    const auto ramSamples = bank.getNumPreloadedSamples();
+
+    juce::int64 idx[kChunk];
+    float frac[kChunk];
+    float out[kChunk];
+
+    for (int done = 0; done < numSamples;)
+    {
+        const int n = juce::jmin (kChunk, numSamples - done);
+
+        for (int i = 0; i < n; ++i)
+        {
+            const double p = pos + static_cast<double> (done + i) * step;
+            const double whole = std::floor (p);
+            idx[i] = static_cast<juce::int64> (whole);
+            frac[i] = static_cast<float> (p - whole);
+        }
+
+        // Positions move monotonically within a chunk, so its ends bound the taps
+        const auto first = juce::jmin (idx[0], idx[n - 1]) - reach.before;
+        const auto last = juce::jmax (idx[0], idx[n - 1]) + reach.after;
+        const bool inRam = first >= 0 && last < ramSamples;
+
+        int renderedChannel = -1;
+        for (int ch = 0; ch < numDestChannels; ++ch)
+        {
+            const int sourceChannel = juce::jmin (ch, bank.numChannels - 1);
+
+            if (sourceChannel != renderedChannel)
+            {
+                const auto* floatData = inRam ? bank.getFloatChannel (sourceChannel) : nullptr;
+                const auto* int16Data = inRam ? bank.getInt16Channel (sourceChannel) : nullptr;
+
+                if (floatData != nullptr)
+                    interpolate (quality, FloatTaps { floatData }, idx, frac, out, n);
+                else if (int16Data != nullptr)
+                    interpolate (quality, Int16Taps { int16Data }, idx, frac, out, n);
+                else
+                    interpolate (quality, ClampedTaps { bank, sourceChannel, maxIndex }, idx, frac, out, n);
+
+                if (gains != nullptr)
+                    juce::FloatVectorOperations::multiply (out, gains + done, n);
+
+                renderedChannel = sourceChannel;
+            }
+
+            juce::FloatVectorOperations::addWithMultiply (dest.getWritePointer (ch, destStart + done), out, gain, n);
+        }
+
+        done += n;
+    }
+}
+
+int SampleResampler::chooseMipLevel (double step, int numLevels) noexcept
+{
+    if (numLevels <= 0)
+        return 0;
+
+    int exponent = 0;
+    std::frexp (step, &exponent);   // |step| = m * 2^exponent, 0.5 <= m < 1
+    return juce::jlimit (0, numLevels, exponent - 1);
+}
+
+float SampleResampler::readSample (const SampleBank& bank, Quality quality, int channel, double pos) noexcept
+{
+    if (bank.totalSamples <= 0 || bank.numChannels <= 0)
+        return 0.0f;
+
+    const int sourceChannel = juce::jlimit (0, bank.numChannels - 1, channel);
+    const double whole = std::floor (pos);
+    const juce::int64 idx = static_cast<juce::int64> (whole);
+    const float frac = static_cast<float> (pos - whole);
+
+    float out = 0.0f;
+    interpolate (quality, ClampedTaps { bank, sourceChannel, bank.totalSamples - 1 }, &idx, &frac, &out, 1);
+    return out;
+}
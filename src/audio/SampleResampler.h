@@ -0,0 +1,53 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "InstrumentParams.h"
+#include "SampleBank.h"
+
+/**
+ * Block resampling kernels for the sampler voices.
+ *
+ * A voice hands over a run of output samples with a constant step (the
+ * render modes split their loops at loop/slice boundaries, so the kernels
+ * never check them). Each run is processed in kChunk-sample chunks: read
+ * positions are computed up front, the source taps are read straight from
+ * the bank's RAM data when the whole chunk is in range (clamped reads only
+ * near the edges and for streamed data), and the interpolation and the mix
+ * into the output run as flat loops over the chunk.
+ *
+ *  - Linear:  2 taps
+ *  - Hermite: 4-point, 3rd-order (Catmull-Rom)
+ *  - Sinc:    8-tap Blackman-windowed sinc, kSincPhases polyphase rows
+ *             with linear interpolation between adjacent rows
+ *
+ * Runs stepping an octave or more at a time read the bank's mip-map level
+ * for the step instead (see chooseMipLevel), so high transpositions read
+ * band-limited data at a stride below 2.
+ */
+struct SampleResampler
+{
+    using Quality = InstrumentParams::Interpolation;
+
+    static constexpr int kChunk = 64;
+    static constexpr int kSincTaps = 8;
+    static constexpr int kSincPhases = 256;
+
+    /** 2^(semitones / 12) from lookup tables, without std::pow. */
+    static double semitonesToRatio (double semitones) noexcept;
+
+    /**
+     * Adds numSamples interpolated samples read at pos, pos + step, ... into
+     * dest from destStart, scaled by gain and, if given, the per-sample gains
+     * (numSamples long). Output channel c reads bank channel
+     * min (c, numChannels - 1). Reads outside the sample clamp to its ends.
+     */
+    static void render (const SampleBank& bank, Quality quality, double pos, double step,
+                        juce::AudioBuffer<float>& dest, int destStart, int numSamples,
+                        float gain, const float* gains = nullptr) noexcept;
+
+    /** The mip-map level a run with this step reads: floor (log2 |step|), within the levels built. */
+    static int chooseMipLevel (double step, int numLevels) noexcept;
+
+    /** A single interpolated read (tests, offline use). */
+    static float readSample (const SampleBank& bank, Quality quality, int channel, double pos) noexcept;
+};
@@ -0,0 +1,229 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <JuceHeader.h>
+#include "GranularCloud.h"
+#include "InstrumentSnapshot.h"
+#include "SampleBank.h"
+
+// One TrackerSamplerPlugin voice. It keeps its own bank and params snapshot,
+// so it carries on playing what it was started with whatever the track
+// switches to afterwards.
+struct SamplerVoice
+{
+    enum class State { Idle, Playing, FadingOut };
+    State state = State::Idle;
+
+    std::shared_ptr<const SampleBank> bank;
+    InstrumentSnapshotPtr snapshot;   // published params, shared (never copied) on the audio thread
+
+    double playbackPos = 0.0;
+    int midiNote = 60;
+    float velocity = 1.0f;
+
+    int lane = 0;                     // note lane that started the voice
+    uint32_t startOrder = 0;          // pool trigger count when started (oldest = lowest)
+
+    int fadeOutRemaining = 0;
+    static constexpr int kFadeOutSamples = 64;
+
+    bool playingForward = true;
+    bool inLoopPhase = false;
+
+    // Slice mode boundaries (in samples)
+    double sliceStart = 0.0;
+    double sliceEnd = 0.0;
+
+    // Granular mode state
+    double grainStart = 0.0;
+    double grainEnd = 0.0;
+    GranularCloud granular;
+
+    bool isPlaying() const noexcept   { return state == State::Playing; }
+    bool isFadingOut() const noexcept { return state == State::FadingOut; }
+
+    // Graceful release: a short fade instead of a click
+    void startFadeOut() noexcept
+    {
+        if (state == State::Playing)
+        {
+            state = State::FadingOut;
+            fadeOutRemaining = kFadeOutSamples;
+        }
+    }
+
+    void reset()
+    {
+        state = State::Idle;
+        bank.reset();
+        snapshot.reset();
+        playbackPos = 0.0;
+        midiNote = 60;
+        velocity = 1.0f;
+        lane = 0;
+        startOrder = 0;
+        fadeOutRemaining = 0;
+        playingForward = true;
+        inLoopPhase = false;
+        sliceStart = sliceEnd = 0.0;
+        grainStart = grainEnd = 0.0;
+        granular.stop();
+    }
+};
+
+//==============================================================================
+/**
+ * Fixed-capacity voice pool for TrackerSamplerPlugin. Every voice is
+ * allocated with the plugin, so starting, releasing and stealing voices on
+ * the audio thread never allocates.
+ *
+ * Each note lane is monophonic like a classic tracker channel: a new note on
+ * a lane fades out that lane's previous voice. Lanes sound together up to the
+ * polyphony limit, after which a playing voice is stolen (faded out)
+ * according to the stealing mode. Fading voices don't count towards the
+ * limit; there are two slots per playable voice so each one can still finish
+ * its fade while its successor starts.
+ */
+class SamplerVoicePool
+{
+public:
+    static constexpr int kMaxPolyphony = 16;
+    static constexpr int kNumSlots = kMaxPolyphony * 2;
+    static constexpr int kDefaultPolyphony = 8;
+
+    enum class Stealing
+    {
+        Oldest,     // the voice started longest ago
+        Quietest    // the lowest-velocity voice (oldest first on a tie)
+    };
+
+    void setPolyphony (int numVoices) noexcept  { polyphony = juce::jlimit (1, kMaxPolyphony, numVoices); }
+    int getPolyphony() const noexcept           { return polyphony; }
+
+    void setStealing (Stealing mode) noexcept   { stealing = mode; }
+    Stealing getStealing() const noexcept       { return stealing; }
+
+    //==============================================================================
+    /** Returns a cleared voice tagged with the lane, ready to be triggered. */
+    SamplerVoice& startVoice (int lane) noexcept
+    {
+        for (auto& v : voices)
+            if (v.isPlaying() && v.lane == lane)
+                v.startFadeOut();
+
+        if (getNumPlaying() >= polyphony)
+            if (auto* victim = findVoiceToSteal())
+                victim->startFadeOut();
+
+        auto& v = findFreeSlot();
+        v.reset();
+        v.lane = lane;
+        v.startOrder = ++triggerCount;
+        return v;
+    }
+
+    /** Fades out the oldest playing voice started with this note. */
+    void releaseNote (int note) noexcept
+    {
+        SamplerVoice* oldest = nullptr;
+        for (auto& v : voices)
+            if (v.isPlaying() && v.midiNote == note && (oldest == nullptr || v.startOrder < oldest->startOrder))
+                oldest = &v;
+
+        if (oldest != nullptr)
+            oldest->startFadeOut();
+    }
+
+    /** Silences a lane's voices at once, including ones still fading. */
+    void cutLane (int lane) noexcept
+    {
+        for (auto& v : voices)
+            if (v.state != SamplerVoice::State::Idle && v.lane == lane)
+                v.state = SamplerVoice::State::Idle;
+    }
+
+    void releaseAll() noexcept
+    {
+        for (auto& v : voices)
+            v.startFadeOut();
+    }
+
+    void cutAll() noexcept
+    {
+        for (auto& v : voices)
+            v.state = SamplerVoice::State::Idle;
+    }
+
+    void reset()
+    {
+        for (auto& v : voices)
+            v.reset();
+        triggerCount = 0;
+    }
+
+    //==============================================================================
+    int getNumPlaying() const noexcept
+    {
+        int count = 0;
+        for (const auto& v : voices)
+            count += v.isPlaying() ? 1 : 0;
+        return count;
+    }
+
+    /** The most recently started voice that is still playing, or nullptr. */
+    const SamplerVoice* getNewestPlaying() const noexcept
+    {
+        const SamplerVoice* newest = nullptr;
+        for (const auto& v : voices)
+            if (v.isPlaying() && (newest == nullptr || v.startOrder > newest->startOrder))
+                newest = &v;
+        return newest;
+    }
+
+    std::array<SamplerVoice, kNumSlots>& getVoices() noexcept { return voices; }
+
+private:
+    std::array<SamplerVoice, kNumSlots> voices;
+    int polyphony = kDefaultPolyphony;
+    Stealing stealing = Stealing::Oldest;
+    uint32_t triggerCount = 0;
+
+    SamplerVoice* findVoiceToSteal() noexcept
+    {
+        SamplerVoice* victim = nullptr;
+        for (auto& v : voices)
+        {
+            if (! v.isPlaying())
+                continue;
+
+            if (victim == nullptr)
+                victim = &v;
+            else if (stealing == Stealing::Quietest && v.velocity != victim->velocity)
+                victim = v.velocity < victim->velocity ? &v : victim;
+            else if (v.startOrder < victim->startOrder)
+                victim = &v;
+        }
+        return victim;
+    }
+
+    // An idle slot, else the fading voice closest to silence (cut short)
+    SamplerVoice& findFreeSlot() noexcept
+    {
+        SamplerVoice* best = nullptr;
+        for (auto& v : voices)
+        {
+            if (v.state == SamplerVoice::State::Idle)
+                return v;
+
+            if (v.isFadingOut() && (best == nullptr || v.fadeOutRemaining < best->fadeOutRemaining))
+                best = &v;
+        }
+
+        if (best == nullptr)
+            best = findVoiceToSteal();   // only reachable if every slot is playing
+
+        return best != nullptr ? *best : voices[0];
+    }
+};
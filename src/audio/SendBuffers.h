@@ -1,132 +1,192 @@
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <JuceHeader.h>
-
-// Thread-safe shared accumulation buffers for delay and reverb sends.
-// Each InstrumentEffectsPlugin adds its post-processed audio (scaled by send amount)
-// into these buffers. The SendEffectsPlugin reads and processes them each block.
+#include "PatternData.h"
+
+// Shared accumulation buffers for delay and reverb sends.
+//
+// Every producer (InstrumentEffectsPlugin, TrackOutputPlugin) writes into its
+// own slot, one per track, so tracks never contend with each other and the
+// render path takes no lock. The SendEffectsPlugin sums all slots that hold
+// data for its block slice (vectorised) and clears them.
+//
+// The consumer must run after every producer of the block, since slot data
+// sits at block-relative offsets. TrackerEngine makes that a graph
+// dependency (each producer track feeds the send bus track through an aux
+// send), so even a multi-threaded graph never has a slot written and read
+// at once and no handoff is needed here.
+//
+// All storage is allocated up front (constructor / prepare on the message
+// thread); writes past the prepared capacity are truncated, never resized.
 
 struct SendBuffers
 {
-    juce::AudioBuffer<float> delayBuffer;
-    juce::AudioBuffer<float> reverbBuffer;
-    juce::SpinLock lock;
+    static constexpr int kNumTrackSlots = kNumTracks + 1;      // tracker tracks + preview track
+    static constexpr int kSharedSlot = kNumTrackSlots;          // slot-less callers
+    static constexpr int kNumSlots = kNumTrackSlots + 1;
+    static constexpr int kDefaultCapacity = 8192;
 
-    // Prepare buffers for the expected block size and channel count.
-    void prepare (int numSamples, int numChannels)
+    SendBuffers()
     {
-        const juce::SpinLock::ScopedLockType sl (lock);
-        delayBuffer.setSize (numChannels, numSamples, false, true, false);
-        reverbBuffer.setSize (numChannels, numSamples, false, true, false);
-        delayBuffer.clear();
-        reverbBuffer.clear();
+        prepare (kDefaultCapacity, 2);
     }
 
-    // Add audio to the delay send buffer (called from each track's effects plugin).
-    void addToDelay (const juce::AudioBuffer<float>& source, int startSample,
-                     int numSamples, float gain)
+    // Slot for a track index as returned by TrackerEngine::getTrack().
+    static int slotForTrack (int trackIndex)
     {
-        if (gain <= 0.0f) return;
-        if (source.getNumChannels() <= 0) return;
-
-        const juce::SpinLock::ScopedLockType sl (lock);
-        if (startSample < 0 || numSamples <= 0) return;
+        return (trackIndex >= 0 && trackIndex < kNumTrackSlots) ? trackIndex : kSharedSlot;
+    }
 
-        int requiredSamples = startSample + numSamples;
-        int requiredChannels = juce::jmax (delayBuffer.getNumChannels(), source.getNumChannels());
-        if (delayBuffer.getNumSamples() < requiredSamples
-            || delayBuffer.getNumChannels() < requiredChannels)
+    // Grows every slot to at least the given size and clears them. Allocates,
+    // so call it from the message thread before the graph is rendering; the
+    // capacity never shrinks, so re-preparing with the same size is safe.
+    void prepare (int numSamples, int numChannels)
+    {
+        for (auto& slot : slots)
         {
-            delayBuffer.setSize (requiredChannels, requiredSamples, true, true, false);
+            for (auto* b : { &slot.delay, &slot.reverb })
+            {
+                if (b->getNumSamples() < numSamples || b->getNumChannels() < numChannels)
+                    b->setSize (juce::jmax (numChannels, b->getNumChannels()),
+                                juce::jmax (numSamples, b->getNumSamples()), false, true, false);
+            }
         }
 
-        int channels = juce::jmin (source.getNumChannels(), delayBuffer.getNumChannels());
-        int srcAvail = juce::jmax (0, source.getNumSamples() - startSample);
-        int dstAvail = juce::jmax (0, delayBuffer.getNumSamples() - startSample);
-        int samples = juce::jmin (numSamples, juce::jmin (srcAvail, dstAvail));
-        if (samples <= 0) return;
-
-        for (int ch = 0; ch < channels; ++ch)
-            delayBuffer.addFrom (ch, startSample, source, ch, startSample, samples, gain);
+        clear();
     }
 
-    // Add audio to the reverb send buffer (called from each track's effects plugin).
-    void addToReverb (const juce::AudioBuffer<float>& source, int startSample,
-                      int numSamples, float gain)
-    {
-        if (gain <= 0.0f) return;
-        if (source.getNumChannels() <= 0) return;
+    int getCapacity() const { return slots[0].delay.getNumSamples(); }
 
-        const juce::SpinLock::ScopedLockType sl (lock);
-        if (startSample < 0 || numSamples <= 0) return;
+    // Add audio to a slot's delay send (audio thread, one producer per slot).
+    void addToDelay (int slot, const juce::AudioBuffer<float>& source, int startSample,
+                     int numSamples, float gain) noexcept
+    {
+        if (auto* s = getSlot (slot))
+            accumulate (s->delay, s->delayEnd, source, startSample, numSamples, gain);
+    }
 
-        int requiredSamples = startSample + numSamples;
-        int requiredChannels = juce::jmax (reverbBuffer.getNumChannels(), source.getNumChannels());
-        if (reverbBuffer.getNumSamples() < requiredSamples
-            || reverbBuffer.getNumChannels() < requiredChannels)
-        {
-            reverbBuffer.setSize (requiredChannels, requiredSamples, true, true, false);
-        }
+    // Add audio to a slot's reverb send (audio thread, one producer per slot).
+    void addToReverb (int slot, const juce::AudioBuffer<float>& source, int startSample,
+                      int numSamples, float gain) noexcept
+    {
+        if (auto* s = getSlot (slot))
+            accumulate (s->reverb, s->reverbEnd, source, startSample, numSamples, gain);
+    }
 
-        int channels = juce::jmin (source.getNumChannels(), reverbBuffer.getNumChannels());
-        int srcAvail = juce::jmax (0, source.getNumSamples() - startSample);
-        int dstAvail = juce::jmax (0, reverbBuffer.getNumSamples() - startSample);
-        int samples = juce::jmin (numSamples, juce::jmin (srcAvail, dstAvail));
-        if (samples <= 0) return;
+    void addToDelay (const juce::AudioBuffer<float>& source, int startSample, int numSamples, float gain) noexcept
+    {
+        addToDelay (kSharedSlot, source, startSample, numSamples, gain);
+    }
 
-        for (int ch = 0; ch < channels; ++ch)
-            reverbBuffer.addFrom (ch, startSample, source, ch, startSample, samples, gain);
+    void addToReverb (const juce::AudioBuffer<float>& source, int startSample, int numSamples, float gain) noexcept
+    {
+        addToReverb (kSharedSlot, source, startSample, numSamples, gain);
     }
 
-    // Copy a block slice for processing and clear that slice in the shared buffers.
-    // This avoids concurrent read/write on the same memory and keeps sub-block timing aligned.
+    // Sum a block slice across all slots into the outputs and clear that slice
+    // in the slots, keeping sub-block timing aligned. The outputs are resized
+    // with avoidReallocating, so they don't allocate once they've seen the
+    // largest block.
     void consumeSlice (juce::AudioBuffer<float>& delayOut,
                        juce::AudioBuffer<float>& reverbOut,
                        int startSample,
                        int numSamples,
-                       int numChannels)
+                       int numChannels) noexcept
     {
         delayOut.setSize (numChannels, numSamples, false, true, true);
         reverbOut.setSize (numChannels, numSamples, false, true, true);
         delayOut.clear();
         reverbOut.clear();
 
-        if (numSamples <= 0)
+        if (numSamples <= 0 || startSample < 0)
             return;
 
-        const juce::SpinLock::ScopedLockType sl (lock);
+        for (auto& slot : slots)
+        {
+            drain (slot.delay, slot.delayEnd, delayOut, startSample, numSamples);
+            drain (slot.reverb, slot.reverbEnd, reverbOut, startSample, numSamples);
+        }
+    }
 
-        int requiredSamples = juce::jmax (0, startSample) + numSamples;
-        if (delayBuffer.getNumSamples() < requiredSamples
-            || reverbBuffer.getNumSamples() < requiredSamples
-            || delayBuffer.getNumChannels() < numChannels
-            || reverbBuffer.getNumChannels() < numChannels)
+    // Clear every slot (not while the graph is rendering).
+    void clear() noexcept
+    {
+        for (auto& slot : slots)
         {
-            delayBuffer.setSize (numChannels, requiredSamples, true, true, false);
-            reverbBuffer.setSize (numChannels, requiredSamples, true, true, false);
+            slot.delay.clear();
+            slot.reverb.clear();
+            slot.delayEnd.store (0, std::memory_order_release);
+            slot.reverbEnd.store (0, std::memory_order_release);
         }
+    }
+
+private:
+    struct Slot
+    {
+        juce::AudioBuffer<float> delay, reverb;
+
+        // Upper bound of the samples that may hold unconsumed data; lets the
+        // consumer skip silent slots without touching their memory.
+        std::atomic<int> delayEnd { 0 }, reverbEnd { 0 };
+    };
+
+    std::array<Slot, kNumSlots> slots;
+
+    Slot* getSlot (int slot) noexcept
+    {
+        return juce::isPositiveAndBelow (slot, kNumSlots) ? &slots[static_cast<size_t> (slot)] : nullptr;
+    }
+
+    static void accumulate (juce::AudioBuffer<float>& dest, std::atomic<int>& writtenEnd,
+                            const juce::AudioBuffer<float>& source, int startSample,
+                            int numSamples, float gain) noexcept
+    {
+        if (gain <= 0.0f || startSample < 0 || numSamples <= 0)
+            return;
 
-        int srcStart = juce::jmax (0, startSample);
-        int maxDelaySamples = juce::jmax (0, delayBuffer.getNumSamples() - srcStart);
-        int maxReverbSamples = juce::jmax (0, reverbBuffer.getNumSamples() - srcStart);
-        int copySamples = juce::jmin (numSamples, juce::jmin (maxDelaySamples, maxReverbSamples));
-        int channels = juce::jmin (numChannels, juce::jmin (delayBuffer.getNumChannels(), reverbBuffer.getNumChannels()));
+        const int channels = juce::jmin (source.getNumChannels(), dest.getNumChannels());
+        const int srcAvail = source.getNumSamples() - startSample;
+        const int dstAvail = dest.getNumSamples() - startSample;
+        const int samples = juce::jmin (numSamples, juce::jmin (srcAvail, dstAvail));
+        if (channels <= 0 || samples <= 0)
+            return;
+
+        // Past the prepared capacity the tail of the write is dropped: the
+        // slots can't grow on the audio thread
+        jassert (dstAvail >= juce::jmin (numSamples, srcAvail));
 
         for (int ch = 0; ch < channels; ++ch)
-        {
-            delayOut.copyFrom (ch, 0, delayBuffer, ch, srcStart, copySamples);
-            reverbOut.copyFrom (ch, 0, reverbBuffer, ch, srcStart, copySamples);
-            delayBuffer.clear (ch, srcStart, copySamples);
-            reverbBuffer.clear (ch, srcStart, copySamples);
-        }
+            juce::FloatVectorOperations::addWithMultiply (dest.getWritePointer (ch, startSample),
+                                                          source.getReadPointer (ch, startSample),
+                                                          gain, samples);
+
+        const int end = startSample + samples;
+        if (writtenEnd.load (std::memory_order_relaxed) < end)
+            writtenEnd.store (end, std::memory_order_relaxed);
     }
 
-    // Clear both buffers (called at the start of each block by SendEffectsPlugin
-    // after it has read them).
-    void clear()
+    static void drain (juce::AudioBuffer<float>& src, std::atomic<int>& writtenEnd,
+                       juce::AudioBuffer<float>& out, int startSample, int numSamples) noexcept
     {
-        const juce::SpinLock::ScopedLockType sl (lock);
-        delayBuffer.clear();
-        reverbBuffer.clear();
+        const int end = writtenEnd.load (std::memory_order_relaxed);
+        if (end <= startSample)
+            return;
+
+        const int samples = juce::jmin (numSamples, end - startSample);
+        const int channels = juce::jmin (src.getNumChannels(), out.getNumChannels());
+
+        for (int ch = 0; ch < channels; ++ch)
+        {
+            auto* data = src.getWritePointer (ch, startSample);
+            juce::FloatVectorOperations::add (out.getWritePointer (ch), data, samples);
+            juce::FloatVectorOperations::clear (data, samples);
+        }
+
+        // Consumed up to the end of the written range: everything from this
+        // slice onwards is silent again.
+        if (end <= startSample + numSamples)
+            writtenEnd.store (startSample, std::memory_order_relaxed);
     }
 };
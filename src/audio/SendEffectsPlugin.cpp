@@ -1,4 +1,5 @@
 #include "SendEffectsPlugin.h"
+#include "SimpleSampler.h"
 
 const char* SendEffectsPlugin::xmlTypeName = "SendEffects";
 
@@ -46,20 +47,16 @@ void SendEffectsPlugin::initialise (const te::PluginInitialisationInfo& info)
     delayReturnScratch.setSize (2, info.blockSizeSamples);
     reverbReturnScratch.setSize (2, info.blockSizeSamples);
 
-    // Initialize EQ filters with flat coefficients
-    auto flatCoeffs = juce::dsp::IIR::Coefficients<float>::makePeakFilter (sampleRate, 1000.0f, 0.707f, 1.0f);
-    delayReturnEqLowL.coefficients = flatCoeffs;  delayReturnEqLowR.coefficients = flatCoeffs;
-    delayReturnEqMidL.coefficients = flatCoeffs;   delayReturnEqMidR.coefficients = flatCoeffs;
-    delayReturnEqHighL.coefficients = flatCoeffs;  delayReturnEqHighR.coefficients = flatCoeffs;
-    reverbReturnEqLowL.coefficients = flatCoeffs;  reverbReturnEqLowR.coefficients = flatCoeffs;
-    reverbReturnEqMidL.coefficients = flatCoeffs;   reverbReturnEqMidR.coefficients = flatCoeffs;
-    reverbReturnEqHighL.coefficients = flatCoeffs;  reverbReturnEqHighR.coefficients = flatCoeffs;
-    masterEqLowL.coefficients = flatCoeffs;  masterEqLowR.coefficients = flatCoeffs;
-    masterEqMidL.coefficients = flatCoeffs;   masterEqMidR.coefficients = flatCoeffs;
-    masterEqHighL.coefficients = flatCoeffs;  masterEqHighR.coefficients = flatCoeffs;
-
-    masterCompEnvelope = 0.0f;
-    masterLimiterEnvelope = 0.0f;
+    // EQs
+    delayReturnEq.prepare (sampleRate);
+    reverbReturnEq.prepare (sampleRate);
+    masterEq.prepare (sampleRate);
+
+    masterCompressor.prepare (sampleRate);
+    masterLimiter.prepare (sampleRate, true);
+
+    delayGate.reset();
+    reverbGate.reset();
 }
 
 void SendEffectsPlugin::deinitialise()
@@ -72,6 +69,11 @@ void SendEffectsPlugin::deinitialise()
     delayScratch.clear();
     reverbInputScratch.clear();
     reverbScratch.clear();
+    delayReturnEq.reset();
+    reverbReturnEq.reset();
+    masterEq.reset();
+    masterCompressor.reset();
+    masterLimiter.reset();
 }
 
 //==============================================================================
@@ -107,6 +109,46 @@ int SendEffectsPlugin::getDelayTimeSamples() const
     }
 }
 
+juce::Reverb::Parameters SendEffectsPlugin::getReverbParameters() const
+{
+    juce::Reverb::Parameters rvParams;
+    rvParams.roomSize   = static_cast<float> (activeReverbParams.roomSize) / 100.0f;
+    rvParams.damping    = static_cast<float> (activeReverbParams.damping) / 100.0f;
+    rvParams.wetLevel   = static_cast<float> (activeReverbParams.wet) / 100.0f;
+    rvParams.dryLevel   = 0.0f; // We only want the wet signal
+    rvParams.width      = 1.0f;
+    rvParams.freezeMode = 0.0f;
+
+    // Map decay to room size blend (decay affects both roomSize and wet)
+    float decayFactor = static_cast<float> (activeReverbParams.decay) / 100.0f;
+    rvParams.roomSize = juce::jlimit (0.0f, 1.0f, rvParams.roomSize * (0.5f + decayFactor * 0.5f));
+
+    return rvParams;
+}
+
+//==============================================================================
+// Tails: how long each effect keeps sounding after its send goes silent
+//==============================================================================
+
+juce::int64 SendEffectsPlugin::getDelayTailSamples() const
+{
+    // Every pass round the loop keeps `feedback` of the level
+    return SilenceGate::tailForFeedback (activeDelayParams.feedback / 100.0, getDelayTimeSamples());
+}
+
+juce::int64 SendEffectsPlugin::getReverbTailSamples() const
+{
+    // juce::Reverb's combs feed back roomSize * 0.28 + 0.7 every pass of up
+    // to 1640 samples (at 44.1kHz), then go through four allpasses
+    const double scale = sampleRate / 44100.0;
+    const double combFeedback = getReverbParameters().roomSize * 0.28 + 0.7;
+    const double allpassSamples = (556 + 441 + 341 + 225 + 4 * 23) * scale;
+    const double preDelaySamples = activeReverbParams.preDelay * sampleRate / 1000.0;
+
+    return SilenceGate::tailForFeedback (combFeedback, 1640.0 * scale)
+         + static_cast<juce::int64> (std::ceil (allpassSamples + preDelaySamples));
+}
+
 //==============================================================================
 // Process delay
 //==============================================================================
@@ -209,20 +251,7 @@ void SendEffectsPlugin::processReverb (const juce::AudioBuffer<float>& input,
     float wet = static_cast<float> (activeReverbParams.wet) / 100.0f;
     if (wet <= 0.0f) return;
 
-    // Configure juce::Reverb parameters
-    juce::Reverb::Parameters rvParams;
-    rvParams.roomSize   = static_cast<float> (activeReverbParams.roomSize) / 100.0f;
-    rvParams.damping    = static_cast<float> (activeReverbParams.damping) / 100.0f;
-    rvParams.wetLevel   = wet;
-    rvParams.dryLevel   = 0.0f; // We only want the wet signal
-    rvParams.width      = 1.0f;
-    rvParams.freezeMode = 0.0f;
-
-    // Map decay to room size blend (decay affects both roomSize and wet)
-    float decayFactor = static_cast<float> (activeReverbParams.decay) / 100.0f;
-    rvParams.roomSize = juce::jlimit (0.0f, 1.0f, rvParams.roomSize * (0.5f + decayFactor * 0.5f));
-
-    reverb.setParameters (rvParams);
+    reverb.setParameters (getReverbParameters());
 
     // Pre-delay: read from a circular buffer offset by preDelay ms
     int preDelaySamples = static_cast<int> (activeReverbParams.preDelay * sampleRate / 1000.0);
@@ -296,17 +325,47 @@ void SendEffectsPlugin::applyToBuffer (const te::PluginRenderContext& fc)
         activeReverbParams = pendingReverbParams;
     }
 
-    // Capture and clear this block slice atomically from shared send buffers.
+    // The bus has no audio of its own; drop whatever its ordering aux return
+    // brought in (the sends are muted)
+    buffer.clear (startSample, numSamples);
+
+    // Sum this block slice across the per-track send slots and clear it there.
     sendBuffers->consumeSlice (delayScratch, reverbInputScratch, startSample, numSamples, 2);
 
+    // Every track has rendered this slice: step the shared global envelopes
+    // through its ticks, on the same edit-sample grid the tracks use
+    if (sampler != nullptr)
+        sampler->advanceGlobalModulation (static_cast<juce::int64> (std::llround (fc.editTime.getStart().inSeconds() * sampleRate)),
+                                          numSamples, sampleRate);
+
     // Process delay and reverb into separate scratch buffers for send return processing
     delayReturnScratch.setSize (2, numSamples, false, false, true);
     delayReturnScratch.clear();
     reverbReturnScratch.setSize (2, numSamples, false, false, true);
     reverbReturnScratch.clear();
 
-    processDelay (delayScratch, delayReturnScratch, 0, numSamples);
-    processReverb (reverbInputScratch, reverbReturnScratch, 0, numSamples);
+    // Each effect sleeps once its send has been silent for longer than its tail.
+    // Anything left in its lines by then is below the silence threshold, so
+    // it's cleared once on the way in rather than carried into the next wake-up.
+    delayGate.setTailSamples (getDelayTailSamples());
+    const bool delayWasSleeping = delayGate.isSleeping();
+    if (! delayGate.update (SilenceGate::isSilent (delayScratch, 0, numSamples), numSamples))
+        processDelay (delayScratch, delayReturnScratch, 0, numSamples);
+    else if (! delayWasSleeping)
+    {
+        delayLine.clear();
+        delayFilter.reset();
+    }
+
+    reverbGate.setTailSamples (getReverbTailSamples());
+    const bool reverbWasSleeping = reverbGate.isSleeping();
+    if (! reverbGate.update (SilenceGate::isSilent (reverbInputScratch, 0, numSamples), numSamples))
+        processReverb (reverbInputScratch, reverbReturnScratch, 0, numSamples);
+    else if (! reverbWasSleeping)
+    {
+        reverb.reset();
+        preDelayBuffer.clear();
+    }
 
     // Apply send return channel processing (EQ, volume, pan)
     if (mixerStatePtr != nullptr)
@@ -316,10 +375,7 @@ void SendEffectsPlugin::applyToBuffer (const te::PluginRenderContext& fc)
 
         if (! delayReturn.muted)
         {
-            processSendReturnEQ (delayReturnScratch, numSamples, delayReturn,
-                                 delayReturnEqLowL, delayReturnEqLowR,
-                                 delayReturnEqMidL, delayReturnEqMidR,
-                                 delayReturnEqHighL, delayReturnEqHighR);
+            processSendReturnEQ (delayReturnScratch, numSamples, delayReturn, delayReturnEq);
             applySendReturnVolumePan (delayReturnScratch, numSamples, delayReturn);
 
             for (int ch = 0; ch < juce::jmin (2, buffer.getNumChannels()); ++ch)
@@ -328,10 +384,7 @@ void SendEffectsPlugin::applyToBuffer (const te::PluginRenderContext& fc)
 
         if (! reverbReturn.muted)
         {
-            processSendReturnEQ (reverbReturnScratch, numSamples, reverbReturn,
-                                 reverbReturnEqLowL, reverbReturnEqLowR,
-                                 reverbReturnEqMidL, reverbReturnEqMidR,
-                                 reverbReturnEqHighL, reverbReturnEqHighR);
+            processSendReturnEQ (reverbReturnScratch, numSamples, reverbReturn, reverbReturnEq);
             applySendReturnVolumePan (reverbReturnScratch, numSamples, reverbReturn);
 
             for (int ch = 0; ch < juce::jmin (2, buffer.getNumChannels()); ++ch)
@@ -413,67 +466,10 @@ void SendEffectsPlugin::applyToBuffer (const te::PluginRenderContext& fc)
 //==============================================================================
 
 void SendEffectsPlugin::processSendReturnEQ (juce::AudioBuffer<float>& buffer, int numSamples,
-                                              const SendReturnState& state,
-                                              juce::dsp::IIR::Filter<float>& eqLowL,
-                                              juce::dsp::IIR::Filter<float>& eqLowR,
-                                              juce::dsp::IIR::Filter<float>& eqMidL,
-                                              juce::dsp::IIR::Filter<float>& eqMidR,
-                                              juce::dsp::IIR::Filter<float>& eqHighL,
-                                              juce::dsp::IIR::Filter<float>& eqHighR)
+                                              const SendReturnState& state, ThreeBandEQ& returnEq)
 {
-    bool hasEQ = state.eqLowGain != 0.0 || state.eqMidGain != 0.0 || state.eqHighGain != 0.0;
-    if (! hasEQ) return;
-
-    {
-        float gain = (state.eqLowGain != 0.0)
-                         ? juce::Decibels::decibelsToGain (static_cast<float> (state.eqLowGain))
-                         : 1.0f;
-        auto coeffs = juce::dsp::IIR::Coefficients<float>::makeLowShelf (sampleRate, 200.0f, 0.707f, gain);
-        eqLowL.coefficients = coeffs;
-        eqLowR.coefficients = coeffs;
-    }
-    {
-        float gain = (state.eqMidGain != 0.0)
-                         ? juce::Decibels::decibelsToGain (static_cast<float> (state.eqMidGain))
-                         : 1.0f;
-        float freq = juce::jlimit (200.0f, 8000.0f, static_cast<float> (state.eqMidFreq));
-        auto coeffs = juce::dsp::IIR::Coefficients<float>::makePeakFilter (sampleRate, freq, 1.0f, gain);
-        eqMidL.coefficients = coeffs;
-        eqMidR.coefficients = coeffs;
-    }
-    {
-        float gain = (state.eqHighGain != 0.0)
-                         ? juce::Decibels::decibelsToGain (static_cast<float> (state.eqHighGain))
-                         : 1.0f;
-        auto coeffs = juce::dsp::IIR::Coefficients<float>::makeHighShelf (sampleRate, 4000.0f, 0.707f, gain);
-        eqHighL.coefficients = coeffs;
-        eqHighR.coefficients = coeffs;
-    }
-
-    if (buffer.getNumChannels() >= 2)
-    {
-        auto* left  = buffer.getWritePointer (0);
-        auto* right = buffer.getWritePointer (1);
-        for (int i = 0; i < numSamples; ++i)
-        {
-            left[i]  = eqLowL.processSample (left[i]);
-            right[i] = eqLowR.processSample (right[i]);
-            left[i]  = eqMidL.processSample (left[i]);
-            right[i] = eqMidR.processSample (right[i]);
-            left[i]  = eqHighL.processSample (left[i]);
-            right[i] = eqHighR.processSample (right[i]);
-        }
-    }
-    else if (buffer.getNumChannels() >= 1)
-    {
-        auto* data = buffer.getWritePointer (0);
-        for (int i = 0; i < numSamples; ++i)
-        {
-            data[i] = eqLowL.processSample (data[i]);
-            data[i] = eqMidL.processSample (data[i]);
-            data[i] = eqHighL.processSample (data[i]);
-        }
-    }
+    returnEq.setSettings (ThreeBandEQ::settingsFrom (state));
+    returnEq.process (buffer, 0, numSamples);
 }
 
 void SendEffectsPlugin::applySendReturnVolumePan (juce::AudioBuffer<float>& buffer, int numSamples,
@@ -515,50 +511,8 @@ void SendEffectsPlugin::processMasterEQ (juce::AudioBuffer<float>& buffer, int s
 {
     if (mixerStatePtr == nullptr) return;
 
-    auto& master = mixerStatePtr->master;
-    bool hasEQ = master.eqLowGain != 0.0 || master.eqMidGain != 0.0 || master.eqHighGain != 0.0;
-    if (! hasEQ) return;
-
-    {
-        float gain = (master.eqLowGain != 0.0)
-                         ? juce::Decibels::decibelsToGain (static_cast<float> (master.eqLowGain))
-                         : 1.0f;
-        auto coeffs = juce::dsp::IIR::Coefficients<float>::makeLowShelf (sampleRate, 200.0f, 0.707f, gain);
-        masterEqLowL.coefficients = coeffs;
-        masterEqLowR.coefficients = coeffs;
-    }
-    {
-        float gain = (master.eqMidGain != 0.0)
-                         ? juce::Decibels::decibelsToGain (static_cast<float> (master.eqMidGain))
-                         : 1.0f;
-        float freq = juce::jlimit (200.0f, 8000.0f, static_cast<float> (master.eqMidFreq));
-        auto coeffs = juce::dsp::IIR::Coefficients<float>::makePeakFilter (sampleRate, freq, 1.0f, gain);
-        masterEqMidL.coefficients = coeffs;
-        masterEqMidR.coefficients = coeffs;
-    }
-    {
-        float gain = (master.eqHighGain != 0.0)
-                         ? juce::Decibels::decibelsToGain (static_cast<float> (master.eqHighGain))
-                         : 1.0f;
-        auto coeffs = juce::dsp::IIR::Coefficients<float>::makeHighShelf (sampleRate, 4000.0f, 0.707f, gain);
-        masterEqHighL.coefficients = coeffs;
-        masterEqHighR.coefficients = coeffs;
-    }
-
-    if (buffer.getNumChannels() >= 2)
-    {
-        auto* left  = buffer.getWritePointer (0, startSample);
-        auto* right = buffer.getWritePointer (1, startSample);
-        for (int i = 0; i < numSamples; ++i)
-        {
-            left[i]  = masterEqLowL.processSample (left[i]);
-            right[i] = masterEqLowR.processSample (right[i]);
-            left[i]  = masterEqMidL.processSample (left[i]);
-            right[i] = masterEqMidR.processSample (right[i]);
-            left[i]  = masterEqHighL.processSample (left[i]);
-            right[i] = masterEqHighR.processSample (right[i]);
-        }
-    }
+    masterEq.setSettings (ThreeBandEQ::settingsFrom (mixerStatePtr->master));
+    masterEq.process (buffer, startSample, numSamples);
 }
 
 //==============================================================================
@@ -569,38 +523,8 @@ void SendEffectsPlugin::processMasterCompressor (juce::AudioBuffer<float>& buffe
 {
     if (mixerStatePtr == nullptr) return;
 
-    auto& master = mixerStatePtr->master;
-    if (master.compThreshold >= 0.0 && master.compRatio <= 1.0) return;
-
-    float thresholdLinear = juce::Decibels::decibelsToGain (static_cast<float> (master.compThreshold));
-    float ratio = static_cast<float> (juce::jmax (1.0, master.compRatio));
-    float attackCoeff  = std::exp (-1.0f / (static_cast<float> (master.compAttack) * 0.001f * static_cast<float> (sampleRate)));
-    float releaseCoeff = std::exp (-1.0f / (static_cast<float> (master.compRelease) * 0.001f * static_cast<float> (sampleRate)));
-
-    int numChannels = buffer.getNumChannels();
-
-    for (int i = 0; i < numSamples; ++i)
-    {
-        float peak = 0.0f;
-        for (int ch = 0; ch < numChannels; ++ch)
-            peak = juce::jmax (peak, std::abs (buffer.getSample (ch, startSample + i)));
-
-        if (peak > masterCompEnvelope)
-            masterCompEnvelope = attackCoeff * masterCompEnvelope + (1.0f - attackCoeff) * peak;
-        else
-            masterCompEnvelope = releaseCoeff * masterCompEnvelope + (1.0f - releaseCoeff) * peak;
-
-        float gain = 1.0f;
-        if (masterCompEnvelope > thresholdLinear && thresholdLinear > 0.0f)
-        {
-            float overDB = juce::Decibels::gainToDecibels (masterCompEnvelope / thresholdLinear);
-            float reductionDB = overDB * (1.0f - 1.0f / ratio);
-            gain = juce::Decibels::decibelsToGain (-reductionDB);
-        }
-
-        for (int ch = 0; ch < numChannels; ++ch)
-            buffer.getWritePointer (ch)[startSample + i] *= gain;
-    }
+    masterCompressor.setSettings (Dynamics::Compressor::settingsFrom (mixerStatePtr->master));
+    masterCompressor.process (buffer, startSample, numSamples);
 }
 
 //==============================================================================
@@ -611,33 +535,6 @@ void SendEffectsPlugin::processMasterLimiter (juce::AudioBuffer<float>& buffer,
 {
     if (mixerStatePtr == nullptr) return;
 
-    auto& master = mixerStatePtr->master;
-    if (master.limiterThreshold >= 0.0) return;  // 0 dB = off
-
-    float thresholdLinear = juce::Decibels::decibelsToGain (static_cast<float> (master.limiterThreshold));
-    float releaseCoeff = std::exp (-1.0f / (static_cast<float> (master.limiterRelease) * 0.001f * static_cast<float> (sampleRate)));
-
-    int numChannels = buffer.getNumChannels();
-
-    for (int i = 0; i < numSamples; ++i)
-    {
-        float peak = 0.0f;
-        for (int ch = 0; ch < numChannels; ++ch)
-            peak = juce::jmax (peak, std::abs (buffer.getSample (ch, startSample + i)));
-
-        float targetGain = 1.0f;
-        if (peak > thresholdLinear && thresholdLinear > 0.0f)
-            targetGain = thresholdLinear / peak;
-
-        // Fast attack (essentially instant), slow release
-        if (targetGain < masterLimiterEnvelope)
-            masterLimiterEnvelope = targetGain;
-        else
-            masterLimiterEnvelope = releaseCoeff * masterLimiterEnvelope + (1.0f - releaseCoeff) * targetGain;
-
-        masterLimiterEnvelope = juce::jlimit (0.0f, 1.0f, masterLimiterEnvelope);
-
-        for (int ch = 0; ch < numChannels; ++ch)
-            buffer.getWritePointer (ch)[startSample + i] *= masterLimiterEnvelope;
-    }
+    masterLimiter.setSettings (Dynamics::Limiter::settingsFrom (mixerStatePtr->master));
+    masterLimiter.process (buffer, startSample, numSamples);
 }
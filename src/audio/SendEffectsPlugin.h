@@ -5,9 +5,14 @@
 #include "SendBuffers.h"
 #include "SendEffectsParams.h"
 #include "MixerState.h"
+#include "ThreeBandEQ.h"
+#include "SilenceGate.h"
+#include "Dynamics.h"
 
 namespace te = tracktion;
 
+class SimpleSampler;
+
 class SendEffectsPlugin : public te::Plugin
 {
 public:
@@ -32,9 +37,21 @@ public:
     juce::String getSelectableDescription() override    { return getName(); }
     bool needsConstantBufferSize() override             { return false; }
 
+    // The master limiter delays the send returns by its maximum lookahead
+    // whatever the setting, so the other tracks are compensated by a latency
+    // that never changes (and never forces a graph rebuild)
+    double getLatencySeconds() override
+    {
+        return Dynamics::Limiter::getMaxLookaheadSamples (sampleRate) / sampleRate;
+    }
+
     // Shared send buffers (owned by SimpleSampler, set during setup)
     void setSendBuffers (SendBuffers* buffers) { sendBuffers = buffers; }
 
+    // Instruments whose global envelopes the bus steps once per block, after
+    // the tracks that read them have rendered it
+    void setSamplerSource (SimpleSampler* s) { sampler = s; }
+
     // Mixer state pointer for send return and master processing
     void setMixerState (MixerState* state) { mixerStatePtr = state; }
 
@@ -64,8 +81,13 @@ public:
     float getMasterPeakLevel() const { return masterPeakLevel.load (std::memory_order_relaxed); }
     void resetMasterPeak() { masterPeakLevel.store (0.0f, std::memory_order_relaxed); }
 
+    // True while nothing is sent and the delay / reverb tails have died out
+    bool isDelaySleeping() const  { return delayGate.isSleeping(); }
+    bool isReverbSleeping() const { return reverbGate.isSleeping(); }
+
 private:
     SendBuffers* sendBuffers = nullptr;
+    SimpleSampler* sampler = nullptr;
     MixerState* mixerStatePtr = nullptr;
 
     // Thread-safe param exchange: UI writes pending, audio copies to active
@@ -95,28 +117,26 @@ private:
     juce::AudioBuffer<float> delayReturnScratch;
     juce::AudioBuffer<float> reverbReturnScratch;
 
-    // Send return EQ filters
-    juce::dsp::IIR::Filter<float> delayReturnEqLowL, delayReturnEqLowR;
-    juce::dsp::IIR::Filter<float> delayReturnEqMidL, delayReturnEqMidR;
-    juce::dsp::IIR::Filter<float> delayReturnEqHighL, delayReturnEqHighR;
-    juce::dsp::IIR::Filter<float> reverbReturnEqLowL, reverbReturnEqLowR;
-    juce::dsp::IIR::Filter<float> reverbReturnEqMidL, reverbReturnEqMidR;
-    juce::dsp::IIR::Filter<float> reverbReturnEqHighL, reverbReturnEqHighR;
+    // Send return EQs
+    ThreeBandEQ delayReturnEq;
+    ThreeBandEQ reverbReturnEq;
 
-    // Master EQ filters
-    juce::dsp::IIR::Filter<float> masterEqLowL, masterEqLowR;
-    juce::dsp::IIR::Filter<float> masterEqMidL, masterEqMidR;
-    juce::dsp::IIR::Filter<float> masterEqHighL, masterEqHighR;
+    // Master EQ
+    ThreeBandEQ masterEq;
 
-    // Master compressor state
-    float masterCompEnvelope = 0.0f;
-
-    // Master limiter state
-    float masterLimiterEnvelope = 0.0f;
+    // Master dynamics. Only the delay and reverb returns pass through here
+    // (the bus clears its input), so the limiter and its lookahead act on
+    // the returns alone; its fixed latency is this plugin's.
+    Dynamics::Compressor masterCompressor;
+    Dynamics::Limiter masterLimiter;
 
     // Master peak level
     std::atomic<float> masterPeakLevel { 0.0f };
 
+    // Skip the delay and reverb while their sends are silent and they've rung out
+    SilenceGate delayGate;
+    SilenceGate reverbGate;
+
     // Processing helpers
     void processDelay (const juce::AudioBuffer<float>& input,
                        juce::AudioBuffer<float>& output,
@@ -127,13 +147,13 @@ private:
                         int startSample,
                         int numSamples);
     int getDelayTimeSamples() const;
+    juce::Reverb::Parameters getReverbParameters() const;
+    juce::int64 getDelayTailSamples() const;
+    juce::int64 getReverbTailSamples() const;
 
     // Send return processing
     void processSendReturnEQ (juce::AudioBuffer<float>& buffer, int numSamples,
-                              const SendReturnState& state,
-                              juce::dsp::IIR::Filter<float>& eqLowL, juce::dsp::IIR::Filter<float>& eqLowR,
-                              juce::dsp::IIR::Filter<float>& eqMidL, juce::dsp::IIR::Filter<float>& eqMidR,
-                              juce::dsp::IIR::Filter<float>& eqHighL, juce::dsp::IIR::Filter<float>& eqHighR);
+                              const SendReturnState& state, ThreeBandEQ& returnEq);
     void applySendReturnVolumePan (juce::AudioBuffer<float>& buffer, int numSamples,
                                    const SendReturnState& state);
 
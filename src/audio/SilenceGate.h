@@ -0,0 +1,95 @@
+#pragma once
+
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <JuceHeader.h>
+
+/**
+ * Idle detection for one processing stage of a track or the send bus.
+ *
+ * The stage reports once per block whether its input was silent. Once the
+ * input has stayed silent for longer than the stage's tail (how long its own
+ * state takes to ring out: filter decay, compressor release, delay feedback,
+ * reverb decay), its output is silent as well and the stage sleeps: it skips
+ * its audio processing until a block with audio arrives. Control state
+ * (events, modulators, parameter snapshots) keeps running while asleep.
+ */
+class SilenceGate
+{
+public:
+    /** Peak level treated as silence (-100 dB). */
+    static constexpr float kThreshold = 1.0e-5f;
+
+    /** Tail that never ends (a stage that can't go to sleep). */
+    static constexpr juce::int64 kInfiniteTail = std::numeric_limits<juce::int64>::max();
+
+    static bool isSilent (const juce::AudioBuffer<float>& buffer, int startSample, int numSamples) noexcept
+    {
+        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+            if (buffer.getMagnitude (ch, startSample, numSamples) > kThreshold)
+                return false;
+        return true;
+    }
+
+    /** Samples for an exponential decay with this time constant to fall from full scale below kThreshold. */
+    static juce::int64 tailForTimeConstant (double timeConstantSamples) noexcept
+    {
+        if (timeConstantSamples <= 0.0)
+            return 0;
+        return static_cast<juce::int64> (std::ceil (timeConstantSamples * std::log (1.0 / kThreshold)));
+    }
+
+    /** Samples for a loop that keeps `feedback` of its level on every pass to fall below kThreshold. */
+    static juce::int64 tailForFeedback (double feedback, double loopSamples) noexcept
+    {
+        if (feedback <= 0.0)
+            return static_cast<juce::int64> (std::ceil (loopSamples));
+        if (feedback >= 0.999)
+            return kInfiniteTail;
+
+        const double passes = std::ceil (std::log (static_cast<double> (kThreshold)) / std::log (feedback)) + 1.0;
+        return static_cast<juce::int64> (std::ceil (passes * loopSamples));
+    }
+
+    void setTailSamples (juce::int64 samples) noexcept { tailSamples = juce::jmax<juce::int64> (0, samples); }
+
+    /**
+     * Call once per block before processing it. Returns true when the stage
+     * can skip the block: its input is silent and has been for the whole tail.
+     */
+    bool update (bool inputSilent, int numSamples) noexcept
+    {
+        if (! inputSilent)
+        {
+            silentSamples = 0;
+            sleeping.store (false, std::memory_order_relaxed);
+            return false;
+        }
+
+        if (silentSamples >= tailSamples)
+        {
+            sleeping.store (true, std::memory_order_relaxed);
+            return true;
+        }
+
+        // This block still carries the tail of earlier audio
+        silentSamples += numSamples;
+        return false;
+    }
+
+    /** Back to awake (the next block is processed). */
+    void reset() noexcept
+    {
+        silentSamples = 0;
+        sleeping.store (false, std::memory_order_relaxed);
+    }
+
+    /** Readable from any thread (profiling). */
+    bool isSleeping() const noexcept { return sleeping.load (std::memory_order_relaxed); }
+
+private:
+    juce::int64 tailSamples = 0;
+    juce::int64 silentSamples = 0;
+    std::atomic<bool> sleeping { false };
+};
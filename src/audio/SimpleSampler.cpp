@@ -1,5 +1,6 @@
 #include "SimpleSampler.h"
 #include "InstrumentEffectsPlugin.h"
+#include "PatternSequencerPlugin.h"
 
 GlobalModState* SimpleSampler::getOrCreateGlobalModState (int instrumentIndex)
 {
@@ -12,18 +13,41 @@ GlobalModState* SimpleSampler::getOrCreateGlobalModState (int instrumentIndex)
     auto state = std::make_unique<GlobalModState>();
     auto* ptr = state.get();
     globalModStates[instrumentIndex] = std::move (state);
+
+    if (juce::isPositiveAndBelow (instrumentIndex, InstrumentSnapshotTable::kNumSlots))
+        globalModStateSlots[static_cast<size_t> (instrumentIndex)].store (ptr, std::memory_order_release);
+
     return ptr;
 }
 
+void SimpleSampler::advanceGlobalModulation (juce::int64 blockStart, int numSamples, double sampleRate) noexcept
+{
+    for (int inst = 0; inst < InstrumentSnapshotTable::kNumSlots; ++inst)
+    {
+        auto* state = globalModStateSlots[static_cast<size_t> (inst)].load (std::memory_order_acquire);
+        if (state == nullptr)
+            continue;
+
+        if (auto snapshot = paramSnapshots.acquire (inst))
+            state->advance (snapshot->params, blockStart, numSamples, sampleRate);
+    }
+}
+
 TrackerSamplerPlugin* SimpleSampler::getOrCreateTrackerSampler (te::AudioTrack& track)
 {
+    const auto limits = getVoiceLimits();
+
     if (auto* existing = track.pluginList.findFirstPluginOfType<TrackerSamplerPlugin>())
+    {
+        existing->setVoiceLimits (limits.polyphony, limits.stealing);
         return existing;
+    }
 
     if (auto plugin = dynamic_cast<TrackerSamplerPlugin*> (
             track.edit.getPluginCache().createNewPlugin (TrackerSamplerPlugin::xmlTypeName, {}).get()))
     {
-        track.pluginList.insertPlugin (*plugin, 0, nullptr);
+        track.pluginList.insertPlugin (*plugin, PatternSequencerPlugin::getSoundSourceIndex (track.pluginList), nullptr);
+        plugin->setVoiceLimits (limits.polyphony, limits.stealing);
         return plugin;
     }
 
@@ -32,13 +56,16 @@ TrackerSamplerPlugin* SimpleSampler::getOrCreateTrackerSampler (te::AudioTrack&
 
 InstrumentEffectsPlugin* SimpleSampler::getOrCreateEffectsPlugin (te::AudioTrack& track, int instrumentIndex)
 {
+    // Audio track order matches TrackerEngine's track indices
+    const int sendSlot = SendBuffers::slotForTrack (te::getAudioTracks (track.edit).indexOf (&track));
+
     for (auto* plugin : track.pluginList)
     {
         if (auto* fx = dynamic_cast<InstrumentEffectsPlugin*> (plugin))
         {
             fx->setSamplerSource (this);
             fx->setInstrumentIndex (instrumentIndex);
-            fx->setSendBuffers (&sendBuffers);
+            fx->setSendBuffers (&sendBuffers, sendSlot);
             return fx;
         }
     }
@@ -46,11 +73,11 @@ InstrumentEffectsPlugin* SimpleSampler::getOrCreateEffectsPlugin (te::AudioTrack
     if (auto fx = dynamic_cast<InstrumentEffectsPlugin*> (
             track.edit.getPluginCache().createNewPlugin (InstrumentEffectsPlugin::xmlTypeName, {}).get()))
     {
-        int insertPos = 1;
+        int insertPos = PatternSequencerPlugin::getSoundSourceIndex (track.pluginList) + 1;
         track.pluginList.insertPlugin (*fx, insertPos, nullptr);
         fx->setSamplerSource (this);
         fx->setInstrumentIndex (instrumentIndex);
-        fx->setSendBuffers (&sendBuffers);
+        fx->setSendBuffers (&sendBuffers, sendSlot);
         return fx;
     }
 
@@ -67,36 +94,95 @@ void SimpleSampler::setupPluginChain (te::AudioTrack& track, int instrumentIndex
 // Load sample
 //==============================================================================
 
-juce::String SimpleSampler::loadInstrumentSample (const juce::File& sampleFile, int instrumentIndex)
+std::shared_ptr<SampleBank> SimpleSampler::loadSampleBank (const juce::File& file, juce::String& error,
+                                                           const SampleBank::ProgressCallback& onProgress)
 {
-    if (! sampleFile.existsAsFile())
-        return "File not found: " + sampleFile.getFullPathName();
-
     juce::AudioFormatManager formatManager;
     formatManager.registerBasicFormats();
 
-    std::unique_ptr<juce::AudioFormatReader> reader (formatManager.createReaderFor (sampleFile));
-    if (reader == nullptr)
-        return "Failed to read audio file: " + sampleFile.getFullPathName();
+    SampleBank::LoadOptions options;
+    {
+        const juce::SpinLock::ScopedLockType lock (stateLock);
+        options = sampleLoadOptions;
+    }
+
+    options.mipMapBudget = mipMapBudget;
 
-    auto bank = std::make_shared<SampleBank>();
-    bank->sampleRate = reader->sampleRate;
-    bank->numChannels = static_cast<int> (reader->numChannels);
-    bank->totalSamples = static_cast<juce::int64> (reader->lengthInSamples);
-    bank->sourceFile = sampleFile;
-    bank->buffer.setSize (bank->numChannels, static_cast<int> (reader->lengthInSamples));
-    reader->read (&bank->buffer, 0, static_cast<int> (reader->lengthInSamples), 0, true, true);
+    auto bank = SampleBank::loadFromFile (file, formatManager, options, error, onProgress);
+    if (bank != nullptr)
+        streamPrefetcher.add (bank);
 
+    return bank;
+}
+
+void SimpleSampler::setSampleLoadOptions (const SampleBank::LoadOptions& options)
+{
+    const juce::SpinLock::ScopedLockType lock (stateLock);
+    sampleLoadOptions = options;
+}
+
+SampleBank::LoadOptions SimpleSampler::getSampleLoadOptions() const
+{
+    const juce::SpinLock::ScopedLockType lock (stateLock);
+    return sampleLoadOptions;
+}
+
+SimpleSampler::SampleMemory SimpleSampler::getSampleMemoryUsage() const
+{
+    const juce::SpinLock::ScopedLockType lock (stateLock);
+
+    SampleMemory usage;
+    for (const auto& [index, bank] : sampleBanks)
+    {
+        if (bank == nullptr)
+            continue;
+
+        usage.total += bank->getMemoryUsage();
+        usage.mipMaps += bank->getMipMapMemoryUsage();
+    }
+    return usage;
+}
+
+void SimpleSampler::setVoiceLimits (const VoiceLimits& limits)
+{
+    const juce::SpinLock::ScopedLockType lock (stateLock);
+    voiceLimits = { juce::jlimit (1, SamplerVoicePool::kMaxPolyphony, limits.polyphony), limits.stealing };
+}
+
+SimpleSampler::VoiceLimits SimpleSampler::getVoiceLimits() const
+{
+    const juce::SpinLock::ScopedLockType lock (stateLock);
+    return voiceLimits;
+}
+
+juce::String SimpleSampler::loadInstrumentSample (const juce::File& sampleFile, int instrumentIndex)
+{
+    juce::String error;
+    auto bank = loadSampleBank (sampleFile, error);
+    if (bank == nullptr)
+        return error;
+
+    installSampleBank (instrumentIndex, sampleFile, std::move (bank));
+    return {};
+}
+
+void SimpleSampler::installSampleBank (int instrumentIndex, const juce::File& sampleFile, std::shared_ptr<SampleBank> bank)
+{
+    bool createdParams = false;
     {
         const juce::SpinLock::ScopedLockType lock (stateLock);
-        sampleBanks[instrumentIndex] = bank;
+        sampleBanks[instrumentIndex] = std::move (bank);
         loadedSamples[instrumentIndex] = sampleFile;
 
         if (instrumentParams.find (instrumentIndex) == instrumentParams.end())
+        {
             instrumentParams[instrumentIndex] = InstrumentParams {};
+            createdParams = true;
+        }
     }
 
-    return {};
+    if (createdParams)
+        paramSnapshots.publish (instrumentIndex, InstrumentParams {});
 }
 
 juce::String SimpleSampler::loadSample (te::AudioTrack& track, const juce::File& sampleFile, int instrumentIndex)
@@ -132,11 +218,15 @@ std::map<int, juce::File> SimpleSampler::getLoadedSamples() const
 
 void SimpleSampler::clearLoadedSamples()
 {
-    const juce::SpinLock::ScopedLockType lock (stateLock);
-    loadedSamples.clear();
-    instrumentParams.clear();
-    sampleBanks.clear();
-    // Keep globalModStates alive: effects plugins can still hold pointers.
+    {
+        const juce::SpinLock::ScopedLockType lock (stateLock);
+        loadedSamples.clear();
+        instrumentParams.clear();
+        sampleBanks.clear();
+        // Keep globalModStates alive: effects plugins can still hold pointers.
+    }
+
+    paramSnapshots.clear();
 }
 
 std::shared_ptr<const SampleBank> SimpleSampler::getSampleBank (int instrumentIndex) const
@@ -170,8 +260,13 @@ bool SimpleSampler::getParamsIfPresent (int instrumentIndex, InstrumentParams& o
 
 void SimpleSampler::setParams (int instrumentIndex, const InstrumentParams& params)
 {
-    const juce::SpinLock::ScopedLockType lock (stateLock);
-    instrumentParams[instrumentIndex] = params;
+    {
+        const juce::SpinLock::ScopedLockType lock (stateLock);
+        instrumentParams[instrumentIndex] = params;
+    }
+
+    // Snapshot is built outside the spin lock (it allocates)
+    paramSnapshots.publish (instrumentIndex, params);
 }
 
 std::map<int, InstrumentParams> SimpleSampler::getAllParams() const
@@ -182,8 +277,12 @@ std::map<int, InstrumentParams> SimpleSampler::getAllParams() const
 
 void SimpleSampler::clearAllParams()
 {
-    const juce::SpinLock::ScopedLockType lock (stateLock);
-    instrumentParams.clear();
+    {
+        const juce::SpinLock::ScopedLockType lock (stateLock);
+        instrumentParams.clear();
+    }
+
+    paramSnapshots.clear();
 }
 
 //==============================================================================
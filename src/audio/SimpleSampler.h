@@ -1,9 +1,12 @@
 #pragma once
 
+#include <array>
 #include <atomic>
 #include <JuceHeader.h>
 #include <tracktion_engine/tracktion_engine.h>
+#include "GlobalModState.h"
 #include "InstrumentParams.h"
+#include "InstrumentSnapshot.h"
 #include "TrackerSamplerPlugin.h"
 #include "SendBuffers.h"
 
@@ -11,24 +14,6 @@ namespace te = tracktion;
 
 class InstrumentEffectsPlugin;
 
-// Shared global modulation state for an instrument (used when ModMode == Global)
-struct GlobalModState
-{
-    // Per-destination envelope state (atomic for audio-thread safety)
-    struct AtomicEnvState
-    {
-        std::atomic<int> stage { 0 };    // 0=Idle, 1=Attack, 2=Decay, 3=Sustain, 4=Release
-        std::atomic<float> level { 0.0f };
-    };
-    std::array<AtomicEnvState, InstrumentParams::kNumModDests> envStates {};
-
-    // Track how many notes are active across all tracks using this instrument
-    std::atomic<int> activeNoteCount { 0 };
-
-    // Deduplication: only advance envelopes once per audio block
-    std::atomic<uint64_t> lastProcessedBlock { 0 };
-};
-
 class SimpleSampler
 {
 public:
@@ -59,6 +44,19 @@ public:
     std::map<int, InstrumentParams> getAllParams() const;
     void clearAllParams();
 
+    // Real-time safe params access for the audio thread (pointer load, no lock/copy).
+    // Returns a default-params snapshot when the instrument has none published.
+    InstrumentSnapshotPtr getParamsSnapshot (int instrumentIndex) const noexcept
+    {
+        return paramSnapshots.acquireOrDefault (instrumentIndex);
+    }
+
+    // Same, but nullptr when the instrument has no params.
+    InstrumentSnapshotPtr getParamsSnapshotIfPresent (int instrumentIndex) const noexcept
+    {
+        return paramSnapshots.acquire (instrumentIndex);
+    }
+
     // Apply params to sampler plugin (no file I/O, just updates plugin state)
     juce::String applyParams (te::AudioTrack& track, int instrumentIndex);
 
@@ -69,19 +67,69 @@ public:
     // Sample bank access
     std::shared_ptr<const SampleBank> getSampleBank (int instrumentIndex) const;
 
+    // Decodes/maps a file with the current load options and registers it for
+    // streaming. Used for instruments and for browser previews.
+    // Thread-safe; the loader pool calls it with a progress callback.
+    std::shared_ptr<SampleBank> loadSampleBank (const juce::File& file, juce::String& error,
+                                                const SampleBank::ProgressCallback& onProgress = nullptr);
+
+    // Make a decoded bank the instrument's sample (creates default params if needed)
+    void installSampleBank (int instrumentIndex, const juce::File& sampleFile, std::shared_ptr<SampleBank> bank);
+
+    // How samples are held in memory (16-bit, streaming threshold, mip-maps);
+    // applies to samples loaded after the call. Mip-maps of every loaded bank
+    // share one budget (MipMapBudget::kDefaultLimitBytes).
+    void setSampleLoadOptions (const SampleBank::LoadOptions& options);
+    SampleBank::LoadOptions getSampleLoadOptions() const;
+
+    // RAM held by the instruments' sample banks, and the mip-map share of it
+    struct SampleMemory
+    {
+        size_t total = 0;
+        size_t mipMaps = 0;
+    };
+
+    SampleMemory getSampleMemoryUsage() const;
+
+    // Voice pool given to each sampler track as its plugin chain is set up:
+    // the polyphony its note lanes share and which voice is stolen past it.
+    struct VoiceLimits
+    {
+        int polyphony = SamplerVoicePool::kDefaultPolyphony;
+        SamplerVoicePool::Stealing stealing = SamplerVoicePool::Stealing::Oldest;
+    };
+
+    void setVoiceLimits (const VoiceLimits& limits);
+    VoiceLimits getVoiceLimits() const;
+
     // Global modulation state (shared across tracks for same instrument)
     GlobalModState* getOrCreateGlobalModState (int instrumentIndex);
 
+    // Render side: steps every instrument's global envelopes through the
+    // control-rate ticks of one block (blockStart in edit samples). Called once
+    // per block, after every track has rendered it (SendEffectsPlugin does it,
+    // ordered after the tracks by the graph), so tracks only read them.
+    void advanceGlobalModulation (juce::int64 blockStart, int numSamples, double sampleRate) noexcept;
+
     // Shared send buffers for delay/reverb sends
     SendBuffers& getSendBuffers() { return sendBuffers; }
 
 private:
+    // Guards the maps below for the message and loader threads only. Render
+    // threads read params via paramSnapshots and banks via each
+    // TrackerSamplerPlugin's preloaded map, so parallel tracks never touch it.
     mutable juce::SpinLock stateLock;
     SendBuffers sendBuffers;
     std::map<int, juce::File> loadedSamples;
     std::map<int, InstrumentParams> instrumentParams;
     std::map<int, std::shared_ptr<SampleBank>> sampleBanks;
     std::map<int, std::unique_ptr<GlobalModState>> globalModStates;
+    std::array<std::atomic<GlobalModState*>, InstrumentSnapshotTable::kNumSlots> globalModStateSlots {};
+    InstrumentSnapshotTable paramSnapshots;
+    SampleBank::LoadOptions sampleLoadOptions;
+    const std::shared_ptr<MipMapBudget> mipMapBudget = std::make_shared<MipMapBudget>();
+    VoiceLimits voiceLimits;
+    SampleStreamPrefetcher streamPrefetcher;
 
     TrackerSamplerPlugin* getOrCreateTrackerSampler (te::AudioTrack& track);
 
@@ -0,0 +1,294 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <JuceHeader.h>
+
+/**
+ * 3-band EQ kernel shared by the channel strips, send returns and master:
+ * low shelf 200Hz, parametric mid (200-8000Hz, Q 1), high shelf 4kHz.
+ *
+ * Coefficients are designed only when the gains/frequency change (no
+ * juce::dsp::IIR::Coefficients allocation on the audio thread) and are then
+ * ramped towards the new values in kRampChunk-sample steps, so moving a knob
+ * doesn't click. Both channels go through the three cascaded biquads in a
+ * single pass with the filter state kept in locals for the whole block.
+ * A flat EQ is bypassed once its ramp has finished.
+ */
+class ThreeBandEQ
+{
+public:
+    static constexpr int kNumBands = 3;
+    static constexpr int kRampChunk = 32;
+
+    // Normalised biquad (a0 == 1), transposed direct form II like juce::dsp::IIR::Filter
+    struct Biquad
+    {
+        float b0 = 1.0f, b1 = 0.0f, b2 = 0.0f, a1 = 0.0f, a2 = 0.0f;
+    };
+
+    using Bands = std::array<Biquad, kNumBands>;
+
+    struct Settings
+    {
+        double lowGainDb = 0.0;
+        double midGainDb = 0.0;
+        double highGainDb = 0.0;
+        double midFreq = 1000.0;
+
+        bool isFlat() const { return lowGainDb == 0.0 && midGainDb == 0.0 && highGainDb == 0.0; }
+        bool operator== (const Settings&) const = default;
+    };
+
+    /** Works with TrackMixState, SendReturnState and MasterMixState. */
+    template <typename MixState>
+    static Settings settingsFrom (const MixState& s)
+    {
+        return { s.eqLowGain, s.eqMidGain, s.eqHighGain, s.eqMidFreq };
+    }
+
+    //==============================================================================
+    void prepare (double newSampleRate, double rampSeconds = 0.02)
+    {
+        sampleRate = newSampleRate;
+        rampChunks = juce::jmax (1, juce::roundToInt (rampSeconds * sampleRate / kRampChunk));
+        reset();
+    }
+
+    /** Clears the filter state; the next setSettings() applies without a ramp. */
+    void reset()
+    {
+        clearState();
+        current = target = Bands {};
+        chunksRemaining = 0;
+        primed = false;
+    }
+
+    /** Cheap when nothing changed; call once per block with the latest mix state. */
+    void setSettings (const Settings& newSettings)
+    {
+        if (primed && newSettings == settings)
+            return;
+
+        settings = newSettings;
+        target = designBands (settings, sampleRate);
+
+        if (! primed)
+        {
+            current = target;
+            chunksRemaining = 0;
+            primed = true;
+            return;
+        }
+
+        const float scale = 1.0f / static_cast<float> (rampChunks);
+        for (size_t b = 0; b < kNumBands; ++b)
+        {
+            step[b].b0 = (target[b].b0 - current[b].b0) * scale;
+            step[b].b1 = (target[b].b1 - current[b].b1) * scale;
+            step[b].b2 = (target[b].b2 - current[b].b2) * scale;
+            step[b].a1 = (target[b].a1 - current[b].a1) * scale;
+            step[b].a2 = (target[b].a2 - current[b].a2) * scale;
+        }
+        chunksRemaining = rampChunks;
+    }
+
+    bool isActive() const { return ! settings.isFlat() || chunksRemaining > 0; }
+
+    /** Processes in place. right may be nullptr for mono. */
+    void process (float* left, float* right, int numSamples) noexcept
+    {
+        if (! isActive())
+            return;
+
+        while (numSamples > 0)
+        {
+            const int n = chunksRemaining > 0 ? juce::jmin (numSamples, kRampChunk) : numSamples;
+
+            if (right != nullptr)
+                processStereo (left, right, n);
+            else
+                processMono (left, n);
+
+            left += n;
+            if (right != nullptr)
+                right += n;
+            numSamples -= n;
+
+            if (chunksRemaining > 0)
+                advanceRamp();
+        }
+
+        // Ramped back to flat: drop the state so re-enabling starts clean
+        if (! isActive())
+            clearState();
+    }
+
+    void process (juce::AudioBuffer<float>& buffer, int startSample, int numSamples) noexcept
+    {
+        if (buffer.getNumChannels() >= 2)
+            process (buffer.getWritePointer (0, startSample), buffer.getWritePointer (1, startSample), numSamples);
+        else if (buffer.getNumChannels() == 1)
+            process (buffer.getWritePointer (0, startSample), nullptr, numSamples);
+    }
+
+    //==============================================================================
+    /** Same responses as juce::dsp::IIR::Coefficients makeLowShelf/makePeakFilter/makeHighShelf. */
+    static Bands designBands (const Settings& s, double sampleRate)
+    {
+        auto gainFactor = [] (double db) { return db != 0.0 ? std::pow (10.0, db * 0.05) : 1.0; };
+
+        return { makeLowShelf (sampleRate, 200.0, 0.707, gainFactor (s.lowGainDb)),
+                 makePeak (sampleRate, juce::jlimit (200.0, 8000.0, s.midFreq), 1.0, gainFactor (s.midGainDb)),
+                 makeHighShelf (sampleRate, 4000.0, 0.707, gainFactor (s.highGainDb)) };
+    }
+
+    const Bands& getCurrentBands() const { return current; }
+
+private:
+    double sampleRate = 44100.0;
+    Settings settings;
+    Bands current, target, step;
+    int rampChunks = 1;
+    int chunksRemaining = 0;
+    bool primed = false;
+
+    // [band][channel]
+    float z1[kNumBands][2] {};
+    float z2[kNumBands][2] {};
+
+    void clearState()
+    {
+        for (int b = 0; b < kNumBands; ++b)
+            for (int ch = 0; ch < 2; ++ch)
+                z1[b][ch] = z2[b][ch] = 0.0f;
+    }
+
+    void advanceRamp()
+    {
+        if (--chunksRemaining == 0)
+        {
+            current = target;
+            return;
+        }
+
+        for (size_t b = 0; b < kNumBands; ++b)
+        {
+            current[b].b0 += step[b].b0;
+            current[b].b1 += step[b].b1;
+            current[b].b2 += step[b].b2;
+            current[b].a1 += step[b].a1;
+            current[b].a2 += step[b].a2;
+        }
+    }
+
+    static inline float tick (const Biquad& c, float x, float& s1, float& s2) noexcept
+    {
+        const float y = c.b0 * x + s1;
+        s1 = c.b1 * x - c.a1 * y + s2;
+        s2 = c.b2 * x - c.a2 * y;
+        return y;
+    }
+
+    void processStereo (float* left, float* right, int numSamples) noexcept
+    {
+        const auto lo = current[0], mid = current[1], hi = current[2];
+
+        float l01 = z1[0][0], l02 = z2[0][0], r01 = z1[0][1], r02 = z2[0][1];
+        float l11 = z1[1][0], l12 = z2[1][0], r11 = z1[1][1], r12 = z2[1][1];
+        float l21 = z1[2][0], l22 = z2[2][0], r21 = z1[2][1], r22 = z2[2][1];
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            float l = left[i];
+            float r = right[i];
+
+            l = tick (lo, l, l01, l02);
+            r = tick (lo, r, r01, r02);
+            l = tick (mid, l, l11, l12);
+            r = tick (mid, r, r11, r12);
+            l = tick (hi, l, l21, l22);
+            r = tick (hi, r, r21, r22);
+
+            left[i] = l;
+            right[i] = r;
+        }
+
+        z1[0][0] = l01; z2[0][0] = l02; z1[0][1] = r01; z2[0][1] = r02;
+        z1[1][0] = l11; z2[1][0] = l12; z1[1][1] = r11; z2[1][1] = r12;
+        z1[2][0] = l21; z2[2][0] = l22; z1[2][1] = r21; z2[2][1] = r22;
+    }
+
+    void processMono (float* data, int numSamples) noexcept
+    {
+        const auto lo = current[0], mid = current[1], hi = current[2];
+
+        float s01 = z1[0][0], s02 = z2[0][0];
+        float s11 = z1[1][0], s12 = z2[1][0];
+        float s21 = z1[2][0], s22 = z2[2][0];
+
+        for (int i = 0; i < numSamples; ++i)
+            data[i] = tick (hi, tick (mid, tick (lo, data[i], s01, s02), s11, s12), s21, s22);
+
+        z1[0][0] = s01; z2[0][0] = s02;
+        z1[1][0] = s11; z2[1][0] = s12;
+        z1[2][0] = s21; z2[2][0] = s22;
+    }
+
+    //==============================================================================
+    // RBJ cookbook designs, as implemented by juce::dsp::IIR::ArrayCoefficients
+
+    static Biquad normalise (double b0, double b1, double b2, double a0, double a1, double a2)
+    {
+        const double inv = 1.0 / a0;
+        return { static_cast<float> (b0 * inv), static_cast<float> (b1 * inv), static_cast<float> (b2 * inv),
+                 static_cast<float> (a1 * inv), static_cast<float> (a2 * inv) };
+    }
+
+    static Biquad makeLowShelf (double sr, double freq, double q, double gainFactor)
+    {
+        const double A = std::sqrt (juce::jmax (0.0, gainFactor));
+        const double aminus1 = A - 1.0, aplus1 = A + 1.0;
+        const double omega = (juce::MathConstants<double>::twoPi * juce::jmax (freq, 2.0)) / sr;
+        const double coso = std::cos (omega);
+        const double beta = std::sin (omega) * std::sqrt (A) / q;
+        const double aminus1TimesCoso = aminus1 * coso;
+
+        return normalise (A * (aplus1 - aminus1TimesCoso + beta),
+                          A * 2.0 * (aminus1 - aplus1 * coso),
+                          A * (aplus1 - aminus1TimesCoso - beta),
+                          aplus1 + aminus1TimesCoso + beta,
+                          -2.0 * (aminus1 + aplus1 * coso),
+                          aplus1 + aminus1TimesCoso - beta);
+    }
+
+    static Biquad makeHighShelf (double sr, double freq, double q, double gainFactor)
+    {
+        const double A = std::sqrt (juce::jmax (0.0, gainFactor));
+        const double aminus1 = A - 1.0, aplus1 = A + 1.0;
+        const double omega = (juce::MathConstants<double>::twoPi * juce::jmax (freq, 2.0)) / sr;
+        const double coso = std::cos (omega);
+        const double beta = std::sin (omega) * std::sqrt (A) / q;
+        const double aminus1TimesCoso = aminus1 * coso;
+
+        return normalise (A * (aplus1 + aminus1TimesCoso + beta),
+                          A * -2.0 * (aminus1 + aplus1 * coso),
+                          A * (aplus1 + aminus1TimesCoso - beta),
+                          aplus1 - aminus1TimesCoso + beta,
+                          2.0 * (aminus1 - aplus1 * coso),
+                          aplus1 - aminus1TimesCoso - beta);
+    }
+
+    static Biquad makePeak (double sr, double freq, double q, double gainFactor)
+    {
+        const double A = std::sqrt (juce::jmax (0.0, gainFactor));
+        const double omega = (juce::MathConstants<double>::twoPi * juce::jmax (freq, 2.0)) / sr;
+        const double alpha = std::sin (omega) / (q * 2.0);
+        const double c2 = -2.0 * std::cos (omega);
+        const double alphaTimesA = alpha * A;
+        const double alphaOverA = alpha / A;
+
+        return normalise (1.0 + alphaTimesA, c2, 1.0 - alphaTimesA,
+                          1.0 + alphaOverA, c2, 1.0 - alphaOverA);
+    }
+};
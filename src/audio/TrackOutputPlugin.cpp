@@ -24,17 +24,20 @@ void TrackOutputPlugin::initialise (const te::PluginInitialisationInfo& info)
     double rampSeconds = 0.008;
     smoothedGainL.reset (sampleRate, rampSeconds);
     smoothedGainR.reset (sampleRate, rampSeconds);
+    silenceGate.reset();
+    setReadyForChain (true);
 }
 
 void TrackOutputPlugin::deinitialise()
 {
+    setReadyForChain (false);
 }
 
 //==============================================================================
 // Volume and Pan (from mixer state)
 //==============================================================================
 
-void TrackOutputPlugin::processVolumeAndPan (juce::AudioBuffer<float>& buffer, int startSample, int numSamples)
+void TrackOutputPlugin::updateGainTargets()
 {
     float gain;
     if (localMixState.volume <= -99.0)
@@ -48,6 +51,11 @@ void TrackOutputPlugin::processVolumeAndPan (juce::AudioBuffer<float>& buffer, i
 
     smoothedGainL.setTargetValue (targetLeftGain);
     smoothedGainR.setTargetValue (targetRightGain);
+}
+
+void TrackOutputPlugin::processVolumeAndPan (juce::AudioBuffer<float>& buffer, int startSample, int numSamples)
+{
+    updateGainTargets();
 
     if (buffer.getNumChannels() >= 2)
     {
@@ -78,13 +86,13 @@ void TrackOutputPlugin::processSends (const juce::AudioBuffer<float>& buffer, in
     if (localMixState.reverbSend > -99.0)
     {
         float reverbGain = juce::Decibels::decibelsToGain (static_cast<float> (localMixState.reverbSend));
-        sendBuffers->addToReverb (buffer, startSample, numSamples, reverbGain);
+        sendBuffers->addToReverb (sendSlot, buffer, startSample, numSamples, reverbGain);
     }
 
     if (localMixState.delaySend > -99.0)
     {
         float delayGain = juce::Decibels::decibelsToGain (static_cast<float> (localMixState.delaySend));
-        sendBuffers->addToDelay (buffer, startSample, numSamples, delayGain);
+        sendBuffers->addToDelay (sendSlot, buffer, startSample, numSamples, delayGain);
     }
 }
 
@@ -93,6 +101,15 @@ void TrackOutputPlugin::processSends (const juce::AudioBuffer<float>& buffer, in
 //==============================================================================
 
 void TrackOutputPlugin::applyToBuffer (const te::PluginRenderContext& fc)
+{
+    // Already run by the track's sampler (fused chain)
+    if (takeRanInChain (fc))
+        return;
+
+    processStage (fc);
+}
+
+void TrackOutputPlugin::processStage (const te::PluginRenderContext& fc)
 {
     if (fc.destBuffer == nullptr) return;
 
@@ -105,6 +122,15 @@ void TrackOutputPlugin::applyToBuffer (const te::PluginRenderContext& fc)
     int startSample = fc.bufferStartSample;
     int numSamples = fc.bufferNumSamples;
 
+    // Silent track: nothing to send or meter, the fader just keeps moving
+    if (silenceGate.update (SilenceGate::isSilent (buffer, startSample, numSamples), numSamples))
+    {
+        updateGainTargets();
+        smoothedGainL.skip (numSamples);
+        smoothedGainR.skip (numSamples);
+        return;
+    }
+
     // DSP chain: Pre-fader Sends -> Volume/Pan
     processSends (buffer, startSample, numSamples);
     processVolumeAndPan (buffer, startSample, numSamples);
@@ -2,8 +2,10 @@
 
 #include <JuceHeader.h>
 #include <tracktion_engine/tracktion_engine.h>
+#include "FusedTrackChain.h"
 #include "MixerState.h"
 #include "SendBuffers.h"
+#include "SilenceGate.h"
 
 namespace te = tracktion;
 
@@ -16,7 +18,8 @@ namespace te = tracktion;
  * Signal chain position:
  *   Sampler -> InstrumentEffects -> ChannelStrip -> [Insert Plugins] -> TrackOutput
  */
-class TrackOutputPlugin : public te::Plugin
+class TrackOutputPlugin : public te::Plugin,
+                          public FusedChainStage
 {
 public:
     TrackOutputPlugin (te::PluginCreationInfo);
@@ -41,17 +44,21 @@ public:
     bool needsConstantBufferSize() override             { return false; }
 
     void setMixState (const TrackMixState& s);
-    void setSendBuffers (SendBuffers* b) { sendBuffers = b; }
+    void setSendBuffers (SendBuffers* b, int slot = SendBuffers::kSharedSlot) { sendBuffers = b; sendSlot = slot; }
 
     // Peak level metering (audio thread writes, UI thread reads)
     float getPeakLevel() const { return peakLevel.load (std::memory_order_relaxed); }
     void resetPeak() { peakLevel.store (0.0f, std::memory_order_relaxed); }
 
+    // True while everything upstream on the track is silent
+    bool isSleeping() const { return silenceGate.isSleeping(); }
+
 private:
     juce::SpinLock mixStateLock;
     TrackMixState sharedMixState;
     TrackMixState localMixState;
     SendBuffers* sendBuffers = nullptr;
+    int sendSlot = SendBuffers::kSharedSlot;
 
     // Smoothed gain
     juce::SmoothedValue<float, juce::ValueSmoothingTypes::Linear> smoothedGainL { 1.0f };
@@ -60,6 +67,12 @@ private:
     // Peak level (written on audio thread, read on UI thread)
     std::atomic<float> peakLevel { 0.0f };
 
+    // No tail of its own: sleeps on the first silent block
+    SilenceGate silenceGate;
+
+    void updateGainTargets();
+
+    void processStage (const te::PluginRenderContext&) override;
     void processVolumeAndPan (juce::AudioBuffer<float>& buffer, int startSample, int numSamples);
     void processSends (const juce::AudioBuffer<float>& buffer, int startSample, int numSamples);
 
@@ -1,4 +1,5 @@
 #include <algorithm>
+#include <tuple>
 #include "TrackerEngine.h"
 #include "InstrumentEffectsPlugin.h"
 #include "TrackerSamplerPlugin.h"
@@ -8,20 +9,29 @@
 #include "ChannelStripPlugin.h"
 #include "TrackOutputPlugin.h"
 #include "InstrumentRouting.h"
-#include "FxParamTransport.h"
+#include "TrackerEvent.h"
+#include "PatternNotes.h"
+#include "PatternSequencerPlugin.h"
+#include "PatternTrackBlock.h"
 
 namespace
 {
-constexpr int kCcFxTune = 31;
-constexpr int kCcFxPortaSteps = 32;
-constexpr int kCcFxSlideUp = 33;
-constexpr int kCcFxSlideDown = 34;
-constexpr int kCcFxDelaySend = 35;
-constexpr int kCcFxReverbSend = 36;
-constexpr int kCcSamplerDirection = 37;
-constexpr int kCcSamplerPosition = 38;
-constexpr int kCcFxNoteReset = 39;
-constexpr int kCcFxVolume = 40;
+// Feeds the user's CPU count to the playback graph (read whenever the
+// Edit's playback context is created)
+class TrackerEngineBehaviour : public te::EngineBehaviour
+{
+public:
+    explicit TrackerEngineBehaviour (const std::atomic<int>& cpus) : numCpus (cpus) {}
+
+    int getNumberOfCPUsToUseForAudio() override
+    {
+        const int n = numCpus.load (std::memory_order_relaxed);
+        return n > 0 ? n : te::EngineBehaviour::getNumberOfCPUsToUseForAudio();
+    }
+
+private:
+    const std::atomic<int>& numCpus;
+};
 
 char getSlotCommandLetter (const FxSlot& slot)
 {
@@ -48,43 +58,252 @@ int getRowTempoCommand (const Pattern& pattern, int row)
     return bpm;
 }
 
-void appendSymbolicTrackFx (juce::MidiMessageSequence& midiSeq, const FxSlot& slot, double ccTime)
+// The tempo changes a pattern's master lane makes when it plays on its own (beat -> bpm)
+std::map<double, int> getPatternTempoPoints (const Pattern& pattern, int rpb)
 {
-    switch (getSlotCommandLetter (slot))
+    std::map<double, int> tempoPoints;
+    for (int row = 0; row < pattern.numRows; ++row)
     {
-        case 'B':
-            FxParamTransport::appendByteAsControllers (midiSeq, 1, kCcSamplerDirection, slot.fxParam, ccTime);
-            break;
-        case 'P':
-            FxParamTransport::appendByteAsControllers (midiSeq, 1, kCcSamplerPosition, slot.fxParam, ccTime);
-            break;
-        case 'T':
-            FxParamTransport::appendByteAsControllers (midiSeq, 1, kCcFxTune, slot.fxParam, ccTime);
-            break;
-        case 'G':
-            FxParamTransport::appendByteAsControllers (midiSeq, 1, kCcFxPortaSteps, slot.fxParam, ccTime);
-            break;
-        case 'Y':
-            FxParamTransport::appendByteAsControllers (midiSeq, 1, kCcFxDelaySend, slot.fxParam, ccTime);
-            break;
-        case 'R':
-            FxParamTransport::appendByteAsControllers (midiSeq, 1, kCcFxReverbSend, slot.fxParam, ccTime);
-            break;
-        case 'S':
-            FxParamTransport::appendByteAsControllers (midiSeq, 1, kCcFxSlideUp, slot.fxParam, ccTime);
-            break;
-        case 'D':
-            FxParamTransport::appendByteAsControllers (midiSeq, 1, kCcFxSlideDown, slot.fxParam, ccTime);
-            break;
-        case 'V':
-            FxParamTransport::appendByteAsControllers (midiSeq, 1, kCcFxVolume, slot.fxParam, ccTime);
-            break;
-        case 'F':
-            // Tempo is handled via master lane tempo points.
-            break;
-        default:
-            break;
+        int bpm = getRowTempoCommand (pattern, row);
+        if (bpm <= 0)
+            continue;
+
+        double beat = static_cast<double> (row) / static_cast<double> (rpb);
+        tempoPoints[beat] = bpm;
     }
+    return tempoPoints;
+}
+
+void appendTrackerEvent (TrackerEventList::Segment& events, TrackerEvent::Command command, int param,
+                         double time, int row, int lane = 0, int instrument = -1)
+{
+    TrackerEvent e;
+    e.time = time;
+    e.row = static_cast<uint16_t> (juce::jlimit (0, 0xFFFF, row));
+    e.instrument = static_cast<int16_t> (instrument);
+    e.lane = static_cast<uint8_t> (lane & 0xFF);
+    e.command = command;
+    e.param = static_cast<uint8_t> (juce::jlimit (0, 255, param));
+    events.push_back (e);
+}
+
+// A note on a portamento row glides the lane's note instead of retriggering
+void appendPortamentoEvents (TrackerEventList::Segment& events, const NoteSlot& noteSlot, int row, int laneIdx,
+                             int instrument, double rowTime)
+{
+    if (noteSlot.volume >= 0)
+        appendTrackerEvent (events, TrackerEvent::Command::PortaVolume, noteSlot.volume, rowTime, row, laneIdx, instrument);
+    appendTrackerEvent (events, TrackerEvent::Command::PortaTarget, noteSlot.note & 0x7F, rowTime, row, laneIdx, instrument);
+}
+
+void collectTrackInstruments (const Pattern& pattern, int trackIdx, std::vector<int>& trackInstruments)
+{
+    pattern.forEachNonEmptyCell (trackIdx, [&] (int, CellView cell)
+    {
+        // Scan all note lanes for instruments
+        int numLanes = cell.getNumNoteLanes();
+        for (int nl = 0; nl < numLanes; ++nl)
+        {
+            int inst = cell.getNoteLane (nl).instrument;
+            if (inst >= 0
+                && std::find (trackInstruments.begin(), trackInstruments.end(), inst) == trackInstruments.end())
+            {
+                trackInstruments.push_back (inst);
+            }
+        }
+    });
+}
+
+// The clip syncPatternToEdit owns on a track, or nullptr if the track holds
+// anything else (e.g. song-mode arrangement clips) and must be rebuilt.
+te::MidiClip* findPatternClip (te::AudioTrack& track)
+{
+    auto clips = track.getClips();
+    if (clips.size() != 1)
+        return nullptr;
+
+    auto* midiClip = dynamic_cast<te::MidiClip*> (clips.getUnchecked (0));
+    if (midiClip == nullptr || midiClip->getName() != "Pattern")
+        return nullptr;
+
+    return midiClip;
+}
+
+void removeAllClips (te::AudioTrack& track)
+{
+    auto clips = track.getClips();
+    for (int i = clips.size(); --i >= 0;)
+        clips.getUnchecked (i)->removeFromParent();
+}
+
+// Times a block's FX column on rowTimes (seconds at the start of each of
+// its rows, plus its end)
+void appendBlockFxEvents (TrackerEventList::Segment& events, const PatternTrackBlock& block,
+                          const std::vector<double>& rowTimes)
+{
+    for (const auto& fx : block.fxEvents)
+        appendTrackerEvent (events, fx.command, fx.param, rowTimes[static_cast<size_t> (fx.row)], fx.row);
+}
+
+// Emits one note lane of a block: notes as MIDI, portamento targets as
+// tracker events.
+template <typename Sink>
+void appendBlockLaneEvents (Sink& midiSink, TrackerEventList::Segment& events,
+                            const PatternTrackBlock& block, int laneIdx, bool multiLane, bool isKill,
+                            const std::vector<double>& rowTimes, PatternNotes::LanePlayState& state)
+{
+    if (laneIdx < block.numNoteLanes)
+    {
+        for (const auto& op : block.lanes[static_cast<size_t> (laneIdx)].ops)
+        {
+            const double rowTime = rowTimes[static_cast<size_t> (op.row)];
+            const int instrument = state.currentInst;
+
+            switch (PatternNotes::playNoteOp (midiSink, op, laneIdx, multiLane, rowTime, state))
+            {
+                case PatternNotes::OpResult::glide:
+                    appendPortamentoEvents (events, { op.note, op.instrument, op.volume }, op.row, laneIdx,
+                                            instrument, rowTime);
+                    break;
+
+                case PatternNotes::OpResult::noteStarted:
+                    PatternNotes::appendNoteEnd (midiSink, laneIdx, multiLane, isKill, op.note,
+                                                 rowTimes[static_cast<size_t> (op.endRow)]);
+                    break;
+
+                case PatternNotes::OpResult::released:
+                    break;
+            }
+        }
+    }
+
+    PatternNotes::finishBlock (block, laneIdx, state);
+}
+
+// Only one note lane's portamento targets, for the sequencer (which plays
+// the notes itself)
+void appendBlockLaneGlides (TrackerEventList::Segment& events, const PatternTrackBlock& block, int laneIdx,
+                            const std::vector<double>& rowTimes, PatternNotes::LanePlayState& state)
+{
+    if (laneIdx < block.numNoteLanes)
+    {
+        for (const auto& op : block.lanes[static_cast<size_t> (laneIdx)].ops)
+        {
+            const int instrument = state.currentInst;
+            if (PatternNotes::stepNoteOp (op, state).result == PatternNotes::OpResult::glide)
+                appendPortamentoEvents (events, { op.note, op.instrument, op.volume }, op.row, laneIdx,
+                                        instrument, rowTimes[static_cast<size_t> (op.row)]);
+        }
+    }
+
+    PatternNotes::finishBlock (block, laneIdx, state);
+}
+
+// What one note lane does over a block it enters in a given state: the
+// ops it glides on (with the instrument playing) and the state it leaves in
+struct LaneEntry
+{
+    std::vector<std::pair<size_t, int>> glides;
+    PatternNotes::LanePlayState exitState;
+};
+
+// The edit's tempo and time signature changes, read once to tell which
+// stretches of the song time their beats alike
+class TempoSpans
+{
+public:
+    explicit TempoSpans (te::TempoSequence& tempoSequence)
+    {
+        for (auto* tempo : tempoSequence.getTempos())
+            tempos.push_back ({ tempo->startBeatNumber.get().inBeats(), tempo->getBpm(),
+                                static_cast<double> (tempo->getCurve()), 0.0 });
+
+        for (auto* timeSig : tempoSequence.getTimeSigs())
+            timeSigs.push_back ({ timeSig->startBeatNumber.get().inBeats(), static_cast<double> (timeSig->numerator.get()),
+                                  static_cast<double> (timeSig->denominator.get()), timeSig->triplets.get() ? 1.0 : 0.0 });
+    }
+
+    // What the tempo map does over beats [startBeat, endBeat], positioned
+    // from startBeat. Spans with equal keys take equally long over each of
+    // their beats.
+    std::vector<double> getKey (double startBeat, double endBeat) const
+    {
+        std::vector<double> key;
+        appendChanges (key, tempos, startBeat, endBeat, true);
+        appendChanges (key, timeSigs, startBeat, endBeat, false);
+        return key;
+    }
+
+private:
+    using Change = std::array<double, 4>;   // start beat, then the setting
+    std::vector<Change> tempos, timeSigs;
+
+    // The change in force at startBeat and each one after it before endBeat.
+    // A tempo ramps towards the next change unless that one keeps its bpm,
+    // so only then does where the two sit matter.
+    static void appendChanges (std::vector<double>& key, const std::vector<Change>& changes,
+                               double startBeat, double endBeat, bool ramps)
+    {
+        auto change = std::upper_bound (changes.begin(), changes.end(), startBeat,
+                                        [] (double beat, const Change& c) { return beat < c[0]; });
+        if (change != changes.begin())
+            --change;
+
+        for (bool inForce = true; change != changes.end() && (inForce || (*change)[0] < endBeat); ++change, inForce = false)
+        {
+            key.push_back (juce::jmax (0.0, (*change)[0] - startBeat));
+            key.insert (key.end(), change->begin() + 1, change->end());
+
+            const auto next = change + 1;
+            if (ramps && next != changes.end() && (*next)[1] != (*change)[1])
+            {
+                key.push_back ((*change)[0] - startBeat);
+                key.push_back ((*next)[0] - startBeat);
+                key.push_back ((*next)[1]);
+            }
+        }
+
+        key.push_back (-1.0);   // ends this list of changes
+    }
+};
+
+// Compiles a cued pattern into everything playback switches to, on the row
+// -> time table of the pattern's own tempo map. Runs on the cue worker, so it
+// compiles afresh rather than going through the block cache.
+PatternCueCompiler::Compiled compileCuedPattern (const Pattern& pattern, std::vector<double> rowTimes,
+                                                 const std::array<bool, kNumTracks>& trackKill)
+{
+    PatternCueCompiler::Compiled compiled;
+    auto sequence = std::make_shared<PatternSequence>();
+    sequence->blocks.emplace_back();
+    sequence->placements.push_back ({ 0, 0, 0, 0.0 });
+
+    for (int trackIdx = 0; trackIdx < kNumTracks; ++trackIdx)
+    {
+        const auto t = static_cast<size_t> (trackIdx);
+        auto block = PatternTrackBlock::compile (pattern, trackIdx);
+
+        // The sequencer plays the notes; the lanes only add their portamento targets
+        TrackerEventList::Segment segment;
+        appendBlockFxEvents (segment, *block, rowTimes);
+
+        for (int laneIdx = 0; laneIdx < block->numNoteLanes; ++laneIdx)
+        {
+            PatternNotes::LanePlayState laneState;
+            appendBlockLaneGlides (segment, *block, laneIdx, rowTimes, laneState);
+        }
+
+        auto events = std::make_shared<TrackerEventList>();
+        events->place (TrackerEventList::makeSegment (std::move (segment)), 0.0);
+        compiled.trackerEvents[t] = std::move (events);
+        compiled.instrumentsByTrack[t] = block->instruments;
+        sequence->tracks[t] = { block->numNoteLanes, trackKill[t] };
+        sequence->blocks[0][t] = std::move (block);
+    }
+
+    sequence->rowTimings.push_back (std::move (rowTimes));
+    compiled.sequence = std::move (sequence);
+    return compiled;
 }
 
 te::Plugin* findInsertPluginForSlot (te::AudioTrack& track, int slotIndex)
@@ -122,16 +341,65 @@ te::Plugin* findInsertPluginForSlot (te::AudioTrack& track, int slotIndex)
 
     return nullptr;
 }
+
+// The stages a track's sampler can run itself: only while the built-in
+// plugins sit back to back (sampler, effects, strip, output), all enabled.
+// Inserts or a plugin instrument in between keep the plain plugin chain.
+std::shared_ptr<const FusedTrackChain> makeFusedTrackChain (te::AudioTrack& track)
+{
+    auto& pluginList = track.pluginList;
+
+    int samplerIdx = -1;
+    for (int i = 0; i < pluginList.size(); ++i)
+    {
+        if (dynamic_cast<TrackerSamplerPlugin*> (pluginList[i]) != nullptr)
+        {
+            samplerIdx = i;
+            break;
+        }
+    }
+
+    if (samplerIdx < 0 || samplerIdx + FusedTrackChain::kNumStages >= pluginList.size())
+        return nullptr;
+
+    auto* effects = dynamic_cast<InstrumentEffectsPlugin*> (pluginList[samplerIdx + 1]);
+    auto* strip = dynamic_cast<ChannelStripPlugin*> (pluginList[samplerIdx + 2]);
+    auto* output = dynamic_cast<TrackOutputPlugin*> (pluginList[samplerIdx + 3]);
+    if (effects == nullptr || strip == nullptr || output == nullptr)
+        return nullptr;
+
+    for (int i = samplerIdx; i <= samplerIdx + FusedTrackChain::kNumStages; ++i)
+        if (! pluginList[i]->isEnabled())
+            return nullptr;
+
+    auto chain = std::make_shared<FusedTrackChain>();
+    chain->plugins = { te::Plugin::Ptr (effects), te::Plugin::Ptr (strip), te::Plugin::Ptr (output) };
+    chain->stages = { effects, strip, output };
+    return chain;
+}
 } // namespace
 
 TrackerEngine::TrackerEngine()
 {
     currentTrackInstrument.fill (-1);
+
+    sampleLoader.onBankInstalled = [this] (int instrumentIndex) { publishSampleBank (instrumentIndex); };
+    cueCompiler.onCompiled = [this] (PatternCueCompiler::Compiled compiled) { armCuedPattern (std::move (compiled)); };
+    sampleLoader.onProgressChanged = [this]
+    {
+        if (onSampleLoadProgress != nullptr)
+            onSampleLoadProgress();
+    };
 }
 
 TrackerEngine::~TrackerEngine()
 {
     stopTimer();
+    sampleLoader.onBankInstalled = nullptr;
+    sampleLoader.onProgressChanged = nullptr;
+    sampleLoader.cancelAll();
+    cueCompiler.onCompiled = nullptr;
+    cueCompiler.cancel();
 
     if (edit != nullptr)
     {
@@ -144,9 +412,15 @@ TrackerEngine::~TrackerEngine()
 
     // Release plugin references while Edit is still alive to avoid dangling
     // access to ParameterChangeHandler mutexes during destruction.
+    if (edit != nullptr)
+        for (auto* track : te::getAudioTracks (*edit))
+            if (auto* samplerPlugin = track->pluginList.findFirstPluginOfType<TrackerSamplerPlugin>())
+                samplerPlugin->setFusedChain (nullptr);
+
     pluginInstrumentEditorWindows.clear();
     pluginEditorWindows.clear();
     pluginInstrumentInstances.clear();
+    automationStage.clear();
 
     sendEffectsPlugin = nullptr;
     edit = nullptr;
@@ -156,7 +430,9 @@ TrackerEngine::~TrackerEngine()
 
 void TrackerEngine::initialise()
 {
-    engine = std::make_unique<te::Engine> ("TrackerAdjust");
+    engine = std::make_unique<te::Engine> ("TrackerAdjust", nullptr,
+                                           std::make_unique<TrackerEngineBehaviour> (renderCpus));
+    renderThreading.strategy = static_cast<te::graph::ThreadPoolStrategy> (te::EditPlaybackContext::getThreadPoolStrategy());
 
     // Register custom plugin types
     engine->getPluginManager().createBuiltInType<InstrumentEffectsPlugin>();
@@ -166,6 +442,7 @@ void TrackerEngine::initialise()
     engine->getPluginManager().createBuiltInType<MixerPlugin>();
     engine->getPluginManager().createBuiltInType<ChannelStripPlugin>();
     engine->getPluginManager().createBuiltInType<TrackOutputPlugin>();
+    engine->getPluginManager().createBuiltInType<PatternSequencerPlugin>();
 
     // Create plugin catalog service
     pluginCatalog = std::make_unique<PluginCatalogService> (*engine);
@@ -202,6 +479,55 @@ void TrackerEngine::initialise()
     edit->getTransport().ensureContextAllocated();
 }
 
+//==============================================================================
+// Multi-threaded rendering
+//==============================================================================
+
+juce::StringArray TrackerEngine::getThreadPoolStrategyNames()
+{
+    // Same order as te::graph::ThreadPoolStrategy
+    return { "Condition variable", "Realtime (spin)", "Hybrid", "Semaphore",
+             "Lightweight semaphore", "Lightweight semaphore hybrid" };
+}
+
+void TrackerEngine::setRenderThreading (const RenderThreading& settings)
+{
+    renderThreading = settings;
+    renderThreading.numCpus = juce::jlimit (0, juce::SystemStats::getNumCpus(), settings.numCpus);
+    renderCpus.store (renderThreading.numCpus, std::memory_order_relaxed);
+    te::EditPlaybackContext::setThreadPoolStrategy (static_cast<int> (renderThreading.strategy));
+
+    if (edit == nullptr)
+        return;
+
+    // The worker pool is created with the playback context
+    auto& transport = edit->getTransport();
+    const bool wasPlaying = transport.isPlaying();
+    transport.freePlaybackContext();
+    transport.ensureContextAllocated();
+
+    if (wasPlaying)
+        transport.play (false);
+}
+
+void TrackerEngine::setSamplerVoiceLimits (const SimpleSampler::VoiceLimits& limits)
+{
+    sampler.setVoiceLimits (limits);
+
+    if (edit == nullptr)
+        return;
+
+    const auto applied = sampler.getVoiceLimits();
+    for (auto* track : te::getAudioTracks (*edit))
+        if (auto* samplerPlugin = track->pluginList.findFirstPluginOfType<TrackerSamplerPlugin>())
+            samplerPlugin->setVoiceLimits (applied.polyphony, applied.stealing);
+}
+
+juce::StringArray TrackerEngine::getVoiceStealingNames()
+{
+    return { "Oldest", "Quietest" };
+}
+
 void TrackerEngine::rebuildTempoSequenceFromPatternMasterLane (const Pattern& pattern)
 {
     if (edit == nullptr)
@@ -215,18 +541,7 @@ void TrackerEngine::rebuildTempoSequenceFromPatternMasterLane (const Pattern& pa
 
     tempoSequence.getTempos()[0]->setBpm (baseBpm);
 
-    std::map<double, int> tempoPoints;
-    for (int row = 0; row < pattern.numRows; ++row)
-    {
-        int bpm = getRowTempoCommand (pattern, row);
-        if (bpm <= 0)
-            continue;
-
-        double beat = static_cast<double> (row) / static_cast<double> (rowsPerBeat);
-        tempoPoints[beat] = bpm;
-    }
-
-    for (const auto& [beat, bpm] : tempoPoints)
+    for (const auto& [beat, bpm] : getPatternTempoPoints (pattern, rowsPerBeat))
     {
         if (beat <= 0.0)
             tempoSequence.getTempos()[0]->setBpm (bpm);
@@ -251,24 +566,31 @@ void TrackerEngine::rebuildTempoSequenceFromArrangementMasterLane (const std::ve
     std::map<double, int> tempoPoints;
     double beatOffset = 0.0;
 
+    // Each distinct pattern's tempo rows, found once however often it plays
+    std::map<const Pattern*, std::vector<std::pair<int, int>>> tempoRowsByPattern;
+
     for (const auto& [pattern, repeats] : sequence)
     {
         if (pattern == nullptr)
             continue;
 
-        const double patternLengthBeats = static_cast<double> (pattern->numRows) / static_cast<double> (rpb);
-
-        for (int rep = 0; rep < repeats; ++rep)
+        auto [tempoRows, isNew] = tempoRowsByPattern.try_emplace (pattern);
+        if (isNew)
         {
             for (int row = 0; row < pattern->numRows; ++row)
             {
-                int bpm = getRowTempoCommand (*pattern, row);
-                if (bpm <= 0)
-                    continue;
-
-                double beat = beatOffset + static_cast<double> (row) / static_cast<double> (rpb);
-                tempoPoints[beat] = bpm;
+                const int bpm = getRowTempoCommand (*pattern, row);
+                if (bpm > 0)
+                    tempoRows->second.emplace_back (row, bpm);
             }
+        }
+
+        const double patternLengthBeats = static_cast<double> (pattern->numRows) / static_cast<double> (rpb);
+
+        for (int rep = 0; rep < repeats; ++rep)
+        {
+            for (const auto& [row, bpm] : tempoRows->second)
+                tempoPoints[beatOffset + static_cast<double> (row) / static_cast<double> (rpb)] = bpm;
 
             beatOffset += patternLengthBeats;
         }
@@ -289,228 +611,166 @@ void TrackerEngine::syncPatternToEdit (const Pattern& pattern,
     if (edit == nullptr)
         return;
 
-    rebuildTempoSequenceFromPatternMasterLane (pattern);
-
-    // Ensure correct instruments are loaded on each track
-    prepareTracksForPattern (pattern);
+    auto& cache = patternSyncCache;
 
-    auto tracks = te::getAudioTracks (*edit);
+    // Anything that moves row times (length, rows per beat, master tempo lane,
+    // base tempo) invalidates every track's clip.
+    const bool fullRebuild = ! cache.valid
+                             || cache.numRows != pattern.numRows
+                             || cache.rowsPerBeat != rowsPerBeat
+                             || cache.masterRevision != pattern.getMasterRevision()
+                             || cache.baseBpm != edit->tempoSequence.getTempos()[0]->getBpm();
 
-    for (int trackIdx = 0; trackIdx < kNumTracks && trackIdx < tracks.size(); ++trackIdx)
+    if (fullRebuild)
     {
-        auto* track = tracks[trackIdx];
-
-        // Remove existing clips
-        auto clips = track->getClips();
-        for (int i = clips.size(); --i >= 0;)
-            clips.getUnchecked (i)->removeFromParent();
-
-        // Calculate pattern length in beats
-        double patternLengthBeats = static_cast<double> (pattern.numRows) / static_cast<double> (rowsPerBeat);
-
-        // Convert beats to time using the tempo sequence
-        auto endTime = edit->tempoSequence.toTime (te::BeatPosition::fromBeats (patternLengthBeats));
-        auto startTime = te::TimePosition::fromSeconds (0.0);
+        rebuildTempoSequenceFromPatternMasterLane (pattern);
+        cache.valid = false;
+    }
 
-        te::TimeRange timeRange { startTime, endTime };
+    auto tracks = te::getAudioTracks (*edit);
 
-        // Create MIDI clip
-        auto midiClip = track->insertMIDIClip ("Pattern", timeRange, nullptr);
-        if (midiClip == nullptr)
-            continue;
+    // Work out which tracks need re-emitting. Clean tracks keep their clip as-is.
+    std::array<bool, kNumTracks> trackDirty {};
+    std::array<bool, kNumTracks> trackKill {};
+    std::array<std::vector<int>, kNumTracks> instrumentsByTrack {};
+    bool anyDirty = false;
 
-        // Build MIDI sequence from pattern data (all note lanes)
-        juce::MidiMessageSequence midiSeq;
+    for (int trackIdx = 0; trackIdx < kNumTracks && trackIdx < tracks.size(); ++trackIdx)
+    {
+        const auto t = static_cast<size_t> (trackIdx);
 
         // For plugin instrument tracks, always use release mode (no allSoundOff).
         // allSoundOff kills ALL voices on the channel, preventing subsequent notes
         // from sounding.  Kill/release mode only applies to sample instruments.
-        bool isKill = ! releaseMode[static_cast<size_t> (trackIdx)];
-        if (getTrackContentMode (trackIdx) == TrackContentMode::PluginInstrument)
-            isKill = false;
+        trackKill[t] = ! releaseMode[t]
+                       && getTrackContentMode (trackIdx) != TrackContentMode::PluginInstrument;
 
-        // Determine how many note lanes this track has
-        int numNoteLanes = 1;
-        for (int row = 0; row < pattern.numRows; ++row)
+        trackDirty[t] = fullRebuild
+                        || cache.trackRevisions[t] != pattern.getTrackRevision (trackIdx)
+                        || cache.trackKill[t] != trackKill[t]
+                        || (! realtimeSequencing && findPatternClip (*tracks[trackIdx]) == nullptr);
+
+        if (trackDirty[t])
         {
-            int nl = pattern.getCell (row, trackIdx).getNumNoteLanes();
-            if (nl > numNoteLanes)
-                numNoteLanes = nl;
+            cache.trackBlocks[t] = getPatternTrackBlock (pattern, trackIdx);
+            instrumentsByTrack[t] = cache.trackBlocks[t]->instruments;
+            anyDirty = true;
         }
+    }
 
-        // Process FX slots (shared across all note lanes, emitted once per row)
-        // Also collect per-lane portamento state
-        std::vector<int> laneActivePortaSteps (static_cast<size_t> (numNoteLanes), 0);
+    if (anyDirty)
+    {
+        // Ensure correct instruments are loaded on each re-emitted track
+        prepareTracksForInstrumentUsage (instrumentsByTrack);
 
-        for (int row = 0; row < pattern.numRows; ++row)
+        // Row start times (plus pattern end) resolved once against the tempo sequence
+        std::vector<double> rowTimes (static_cast<size_t> (pattern.numRows) + 1);
+        for (int row = 0; row <= pattern.numRows; ++row)
         {
-            const auto& cell = pattern.getCell (row, trackIdx);
-            double startBeat = static_cast<double> (row) / static_cast<double> (rowsPerBeat);
-            auto rowTime = edit->tempoSequence.toTime (te::BeatPosition::fromBeats (startBeat));
+            double beat = static_cast<double> (row) / static_cast<double> (rowsPerBeat);
+            rowTimes[static_cast<size_t> (row)] = edit->tempoSequence.toTime (te::BeatPosition::fromBeats (beat)).inSeconds();
+        }
 
-            // Check if any lane has a note for FX reset
-            bool anyLaneHasNote = false;
-            for (int nl = 0; nl < numNoteLanes; ++nl)
-            {
-                auto slot = cell.getNoteLane (nl);
-                if (slot.note >= 0)
-                    anyLaneHasNote = true;
-            }
+        te::TimeRange timeRange { te::TimePosition::fromSeconds (0.0),
+                                  te::TimePosition::fromSeconds (rowTimes.back()) };
+        syncedContentRange = timeRange;
 
-            if (anyLaneHasNote)
-            {
-                const double resetTime = juce::jmax (0.0, rowTime.inSeconds() - 0.00008);
-                midiSeq.addEvent (juce::MidiMessage::controllerEvent (1, kCcFxNoteReset, 0), resetTime);
-            }
+        for (int trackIdx = 0; trackIdx < kNumTracks && trackIdx < tracks.size(); ++trackIdx)
+        {
+            const auto t = static_cast<size_t> (trackIdx);
+            if (! trackDirty[t])
+                continue;
 
-            // Process FX slots (shared)
-            for (int fxSlotIdx = 0; fxSlotIdx < cell.getNumFxSlots(); ++fxSlotIdx)
-            {
-                const auto& fxSlot = cell.getFxSlot (fxSlotIdx);
-                if (fxSlot.isEmpty())
-                    continue;
+            auto* track = tracks[trackIdx];
+            TrackerEventList::Segment segment;
+            const auto& block = *cache.trackBlocks[t];
+            appendBlockFxEvents (segment, block, rowTimes);
 
-                const auto letter = getSlotCommandLetter (fxSlot);
-                if (letter == '\0')
-                    continue;
+            if (realtimeSequencing)
+            {
+                // The sequencer plays the notes; only the FX events are compiled here
+                removeAllClips (*track);
 
-                if (letter == 'G' && fxSlot.fxParam > 0)
+                for (int laneIdx = 0; laneIdx < block.numNoteLanes; ++laneIdx)
                 {
-                    // Apply portamento to all lanes
-                    for (auto& ps : laneActivePortaSteps)
-                        ps = fxSlot.fxParam;
+                    PatternNotes::LanePlayState laneState;
+                    appendBlockLaneGlides (segment, block, laneIdx, rowTimes, laneState);
                 }
-
-                const double ccTime = juce::jmax (0.0, rowTime.inSeconds() - 0.00005);
-                appendSymbolicTrackFx (midiSeq, fxSlot, ccTime);
             }
-        }
-
-        // Per-lane note generation
-        for (int laneIdx = 0; laneIdx < numNoteLanes; ++laneIdx)
-        {
-            int lastPlayingNote = -1;
-            int currentInst = -1;
-            int activePortaSteps = 0;
-
-            for (int row = 0; row < pattern.numRows; ++row)
+            else
             {
-                const auto& cell = pattern.getCell (row, trackIdx);
-                auto noteSlot = cell.getNoteLane (laneIdx);
-
-                double startBeat = static_cast<double> (row) / static_cast<double> (rowsPerBeat);
-                auto rowTime = edit->tempoSequence.toTime (te::BeatPosition::fromBeats (startBeat));
+                // Reuse the existing pattern clip when its length still matches,
+                // otherwise replace whatever the track holds.
+                te::MidiClip::Ptr midiClip = fullRebuild ? nullptr : findPatternClip (*track);
 
-                // Check FX for portamento (shared FX affects all lanes)
-                for (int fxSlotIdx = 0; fxSlotIdx < cell.getNumFxSlots(); ++fxSlotIdx)
+                if (midiClip != nullptr)
                 {
-                    const auto& fxSlot = cell.getFxSlot (fxSlotIdx);
-                    if (fxSlot.isEmpty()) continue;
-                    const auto letter = getSlotCommandLetter (fxSlot);
-                    if (letter == 'G' && fxSlot.fxParam > 0)
-                        activePortaSteps = fxSlot.fxParam;
+                    midiClip->getSequence().clear (nullptr);
                 }
-
-                const bool rowHasPorta = (activePortaSteps > 0);
-
-                if (noteSlot.note < 0)
-                    continue;
-
-                // OFF (255)
-                if (noteSlot.note == 255)
+                else
                 {
-                    if (lastPlayingNote >= 0)
-                        midiSeq.addEvent (juce::MidiMessage::noteOff (1, lastPlayingNote), rowTime.inSeconds());
-                    else
-                        midiSeq.addEvent (juce::MidiMessage::allNotesOff (1), rowTime.inSeconds());
-                    lastPlayingNote = -1;
-                    activePortaSteps = 0;
-                    continue;
-                }
+                    removeAllClips (*track);
 
-                // KILL (254)
-                if (noteSlot.note == 254)
-                {
-                    midiSeq.addEvent (juce::MidiMessage::allSoundOff (1), rowTime.inSeconds());
-                    lastPlayingNote = -1;
-                    activePortaSteps = 0;
-                    continue;
+                    midiClip = track->insertMIDIClip ("Pattern", timeRange, nullptr);
+                    if (midiClip == nullptr)
+                    {
+                        setTrackTrackerEvents (trackIdx, nullptr);
+                        continue;
+                    }
                 }
 
-                // Portamento
-                if (rowHasPorta && lastPlayingNote >= 0)
+                juce::MidiMessageSequence midiSeq;
+                for (int laneIdx = 0; laneIdx < block.numNoteLanes; ++laneIdx)
                 {
-                    midiSeq.addEvent (juce::MidiMessage::controllerEvent (1, 28, noteSlot.note & 0x7F),
-                                      rowTime.inSeconds());
-                    if (noteSlot.volume >= 0)
-                        midiSeq.addEvent (juce::MidiMessage::controllerEvent (1, 7, noteSlot.volume),
-                                          juce::jmax (0.0, rowTime.inSeconds() - 0.00003));
-                    activePortaSteps = 0;
-                    continue;
+                    PatternNotes::LanePlayState laneState;
+                    appendBlockLaneEvents (midiSeq, segment, block, laneIdx, block.numNoteLanes > 1, trackKill[t],
+                                           rowTimes, laneState);
                 }
 
-                // Program change
-                if (noteSlot.instrument >= 0 && noteSlot.instrument != currentInst)
-                {
-                    currentInst = InstrumentRouting::clampInstrumentIndex (noteSlot.instrument);
-                    const double bankTime = juce::jmax (0.0, rowTime.inSeconds() - 0.00012);
-                    const double progTime = juce::jmax (0.0, rowTime.inSeconds() - 0.0001);
-                    midiSeq.addEvent (juce::MidiMessage::controllerEvent (1, 0,
-                                      InstrumentRouting::getBankMsbForInstrument (currentInst)), bankTime);
-                    midiSeq.addEvent (juce::MidiMessage::programChange (1,
-                                      InstrumentRouting::getProgramForInstrument (currentInst)), progTime);
-                }
+                midiSeq.updateMatchedPairs();
+                midiClip->mergeInMidiSequence (midiSeq, te::MidiList::NoteAutomationType::none);
+            }
 
-                // Calculate note end: sustain until next note in this lane
-                int endRow = pattern.numRows;
-                for (int nextRow = row + 1; nextRow < pattern.numRows; ++nextRow)
-                {
-                    auto nextSlot = pattern.getCell (nextRow, trackIdx).getNoteLane (laneIdx);
-                    if (nextSlot.note >= 0)
-                    {
-                        bool nextIsPorta = false;
-                        if (nextSlot.note < 254)
-                        {
-                            for (int fxi = 0; fxi < pattern.getCell (nextRow, trackIdx).getNumFxSlots(); ++fxi)
-                            {
-                                const auto& ns = pattern.getCell (nextRow, trackIdx).getFxSlot (fxi);
-                                if (getSlotCommandLetter (ns) == 'G' && ns.fxParam > 0)
-                                    nextIsPorta = true;
-                            }
-                        }
-                        if (nextIsPorta)
-                            continue;
-                        endRow = nextRow;
-                        break;
-                    }
-                }
-                double endBeat = static_cast<double> (endRow) / static_cast<double> (rowsPerBeat);
-                auto noteEnd = edit->tempoSequence.toTime (te::BeatPosition::fromBeats (endBeat));
+            auto events = std::make_shared<TrackerEventList>();
+            events->place (TrackerEventList::makeSegment (std::move (segment)), 0.0);
+            setTrackTrackerEvents (trackIdx, std::move (events));
 
-                int velocity = noteSlot.volume >= 0 ? noteSlot.volume : 127;
+            cache.trackRevisions[t] = pattern.getTrackRevision (trackIdx);
+            cache.trackKill[t] = trackKill[t];
+        }
 
-                midiSeq.addEvent (juce::MidiMessage::noteOn (1, noteSlot.note, static_cast<juce::uint8> (velocity)),
-                                  rowTime.inSeconds());
+        if (realtimeSequencing)
+        {
+            auto sequence = std::make_shared<PatternSequence>();
+            sequence->rowTimings.push_back (std::move (rowTimes));
+            sequence->blocks.push_back (cache.trackBlocks);
+            sequence->placements.push_back ({ 0, 0, 0, 0.0 });
+            for (size_t t = 0; t < trackKill.size(); ++t)
+                sequence->tracks[t] = { cache.trackBlocks[t] != nullptr ? cache.trackBlocks[t]->numNoteLanes : 1,
+                                        trackKill[t] };
 
-                if (isKill)
-                    midiSeq.addEvent (juce::MidiMessage::allSoundOff (1), noteEnd.inSeconds());
+            for (int trackIdx = 0; trackIdx < kNumTracks; ++trackIdx)
+                placePatternSequencer (trackIdx);
+            publishedSequence.publish (LoopCueFollower<PatternSequence>::kCurrentSlot, std::move (sequence));
+        }
+    }
 
-                midiSeq.addEvent (juce::MidiMessage::noteOff (1, noteSlot.note),
-                                  noteEnd.inSeconds());
+    // A cue that took over is this pattern now; playback has moved on to what was just published
+    if (hasCuedPatternStarted())
+        cancelCuedPattern();
 
-                lastPlayingNote = noteSlot.note;
-                activePortaSteps = 0;
-            }
-        }
+    cache.valid = true;
+    cache.numRows = pattern.numRows;
+    cache.rowsPerBeat = rowsPerBeat;
+    cache.masterRevision = pattern.getMasterRevision();
+    cache.baseBpm = edit->tempoSequence.getTempos()[0]->getBpm();
 
-        midiSeq.updateMatchedPairs();
-        midiClip->mergeInMidiSequence (midiSeq, te::MidiList::NoteAutomationType::none);
-    }
+    prunePatternBlocks();
 
     // Apply plugin automation from pattern data (Phase 5)
     applyPatternAutomation (pattern.automationData, pattern.numRows, rowsPerBeat);
 
-    refreshTransportLoopRangeFromClip();
+    refreshTransportLoopRange();
 }
 
 void TrackerEngine::syncArrangementToEdit (const std::vector<std::pair<const Pattern*, int>>& sequence, int rpb,
@@ -519,267 +779,302 @@ void TrackerEngine::syncArrangementToEdit (const std::vector<std::pair<const Pat
     if (edit == nullptr || sequence.empty())
         return;
 
+    // Song mode replaces the pattern clips and tempo map, and plays no cues
+    patternSyncCache.valid = false;
+    cancelCuedPattern();
+
     rebuildTempoSequenceFromArrangementMasterLane (sequence, rpb);
 
+    // Every distinct pattern is compiled once per track (or found in the block
+    // cache); entries and their repeats only say where its blocks play.
+    std::vector<const Pattern*> patterns;
+    std::vector<std::array<std::shared_ptr<const PatternTrackBlock>, kNumTracks>> blocksByPattern;
+    std::map<const Pattern*, size_t> patternIndices;
+
+    std::vector<PatternSequence::Placement> placements;
+    size_t totalRows = 0;
+
+    arrangementBlocks.clear();
+
+    for (const auto& [pattern, repeats] : sequence)
+    {
+        if (pattern == nullptr)
+            continue;
+
+        auto [it, isNew] = patternIndices.try_emplace (pattern, patterns.size());
+        if (isNew)
+        {
+            patterns.push_back (pattern);
+            auto& blocks = blocksByPattern.emplace_back();
+            for (int t = 0; t < kNumTracks; ++t)
+            {
+                blocks[static_cast<size_t> (t)] = getPatternTrackBlock (*pattern, t);
+                arrangementBlocks.push_back (blocks[static_cast<size_t> (t)]);
+            }
+        }
+
+        for (int rep = 0; rep < repeats; ++rep)
+        {
+            placements.push_back ({ it->second, totalRows });
+            totalRows += static_cast<size_t> (pattern->numRows);
+        }
+    }
+
     // Prepare instruments once across the full arrangement so program changes can
     // switch to any instrument used by any pattern in the sequence.
     std::array<std::vector<int>, kNumTracks> instrumentsByTrack {};
-    for (auto& [pattern, repeats] : sequence)
+    for (const auto& blocks : blocksByPattern)
     {
-        juce::ignoreUnused (repeats);
         for (int t = 0; t < kNumTracks; ++t)
         {
             auto& trackInstruments = instrumentsByTrack[static_cast<size_t> (t)];
-            for (int row = 0; row < pattern->numRows; ++row)
-            {
-                const auto& cell = pattern->getCell (row, t);
-                int numLanes = cell.getNumNoteLanes();
-                for (int nl = 0; nl < numLanes; ++nl)
-                {
-                    int inst = cell.getNoteLane (nl).instrument;
-                    if (inst >= 0
-                        && std::find (trackInstruments.begin(), trackInstruments.end(), inst) == trackInstruments.end())
-                    {
-                        trackInstruments.push_back (inst);
-                    }
-                }
-            }
+            for (int inst : blocks[static_cast<size_t> (t)]->instruments)
+                if (std::find (trackInstruments.begin(), trackInstruments.end(), inst) == trackInstruments.end())
+                    trackInstruments.push_back (inst);
         }
     }
     prepareTracksForInstrumentUsage (instrumentsByTrack);
 
-    auto tracks = te::getAudioTracks (*edit);
+    // Each placement starts at its own edit time and times its rows from
+    // there. Placements of a pattern under alike stretches of the tempo map
+    // share one row timing, so rows are resolved per distinct pattern and
+    // tempo span rather than per song row.
+    std::vector<std::vector<double>> rowTimings;
+    std::map<std::pair<size_t, std::vector<double>>, size_t> timingIndices;
+    double songEnd = 0.0;
+    {
+        auto& tempoSequence = edit->tempoSequence;
+        const TempoSpans tempoSpans (tempoSequence);
+        auto toTime = [&tempoSequence] (double beat)
+        {
+            return tempoSequence.toTime (te::BeatPosition::fromBeats (beat)).inSeconds();
+        };
+
+        double beatOffset = 0.0;
+        for (auto& placement : placements)
+        {
+            const int numRows = patterns[placement.patternIndex]->numRows;
+            const double endBeat = beatOffset + static_cast<double> (numRows) / static_cast<double> (rpb);
 
-    // Calculate total length in beats
-    double totalBeats = 0.0;
-    for (auto& [pattern, repeats] : sequence)
-        totalBeats += (static_cast<double> (pattern->numRows) / static_cast<double> (rpb)) * repeats;
+            placement.startTime = toTime (beatOffset);
 
-    auto totalEndTime = edit->tempoSequence.toTime (te::BeatPosition::fromBeats (totalBeats));
-    auto startTime = te::TimePosition::fromSeconds (0.0);
-    te::TimeRange fullRange { startTime, totalEndTime };
+            auto [timing, isNew] = timingIndices.try_emplace ({ placement.patternIndex, tempoSpans.getKey (beatOffset, endBeat) },
+                                                              rowTimings.size());
+            if (isNew)
+            {
+                auto& rowTimes = rowTimings.emplace_back (static_cast<size_t> (numRows) + 1);
+                for (int row = 0; row <= numRows; ++row)
+                    rowTimes[static_cast<size_t> (row)] = toTime (beatOffset + static_cast<double> (row) / static_cast<double> (rpb))
+                                                          - placement.startTime;
+            }
+
+            placement.timingIndex = timing->second;
+            beatOffset = endBeat;
+        }
+
+        songEnd = toTime (beatOffset);
+    }
+
+    auto tracks = te::getAudioTracks (*edit);
+    te::TimeRange fullRange { te::TimePosition::fromSeconds (0.0), te::TimePosition::fromSeconds (songEnd) };
+    std::array<PatternSequence::Track, kNumTracks> songTracks {};
+
+    // An entry plays the same for each placement that enters its block with
+    // the lanes in the same state, so what a lane does over a block is worked
+    // out once per state it's entered in, and each distinct entry's events (and
+    // MIDI, on the clip path) compile once and are shared by its placements.
+    using EntryKey = std::tuple<const PatternTrackBlock*, size_t, std::vector<int>>;
+    std::map<std::tuple<const PatternTrackBlock*, int, int, int, bool>, LaneEntry> laneEntries;
+    std::map<EntryKey, std::shared_ptr<const TrackerEventList::Segment>> entrySegments;
+    std::map<EntryKey, juce::MidiMessageSequence> entryMidi;
 
     for (int trackIdx = 0; trackIdx < kNumTracks && trackIdx < tracks.size(); ++trackIdx)
     {
+        const auto t = static_cast<size_t> (trackIdx);
         auto* track = tracks[trackIdx];
 
-        // Remove existing clips
-        auto clips = track->getClips();
-        for (int i = clips.size(); --i >= 0;)
-            clips.getUnchecked (i)->removeFromParent();
-
-        // Create one long MIDI clip spanning all entries
-        auto midiClip = track->insertMIDIClip ("Arrangement", fullRange, nullptr);
-        if (midiClip == nullptr)
-            continue;
+        removeAllClips (*track);
 
-        juce::MidiMessageSequence midiSeq;
-        bool isKill = ! releaseMode[static_cast<size_t> (trackIdx)];
+        auto events = std::make_shared<TrackerEventList>();
+        bool isKill = ! releaseMode[t];
         if (getTrackContentMode (trackIdx) == TrackContentMode::PluginInstrument)
             isKill = false;
 
-        // Determine how many note lanes this track has across all patterns
+        // Note lanes the track has across all patterns
         int numNoteLanes = 1;
-        for (auto& [pat, reps] : sequence)
-        {
-            juce::ignoreUnused (reps);
-            for (int row = 0; row < pat->numRows; ++row)
-            {
-                int nl = pat->getCell (row, trackIdx).getNumNoteLanes();
-                if (nl > numNoteLanes)
-                    numNoteLanes = nl;
-            }
-        }
+        for (const auto& blocks : blocksByPattern)
+            numNoteLanes = juce::jmax (numNoteLanes, blocks[t]->numNoteLanes);
+
+        songTracks[t] = { numNoteLanes, isKill };
+        const bool multiLane = numNoteLanes > 1;
+
+        // Each lane carries its playing note, instrument and pending portamento across entries
+        std::vector<PatternNotes::LanePlayState> laneStates (static_cast<size_t> (numNoteLanes));
+        bool clipFailed = false;
 
-        // First pass: process FX slots and note resets (shared across all lanes)
+        for (const auto& placement : placements)
         {
-            double beatOffset = 0.0;
-            for (auto& [pattern, repeats] : sequence)
+            const auto* block = blocksByPattern[placement.patternIndex][t].get();
+            const auto& rowTimes = rowTimings[placement.timingIndex];
+
+            // Without the sequencer each entry gets a clip of the entry's MIDI
+            if (! realtimeSequencing)
             {
-                double patternLengthBeats = static_cast<double> (pattern->numRows) / static_cast<double> (rpb);
+                std::vector<int> midiKey { multiLane ? 1 : 0, isKill ? 1 : 0 };
+                for (int laneIdx = 0; laneIdx < block->numNoteLanes; ++laneIdx)
+                {
+                    const auto& state = laneStates[static_cast<size_t> (laneIdx)];
+                    midiKey.insert (midiKey.end(), { state.lastPlayingNote, state.currentInst, state.portaPending ? 1 : 0 });
+                }
 
-                for (int rep = 0; rep < repeats; ++rep)
+                auto [midi, isNew] = entryMidi.try_emplace ({ block, placement.timingIndex, std::move (midiKey) });
+                if (isNew)
                 {
-                    for (int row = 0; row < pattern->numRows; ++row)
+                    TrackerEventList::Segment glides;   // the entry's segment has these
+                    for (int laneIdx = 0; laneIdx < block->numNoteLanes; ++laneIdx)
                     {
-                        const auto& cell = pattern->getCell (row, trackIdx);
-                        double startBeat = beatOffset + static_cast<double> (row) / static_cast<double> (rpb);
-                        auto rowTime = edit->tempoSequence.toTime (te::BeatPosition::fromBeats (startBeat));
-
-                        // Check if any lane has a note for FX reset
-                        bool anyLaneHasNote = false;
-                        for (int nl = 0; nl < numNoteLanes; ++nl)
-                        {
-                            auto slot = cell.getNoteLane (nl);
-                            if (slot.note >= 0)
-                                anyLaneHasNote = true;
-                        }
-
-                        if (anyLaneHasNote)
-                        {
-                            const double resetTime = juce::jmax (0.0, rowTime.inSeconds() - 0.00008);
-                            midiSeq.addEvent (juce::MidiMessage::controllerEvent (1, kCcFxNoteReset, 0), resetTime);
-                        }
-
-                        // Process FX slots (shared across all note lanes)
-                        for (int fxSlotIdx = 0; fxSlotIdx < cell.getNumFxSlots(); ++fxSlotIdx)
-                        {
-                            const auto& slot = cell.getFxSlot (fxSlotIdx);
-                            if (slot.isEmpty())
-                                continue;
-
-                            const auto letter = getSlotCommandLetter (slot);
-                            if (letter == '\0')
-                                continue;
-
-                            const double ccTime = juce::jmax (0.0, rowTime.inSeconds() - 0.00005);
-                            appendSymbolicTrackFx (midiSeq, slot, ccTime);
-                        }
+                        auto state = laneStates[static_cast<size_t> (laneIdx)];
+                        appendBlockLaneEvents (midi->second, glides, *block, laneIdx, multiLane, isKill, rowTimes, state);
                     }
+                    midi->second.updateMatchedPairs();
+                }
 
-                    beatOffset += patternLengthBeats;
+                auto midiClip = track->insertMIDIClip ("Arrangement",
+                                                       { te::TimePosition::fromSeconds (placement.startTime),
+                                                         te::TimePosition::fromSeconds (placement.startTime + rowTimes.back()) },
+                                                       nullptr);
+                if (midiClip == nullptr)
+                {
+                    clipFailed = true;
+                    break;
                 }
-            }
-        }
 
-        // Per-lane note generation (mirrors syncPatternToEdit approach)
-        for (int laneIdx = 0; laneIdx < numNoteLanes; ++laneIdx)
-        {
-            int lastPlayingNote = -1;
-            int currentInst = -1;
-            int activePortaSteps = 0;
-            double beatOffset = 0.0;
+                midiClip->mergeInMidiSequence (midi->second, te::MidiList::NoteAutomationType::none);
+            }
 
-            for (auto& [pattern, repeats] : sequence)
+            // The lanes' glides this time through, keyed with the block and timing
+            std::vector<int> glideKey;
+            for (int laneIdx = 0; laneIdx < numNoteLanes; ++laneIdx)
             {
-                double patternLengthBeats = static_cast<double> (pattern->numRows) / static_cast<double> (rpb);
+                auto& state = laneStates[static_cast<size_t> (laneIdx)];
+                if (laneIdx >= block->numNoteLanes)
+                {
+                    PatternNotes::finishBlock (*block, laneIdx, state);
+                    continue;
+                }
 
-                for (int rep = 0; rep < repeats; ++rep)
+                auto [entry, isNew] = laneEntries.try_emplace ({ block, laneIdx, state.lastPlayingNote,
+                                                                 state.currentInst, state.portaPending });
+                if (isNew)
                 {
-                    for (int row = 0; row < pattern->numRows; ++row)
+                    auto exitState = state;
+                    const auto& ops = block->lanes[static_cast<size_t> (laneIdx)].ops;
+                    for (size_t i = 0; i < ops.size(); ++i)
                     {
-                        const auto& cell = pattern->getCell (row, trackIdx);
-                        auto noteSlot = cell.getNoteLane (laneIdx);
-
-                        double startBeat = beatOffset + static_cast<double> (row) / static_cast<double> (rpb);
-                        auto rowTime = edit->tempoSequence.toTime (te::BeatPosition::fromBeats (startBeat));
-
-                        // Check FX for portamento (shared FX affects all lanes)
-                        for (int fxSlotIdx = 0; fxSlotIdx < cell.getNumFxSlots(); ++fxSlotIdx)
-                        {
-                            const auto& fxSlot = cell.getFxSlot (fxSlotIdx);
-                            if (fxSlot.isEmpty()) continue;
-                            const auto letter = getSlotCommandLetter (fxSlot);
-                            if (letter == 'G' && fxSlot.fxParam > 0)
-                                activePortaSteps = fxSlot.fxParam;
-                        }
-
-                        const bool rowHasPorta = (activePortaSteps > 0);
-
-                        if (noteSlot.note < 0)
-                            continue;
-
-                        // OFF (255)
-                        if (noteSlot.note == 255)
-                        {
-                            if (lastPlayingNote >= 0)
-                                midiSeq.addEvent (juce::MidiMessage::noteOff (1, lastPlayingNote), rowTime.inSeconds());
-                            else
-                                midiSeq.addEvent (juce::MidiMessage::allNotesOff (1), rowTime.inSeconds());
-                            lastPlayingNote = -1;
-                            activePortaSteps = 0;
-                            continue;
-                        }
-
-                        // KILL (254)
-                        if (noteSlot.note == 254)
-                        {
-                            midiSeq.addEvent (juce::MidiMessage::allSoundOff (1), rowTime.inSeconds());
-                            lastPlayingNote = -1;
-                            activePortaSteps = 0;
-                            continue;
-                        }
-
-                        // Portamento
-                        if (rowHasPorta && lastPlayingNote >= 0)
-                        {
-                            midiSeq.addEvent (juce::MidiMessage::controllerEvent (1, 28, noteSlot.note & 0x7F),
-                                              rowTime.inSeconds());
-                            if (noteSlot.volume >= 0)
-                                midiSeq.addEvent (juce::MidiMessage::controllerEvent (1, 7, noteSlot.volume),
-                                                  juce::jmax (0.0, rowTime.inSeconds() - 0.00003));
-                            activePortaSteps = 0;
-                            continue;
-                        }
-
-                        // Program change
-                        if (noteSlot.instrument >= 0 && noteSlot.instrument != currentInst)
-                        {
-                            currentInst = InstrumentRouting::clampInstrumentIndex (noteSlot.instrument);
-                            const double bankTime = juce::jmax (0.0, rowTime.inSeconds() - 0.00012);
-                            const double progTime = juce::jmax (0.0, rowTime.inSeconds() - 0.0001);
-                            midiSeq.addEvent (juce::MidiMessage::controllerEvent (1, 0,
-                                              InstrumentRouting::getBankMsbForInstrument (currentInst)), bankTime);
-                            midiSeq.addEvent (juce::MidiMessage::programChange (1,
-                                              InstrumentRouting::getProgramForInstrument (currentInst)), progTime);
-                        }
-
-                        // Calculate note end: sustain until next note in this lane or end of repeat
-                        double repeatEndBeat = beatOffset + patternLengthBeats;
-                        double endBeat = repeatEndBeat;
-                        for (int nextRow = row + 1; nextRow < pattern->numRows; ++nextRow)
-                        {
-                            auto nextSlot = pattern->getCell (nextRow, trackIdx).getNoteLane (laneIdx);
-                            if (nextSlot.note >= 0)
-                            {
-                                bool nextIsPorta = false;
-                                if (nextSlot.note < 254)
-                                {
-                                    for (int fxi = 0; fxi < pattern->getCell (nextRow, trackIdx).getNumFxSlots(); ++fxi)
-                                    {
-                                        const auto& ns = pattern->getCell (nextRow, trackIdx).getFxSlot (fxi);
-                                        if (getSlotCommandLetter (ns) == 'G' && ns.fxParam > 0)
-                                            nextIsPorta = true;
-                                    }
-                                }
-                                if (nextIsPorta)
-                                    continue;
-                                endBeat = beatOffset + static_cast<double> (nextRow) / static_cast<double> (rpb);
-                                break;
-                            }
-                        }
-
-                        auto noteEnd = edit->tempoSequence.toTime (te::BeatPosition::fromBeats (endBeat));
-
-                        int velocity = noteSlot.volume >= 0 ? noteSlot.volume : 127;
-
-                        midiSeq.addEvent (juce::MidiMessage::noteOn (1, noteSlot.note, static_cast<juce::uint8> (velocity)),
-                                          rowTime.inSeconds());
-
-                        if (isKill)
-                            midiSeq.addEvent (juce::MidiMessage::allSoundOff (1), noteEnd.inSeconds());
-
-                        midiSeq.addEvent (juce::MidiMessage::noteOff (1, noteSlot.note),
-                                          noteEnd.inSeconds());
-
-                        lastPlayingNote = noteSlot.note;
-                        activePortaSteps = 0;
+                        const int instrument = exitState.currentInst;
+                        if (PatternNotes::stepNoteOp (ops[i], exitState).result == PatternNotes::OpResult::glide)
+                            entry->second.glides.emplace_back (i, instrument);
                     }
+                    PatternNotes::finishBlock (*block, laneIdx, exitState);
+                    entry->second.exitState = exitState;
+                }
+
+                for (const auto& [opIndex, instrument] : entry->second.glides)
+                    glideKey.insert (glideKey.end(), { laneIdx, static_cast<int> (opIndex), instrument });
+                state = entry->second.exitState;
+            }
+
+            auto [segment, isNew] = entrySegments.try_emplace ({ block, placement.timingIndex, std::move (glideKey) });
+            if (isNew)
+            {
+                // FX column first (shared across all lanes), then each lane's glides
+                TrackerEventList::Segment entryEvents;
+                appendBlockFxEvents (entryEvents, *block, rowTimes);
 
-                    beatOffset += patternLengthBeats;
+                const auto& glides = std::get<2> (segment->first);
+                for (size_t i = 0; i + 2 < glides.size(); i += 3)
+                {
+                    const int laneIdx = glides[i];
+                    const auto& op = block->lanes[static_cast<size_t> (laneIdx)].ops[static_cast<size_t> (glides[i + 1])];
+                    appendPortamentoEvents (entryEvents, { op.note, op.instrument, op.volume }, op.row, laneIdx,
+                                            glides[i + 2], rowTimes[static_cast<size_t> (op.row)]);
                 }
+
+                segment->second = TrackerEventList::makeSegment (std::move (entryEvents));
             }
+
+            events->place (segment->second, placement.startTime);
+        }
+
+        if (clipFailed)
+        {
+            removeAllClips (*track);
+            setTrackTrackerEvents (trackIdx, nullptr);
+            continue;
         }
 
-        midiSeq.updateMatchedPairs();
-        midiClip->mergeInMidiSequence (midiSeq, te::MidiList::NoteAutomationType::none);
+        setTrackTrackerEvents (trackIdx, std::move (events));
     }
 
-    // Prime automation baselines and initial values for arrangement playback.
-    if (! sequence.empty() && sequence.front().first != nullptr)
-        applyPatternAutomation (sequence.front().first->automationData, sequence.front().first->numRows, rpb);
+    syncedContentRange = fullRange;
+
+    if (realtimeSequencing)
+    {
+        auto song = std::make_shared<PatternSequence>();
+        song->rowTimings = std::move (rowTimings);
+        song->blocks = std::move (blocksByPattern);
+        song->placements = std::move (placements);
+        song->tracks = songTracks;
+
+        for (int trackIdx = 0; trackIdx < kNumTracks; ++trackIdx)
+            placePatternSequencer (trackIdx);
+        publishedSequence.publish (LoopCueFollower<PatternSequence>::kCurrentSlot, std::move (song));
+    }
+
+    prunePatternBlocks();
+
+    // Compile automation for every arrangement entry and prime initial values.
+    applyArrangementAutomation (sequence, rpb);
+
+    refreshTransportLoopRange();
+}
+
+std::shared_ptr<const PatternTrackBlock> TrackerEngine::getPatternTrackBlock (const Pattern& pattern, int trackIndex)
+{
+    // Revisions are unique per edit of a track, so a known one has a known hash
+    const auto revision = pattern.getTrackRevision (trackIndex);
+    auto hashIt = patternBlockHashByRevision.find (revision);
+    const auto hash = hashIt != patternBlockHashByRevision.end() ? hashIt->second
+                                                                : PatternTrackBlock::hashTrack (pattern, trackIndex);
+
+    auto& block = patternBlocks[hash];
+    if (block == nullptr)
+        block = PatternTrackBlock::compile (pattern, trackIndex);
+    else if (! block->matchesTrack (pattern, trackIndex))
+        return PatternTrackBlock::compile (pattern, trackIndex); // hash collision: don't share
 
-    refreshTransportLoopRangeFromClip();
+    patternBlockHashByRevision[revision] = hash;
+    return block;
+}
+
+void TrackerEngine::prunePatternBlocks()
+{
+    // Only the cache itself still holds blocks no synced content uses
+    for (auto it = patternBlocks.begin(); it != patternBlocks.end();)
+    {
+        if (it->second.use_count() == 1)
+            it = patternBlocks.erase (it);
+        else
+            ++it;
+    }
+
+    for (auto it = patternBlockHashByRevision.begin(); it != patternBlockHashByRevision.end();)
+    {
+        if (patternBlocks.find (it->second) == patternBlocks.end())
+            it = patternBlockHashByRevision.erase (it);
+        else
+            ++it;
+    }
 }
 
 void TrackerEngine::play()
@@ -788,7 +1083,8 @@ void TrackerEngine::play()
         return;
 
     auto& transport = edit->getTransport();
-    refreshTransportLoopRangeFromClip();
+    refreshTransportLoopRange();
+    cancelCuedPattern();
 
     transport.setPosition (te::TimePosition::fromSeconds (0.0));
     transport.play (false);
@@ -821,6 +1117,8 @@ void TrackerEngine::stop()
     }
 
     edit->getTransport().stop (false, false);
+    cancelCuedPattern();
+
     // Avoid synchronous parameter writes during transport stop (can block with
     // some plugin combinations). New play/sync re-establishes automation state.
     lastAutomatedParams.clear();
@@ -883,27 +1181,21 @@ void TrackerEngine::updateLoopRangeForPatternLength (int numRows)
         transport.setPosition (startTime);
 }
 
-void TrackerEngine::refreshTransportLoopRangeFromClip()
+void TrackerEngine::refreshTransportLoopRange()
 {
     if (edit == nullptr)
         return;
 
     auto& transport = edit->getTransport();
-    auto tracks = te::getAudioTracks (*edit);
-    if (tracks.isEmpty())
+    if (syncedContentRange.isEmpty())
         return;
 
-    auto clips = tracks[0]->getClips();
-    if (clips.isEmpty())
-        return;
-
-    auto clipRange = clips[0]->getEditTimeRange();
-    transport.setLoopRange (clipRange);
+    transport.setLoopRange (syncedContentRange);
     transport.looping = true;
 
     auto currentPos = transport.getPosition();
-    if (currentPos < clipRange.getStart() || currentPos >= clipRange.getEnd())
-        transport.setPosition (clipRange.getStart());
+    if (currentPos < syncedContentRange.getStart() || currentPos >= syncedContentRange.getEnd())
+        transport.setPosition (syncedContentRange.getStart());
 }
 
 void TrackerEngine::refreshTracksForInstrument (int instrumentIndex, const Pattern& pattern)
@@ -917,18 +1209,12 @@ void TrackerEngine::refreshTracksForInstrument (int instrumentIndex, const Patte
     {
         // Check if this track uses the specified instrument (across all note lanes)
         bool usesInstrument = false;
-        for (int row = 0; row < pattern.numRows && ! usesInstrument; ++row)
+        pattern.forEachNonEmptyCell (t, [&] (int, CellView cell)
         {
-            const auto& cell = pattern.getCell (row, t);
-            for (int nl = 0; nl < cell.getNumNoteLanes(); ++nl)
-            {
-                if (cell.getNoteLane (nl).instrument == instrumentIndex)
-                {
-                    usesInstrument = true;
-                    break;
-                }
-            }
-        }
+            for (int nl = 0; nl < cell.getNumNoteLanes() && ! usesInstrument; ++nl)
+                usesInstrument = cell.getNoteLane (nl).instrument == instrumentIndex;
+            return ! usesInstrument;
+        });
 
         if (! usesInstrument)
             continue;
@@ -965,8 +1251,12 @@ void TrackerEngine::setRowsPerBeat (int rpb)
 
     auto tracks = te::getAudioTracks (*edit);
     for (int t = 0; t < kNumTracks && t < tracks.size(); ++t)
+    {
+        if (auto* samplerPlugin = tracks[t]->pluginList.findFirstPluginOfType<TrackerSamplerPlugin>())
+            samplerPlugin->setRowsPerBeat (rowsPerBeat);
         if (auto* fxPlugin = tracks[t]->pluginList.findFirstPluginOfType<InstrumentEffectsPlugin>())
             fxPlugin->setRowsPerBeat (rowsPerBeat);
+    }
 }
 
 void TrackerEngine::setBpm (double bpm)
@@ -987,6 +1277,9 @@ double TrackerEngine::getBpm() const
 
 juce::String TrackerEngine::loadSampleForInstrument (int instrumentIndex, const juce::File& sampleFile)
 {
+    // A queued background load must not replace this sample when it lands
+    sampleLoader.cancel (instrumentIndex);
+
     auto result = sampler.loadInstrumentSample (sampleFile, instrumentIndex);
     if (result.isEmpty())
     {
@@ -998,11 +1291,57 @@ juce::String TrackerEngine::loadSampleForInstrument (int instrumentIndex, const
     return result;
 }
 
+void TrackerEngine::loadSampleForInstrumentAsync (int instrumentIndex, const juce::File& sampleFile,
+                                                  SampleLoader::Completion onLoaded)
+{
+    sampleLoader.load (instrumentIndex, sampleFile, std::move (onLoaded));
+}
+
+std::map<int, juce::File> TrackerEngine::getInstrumentSampleFiles() const
+{
+    auto files = sampler.getLoadedSamples();
+    for (auto& [index, file] : sampleLoader.getPendingFiles())
+        files[index] = file;
+    return files;
+}
+
+void TrackerEngine::publishSampleBank (int instrumentIndex)
+{
+    if (edit == nullptr)
+        return;
+
+    auto bank = sampler.getSampleBank (instrumentIndex);
+    if (bank == nullptr)
+        return;
+
+    auto tracks = te::getAudioTracks (*edit);
+
+    for (int t = 0; t < kNumTracks && t < tracks.size(); ++t)
+    {
+        const auto& used = trackInstrumentUsage[static_cast<size_t> (t)];
+        const bool inUse = std::find (used.begin(), used.end(), instrumentIndex) != used.end();
+        auto& current = currentTrackInstrument[static_cast<size_t> (t)];
+
+        if (! inUse && current != instrumentIndex)
+            continue;
+
+        // The track's default instrument (or the one it's already on) gets
+        // the full setup that failed while the bank was missing
+        if (current == instrumentIndex || (current == -1 && used.front() == instrumentIndex))
+            current = sampler.applyParams (*tracks[t], instrumentIndex).isEmpty() ? instrumentIndex : -1;
+
+        if (inUse)
+            if (auto* samplerPlugin = tracks[t]->pluginList.findFirstPluginOfType<TrackerSamplerPlugin>())
+                samplerPlugin->updateBank (instrumentIndex, bank);
+    }
+}
+
 void TrackerEngine::clearSampleForInstrument (int instrumentIndex)
 {
     if (instrumentIndex < 0)
         return;
 
+    sampleLoader.cancel (instrumentIndex);
     sampler.clearInstrumentSample (instrumentIndex);
 
     for (int t = 0; t < kNumTracks; ++t)
@@ -1038,24 +1377,7 @@ void TrackerEngine::prepareTracksForPattern (const Pattern& pattern)
     std::array<std::vector<int>, kNumTracks> instrumentsByTrack {};
 
     for (int t = 0; t < kNumTracks; ++t)
-    {
-        auto& trackInstruments = instrumentsByTrack[static_cast<size_t> (t)];
-        for (int row = 0; row < pattern.numRows; ++row)
-        {
-            const auto& cell = pattern.getCell (row, t);
-            // Scan all note lanes for instruments
-            int numLanes = cell.getNumNoteLanes();
-            for (int nl = 0; nl < numLanes; ++nl)
-            {
-                int inst = cell.getNoteLane (nl).instrument;
-                if (inst >= 0
-                    && std::find (trackInstruments.begin(), trackInstruments.end(), inst) == trackInstruments.end())
-                {
-                    trackInstruments.push_back (inst);
-                }
-            }
-        }
-    }
+        collectTrackInstruments (pattern, t, instrumentsByTrack[static_cast<size_t> (t)]);
 
     prepareTracksForInstrumentUsage (instrumentsByTrack);
 }
@@ -1067,6 +1389,9 @@ void TrackerEngine::prepareTracksForInstrumentUsage (const std::array<std::vecto
 
     auto tracks = te::getAudioTracks (*edit);
 
+    for (auto& used : trackInstrumentUsage)
+        used.clear();
+
     for (int t = 0; t < kNumTracks && t < tracks.size(); ++t)
     {
         const auto& usedInstruments = instrumentsByTrack[static_cast<size_t> (t)];
@@ -1087,6 +1412,7 @@ void TrackerEngine::prepareTracksForInstrumentUsage (const std::array<std::vecto
         }
 
         const int firstInst = usedInstruments.front();
+        trackInstrumentUsage[static_cast<size_t> (t)] = usedInstruments;
 
         // Load the first (default) instrument onto this track
         if (firstInst != currentTrackInstrument[static_cast<size_t> (t)])
@@ -1110,6 +1436,8 @@ void TrackerEngine::prepareTracksForInstrumentUsage (const std::array<std::vecto
                     banks[inst] = bank;
             }
             samplerPlugin->preloadBanks (banks);
+            samplerPlugin->setRowsPerBeat (rowsPerBeat);
+            samplerPlugin->setTrackerEvents (trackTrackerEvents[static_cast<size_t> (t)]);
         }
 
         // Configure effects plugin with rowsPerBeat, global mod state, and send buffers
@@ -1122,12 +1450,32 @@ void TrackerEngine::prepareTracksForInstrumentUsage (const std::array<std::vecto
             fxPlugin->setRowsPerBeat (rowsPerBeat);
             fxPlugin->setGlobalModState (sampler.getOrCreateGlobalModState (firstInst));
             fxPlugin->setGlobalModStates (globalStates);
-            fxPlugin->setSendBuffers (&sampler.getSendBuffers());
+            fxPlugin->setSendBuffers (&sampler.getSendBuffers(), SendBuffers::slotForTrack (t));
+            fxPlugin->setTrackerEvents (trackTrackerEvents[static_cast<size_t> (t)]);
             fxPlugin->onTempoChange = nullptr;
         }
+
+        refreshFusedTrackChain (t);
     }
 }
 
+void TrackerEngine::setTrackTrackerEvents (int trackIndex, std::shared_ptr<const TrackerEventList> events)
+{
+    if (trackIndex < 0 || trackIndex >= kNumTracks || edit == nullptr)
+        return;
+
+    trackTrackerEvents[static_cast<size_t> (trackIndex)] = events;
+
+    auto tracks = te::getAudioTracks (*edit);
+    if (trackIndex >= tracks.size())
+        return;
+
+    if (auto* samplerPlugin = tracks[trackIndex]->pluginList.findFirstPluginOfType<TrackerSamplerPlugin>())
+        samplerPlugin->setTrackerEvents (events);
+    if (auto* fxPlugin = tracks[trackIndex]->pluginList.findFirstPluginOfType<InstrumentEffectsPlugin>())
+        fxPlugin->setTrackerEvents (std::move (events));
+}
+
 int TrackerEngine::getTrackInstrument (int trackIndex) const
 {
     if (trackIndex < 0 || trackIndex >= kNumTracks)
@@ -1138,6 +1486,7 @@ int TrackerEngine::getTrackInstrument (int trackIndex) const
 void TrackerEngine::invalidateTrackInstruments()
 {
     currentTrackInstrument.fill (-1);
+    patternSyncCache.valid = false;
 }
 
 void TrackerEngine::previewNote (int trackIndex, int instrumentIndex, int midiNote, bool autoStop)
@@ -1231,21 +1580,11 @@ void TrackerEngine::previewAudioFile (const juce::File& file)
     stopPreview();
 
     // Load the audio file into a temporary bank
-    juce::AudioFormatManager formatManager;
-    formatManager.registerBasicFormats();
-
-    std::unique_ptr<juce::AudioFormatReader> reader (formatManager.createReaderFor (file));
-    if (reader == nullptr)
+    juce::String error;
+    auto bank = sampler.loadSampleBank (file, error);
+    if (bank == nullptr)
         return;
 
-    auto bank = std::make_shared<SampleBank>();
-    bank->sampleRate = reader->sampleRate;
-    bank->numChannels = static_cast<int> (reader->numChannels);
-    bank->totalSamples = static_cast<juce::int64> (reader->lengthInSamples);
-    bank->sourceFile = file;
-    bank->buffer.setSize (bank->numChannels, static_cast<int> (reader->lengthInSamples));
-    reader->read (&bank->buffer, 0, static_cast<int> (reader->lengthInSamples), 0, true, true);
-
     // Keep bank alive
     previewBank = bank;
 
@@ -1431,9 +1770,57 @@ void TrackerEngine::setupSendEffectsTrack()
     if (existing != nullptr)
     {
         existing->setSendBuffers (&sampler.getSendBuffers());
+        existing->setSamplerSource (&sampler);
         existing->setMixerState (mixerStatePtr);
         sendEffectsPlugin = existing;
     }
+
+    // The aux return ahead of the SendEffectsPlugin waits for every aux send
+    // on its bus, so the bus only renders once the tracks have filled their
+    // send slots for the block
+    if (track->pluginList.findFirstPluginOfType<te::AuxReturnPlugin>() == nullptr)
+    {
+        if (auto plugin = dynamic_cast<te::AuxReturnPlugin*> (
+                track->edit.getPluginCache().createNewPlugin (te::AuxReturnPlugin::xmlTypeName, {}).get()))
+        {
+            plugin->busNumber = kSendOrderBus;
+            track->pluginList.insertPlugin (*plugin, 0, nullptr);
+        }
+    }
+
+    for (int t = 0; t <= kPreviewTrack; ++t)
+        connectSendProducer (t);
+}
+
+void TrackerEngine::connectSendProducer (int trackIndex)
+{
+    auto* track = getTrack (trackIndex);
+    if (track == nullptr)
+        return;
+
+    // A muted aux send after the track's last plugin: carries no audio, only
+    // the graph dependency of the send bus on everything before it
+    auto& pluginList = track->pluginList;
+    te::Plugin::Ptr send = pluginList.findFirstPluginOfType<te::AuxSendPlugin>();
+    if (send != nullptr && pluginList.indexOf (send.get()) == pluginList.size() - 1)
+        return;
+
+    if (send != nullptr)
+    {
+        send->removeFromParent();
+    }
+    else
+    {
+        send = track->edit.getPluginCache().createNewPlugin (te::AuxSendPlugin::xmlTypeName, {});
+        auto* auxSend = dynamic_cast<te::AuxSendPlugin*> (send.get());
+        if (auxSend == nullptr)
+            return;
+
+        auxSend->busNumber = kSendOrderBus;
+        auxSend->setMute (true);
+    }
+
+    pluginList.insertPlugin (*send, -1, nullptr);
 }
 
 void TrackerEngine::setDelayParams (const DelayParams& params)
@@ -1479,20 +1866,25 @@ void TrackerEngine::setupChannelStripAndOutput (int trackIndex)
 
     auto* track = tracks[trackIndex];
 
-    // Ensure ChannelStripPlugin exists (position 2: sampler=0, effects=1, channelstrip=2)
+    // Ensure ChannelStripPlugin exists (position 2: sampler=0, effects=1, channelstrip=2,
+    // one further along behind a pattern sequencer)
     auto* strip = track->pluginList.findFirstPluginOfType<ChannelStripPlugin>();
     if (strip == nullptr)
     {
         if (auto plugin = dynamic_cast<ChannelStripPlugin*> (
                 track->edit.getPluginCache().createNewPlugin (ChannelStripPlugin::xmlTypeName, {}).get()))
         {
-            track->pluginList.insertPlugin (*plugin, 2, nullptr);
+            track->pluginList.insertPlugin (*plugin, PatternSequencerPlugin::getSoundSourceIndex (track->pluginList) + 2,
+                                            nullptr);
             strip = plugin;
         }
     }
 
     if (strip != nullptr)
+    {
         strip->setMixState (mixerStatePtr->tracks[static_cast<size_t> (trackIndex)]);
+        strip->setAutomationStage (&automationStage, trackIndex);
+    }
 
     // Ensure TrackOutputPlugin exists (always the last plugin in the chain)
     auto* output = track->pluginList.findFirstPluginOfType<TrackOutputPlugin>();
@@ -1510,13 +1902,18 @@ void TrackerEngine::setupChannelStripAndOutput (int trackIndex)
     if (output != nullptr)
     {
         output->setMixState (mixerStatePtr->tracks[static_cast<size_t> (trackIndex)]);
-        output->setSendBuffers (&sampler.getSendBuffers());
+        output->setSendBuffers (&sampler.getSendBuffers(), SendBuffers::slotForTrack (trackIndex));
     }
 
+    // The output plugin may have just gone in behind the aux send
+    connectSendProducer (trackIndex);
+
     // Also remove any legacy MixerPlugin if present (migrating from old chain)
     auto* legacyMixer = track->pluginList.findFirstPluginOfType<MixerPlugin>();
     if (legacyMixer != nullptr)
         legacyMixer->removeFromParent();
+
+    refreshFusedTrackChain (trackIndex);
 }
 
 void TrackerEngine::setupMixerPlugins()
@@ -1584,6 +1981,35 @@ void TrackerEngine::decayTrackPeaks()
     }
 }
 
+bool TrackerEngine::isTrackSleeping (int trackIndex) const
+{
+    if (edit == nullptr || trackIndex < 0 || trackIndex >= kNumTracks)
+        return false;
+
+    auto tracks = te::getAudioTracks (*edit);
+    if (trackIndex >= tracks.size())
+        return false;
+
+    auto* output = tracks[trackIndex]->pluginList.findFirstPluginOfType<TrackOutputPlugin>();
+    return output != nullptr && output->isSleeping();
+}
+
+int TrackerEngine::getNumSleepingTracks() const
+{
+    if (edit == nullptr)
+        return 0;
+
+    int count = 0;
+    auto tracks = te::getAudioTracks (*edit);
+    for (int t = 0; t < kNumTracks && t < tracks.size(); ++t)
+    {
+        auto* output = tracks[t]->pluginList.findFirstPluginOfType<TrackOutputPlugin>();
+        if (output != nullptr && output->isSleeping())
+            ++count;
+    }
+    return count;
+}
+
 //==============================================================================
 // Insert plugin management
 //==============================================================================
@@ -1637,6 +2063,7 @@ bool TrackerEngine::addInsertPlugin (int trackIndex, const juce::PluginDescripti
         insertPos = pluginList.size(); // Fallback: insert at end
 
     pluginList.insertPlugin (*externalPlugin, insertPos, nullptr);
+    refreshFusedTrackChain (trackIndex);
 
     // Add to state model
     InsertSlotState newSlot;
@@ -1672,6 +2099,8 @@ void TrackerEngine::removeInsertPlugin (int trackIndex, int slotIndex)
     {
         if (auto* plugin = findInsertPluginForSlot (*track, slotIndex))
             plugin->removeFromParent();
+
+        refreshFusedTrackChain (trackIndex);
     }
 
     slots.erase (slots.begin() + slotIndex);
@@ -1803,6 +2232,210 @@ void TrackerEngine::rebuildInsertChain (int trackIndex)
         // Apply bypass state
         externalPlugin->setEnabled (! slot.bypassed);
     }
+
+    refreshFusedTrackChain (trackIndex);
+}
+
+void TrackerEngine::setFusedTrackProcessing (bool shouldFuse)
+{
+    fusedTrackProcessing = shouldFuse;
+
+    for (int t = 0; t < kNumTracks; ++t)
+        refreshFusedTrackChain (t);
+}
+
+void TrackerEngine::setRealtimeSequencing (bool shouldSequence)
+{
+    if (realtimeSequencing == shouldSequence)
+        return;
+
+    realtimeSequencing = shouldSequence;
+
+    // The next sync rebuilds every track for the other path
+    patternSyncCache.valid = false;
+    cancelCuedPattern();
+    if (! shouldSequence)
+        publishedSequence.clear();
+
+    for (int t = 0; t < kNumTracks; ++t)
+        placePatternSequencer (t);
+}
+
+void TrackerEngine::placePatternSequencer (int trackIndex)
+{
+    auto* track = getTrack (trackIndex);
+    if (track == nullptr)
+        return;
+
+    auto& pluginList = track->pluginList;
+    auto* sequencer = pluginList.findFirstPluginOfType<PatternSequencerPlugin>();
+
+    if (! realtimeSequencing)
+    {
+        if (sequencer != nullptr)
+            sequencer->removeFromParent();
+        return;
+    }
+
+    // Sound sources are inserted behind it (see PatternSequencerPlugin::getSoundSourceIndex)
+    if (sequencer == nullptr)
+    {
+        if (auto plugin = dynamic_cast<PatternSequencerPlugin*> (
+                track->edit.getPluginCache().createNewPlugin (PatternSequencerPlugin::xmlTypeName, {}).get()))
+        {
+            pluginList.insertPlugin (*plugin, 0, nullptr);
+            sequencer = plugin;
+        }
+    }
+
+    if (sequencer != nullptr)
+        sequencer->setSequenceSource (&publishedSequence, trackIndex);
+}
+
+bool TrackerEngine::cuePattern (const Pattern& pattern, const std::array<bool, kNumTracks>& releaseMode)
+{
+    // Only a synced pattern loops back to where a cue can take over, and only
+    // the sequencer can switch mid-play. A cue that took over waits for its sync.
+    if (edit == nullptr || ! realtimeSequencing || ! isPlaying() || ! patternSyncCache.valid
+        || hasCuedPatternStarted())
+        return false;
+
+    // The latest cue wins, even over one that's already waiting for the wrap
+    cancelCuedPattern();
+
+    std::array<bool, kNumTracks> trackKill {};
+    for (int t = 0; t < kNumTracks; ++t)
+        trackKill[static_cast<size_t> (t)] = ! releaseMode[static_cast<size_t> (t)]
+                                             && getTrackContentMode (t) != TrackContentMode::PluginInstrument;
+
+    // The tempo map syncPatternToEdit will set up for the pattern, in te's own
+    // tempo model so the worker resolves its rows exactly as the Edit will
+    auto& tempoSequence = edit->tempoSequence;
+    auto* baseTempo = tempoSequence.getTempos()[0];
+    std::vector<te::tempo::TempoChange> tempos { { te::BeatPosition(), baseTempo->getBpm(), baseTempo->getCurve() } };
+
+    for (const auto& [beat, bpm] : getPatternTempoPoints (pattern, rowsPerBeat))
+    {
+        if (beat <= 0.0)
+            tempos.front().bpm = bpm;
+        else
+            tempos.push_back ({ te::BeatPosition::fromBeats (beat), static_cast<double> (bpm), 0.0f });
+    }
+
+    std::vector<te::tempo::TimeSigChange> timeSigs;
+    for (auto* timeSig : tempoSequence.getTimeSigs())
+        timeSigs.push_back ({ timeSig->startBeatNumber.get(), timeSig->numerator.get(),
+                              timeSig->denominator.get(), timeSig->triplets.get() });
+
+    const auto lengthOfOneBeat = edit->engine.getEngineBehaviour().lengthOfOneBeatDependsOnTimeSignature()
+                                     ? te::tempo::LengthOfOneBeat::dependsOnTimeSignature
+                                     : te::tempo::LengthOfOneBeat::isAlwaysACrotchet;
+
+    cueCompiler.cue ([cued = std::make_shared<const Pattern> (pattern), rpb = rowsPerBeat, trackKill,
+                      tempos = std::move (tempos), timeSigs = std::move (timeSigs), lengthOfOneBeat]
+    {
+        const te::tempo::Sequence tempoMap (tempos, timeSigs, lengthOfOneBeat);
+
+        std::vector<double> rowTimes (static_cast<size_t> (cued->numRows) + 1);
+        for (int row = 0; row <= cued->numRows; ++row)
+        {
+            const double beat = static_cast<double> (row) / static_cast<double> (rpb);
+            rowTimes[static_cast<size_t> (row)] = tempoMap.toTime (te::BeatPosition::fromBeats (beat)).inSeconds();
+        }
+
+        return compileCuedPattern (*cued, std::move (rowTimes), trackKill);
+    });
+
+    return true;
+}
+
+void TrackerEngine::armCuedPattern (PatternCueCompiler::Compiled compiled)
+{
+    // Stopped, left pattern mode or turned the sequencer off while it compiled
+    if (edit == nullptr || ! realtimeSequencing || ! isPlaying() || ! patternSyncCache.valid
+        || compiled.sequence == nullptr)
+        return;
+
+    auto tracks = te::getAudioTracks (*edit);
+    for (int t = 0; t < kNumTracks && t < tracks.size(); ++t)
+    {
+        const auto idx = static_cast<size_t> (t);
+        auto& pluginList = tracks[t]->pluginList;
+
+        // The cued pattern's instruments join the playing one's, so both have
+        // their banks across the wrap (the sync after it trims them)
+        std::vector<int> usedInstruments = trackInstrumentUsage[idx];
+        for (int inst : compiled.instrumentsByTrack[idx])
+            if (std::find (usedInstruments.begin(), usedInstruments.end(), inst) == usedInstruments.end())
+                usedInstruments.push_back (inst);
+
+        const bool isSampleTrack = getTrackContentMode (t) != TrackContentMode::PluginInstrument;
+
+        if (auto* samplerPlugin = pluginList.findFirstPluginOfType<TrackerSamplerPlugin>())
+        {
+            if (isSampleTrack)
+            {
+                std::map<int, std::shared_ptr<const SampleBank>> banks;
+                for (int inst : usedInstruments)
+                    if (auto bank = sampler.getSampleBank (inst))
+                        banks[inst] = bank;
+                samplerPlugin->preloadBanks (banks);
+            }
+            samplerPlugin->setCuedTrackerEvents (compiled.trackerEvents[idx]);
+        }
+
+        if (auto* fxPlugin = pluginList.findFirstPluginOfType<InstrumentEffectsPlugin>())
+        {
+            if (isSampleTrack)
+            {
+                std::map<int, GlobalModState*> globalStates;
+                for (int inst : usedInstruments)
+                    globalStates[inst] = sampler.getOrCreateGlobalModState (inst);
+                fxPlugin->setGlobalModStates (globalStates);
+            }
+            fxPlugin->setCuedTrackerEvents (compiled.trackerEvents[idx]);
+        }
+    }
+
+    cuedSequence = compiled.sequence;
+    publishedSequence.publish (LoopCueFollower<PatternSequence>::kCuedSlot, std::move (compiled.sequence));
+}
+
+void TrackerEngine::cancelCuedPattern()
+{
+    cueCompiler.cancel();
+
+    if (cuedSequence == nullptr)
+        return;
+
+    cuedSequence = nullptr;
+    publishedSequence.remove (LoopCueFollower<PatternSequence>::kCuedSlot);
+
+    if (edit == nullptr)
+        return;
+
+    for (auto* track : te::getAudioTracks (*edit))
+    {
+        if (auto* samplerPlugin = track->pluginList.findFirstPluginOfType<TrackerSamplerPlugin>())
+            samplerPlugin->setCuedTrackerEvents (nullptr);
+        if (auto* fxPlugin = track->pluginList.findFirstPluginOfType<InstrumentEffectsPlugin>())
+            fxPlugin->setCuedTrackerEvents (nullptr);
+    }
+}
+
+bool TrackerEngine::hasCuedPatternStarted() const
+{
+    return cuedSequence != nullptr && cuedSequence->cueStarted.load (std::memory_order_acquire);
+}
+
+void TrackerEngine::refreshFusedTrackChain (int trackIndex)
+{
+    auto* track = getTrack (trackIndex);
+    if (track == nullptr)
+        return;
+
+    if (auto* samplerPlugin = track->pluginList.findFirstPluginOfType<TrackerSamplerPlugin>())
+        samplerPlugin->setFusedChain (fusedTrackProcessing ? makeFusedTrackChain (*track) : nullptr);
 }
 
 void TrackerEngine::snapshotInsertPluginStates()
@@ -2123,8 +2756,9 @@ void TrackerEngine::ensurePluginInstrumentLoaded (int instrumentIndex)
 
     if (pluginPtr != nullptr)
     {
-        // Insert at position 0 -- the plugin instrument acts as the sound source
-        track->pluginList.insertPlugin (*pluginPtr, 0, nullptr);
+        // Insert at the head (behind a pattern sequencer) -- the plugin instrument acts as the sound source
+        track->pluginList.insertPlugin (*pluginPtr, PatternSequencerPlugin::getSoundSourceIndex (track->pluginList),
+                                        nullptr);
         pluginInstrumentInstances[instrumentIndex] = pluginPtr;
 
         // Restore plugin state (preset) if available
@@ -2725,24 +3359,11 @@ const TrackerEngine::AutomatedParam* TrackerEngine::findAutomatedParam (const ju
     return nullptr;
 }
 
-void TrackerEngine::applyPatternAutomation (const PatternAutomationData& automationData,
-                                            int /*patternLength*/, int /*rpb*/)
+void TrackerEngine::trackAutomationBaselines (const PatternAutomationData& automationData)
 {
-    if (edit == nullptr)
-        return;
-
-    // Clear previous tracking without touching plugin parameters synchronously.
-    // resetAutomationParameters() used to call param->setValue() for every
-    // tracked param, which deadlocks when the audio thread is processing the
-    // plugin (playInStopEnabled = true means the graph is always live).
-    lastAutomatedParams.clear();
-
-    if (automationData.isEmpty())
-        return;
-
     for (const auto& lane : automationData.lanes)
     {
-        if (lane.isEmpty())
+        if (lane.isEmpty() || findAutomatedParam (lane.pluginId, lane.parameterId) != nullptr)
             continue;
 
         auto* audioPlugin = resolvePluginInstance (lane.pluginId);
@@ -2757,7 +3378,7 @@ void TrackerEngine::applyPatternAutomation (const PatternAutomationData& automat
         if (param == nullptr)
             continue;
 
-        // Store baseline for later row-wise playback updates.
+        // Store baseline so stopping playback can restore the parameter.
         // tryEnter: audio thread may hold the callback lock (playInStopEnabled).
         float baseline = 0.5f;
         auto& lock = audioPlugin->getCallbackLock();
@@ -2768,11 +3389,138 @@ void TrackerEngine::applyPatternAutomation (const PatternAutomationData& automat
         }
         lastAutomatedParams.push_back ({ lane.pluginId, lane.parameterId, baseline });
     }
+}
+
+PluginAutomationStage::Section TrackerEngine::compileAutomationSection (const PatternAutomationData& automationData,
+                                                                        int patternLength, int rpb, double beatOffset)
+{
+    PluginAutomationStage::Section section;
+
+    const int numRows = juce::jmax (1, patternLength);
+    section.rowTimes.resize (static_cast<size_t> (numRows) + 1);
+    for (int row = 0; row <= numRows; ++row)
+    {
+        const double beat = beatOffset + static_cast<double> (row) / static_cast<double> (rpb);
+        section.rowTimes[static_cast<size_t> (row)] = edit->tempoSequence.toTime (te::BeatPosition::fromBeats (beat)).inSeconds();
+    }
+    section.startTime = section.rowTimes.front();
+    section.endTime = section.rowTimes.back();
+
+    for (const auto& lane : automationData.lanes)
+    {
+        if (lane.isEmpty())
+            continue;
+
+        // Resolve the plugin and the track whose chain hosts it
+        te::Plugin* plugin = nullptr;
+        int hostTrack = -1;
+        bool precedesStage = false;
+
+        if (lane.pluginId.startsWith ("inst:"))
+        {
+            const int instIdx = lane.pluginId.substring (5).getIntValue();
+            plugin = getPluginInstrumentInstance (instIdx);
+            auto infoIt = instrumentSlotInfos.find (instIdx);
+            hostTrack = infoIt != instrumentSlotInfos.end() ? infoIt->second.ownerTrack : -1;
+            precedesStage = true;
+        }
+        else if (lane.pluginId.startsWith ("insert:"))
+        {
+            auto parts = juce::StringArray::fromTokens (lane.pluginId.substring (7), ":", "");
+            if (parts.size() >= 2)
+            {
+                hostTrack = parts[0].getIntValue();
+                plugin = getInsertPlugin (hostTrack, parts[1].getIntValue());
+            }
+        }
+
+        auto* ext = dynamic_cast<te::ExternalPlugin*> (plugin);
+        if (ext == nullptr || hostTrack < 0 || hostTrack >= kNumTracks)
+            continue;
+
+        auto* audioPlugin = ext->getAudioPluginInstance();
+        if (audioPlugin == nullptr)
+            continue;
+
+        auto& params = audioPlugin->getParameters();
+        if (lane.parameterId < 0 || lane.parameterId >= params.size() || params[lane.parameterId] == nullptr)
+            continue;
+
+        PluginAutomationStage::Target target;
+        target.plugin = plugin;
+        target.parameter = params[lane.parameterId];
+        target.curve = CompiledAutomationCurve::compile (lane);
+        target.precedesStage = precedesStage;
+        section.targetsByTrack[static_cast<size_t> (hostTrack)].push_back (std::move (target));
+    }
+
+    return section;
+}
+
+void TrackerEngine::applyPatternAutomation (const PatternAutomationData& automationData,
+                                            int patternLength, int rpb)
+{
+    if (edit == nullptr)
+        return;
+
+    // Clear previous tracking without touching plugin parameters synchronously.
+    // resetAutomationParameters() used to call param->setValue() for every
+    // tracked param, which deadlocks when the audio thread is processing the
+    // plugin (playInStopEnabled = true means the graph is always live).
+    lastAutomatedParams.clear();
+
+    if (automationData.isEmpty())
+    {
+        automationStage.clear();
+        return;
+    }
+
+    trackAutomationBaselines (automationData);
+
+    auto program = std::make_shared<PluginAutomationStage::Program>();
+    program->sections.push_back (compileAutomationSection (automationData, patternLength, rpb, 0.0));
+    automationStage.publish (std::move (program));
 
     // Prime row-0 value immediately so playback starts from correct automation state.
     applyAutomationForPlaybackRow (automationData, 0);
 }
 
+void TrackerEngine::applyArrangementAutomation (const std::vector<std::pair<const Pattern*, int>>& sequence, int rpb)
+{
+    if (edit == nullptr)
+        return;
+
+    lastAutomatedParams.clear();
+
+    auto program = std::make_shared<PluginAutomationStage::Program>();
+    double beatOffset = 0.0;
+
+    for (const auto& [pattern, repeats] : sequence)
+    {
+        if (pattern == nullptr)
+            continue;
+
+        const double patternLengthBeats = static_cast<double> (pattern->numRows) / static_cast<double> (rpb);
+        trackAutomationBaselines (pattern->automationData);
+
+        for (int rep = 0; rep < repeats; ++rep)
+        {
+            if (! pattern->automationData.isEmpty())
+                program->sections.push_back (compileAutomationSection (pattern->automationData,
+                                                                       pattern->numRows, rpb, beatOffset));
+            beatOffset += patternLengthBeats;
+        }
+    }
+
+    if (program->isEmpty())
+        automationStage.clear();
+    else
+        automationStage.publish (std::move (program));
+
+    if (! sequence.empty() && sequence.front().first != nullptr)
+        applyAutomationForPlaybackRow (sequence.front().first->automationData, 0);
+}
+
 void TrackerEngine::applyAutomationForPlaybackRow (const PatternAutomationData& automationData, int row)
 {
     if (automationData.isEmpty())
@@ -2809,8 +3557,8 @@ void TrackerEngine::applyAutomationForPlaybackRow (const PatternAutomationData&
         // Use tryEnter on the plugin's callback lock to avoid deadlocking
         // with the audio thread.  playInStopEnabled = true means the
         // playback graph is always live, so processBlock() can hold the
-        // lock at any time.  If we can't get the lock we skip this tick;
-        // the next timer callback (30 Hz) will try again.
+        // lock at any time.  During playback the automation stage owns the
+        // value, so a skipped prime is harmless.
         auto& lock = audioPlugin->getCallbackLock();
         if (lock.tryEnter())
         {
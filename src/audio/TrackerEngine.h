@@ -1,9 +1,11 @@
 #pragma once
 
+#include <unordered_map>
 #include <JuceHeader.h>
 #include <tracktion_engine/tracktion_engine.h>
 #include "PatternData.h"
 #include "SimpleSampler.h"
+#include "SampleLoader.h"
 #include "InstrumentEffectsPlugin.h"
 #include "MetronomePlugin.h"
 #include "SendEffectsPlugin.h"
@@ -15,6 +17,13 @@
 #include "PluginCatalogService.h"
 #include "InstrumentSlotInfo.h"
 #include "PluginAutomationData.h"
+#include "PluginAutomationStage.h"
+#include "TrackerEvent.h"
+#include "PatternTrackBlock.h"
+#include "PatternSequencer.h"
+#include "PatternCueCompiler.h"
+#include "LoopCue.h"
+#include "AtomicSharedPtrTable.h"
 
 namespace te = tracktion;
 
@@ -68,6 +77,19 @@ public:
     juce::String loadSampleForInstrument (int instrumentIndex, const juce::File& sampleFile);
     void clearSampleForInstrument (int instrumentIndex);
 
+    // Background loading: the bank reaches the sampler and every track using
+    // the instrument when it's decoded; onLoaded runs on the message thread.
+    void loadSampleForInstrumentAsync (int instrumentIndex, const juce::File& sampleFile,
+                                       SampleLoader::Completion onLoaded = nullptr);
+    void cancelSampleLoads() { sampleLoader.cancelAll(); }
+    std::map<int, float> getSampleLoadProgress() const { return sampleLoader.getProgress(); }
+
+    // Loaded samples plus those still loading (what a project save should reference)
+    std::map<int, juce::File> getInstrumentSampleFiles() const;
+
+    // Called when background sample loads progress, finish or are cancelled
+    std::function<void()> onSampleLoadProgress;
+
     // Ensure a track's plugin is configured for a specific instrument
     void ensureTrackHasInstrument (int trackIndex, int instrumentIndex);
 
@@ -107,11 +129,72 @@ public:
     // Get audio track
     te::AudioTrack* getTrack (int index);
 
+    // Offline render support (see OfflineRenderer)
+    te::Edit* getEdit() { return edit.get(); }
+    te::AudioTrack* getSendEffectsTrack() { return getTrack (kSendEffectsTrack); }
+
+    // Edit-time range of the pattern/arrangement written by the last sync
+    te::TimeRange getSyncedContentRange() const { return syncedContentRange; }
+
     // Callback when transport state changes
     std::function<void()> onTransportChanged;
 
     te::Engine& getEngine() { return *engine; }
     SimpleSampler& getSampler() { return sampler; }
+
+    // Multi-threaded graph rendering. Tracks render in parallel on a pool of
+    // numCpus - 1 worker threads plus the audio device thread; 1 keeps the
+    // whole graph on the device thread, 0 uses Tracktion's default.
+    struct RenderThreading
+    {
+        int numCpus = 0;
+        te::graph::ThreadPoolStrategy strategy = te::graph::ThreadPoolStrategy::realTime;
+    };
+
+    /** Applies the settings by rebuilding the playback graph (playback resumes). */
+    void setRenderThreading (const RenderThreading& settings);
+    RenderThreading getRenderThreading() const { return renderThreading; }
+
+    /** Display names indexed by ThreadPoolStrategy value. */
+    static juce::StringArray getThreadPoolStrategyNames();
+
+    /** Sets the sampler voice pool of every track, including ones already playing. */
+    void setSamplerVoiceLimits (const SimpleSampler::VoiceLimits& limits);
+
+    /** Display names indexed by SamplerVoicePool::Stealing value. */
+    static juce::StringArray getVoiceStealingNames();
+
+    /**
+     * Lets the sampler of each sample track run the track's effects, channel
+     * strip and output stages itself in one pass over the block. Tracks with
+     * inserts keep the plugin chain either way.
+     */
+    void setFusedTrackProcessing (bool shouldFuse);
+    bool isFusedTrackProcessing() const { return fusedTrackProcessing; }
+
+    /**
+     * Plays patterns from a sequencer at the head of each track instead of
+     * MIDI clips. Syncs then publish the pattern (or song) as a
+     * PatternSequence that playback picks up from the next row, without
+     * rebuilding any clip. Off (the default) writes clips, which is what
+     * exports render. Takes effect with the next sync.
+     */
+    void setRealtimeSequencing (bool shouldSequence);
+    bool isRealtimeSequencing() const { return realtimeSequencing; }
+
+    /**
+     * Cues a pattern to take over from the playing one at the next loop wrap.
+     * It's compiled on a worker thread and handed to playback ahead of the
+     * wrap, so the switch lands on the downbeat without a sync. Once
+     * hasCuedPatternStarted(), syncPatternToEdit() the pattern to bring the
+     * tempo map, loop range and automation along. False when the pattern
+     * can't be cued (needs realtime sequencing, playing a pattern): sync it
+     * instead. A later cue replaces this one.
+     */
+    bool cuePattern (const Pattern& pattern, const std::array<bool, kNumTracks>& releaseMode = {});
+    void cancelCuedPattern();
+    bool hasCuedPattern() const { return cueCompiler.isCompiling() || cuedSequence != nullptr; }
+    bool hasCuedPatternStarted() const;
     PluginCatalogService& getPluginCatalog() { return *pluginCatalog; }
 
     // Send effects access
@@ -145,6 +228,11 @@ public:
     float getTrackPeakLevel (int trackIndex) const;
     void decayTrackPeaks();
 
+    // Idle tracks: silent for longer than their effect tails, so the track
+    // plugins skip their processing (any thread, for profiling and display)
+    bool isTrackSleeping (int trackIndex) const;
+    int getNumSleepingTracks() const;
+
     //==============================================================================
     // Plugin instrument slot management (Phase 4)
     //==============================================================================
@@ -201,12 +289,14 @@ public:
     // Plugin automation (Phase 5)
     //==============================================================================
 
-    /** Apply automation data from a pattern to plugin parameter automation curves.
-     *  This is called during syncPatternToEdit to map modulation points to plugin parameters. */
+    /** Compile a pattern's automation lanes and publish them to the audio-thread
+     *  automation stage. Called during syncPatternToEdit. */
     void applyPatternAutomation (const PatternAutomationData& automationData,
                                  int patternLength, int rowsPerBeat);
 
-    /** Apply automation values for a specific playback row (used by live playback updates). */
+    /** Set automation values for a specific row from the message thread.
+     *  Playback automation runs on the audio thread; this only primes values
+     *  while stopped (e.g. so the UI shows the row-0 state). */
     void applyAutomationForPlaybackRow (const PatternAutomationData& automationData, int row);
 
     /** Reset all plugin parameters modified by automation to their baseline values.
@@ -217,26 +307,81 @@ public:
     juce::AudioPluginInstance* resolvePluginInstance (const juce::String& pluginId);
 
 private:
+    std::atomic<int> renderCpus { 0 };   // read by the engine behaviour
+    RenderThreading renderThreading;
     std::unique_ptr<te::Engine> engine;
     std::unique_ptr<te::Edit> edit;
     SimpleSampler sampler;
+    SampleLoader sampleLoader { sampler };
     std::unique_ptr<PluginCatalogService> pluginCatalog;
     int rowsPerBeat = 4;
     std::array<int, kNumTracks + 3> currentTrackInstrument {};
 
+    // Sample instruments each track played in the last prepared pattern(s),
+    // so banks that arrive from the loader later can be handed to the tracks
+    std::array<std::vector<int>, kNumTracks> trackInstrumentUsage {};
+    void publishSampleBank (int instrumentIndex);
+
+    // Each track's pattern FX as compiled with its clip, handed again to
+    // the track's built-in plugins whenever they are set up
+    std::array<std::shared_ptr<const TrackerEventList>, kNumTracks> trackTrackerEvents {};
+    void setTrackTrackerEvents (int trackIndex, std::shared_ptr<const TrackerEventList> events);
+
+    // What syncPatternToEdit last wrote, so edits only re-emit the tracks they touched
+    struct PatternSyncCache
+    {
+        bool valid = false;
+        int numRows = 0;
+        int rowsPerBeat = 0;
+        double baseBpm = 0.0;
+        juce::uint64 masterRevision = 0;
+        std::array<juce::uint64, kNumTracks> trackRevisions {};
+        std::array<bool, kNumTracks> trackKill {};
+        std::array<std::shared_ptr<const PatternTrackBlock>, kNumTracks> trackBlocks {};
+    };
+    PatternSyncCache patternSyncCache;
+
+    // Compiled pattern tracks by content hash, shared by every arrangement
+    // entry and track holding the same cells. Track revisions that were
+    // already hashed skip the hashing. Blocks neither the pattern sync cache
+    // nor the last synced arrangement uses are dropped after each sync.
+    std::unordered_map<juce::uint64, std::shared_ptr<const PatternTrackBlock>> patternBlocks;
+    std::unordered_map<juce::uint64, juce::uint64> patternBlockHashByRevision;
+    std::vector<std::shared_ptr<const PatternTrackBlock>> arrangementBlocks;
+    std::shared_ptr<const PatternTrackBlock> getPatternTrackBlock (const Pattern& pattern, int trackIndex);
+    void prunePatternBlocks();
+
     // Preview, metronome, and send effects track indices
     static constexpr int kPreviewTrack = kNumTracks;
     static constexpr int kMetronomeTrack = kNumTracks + 1;
     static constexpr int kSendEffectsTrack = kNumTracks + 2;
+    static constexpr int kSendOrderBus = 0;   // aux bus that orders the send bus after its producers
     SendEffectsPlugin* sendEffectsPlugin = nullptr;
     MixerState* mixerStatePtr = nullptr;
     void setupSendEffectsTrack();
+    void connectSendProducer (int trackIndex);
     void setupMixerPlugins();
     void setupChannelStripAndOutput (int trackIndex);
 
+    bool fusedTrackProcessing = true;
+    void refreshFusedTrackChain (int trackIndex);
+
+    // Realtime sequencing: the sequence each track's PatternSequencerPlugin
+    // plays, and putting that plugin ahead of the track's sound source
+    bool realtimeSequencing = false;
+    LoopCueFollower<PatternSequence>::Table publishedSequence;
+    void placePatternSequencer (int trackIndex);
+
+    // Cued pattern: compiled off the message thread, then parked in the cue
+    // slots of the sequence and tracker event tables until the loop wraps
+    PatternCueCompiler cueCompiler;
+    std::shared_ptr<const PatternSequence> cuedSequence;
+    void armCuedPattern (PatternCueCompiler::Compiled compiled);
+
     // Plugin editor windows (keyed by "track:slot")
     std::map<juce::String, std::unique_ptr<juce::DocumentWindow>> pluginEditorWindows;
-    void refreshTransportLoopRangeFromClip();
+    te::TimeRange syncedContentRange;
+    void refreshTransportLoopRange();
     static constexpr int kPreviewDurationMs = 30000;
     static constexpr int kPluginPreviewDurationMs = 500;
     int activePreviewTrack = -1;
@@ -269,6 +414,13 @@ private:
     std::vector<AutomatedParam> lastAutomatedParams;
     AutomatedParam* findAutomatedParam (const juce::String& pluginId, int paramIndex);
     const AutomatedParam* findAutomatedParam (const juce::String& pluginId, int paramIndex) const;
+    void trackAutomationBaselines (const PatternAutomationData& automationData);
+
+    // Audio-thread automation (run from each track's ChannelStripPlugin)
+    PluginAutomationStage automationStage;
+    PluginAutomationStage::Section compileAutomationSection (const PatternAutomationData& automationData,
+                                                             int patternLength, int rpb, double beatOffset);
+    void applyArrangementAutomation (const std::vector<std::pair<const Pattern*, int>>& sequence, int rpb);
 
     // Ensure the plugin instrument is loaded on its owner track
     void ensurePluginInstrumentLoaded (int instrumentIndex);
@@ -0,0 +1,231 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/**
+ * A pattern FX command for the built-in track plugins.
+ *
+ * TrackerEngine compiles a track's FX column into these alongside the
+ * track's MIDI clip (which keeps the notes, note lanes and program changes)
+ * and publishes the list to the track's TrackerSamplerPlugin and
+ * InstrumentEffectsPlugin. They read the events in each block straight from
+ * the list: one event per command with its full 8-bit parameter, in the
+ * order they apply on the row, and ahead of MIDI at the same sample.
+ */
+struct TrackerEvent
+{
+    enum class Command : uint8_t
+    {
+        RowReset,      // a note row starts: per-row commands go back to their defaults
+        Direction,     // Bxx: 00 = backward, anything else forward
+        Position,      // Pxx: sample position 00-FF
+        Tune,          // Txx: signed semitones
+        PortaSteps,    // Gxx: portamento time in rows
+        SlideUp,       // Sxy: x semitones over y rows
+        SlideDown,     // Dxy
+        DelaySend,     // Yxx: 00-FF maps to -100..0 dB
+        ReverbSend,    // Rxx
+        Volume,        // Vxx: 00 = silence, 7F = unity, FF = +10 dB
+        PortaTarget,   // param = note to glide to, without retriggering
+        PortaVolume    // param = note volume (0-127) given on a portamento row
+    };
+
+    double time = 0.0;           // edit seconds
+    uint16_t row = 0;            // row within its pattern
+    int16_t instrument = -1;     // the lane's instrument (-1 for the shared FX column)
+    uint8_t lane = 0;            // note lane (0 for the shared FX column)
+    Command command = Command::RowReset;
+    uint8_t param = 0;
+};
+
+/** The command an FX column letter maps to, or false for letters the plugins don't play. */
+inline bool getTrackerEventCommand (char letter, TrackerEvent::Command& command) noexcept
+{
+    using Command = TrackerEvent::Command;
+
+    switch (letter)
+    {
+        case 'B': command = Command::Direction;  return true;
+        case 'P': command = Command::Position;   return true;
+        case 'T': command = Command::Tune;       return true;
+        case 'G': command = Command::PortaSteps; return true;
+        case 'S': command = Command::SlideUp;    return true;
+        case 'D': command = Command::SlideDown;  return true;
+        case 'Y': command = Command::DelaySend;  return true;
+        case 'R': command = Command::ReverbSend; return true;
+        case 'V': command = Command::Volume;     return true;
+        default:  return false;   // F (tempo) goes to the master tempo lane
+    }
+}
+
+/**
+ * A track's events, sorted by time; events on the same time keep the order
+ * they were added in. Immutable once published.
+ *
+ * Events are either added one by one, or placed as shared segments: one per
+ * distinct compiled entry, timed from the entry's start, and referenced from
+ * each place it plays rather than copied there. Iterating a range yields
+ * each event with its placement's start added to its time.
+ */
+class TrackerEventList : public std::enable_shared_from_this<TrackerEventList>
+{
+public:
+    /** Events timed from the start of their placement, sorted by time. */
+    using Segment = std::vector<TrackerEvent>;
+
+    void add (const TrackerEvent& event) { events.push_back (event); }
+
+    /**
+     * Plays segment from startTime. Placements go in time order, each after
+     * the last event of the one before.
+     */
+    void place (std::shared_ptr<const Segment> segment, double startTime)
+    {
+        if (segment == nullptr || segment->empty())
+            return;
+
+        placements.push_back ({ segment->data(), segment->data() + segment->size(), startTime });
+        numEvents += segment->size();
+        segments.push_back (std::move (segment));
+    }
+
+    /** Sorts a segment's events by time, keeping the order they were added in on the same time. */
+    static std::shared_ptr<const Segment> makeSegment (Segment segment)
+    {
+        sortByTime (segment);
+        return std::make_shared<const Segment> (std::move (segment));
+    }
+
+    /** Sorts the added events by time. Call once everything is added. */
+    void finalise()
+    {
+        sortByTime (events);
+
+        if (! events.empty())
+        {
+            placements.insert (placements.begin(), Placement { events.data(), events.data() + events.size(), 0.0 });
+            numEvents += events.size();
+        }
+    }
+
+    bool isEmpty() const noexcept { return numEvents == 0; }
+    size_t size() const noexcept { return numEvents; }
+
+    /** The events added one by one (placed segments aren't copied in). */
+    const std::vector<TrackerEvent>& getEvents() const noexcept { return events; }
+
+private:
+    struct Placement
+    {
+        const TrackerEvent* first = nullptr;
+        const TrackerEvent* last = nullptr;
+        double startTime = 0.0;
+    };
+
+public:
+    /** Walks events across placements, each timed on the edit. */
+    class Iterator
+    {
+    public:
+        Iterator() = default;
+
+        TrackerEvent operator*() const noexcept
+        {
+            auto e = *event;
+            e.time += placement->startTime;
+            return e;
+        }
+
+        Iterator& operator++() noexcept
+        {
+            if (++event == placement->last)
+                event = ++placement != endPlacement ? placement->first : nullptr;
+            return *this;
+        }
+
+        Iterator operator++ (int) noexcept
+        {
+            auto was = *this;
+            ++*this;
+            return was;
+        }
+
+        bool operator== (const Iterator& other) const noexcept { return placement == other.placement && event == other.event; }
+        bool operator!= (const Iterator& other) const noexcept { return ! (*this == other); }
+
+    private:
+        friend class TrackerEventList;
+
+        Iterator (const Placement* p, const Placement* endP, const TrackerEvent* e) noexcept
+            : placement (p), endPlacement (endP), event (e) {}
+
+        const Placement* placement = nullptr;
+        const Placement* endPlacement = nullptr;
+        const TrackerEvent* event = nullptr;   // nullptr past the last placement
+    };
+
+    /** The events of one rendered block, each placed on the sample nearest its time. */
+    struct Range
+    {
+        Iterator first, last;
+
+        Iterator begin() const noexcept { return first; }
+        Iterator end() const noexcept   { return last; }
+        bool isEmpty() const noexcept   { return first == last; }
+    };
+
+    /**
+     * Events landing on samples [startSample, startSample + numSamples) at
+     * this rate. Consecutive blocks see every event exactly once.
+     */
+    Range getRange (int64_t startSample, int numSamples, double sampleRate) const noexcept
+    {
+        const double start = (static_cast<double> (startSample) - 0.5) / sampleRate;
+        const double end = (static_cast<double> (startSample + numSamples) - 0.5) / sampleRate;
+        return { findFirstAtOrAfter (start), findFirstAtOrAfter (end) };
+    }
+
+    /** The sample an event lands on at this rate. */
+    static int64_t getSample (const TrackerEvent& event, double sampleRate) noexcept
+    {
+        return static_cast<int64_t> (std::llround (event.time * sampleRate));
+    }
+
+private:
+    std::vector<TrackerEvent> events;
+    std::vector<std::shared_ptr<const Segment>> segments;
+    std::vector<Placement> placements;
+    size_t numEvents = 0;
+
+    static void sortByTime (std::vector<TrackerEvent>& toSort)
+    {
+        std::stable_sort (toSort.begin(), toSort.end(),
+                          [] (const TrackerEvent& a, const TrackerEvent& b) { return a.time < b.time; });
+    }
+
+    Iterator findFirstAtOrAfter (double time) const noexcept
+    {
+        const auto* const endPlacement = placements.data() + placements.size();
+
+        // From the last placement starting at or before time
+        auto p = std::upper_bound (placements.begin(), placements.end(), time,
+                                   [] (double t, const Placement& pl) { return t < pl.startTime; });
+        if (p != placements.begin())
+            --p;
+
+        for (; p != placements.end(); ++p)
+        {
+            const double startTime = p->startTime;
+            const auto* e = std::lower_bound (p->first, p->last, time,
+                                              [startTime] (const TrackerEvent& ev, double t) { return ev.time + startTime < t; });
+            if (e != p->last)
+                return { &*p, endPlacement, e };
+        }
+
+        return { endPlacement, endPlacement, nullptr };
+    }
+};
@@ -0,0 +1,146 @@
+#include "TrackerPitchFx.h"
+#include <cstdint>
+
+void TrackerPitchFx::reset()
+{
+    resetRow();
+    currentNote = -1;
+    heldNotes.reset();
+}
+
+void TrackerPitchFx::resetRow()
+{
+    tuneOffset = 0.0f;
+    stepSlideOffset = 0.0f;
+    stepSlideActive = false;
+    stepSlideStart = 0.0f;
+    stepSlideTarget = 0.0f;
+    stepSlideSteps = 0;
+    stepSlideRowsProgress = 0.0;
+    portaSteps = 0;
+    portaTarget = -1;
+    portaActive = false;
+    portaPitch = 0.0f;
+    portaTargetOffset = 0.0f;
+    portaRowsProgress = 0.0;
+}
+
+void TrackerPitchFx::releaseAll()
+{
+    heldNotes.reset();
+    portaTarget = -1;
+}
+
+void TrackerPitchFx::handleMidi (const juce::MidiMessage& m)
+{
+    if (m.isNoteOn())
+    {
+        // An actual retrigger (glide targets come as PortaTarget events)
+        currentNote = m.getNoteNumber();
+        heldNotes.set (static_cast<size_t> (currentNote));
+        portaTarget = -1;
+        portaPitch = 0.0f;
+        return;
+    }
+
+    if (m.isNoteOff())
+    {
+        // Releasing the last held note drops the portamento target
+        heldNotes.reset (static_cast<size_t> (m.getNoteNumber()));
+        if (heldNotes.none())
+            portaTarget = -1;
+        return;
+    }
+
+    if (m.isAllNotesOff())
+        releaseAll();
+}
+
+void TrackerPitchFx::handleEvent (const TrackerEvent& event)
+{
+    using Command = TrackerEvent::Command;
+
+    switch (event.command)
+    {
+        case Command::RowReset:
+            resetRow();
+            break;
+
+        case Command::PortaTarget: // Glide to this note (don't retrigger)
+            portaTarget = event.param;
+            if (portaSteps > 0 && currentNote >= 0)
+            {
+                portaActive = true;
+                portaRowsProgress = 0.0;
+                portaTargetOffset = static_cast<float> (portaTarget - currentNote);
+                portaPitch = 0.0f;
+            }
+            break;
+
+        case Command::Tune: // Txx tune (signed two's complement)
+            tuneOffset = static_cast<float> (static_cast<int8_t> (event.param));
+            break;
+
+        case Command::PortaSteps: // Gxx portamento speed in steps
+            if (event.param > 0)
+                portaSteps = event.param;
+            break;
+
+        case Command::SlideUp:   // Sxy step slide up
+        case Command::SlideDown: // Dxy step slide down
+        {
+            const float semitones = static_cast<float> ((event.param >> 4) & 0xF);
+            const int steps = event.param & 0xF;
+            const float signedDelta = (event.command == Command::SlideUp) ? semitones : -semitones;
+
+            if (steps <= 0)
+            {
+                stepSlideOffset += signedDelta;
+                stepSlideActive = false;
+            }
+            else
+            {
+                stepSlideActive = true;
+                stepSlideStart = stepSlideOffset;
+                stepSlideTarget = stepSlideOffset + signedDelta;
+                stepSlideSteps = steps;
+                stepSlideRowsProgress = 0.0;
+            }
+            break;
+        }
+
+        default:
+            break;
+    }
+}
+
+void TrackerPitchFx::advance (double rows)
+{
+    // Sxy/Dxy: slide in tracker steps
+    if (stepSlideActive && stepSlideSteps > 0)
+    {
+        stepSlideRowsProgress += rows;
+        const float t = juce::jlimit (0.0f, 1.0f,
+            static_cast<float> (stepSlideRowsProgress / static_cast<double> (stepSlideSteps)));
+        stepSlideOffset = juce::jmap (t, stepSlideStart, stepSlideTarget);
+        if (t >= 1.0f)
+            stepSlideActive = false;
+    }
+
+    // Gxx + portamento target
+    if (portaActive && portaSteps > 0 && portaTarget >= 0 && currentNote >= 0)
+    {
+        portaRowsProgress += rows;
+        const float t = juce::jlimit (0.0f, 1.0f,
+            static_cast<float> (portaRowsProgress / static_cast<double> (portaSteps)));
+        portaPitch = portaTargetOffset * t;
+
+        if (t >= 1.0f)
+        {
+            currentNote = portaTarget;
+            portaPitch = 0.0f;
+            portaActive = false;
+            portaRowsProgress = 0.0;
+        }
+    }
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <bitset>
+#include <JuceHeader.h>
+#include "TrackerEvent.h"
+
+/**
+ * Pitch commands of a tracker track: Txx tune, Sxy/Dxy step slides and Gxx
+ * portamento (speed from Gxx, target from the note on the glide row), reset
+ * at every note row.
+ *
+ * TrackerSamplerPlugin feeds it the track's notes and pattern FX events at
+ * their sample and advances it once per control tick, so the pitch it plays
+ * follows the commands without waiting a block for the effects plugin after it.
+ */
+class TrackerPitchFx
+{
+public:
+    void reset();
+
+    /** Follows the notes held on the track; other messages are ignored. */
+    void handleMidi (const juce::MidiMessage& message);
+
+    /** Applies a pattern FX event; commands other than pitch ones are ignored. */
+    void handleEvent (const TrackerEvent& event);
+
+    /** All notes released (end of pattern, transport stop). */
+    void releaseAll();
+
+    /** Moves slides and portamento on by a number of pattern rows. */
+    void advance (double rows);
+
+    /** Current offset from the played note, in semitones. */
+    float getPitchOffset() const noexcept { return tuneOffset + stepSlideOffset + portaPitch; }
+
+private:
+    int currentNote = -1;
+    std::bitset<128> heldNotes;
+
+    float tuneOffset = 0.0f;
+
+    float stepSlideOffset = 0.0f;
+    bool stepSlideActive = false;
+    float stepSlideStart = 0.0f;
+    float stepSlideTarget = 0.0f;
+    int stepSlideSteps = 0;
+    double stepSlideRowsProgress = 0.0;
+
+    int portaSteps = 0;
+    int portaTarget = -1;
+    bool portaActive = false;
+    float portaPitch = 0.0f;
+    float portaTargetOffset = 0.0f;
+    double portaRowsProgress = 0.0;
+
+    void resetRow();
+};
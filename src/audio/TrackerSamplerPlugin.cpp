@@ -1,13 +1,16 @@
 #include "TrackerSamplerPlugin.h"
 #include "SimpleSampler.h"
 #include "InstrumentRouting.h"
-#include "FxParamTransport.h"
 #include "SamplePlaybackLayout.h"
+#include "SampleResampler.h"
+#include "ControlRate.h"
+#include "GranularCloud.h"
 
 const char* TrackerSamplerPlugin::xmlTypeName = "TrackerSampler";
 
 TrackerSamplerPlugin::TrackerSamplerPlugin (te::PluginCreationInfo info)
-    : te::Plugin (info)
+    : te::Plugin (info),
+      fallbackSnapshot (std::make_shared<const InstrumentSnapshot> (InstrumentParams {}))
 {
 }
 
@@ -19,22 +22,23 @@ void TrackerSamplerPlugin::initialise (const te::PluginInitialisationInfo& info)
 {
     outputSampleRate = info.sampleRate;
     scratchBuffer.setSize (2, info.blockSizeSamples);
+    GrainWindows::get();   // build the window tables off the audio thread
 }
 
 void TrackerSamplerPlugin::deinitialise()
 {
-    voice.reset();
-    fadeOutVoice.reset();
+    voicePool.reset();
+    currentLane = 0;
     pendingSampleOffset = -1;
-    pendingSampleOffsetHighBit = 0;
-    hasPendingSampleOffsetHighBit = false;
     directionOverride = -1;
+    pitchFx.reset();
+    fxPitch = 0.0f;
 }
 
 void TrackerSamplerPlugin::setSampleBank (std::shared_ptr<const SampleBank> bank)
 {
-    const juce::SpinLock::ScopedLockType lock (bankLock);
-    sharedBank = std::move (bank);
+    assignedBank.publish (0, std::move (bank));
+    assignedBankSerial.fetch_add (1, std::memory_order_release);
 }
 
 void TrackerSamplerPlugin::playNote (int note, float vel)
@@ -55,53 +59,34 @@ void TrackerSamplerPlugin::stopAllNotes()
 double TrackerSamplerPlugin::getPitchRatio (int midiNote, const SampleBank& bank,
                                              const InstrumentParams& params) const
 {
-    double ratio = bank.sampleRate / outputSampleRate;
-    ratio *= std::pow (2.0, params.tune / 12.0);
-    ratio *= std::pow (2.0, params.finetune / 1200.0);
-    ratio *= std::pow (2.0, (midiNote - 60) / 12.0);
-    // Apply FX pitch offset (slides, arpeggio, vibrato, portamento)
-    float fxPitch = pitchOffset.load (std::memory_order_relaxed);
+    double semitones = params.tune + params.finetune / 100.0 + (midiNote - 60);
+    // Apply FX pitch offset (tune, slides, portamento) for the current control tick
     if (std::abs (fxPitch) > 0.001f)
-        ratio *= std::pow (2.0, static_cast<double> (fxPitch) / 12.0);
-    return ratio;
+        semitones += static_cast<double> (fxPitch);
+    return bank.sampleRate / outputSampleRate * SampleResampler::semitonesToRatio (semitones);
 }
 
-float TrackerSamplerPlugin::interpolateSample (const SampleBank& bank, int channel, double pos) const
+int TrackerSamplerPlugin::samplesUntilBoundary (double pos, double step, double boundary, int maxSamples)
 {
-    if (bank.totalSamples <= 0) return 0.0f;
-
-    int idx0 = static_cast<int> (pos);
-    int idx1 = idx0 + 1;
-    float frac = static_cast<float> (pos - idx0);
-
-    int maxIdx = static_cast<int> (bank.totalSamples) - 1;
-    idx0 = juce::jlimit (0, maxIdx, idx0);
-    idx1 = juce::jlimit (0, maxIdx, idx1);
-
-    int ch = juce::jmin (channel, bank.numChannels - 1);
-
-    return bank.buffer.getSample (ch, idx0) * (1.0f - frac)
-         + bank.buffer.getSample (ch, idx1) * frac;
+    // Forward runs end once pos reaches the boundary, backward runs once it
+    // drops below it. Always at least one sample, so a voice that is already
+    // past its boundary renders one sample and is then handled by the caller.
+    double n = static_cast<double> (maxSamples);
+    if (step > 0.0)
+        n = std::ceil ((boundary - pos) / step);
+    else if (step < 0.0)
+        n = std::floor ((pos - boundary) / -step) + 1.0;
+
+    return static_cast<int> (juce::jlimit (1.0, static_cast<double> (maxSamples), n));
 }
 
-float TrackerSamplerPlugin::getGranularEnvelope (const InstrumentParams& params, int pos, int length) const
+void TrackerSamplerPlugin::renderSpan (Voice& v, juce::AudioBuffer<float>& buffer, int startSample,
+                                        int numSamples, const SampleBank& bank,
+                                        const InstrumentParams& params, double step, const float* gains)
 {
-    if (length <= 0) return 0.0f;
-    float t = static_cast<float> (pos) / static_cast<float> (length);
-
-    switch (params.granularShape)
-    {
-        case InstrumentParams::GranShape::Square:
-            return 1.0f;
-        case InstrumentParams::GranShape::Triangle:
-            return (t < 0.5f) ? (t * 2.0f) : (2.0f - t * 2.0f);
-        case InstrumentParams::GranShape::Gauss:
-        {
-            float x = (t - 0.5f) * 4.0f;
-            return std::exp (-x * x);
-        }
-    }
-    return 1.0f;
+    SampleResampler::render (bank, params.interpolation, v.playbackPos, step,
+                             buffer, startSample, numSamples, v.velocity, gains);
+    v.playbackPos += step * numSamples;
 }
 
 //==============================================================================
@@ -110,17 +95,17 @@ float TrackerSamplerPlugin::getGranularEnvelope (const InstrumentParams& params,
 
 void TrackerSamplerPlugin::triggerNote (Voice& v, int note, float vel,
                                          std::shared_ptr<const SampleBank> bank,
-                                         const InstrumentParams& params)
+                                         InstrumentSnapshotPtr snapshot)
 {
-    if (bank == nullptr || bank->totalSamples <= 0)
+    if (bank == nullptr || bank->totalSamples <= 0 || snapshot == nullptr)
     {
         v.reset();
         return;
     }
 
-    v.reset();
+    // v comes cleared (and tagged with its lane) from SamplerVoicePool::startVoice
     v.bank = std::move (bank);
-    v.params = params;
+    v.snapshot = std::move (snapshot);
     v.state = Voice::State::Playing;
     v.midiNote = note;
     v.velocity = vel;
@@ -128,7 +113,7 @@ void TrackerSamplerPlugin::triggerNote (Voice& v, int note, float vel,
     v.inLoopPhase = false;
 
     const auto& bankRef = *v.bank;
-    const auto& paramsRef = v.params;
+    const auto& paramsRef = v.snapshot->params;
 
     double totalSmp = static_cast<double> (bankRef.totalSamples);
     double regionStart = paramsRef.startPos * totalSmp;
@@ -145,9 +130,9 @@ void TrackerSamplerPlugin::triggerNote (Voice& v, int note, float vel,
 
         if (playMode == InstrumentParams::PlayMode::Slice && ! paramsRef.slicePoints.empty())
         {
-            auto boundaries = SamplePlaybackLayout::getSliceBoundariesNorm (paramsRef);
+            const auto& boundaries = v.snapshot->sliceBoundariesNorm;
 
-            int numSlices = static_cast<int> (boundaries.size()) - 1;
+            int numSlices = v.snapshot->getNumSliceRegions();
             sliceIndex = juce::jlimit (0, numSlices - 1, sliceIndex);
 
             v.sliceStart = boundaries[static_cast<size_t> (sliceIndex)] * totalSmp;
@@ -200,11 +185,23 @@ void TrackerSamplerPlugin::triggerNote (Voice& v, int note, float vel,
         double grainCenter = SamplePlaybackLayout::getGranularCenterNorm (paramsRef) * totalSmp;
         v.grainStart = juce::jmax (regionStart, grainCenter - grainLenSamples / 2.0);
         v.grainEnd = juce::jmin (regionEnd, v.grainStart + grainLenSamples);
-        v.grainLength = static_cast<int> (v.grainEnd - v.grainStart);
-        v.grainPos = 0;
         const bool defaultForward = (paramsRef.granularLoop != InstrumentParams::GranLoop::Reverse);
         const bool useForward = directionOverride >= 0 ? directionOverride == 1 : defaultForward;
-        v.playbackPos = useForward ? v.grainStart : juce::jmax (v.grainStart, v.grainEnd - 1.0);
+
+        GranularCloud::Settings cloud;
+        cloud.regionStart = regionStart;
+        cloud.regionEnd = regionEnd;
+        cloud.grainStart = v.grainStart;
+        cloud.grainEnd = v.grainEnd;
+        cloud.grainLength = static_cast<int> (v.grainEnd - v.grainStart);
+        cloud.density = paramsRef.granularDensity;
+        cloud.spray = paramsRef.granularSpray / 100.0;
+        cloud.pitchSprayCents = static_cast<double> (paramsRef.granularPitch);
+        cloud.shape = paramsRef.granularShape;
+        cloud.loop = paramsRef.granularLoop;
+
+        v.granular.start (cloud, useForward, v.startOrder * 2654435761u + static_cast<uint32_t> (note));
+        v.playbackPos = v.granular.getNewestPosition();
         v.playingForward = useForward;
         return;
     }
@@ -238,28 +235,16 @@ void TrackerSamplerPlugin::renderOneShot (Voice& v, juce::AudioBuffer<float>& bu
     double regionStart = params.startPos * totalSmp;
     double regionEnd = params.endPos * totalSmp;
     double advance = v.playingForward ? pitchRatio : -pitchRatio;
-    int numCh = buffer.getNumChannels();
+    double boundary = v.playingForward ? regionEnd : regionStart;
 
-    for (int i = 0; i < numSamples; ++i)
+    for (int done = 0; done < numSamples && v.state == Voice::State::Playing;)
     {
-        if (v.state != Voice::State::Playing) break;
-
-        for (int ch = 0; ch < numCh; ++ch)
-            buffer.addSample (ch, startSample + i,
-                              interpolateSample (bank, ch, v.playbackPos) * v.velocity);
-
-        v.playbackPos += advance;
+        const int n = samplesUntilBoundary (v.playbackPos, advance, boundary, numSamples - done);
+        renderSpan (v, buffer, startSample + done, n, bank, params, advance);
+        done += n;
 
-        if (! v.playingForward)
-        {
-            if (v.playbackPos < regionStart)
-                v.state = Voice::State::Idle;
-        }
-        else
-        {
-            if (v.playbackPos >= regionEnd)
-                v.state = Voice::State::Idle;
-        }
+        if (v.playingForward ? v.playbackPos >= regionEnd : v.playbackPos < regionStart)
+            v.state = Voice::State::Idle;
     }
 }
 
@@ -285,42 +270,38 @@ void TrackerSamplerPlugin::renderForwardLoop (Voice& v, juce::AudioBuffer<float>
         return loopStartPos + wrapped;
     };
 
-    int numCh = buffer.getNumChannels();
-
-    for (int i = 0; i < numSamples; ++i)
+    // Reverse command while in pre-loop attack: enter loop phase immediately.
+    if (! v.inLoopPhase && ! v.playingForward)
     {
-        if (v.state != Voice::State::Playing) break;
+        v.inLoopPhase = true;
+        if (v.playbackPos < loopStartPos)
+            v.playbackPos = loopStartPos;
+    }
 
-        for (int ch = 0; ch < numCh; ++ch)
-            buffer.addSample (ch, startSample + i,
-                              interpolateSample (bank, ch, v.playbackPos) * v.velocity);
+    for (int done = 0; done < numSamples && v.state == Voice::State::Playing;)
+    {
+        const double advance = v.playingForward ? pitchRatio : -pitchRatio;
 
-        bool advancedInAttack = false;
         if (! v.inLoopPhase)
         {
             // Forward attack before loop start.
-            if (v.playingForward)
-            {
-                v.playbackPos += pitchRatio;
-                advancedInAttack = true;
-                if (v.playbackPos >= loopStartPos)
-                {
-                    v.inLoopPhase = true;
-                    v.playbackPos = wrapLoopPosition (v.playbackPos);
-                }
-            }
-            else
+            const int n = samplesUntilBoundary (v.playbackPos, advance, loopStartPos, numSamples - done);
+            renderSpan (v, buffer, startSample + done, n, bank, params, advance);
+            done += n;
+
+            if (v.playbackPos >= loopStartPos)
             {
-                // Reverse command while in pre-loop attack: enter loop phase immediately.
                 v.inLoopPhase = true;
-                if (v.playbackPos < loopStartPos)
-                    v.playbackPos = loopStartPos;
+                v.playbackPos = wrapLoopPosition (v.playbackPos);
             }
         }
-
-        if (v.inLoopPhase && ! advancedInAttack)
+        else
         {
-            v.playbackPos += v.playingForward ? pitchRatio : -pitchRatio;
+            const double boundary = v.playingForward ? loopEndPos : loopStartPos;
+            const int n = samplesUntilBoundary (v.playbackPos, advance, boundary, numSamples - done);
+            renderSpan (v, buffer, startSample + done, n, bank, params, advance);
+            done += n;
+
             v.playbackPos = wrapLoopPosition (v.playbackPos);
         }
     }
@@ -348,20 +329,15 @@ void TrackerSamplerPlugin::renderBackwardLoop (Voice& v, juce::AudioBuffer<float
         return loopStartPos + wrapped;
     };
 
-    int numCh = buffer.getNumChannels();
-
-    for (int i = 0; i < numSamples; ++i)
+    for (int done = 0; done < numSamples && v.state == Voice::State::Playing;)
     {
-        if (v.state != Voice::State::Playing) break;
-
-        for (int ch = 0; ch < numCh; ++ch)
-            buffer.addSample (ch, startSample + i,
-                              interpolateSample (bank, ch, v.playbackPos) * v.velocity);
-
         if (! v.inLoopPhase)
         {
             // Attack: play forward to loop start
-            v.playbackPos += pitchRatio;
+            const int n = samplesUntilBoundary (v.playbackPos, pitchRatio, loopStartPos, numSamples - done);
+            renderSpan (v, buffer, startSample + done, n, bank, params, pitchRatio);
+            done += n;
+
             if (v.playbackPos >= loopStartPos)
             {
                 v.inLoopPhase = true;
@@ -370,7 +346,12 @@ void TrackerSamplerPlugin::renderBackwardLoop (Voice& v, juce::AudioBuffer<float
         }
         else
         {
-            v.playbackPos += v.playingForward ? pitchRatio : -pitchRatio;
+            const double advance = v.playingForward ? pitchRatio : -pitchRatio;
+            const double boundary = v.playingForward ? loopEndPos : loopStartPos;
+            const int n = samplesUntilBoundary (v.playbackPos, advance, boundary, numSamples - done);
+            renderSpan (v, buffer, startSample + done, n, bank, params, advance);
+            done += n;
+
             v.playbackPos = wrapLoopPosition (v.playbackPos);
         }
     }
@@ -390,20 +371,15 @@ void TrackerSamplerPlugin::renderPingpongLoop (Voice& v, juce::AudioBuffer<float
     double loopEndPos = regionStart + params.loopEnd * regionLen;
     if (loopEndPos <= loopStartPos) loopEndPos = loopStartPos + 1.0;
 
-    int numCh = buffer.getNumChannels();
-
-    for (int i = 0; i < numSamples; ++i)
+    for (int done = 0; done < numSamples && v.state == Voice::State::Playing;)
     {
-        if (v.state != Voice::State::Playing) break;
-
-        for (int ch = 0; ch < numCh; ++ch)
-            buffer.addSample (ch, startSample + i,
-                              interpolateSample (bank, ch, v.playbackPos) * v.velocity);
-
         if (! v.inLoopPhase)
         {
             // Attack: play forward to loop end (first pass through loop region)
-            v.playbackPos += pitchRatio;
+            const int n = samplesUntilBoundary (v.playbackPos, pitchRatio, loopEndPos, numSamples - done);
+            renderSpan (v, buffer, startSample + done, n, bank, params, pitchRatio);
+            done += n;
+
             if (v.playbackPos >= loopEndPos)
             {
                 v.inLoopPhase = true;
@@ -413,10 +389,11 @@ void TrackerSamplerPlugin::renderPingpongLoop (Voice& v, juce::AudioBuffer<float
         }
         else
         {
-            if (v.playingForward)
-                v.playbackPos += pitchRatio;
-            else
-                v.playbackPos -= pitchRatio;
+            const double advance = v.playingForward ? pitchRatio : -pitchRatio;
+            const double boundary = v.playingForward ? loopEndPos : loopStartPos;
+            const int n = samplesUntilBoundary (v.playbackPos, advance, boundary, numSamples - done);
+            renderSpan (v, buffer, startSample + done, n, bank, params, advance);
+            done += n;
 
             if (v.playbackPos >= loopEndPos)
             {
@@ -437,31 +414,19 @@ void TrackerSamplerPlugin::renderSlice (Voice& v, juce::AudioBuffer<float>& buff
                                          const SampleBank& bank, const InstrumentParams& params)
 {
     // Slices play at original pitch (note selects slice, not pitch)
-    double pitchRatio = bank.sampleRate / outputSampleRate;
-    pitchRatio *= std::pow (2.0, params.tune / 12.0);
-    pitchRatio *= std::pow (2.0, params.finetune / 1200.0);
-
-    int numCh = buffer.getNumChannels();
+    double pitchRatio = bank.sampleRate / outputSampleRate
+                      * SampleResampler::semitonesToRatio (params.tune + params.finetune / 100.0);
+    double advance = v.playingForward ? pitchRatio : -pitchRatio;
+    double boundary = v.playingForward ? v.sliceEnd : v.sliceStart;
 
-    for (int i = 0; i < numSamples; ++i)
+    for (int done = 0; done < numSamples && v.state == Voice::State::Playing;)
     {
-        if (v.state != Voice::State::Playing) break;
-
-        for (int ch = 0; ch < numCh; ++ch)
-            buffer.addSample (ch, startSample + i,
-                              interpolateSample (bank, ch, v.playbackPos) * v.velocity);
+        const int n = samplesUntilBoundary (v.playbackPos, advance, boundary, numSamples - done);
+        renderSpan (v, buffer, startSample + done, n, bank, params, advance);
+        done += n;
 
-        v.playbackPos += v.playingForward ? pitchRatio : -pitchRatio;
-
-        if (v.playingForward)
-        {
-            if (v.playbackPos >= v.sliceEnd)
-                v.state = Voice::State::Idle;
-        }
-        else if (v.playbackPos < v.sliceStart)
-        {
+        if (v.playingForward ? v.playbackPos >= v.sliceEnd : v.playbackPos < v.sliceStart)
             v.state = Voice::State::Idle;
-        }
     }
 }
 
@@ -469,59 +434,23 @@ void TrackerSamplerPlugin::renderGranular (Voice& v, juce::AudioBuffer<float>& b
                                             int startSample, int numSamples,
                                             const SampleBank& bank, const InstrumentParams& params)
 {
-    double pitchRatio = getPitchRatio (v.midiNote, bank, params);
-    int numCh = buffer.getNumChannels();
-
-    for (int i = 0; i < numSamples; ++i)
-    {
-        if (v.state != Voice::State::Playing) break;
-
-        float env = getGranularEnvelope (params, v.grainPos, v.grainLength);
-
-        for (int ch = 0; ch < numCh; ++ch)
-            buffer.addSample (ch, startSample + i,
-                              interpolateSample (bank, ch, v.playbackPos) * v.velocity * env);
+    v.granular.render (bank, params.interpolation, getPitchRatio (v.midiNote, bank, params), v.velocity,
+                       buffer, startSample, numSamples, v.playingForward);
 
-        if (v.playingForward)
-            v.playbackPos += pitchRatio;
-        else
-            v.playbackPos -= pitchRatio;
-
-        v.grainPos++;
-
-        if (v.grainPos >= v.grainLength)
-        {
-            v.grainPos = 0;
-
-            switch (params.granularLoop)
-            {
-                case InstrumentParams::GranLoop::Forward:
-                    v.playbackPos = v.grainStart;
-                    v.playingForward = true;
-                    break;
-                case InstrumentParams::GranLoop::Reverse:
-                    v.playbackPos = v.grainEnd - 1.0;
-                    v.playingForward = false;
-                    break;
-                case InstrumentParams::GranLoop::Pingpong:
-                    v.playingForward = ! v.playingForward;
-                    if (v.playingForward)
-                        v.playbackPos = v.grainStart;
-                    else
-                        v.playbackPos = v.grainEnd - 1.0;
-                    break;
-            }
-        }
-    }
+    // Cursor and streaming hint follow the latest grain
+    const double newestPos = v.granular.getNewestPosition();
+    if (newestPos >= 0.0)
+        v.playbackPos = newestPos;
 }
 
 void TrackerSamplerPlugin::applyPositionCommandToVoice (Voice& v, int positionByte)
 {
-    if (v.state != Voice::State::Playing || v.bank == nullptr || v.bank->totalSamples <= 0)
+    if (v.state != Voice::State::Playing || v.bank == nullptr || v.bank->totalSamples <= 0
+        || v.snapshot == nullptr)
         return;
 
     const auto& bank = *v.bank;
-    const auto& params = v.params;
+    const auto& params = v.snapshot->params;
 
     double totalSmp = static_cast<double> (bank.totalSamples);
     double regionStart = params.startPos * totalSmp;
@@ -546,6 +475,9 @@ void TrackerSamplerPlugin::applyPositionCommandToVoice (Voice& v, int positionBy
     const double frac = static_cast<double> (juce::jlimit (0, 255, positionByte)) / 255.0;
     const double regionLen = juce::jmax (1.0, regionEnd - regionStart - 1.0);
     v.playbackPos = regionStart + frac * regionLen;
+
+    if (params.playMode == InstrumentParams::PlayMode::Granular)
+        v.granular.setNewestPosition (v.playbackPos);
 }
 
 //==============================================================================
@@ -555,11 +487,12 @@ void TrackerSamplerPlugin::applyPositionCommandToVoice (Voice& v, int positionBy
 void TrackerSamplerPlugin::renderVoice (Voice& v, juce::AudioBuffer<float>& buffer,
                                          int startSample, int numSamples)
 {
-    if (v.state != Voice::State::Playing || v.bank == nullptr || v.bank->totalSamples <= 0)
+    if (v.state != Voice::State::Playing || v.bank == nullptr || v.bank->totalSamples <= 0
+        || v.snapshot == nullptr)
         return;
 
     const auto& bank = *v.bank;
-    const auto& params = v.params;
+    const auto& params = v.snapshot->params;
 
     auto mode = params.playMode;
 
@@ -581,6 +514,43 @@ void TrackerSamplerPlugin::renderVoice (Voice& v, juce::AudioBuffer<float>& buff
         case InstrumentParams::PlayMode::BeatSlice:     renderSlice (v, buffer, startSample, numSamples, bank, params); break;
         case InstrumentParams::PlayMode::Granular:      renderGranular (v, buffer, startSample, numSamples, bank, params); break;
     }
+
+    // Lets the streaming thread page in what this voice plays next
+    bank.notePlayPosition (static_cast<juce::int64> (v.playbackPos));
+}
+
+void TrackerSamplerPlugin::renderFadingVoice (Voice& v, juce::AudioBuffer<float>& buffer,
+                                               int startSample, int numSamples)
+{
+    int fadeSamples = juce::jmin (numSamples, v.fadeOutRemaining);
+
+    // Render to the scratch buffer, then mix in with a gain ramp. The gain
+    // follows the samples left in the fade, so it doesn't depend on how the
+    // fade is split across blocks.
+    int scratchCh = scratchBuffer.getNumChannels();
+    int scratchSmp = scratchBuffer.getNumSamples();
+    if (fadeSamples > 0 && scratchCh >= buffer.getNumChannels() && scratchSmp >= fadeSamples)
+    {
+        scratchBuffer.clear (0, fadeSamples);
+
+        v.state = Voice::State::Playing;
+        renderVoice (v, scratchBuffer, 0, fadeSamples);
+        v.state = Voice::State::FadingOut;
+
+        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+        {
+            const float* src = scratchBuffer.getReadPointer (ch);
+            float* dst = buffer.getWritePointer (ch, startSample);
+
+            for (int i = 0; i < fadeSamples; ++i)
+                dst[i] += src[i] * static_cast<float> (v.fadeOutRemaining - i)
+                                 / static_cast<float> (Voice::kFadeOutSamples);
+        }
+    }
+
+    v.fadeOutRemaining -= fadeSamples;
+    if (v.fadeOutRemaining <= 0)
+        v.state = Voice::State::Idle;
 }
 
 //==============================================================================
@@ -595,259 +565,224 @@ void TrackerSamplerPlugin::applyToBuffer (const te::PluginRenderContext& fc)
     int startSample = fc.bufferStartSample;
     int numSamples = fc.bufferNumSamples;
 
-    // Get current selected bank (thread-safe shared_ptr copy).
-    // Active voices keep their own bank snapshots, so missing this lock doesn't
-    // break already-playing notes.
-    std::shared_ptr<const SampleBank> currentBank;
+    // Pick up a bank and instrument assigned by the message thread since the
+    // last block. Active voices keep their own bank references, so swapping
+    // it here never affects already-playing notes.
+    const auto bankSerial = assignedBankSerial.load (std::memory_order_acquire);
+    if (bankSerial != seenBankSerial)
     {
-        const juce::SpinLock::ScopedTryLockType lock (bankLock);
-        if (lock.isLocked())
-            currentBank = sharedBank;
+        seenBankSerial = bankSerial;
+        currentBank = assignedBank.acquire (0);
+
+        const int assigned = assignedInstrument.load (std::memory_order_relaxed);
+        if (assigned >= 0)
+        {
+            instrumentIndex = assigned;
+            currentBankMsb = (assigned >> 7) & 0x7F;
+        }
     }
 
     // Clear output region (synth, additive rendering)
     buffer.clear (startSample, numSamples);
 
-    auto getCurrentInstrumentParams = [this]()
+    // Pointer load + ref-count bump only: no lock, no InstrumentParams copy
+    auto getCurrentInstrumentSnapshot = [this]()
     {
         if (samplerSource != nullptr && instrumentIndex >= 0)
-            return samplerSource->getParams (instrumentIndex);
-        return InstrumentParams {};
+            return samplerSource->getParamsSnapshot (instrumentIndex);
+        return fallbackSnapshot;
     };
 
-    auto decodeControllerByte = [this] (int controllerValue)
+    // Lane-independent settings from the message thread
+    voicePool.setPolyphony (requestedPolyphony.load (std::memory_order_relaxed));
+    voicePool.setStealing (requestedStealing.load (std::memory_order_relaxed));
+
+    auto startNote = [this, &getCurrentInstrumentSnapshot] (int note, float velocity, bool fromPattern)
     {
-        const int lowBits = controllerValue & 0x7F;
-        const int decoded = hasPendingSampleOffsetHighBit
-                                ? ((pendingSampleOffsetHighBit << 7) | lowBits)
-                                : lowBits;
-        hasPendingSampleOffsetHighBit = false;
-        return decoded;
+        if (currentBank == nullptr || currentBank->totalSamples <= 0)
+            return;
+
+        auto& v = voicePool.startVoice (currentLane);
+        triggerNote (v, note, velocity, currentBank, getCurrentInstrumentSnapshot());
+
+        // Every note of the row (one per lane) starts from the Pxx position
+        if (fromPattern && pendingSampleOffset >= 0)
+            applyPositionCommandToVoice (v, pendingSampleOffset);
     };
 
     // --- Handle stop request before new note (avoids stopping a just-triggered note) ---
     if (previewStop.exchange (false))
-    {
-        if (voice.state == Voice::State::Playing)
-        {
-            fadeOutVoice = voice;
-            fadeOutVoice.state = Voice::State::FadingOut;
-            fadeOutVoice.fadeOutRemaining = Voice::kFadeOutSamples;
-            voice.state = Voice::State::Idle;
-        }
-    }
+        voicePool.releaseAll();
 
     // --- Handle preview notes from message thread ---
     int pNote = previewNote.exchange (-1);
     if (pNote >= 0)
     {
-        float pVel = previewVelocity.load();
-
-        if (voice.state == Voice::State::Playing)
-        {
-            fadeOutVoice = voice;
-            fadeOutVoice.state = Voice::State::FadingOut;
-            fadeOutVoice.fadeOutRemaining = Voice::kFadeOutSamples;
-        }
+        currentLane = 0;
+        startNote (pNote, previewVelocity.load(), false);
+    }
 
-        if (currentBank != nullptr && currentBank->totalSamples > 0)
-        {
-            auto params = getCurrentInstrumentParams();
-            triggerNote (voice, pNote, pVel, currentBank, params);
-            voiceTriggeredByPreview = true;
-        }
+    if (fc.bufferForMidiMessages != nullptr && fc.bufferForMidiMessages->isAllNotesOff)
+    {
+        voicePool.releaseAll();   // graceful fade (same as noteOff)
+        pitchFx.releaseAll();
     }
 
-    // --- Process MIDI messages ---
-    if (fc.bufferForMidiMessages != nullptr)
+    auto& voices = voicePool.getVoices();
+
+    auto handleMessage = [&] (const juce::MidiMessage& m)
     {
-        if (fc.bufferForMidiMessages->isAllNotesOff)
-        {
-            // Graceful fade (same as noteOff)
-            if (voice.state == Voice::State::Playing)
-            {
-                fadeOutVoice = voice;
-                fadeOutVoice.state = Voice::State::FadingOut;
-                fadeOutVoice.fadeOutRemaining = Voice::kFadeOutSamples;
-                voice.state = Voice::State::Idle;
-            }
-        }
+        pitchFx.handleMidi (m);
 
-        for (auto& m : *fc.bufferForMidiMessages)
+        if (m.isProgramChange())
         {
-            if (m.isProgramChange())
-            {
-                // Switch to a preloaded bank for multi-instrument support
-                int progNum = m.getProgramChangeNumber();
-                const int instrument = InstrumentRouting::decodeInstrumentFromBankAndProgram (currentBankMsb, progNum);
-                const juce::SpinLock::ScopedLockType lock (bankLock);
-                auto it = preloadedBanks.find (instrument);
-                if (it != preloadedBanks.end() && it->second != nullptr)
-                {
-                    sharedBank = it->second;
-                    currentBank = sharedBank;
-                    instrumentIndex = instrument;
-                }
-                else
-                {
-                    // Legacy fallback: older sessions that only used 7-bit program numbers.
-                    auto legacyIt = preloadedBanks.find (progNum);
-                    if (legacyIt != preloadedBanks.end() && legacyIt->second != nullptr)
-                    {
-                        sharedBank = legacyIt->second;
-                        currentBank = sharedBank;
-                        instrumentIndex = progNum;
-                    }
-                }
-            }
-            else if (m.isController())
+            // Switch to a preloaded bank for multi-instrument support
+            int progNum = m.getProgramChangeNumber();
+            const int instrument = InstrumentRouting::decodeInstrumentFromBankAndProgram (currentBankMsb, progNum);
+            if (auto bank = preloadedBanks.acquire (instrument))
             {
-                if (m.getControllerNumber() == 0) // Bank Select MSB
-                {
-                    currentBankMsb = m.getControllerValue() & 0x7F;
-                    hasPendingSampleOffsetHighBit = false;
-                }
-                else if (m.getControllerNumber() == FxParamTransport::kParamHighBitCc)
-                {
-                    pendingSampleOffsetHighBit = m.getControllerValue() & 0x1;
-                    hasPendingSampleOffsetHighBit = true;
-                }
-                // B (direction) and P (position) modify independent voice state:
-                // B sets voice.playingForward, P sets voice.playbackPos via
-                // applyPositionCommandToVoice() which computes an absolute position
-                // (regionStart + frac * regionLen) without referencing direction.
-                // This means slot order does not affect the final result when both
-                // B and P appear in the same tracker step.  On a note-trigger row
-                // both CCs arrive before the note-on, so triggerNote() sees the
-                // directionOverride and pendingSampleOffset is applied afterwards.
-                else if (m.getControllerNumber() == 37) // Bxx direction
-                {
-                    const int value = decodeControllerByte (m.getControllerValue());
-                    directionOverride = (value == 0) ? 0 : 1;
-                    if (voice.state == Voice::State::Playing)
-                        voice.playingForward = (directionOverride == 1);
-                }
-                else if (m.getControllerNumber() == 38) // Pxx
-                {
-                    pendingSampleOffset = decodeControllerByte (m.getControllerValue());
-                    if (voice.state == Voice::State::Playing)
-                        applyPositionCommandToVoice (voice, pendingSampleOffset);
-                }
-                else if (m.getControllerNumber() == 39) // note-row reset
-                {
-                    directionOverride = -1;
-                    pendingSampleOffset = -1;
-                    hasPendingSampleOffsetHighBit = false;
-                    if (voice.state == Voice::State::Playing)
-                        voice.playingForward = ! voice.params.reversed;
-                }
-                else
-                {
-                    hasPendingSampleOffsetHighBit = false;
-                }
-            }
-            else if (m.isNoteOn())
-            {
-                if (voice.state == Voice::State::Playing)
-                {
-                    fadeOutVoice = voice;
-                    fadeOutVoice.state = Voice::State::FadingOut;
-                    fadeOutVoice.fadeOutRemaining = Voice::kFadeOutSamples;
-                }
-
-                if (currentBank != nullptr && currentBank->totalSamples > 0)
-                {
-                    auto params = getCurrentInstrumentParams();
-
-                    triggerNote (voice, m.getNoteNumber(),
-                                 m.getVelocity() / 127.0f, currentBank, params);
-                    voiceTriggeredByPreview = false;
-
-                    if (pendingSampleOffset >= 0)
-                    {
-                        applyPositionCommandToVoice (voice, pendingSampleOffset);
-                        pendingSampleOffset = -1;
-                    }
-                }
+                currentBank = std::move (bank);
+                instrumentIndex = instrument;
             }
-            else if (m.isNoteOff())
+            else if (auto legacyBank = preloadedBanks.acquire (progNum))
             {
-                // Graceful fade-out with crossfade
-                if (voice.state == Voice::State::Playing)
-                {
-                    fadeOutVoice = voice;
-                    fadeOutVoice.state = Voice::State::FadingOut;
-                    fadeOutVoice.fadeOutRemaining = Voice::kFadeOutSamples;
-                    voice.state = Voice::State::Idle;
-                }
-            }
-            else if (m.isAllNotesOff())
-            {
-                // Graceful fade (OFF) — same as noteOff
-                if (voice.state == Voice::State::Playing)
-                {
-                    fadeOutVoice = voice;
-                    fadeOutVoice.state = Voice::State::FadingOut;
-                    fadeOutVoice.fadeOutRemaining = Voice::kFadeOutSamples;
-                    voice.state = Voice::State::Idle;
-                }
-            }
-            else if (m.isAllSoundOff())
-            {
-                // Hard cut (KILL) — immediate silence
-                voice.state = Voice::State::Idle;
-                fadeOutVoice.state = Voice::State::Idle;
+                // Legacy fallback: older sessions that only used 7-bit program numbers.
+                currentBank = std::move (legacyBank);
+                instrumentIndex = progNum;
             }
         }
-    }
-
-    // --- Render fade-out voice ---
-    if (fadeOutVoice.state == Voice::State::FadingOut && fadeOutVoice.fadeOutRemaining > 0)
-    {
-        int fadeSamples = juce::jmin (numSamples, fadeOutVoice.fadeOutRemaining);
-        float startGain = static_cast<float> (fadeOutVoice.fadeOutRemaining)
-                        / static_cast<float> (Voice::kFadeOutSamples);
-        float endGain = static_cast<float> (fadeOutVoice.fadeOutRemaining - fadeSamples)
-                      / static_cast<float> (Voice::kFadeOutSamples);
-
-        // Render fade-out to scratch buffer, then apply gain ramp
-        int scratchCh = scratchBuffer.getNumChannels();
-        int scratchSmp = scratchBuffer.getNumSamples();
-        if (scratchCh >= buffer.getNumChannels() && scratchSmp >= fadeSamples)
+        else if (m.isController())
+        {
+            if (m.getControllerNumber() == 0) // Bank Select MSB
+                currentBankMsb = m.getControllerValue() & 0x7F;
+            else if (m.getControllerNumber() == kCcNoteLane)
+                currentLane = m.getControllerValue();
+            else if (m.getControllerNumber() == kCcLaneCut)
+                voicePool.cutLane (m.getControllerValue());
+        }
+        else if (m.isNoteOn())
         {
-            scratchBuffer.clear (0, fadeSamples);
+            startNote (m.getNoteNumber(), m.getVelocity() / 127.0f, true);
+        }
+        else if (m.isNoteOff())
+        {
+            // Graceful fade-out with crossfade
+            voicePool.releaseNote (m.getNoteNumber());
+        }
+        else if (m.isAllNotesOff())
+        {
+            // Graceful fade (OFF) — same as noteOff
+            voicePool.releaseAll();
+        }
+        else if (m.isAllSoundOff())
+        {
+            // Hard cut (KILL) — immediate silence
+            voicePool.cutAll();
+        }
+    };
 
-            fadeOutVoice.state = Voice::State::Playing;
-            renderVoice (fadeOutVoice, scratchBuffer, 0, fadeSamples);
-            fadeOutVoice.state = Voice::State::FadingOut;
+    // B (direction) and P (position) modify independent voice state:
+    // B sets playingForward, P sets playbackPos via
+    // applyPositionCommandToVoice() which computes an absolute position
+    // (regionStart + frac * regionLen) without referencing direction.
+    // This means slot order does not affect the final result when both
+    // B and P appear in the same tracker step.  FX events go ahead of the
+    // row's note-ons, so triggerNote() sees the directionOverride and
+    // pendingSampleOffset is applied afterwards.
+    // The FX column is shared by the lanes, so both act on every voice.
+    auto handleTrackerEvent = [&] (const TrackerEvent& e)
+    {
+        pitchFx.handleEvent (e);
 
-            for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
-            {
-                const float* src = scratchBuffer.getReadPointer (ch);
-                float* dst = buffer.getWritePointer (ch, startSample);
-
-                for (int i = 0; i < fadeSamples; ++i)
-                {
-                    float t = (fadeSamples > 1)
-                        ? static_cast<float> (i) / static_cast<float> (fadeSamples - 1)
-                        : 0.0f;
-                    dst[i] += src[i] * (startGain + (endGain - startGain) * t);
-                }
-            }
+        switch (e.command)
+        {
+            case TrackerEvent::Command::RowReset:
+                directionOverride = -1;
+                pendingSampleOffset = -1;
+                for (auto& v : voices)
+                    if (v.isPlaying() && v.snapshot != nullptr)
+                        v.playingForward = ! v.snapshot->params.reversed;
+                break;
+
+            case TrackerEvent::Command::Direction:
+                directionOverride = (e.param == 0) ? 0 : 1;
+                for (auto& v : voices)
+                    if (v.isPlaying())
+                        v.playingForward = (directionOverride == 1);
+                break;
+
+            case TrackerEvent::Command::Position:
+                pendingSampleOffset = e.param;
+                for (auto& v : voices)
+                    applyPositionCommandToVoice (v, pendingSampleOffset);
+                break;
+
+            default:
+                break;
         }
+    };
 
-        fadeOutVoice.fadeOutRemaining -= fadeSamples;
-        if (fadeOutVoice.fadeOutRemaining <= 0)
-            fadeOutVoice.state = Voice::State::Idle;
+    // --- Walk the block on the control-rate grid: pitch commands step at
+    // each tick, pattern FX and MIDI events apply at their own sample ---
+    const auto blockStart = static_cast<juce::int64> (std::llround (fc.editTime.getStart().inSeconds() * outputSampleRate));
+    // The pattern's FX, or a cued pattern's from the loop wrap on
+    std::shared_ptr<const TrackerEventList> events;
+    if (fc.isPlaying)
+    {
+        bool tookCue = false;
+        events = trackerEventsCue.select (trackerEvents, blockStart, numSamples, tookCue);
+    }
+    else
+    {
+        trackerEventsCue.reset();
     }
 
-    // --- Render main voice ---
-    renderVoice (voice, buffer, startSample, numSamples);
+    const auto blockEvents = events != nullptr
+                                 ? events->getRange (blockStart, numSamples, outputSampleRate)
+                                 : TrackerEventList::Range {};
+    const double bpm = edit.tempoSequence.getTempos()[0]->getBpm();
+    const double rowsPerTick = static_cast<double> (juce::jmax (1, rowsPerBeat)) * bpm / 60.0
+                             * ControlRate::kInterval / outputSampleRate;
 
-    // Publish playback position for UI cursor
-    if (voice.state == Voice::State::Playing && voice.bank != nullptr && voice.bank->totalSamples > 0)
-        playbackPosNorm.store (static_cast<float> (voice.playbackPos / static_cast<double> (voice.bank->totalSamples)),
+    ControlRate::process (blockStart, numSamples, outputSampleRate, blockEvents, fc.bufferForMidiMessages,
+        [&] (int)
+        {
+            pitchFx.advance (rowsPerTick);
+            fxPitch = pitchFx.getPitchOffset();
+        },
+        [&] (const TrackerEvent& e)
+        {
+            handleTrackerEvent (e);
+            fxPitch = pitchFx.getPitchOffset();
+        },
+        [&] (const juce::MidiMessage& m)
+        {
+            handleMessage (m);
+            fxPitch = pitchFx.getPitchOffset();
+        },
+        [&] (int offset, int n)
+        {
+            // --- Mix every active voice into the segment ---
+            for (auto& v : voices)
+            {
+                if (v.isFadingOut())
+                    renderFadingVoice (v, buffer, startSample + offset, n);
+                else
+                    renderVoice (v, buffer, startSample + offset, n);
+            }
+        });
+
+    // Publish playback position for UI cursor (the most recent note)
+    const auto* newest = voicePool.getNewestPlaying();
+    if (newest != nullptr && newest->bank != nullptr && newest->bank->totalSamples > 0)
+        playbackPosNorm.store (static_cast<float> (newest->playbackPos / static_cast<double> (newest->bank->totalSamples)),
                                std::memory_order_relaxed);
     else
         playbackPosNorm.store (-1.0f, std::memory_order_relaxed);
+
+    // Fused track: effects, strip and output run on the block while it is
+    // still in cache, and their own nodes pass it through
+    if (const auto chain = fusedChain.acquire (0); chain != nullptr && chain->isReady())
+        for (auto* stage : chain->stages)
+            stage->processInChain (fc);
 }
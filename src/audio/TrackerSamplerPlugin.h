@@ -5,21 +5,21 @@
 #include <JuceHeader.h>
 #include <tracktion_engine/tracktion_engine.h>
 #include "InstrumentParams.h"
+#include "AtomicSharedPtrTable.h"
+#include "FusedTrackChain.h"
+#include "InstrumentRouting.h"
+#include "InstrumentSnapshot.h"
+#include "LoopCue.h"
+#include "PatternNotes.h"
+#include "SampleBank.h"
+#include "SamplerVoicePool.h"
+#include "TrackerEvent.h"
+#include "TrackerPitchFx.h"
 
 namespace te = tracktion;
 
 class SimpleSampler;
 
-// Holds the entire sample data in memory for lock-free audio thread access
-struct SampleBank
-{
-    juce::AudioBuffer<float> buffer;
-    double sampleRate = 44100.0;
-    int numChannels = 1;
-    juce::int64 totalSamples = 0;
-    juce::File sourceFile;
-};
-
 class TrackerSamplerPlugin : public te::Plugin
 {
 public:
@@ -49,123 +49,127 @@ public:
     void setSamplerSource (SimpleSampler* s) { samplerSource = s; }
     void setInstrumentIndex (int index)
     {
-        instrumentIndex = juce::jlimit (0, 255, index);
-        currentBankMsb = (instrumentIndex >> 7) & 0x7F;
+        assignedInstrument.store (juce::jlimit (0, 255, index), std::memory_order_relaxed);
+        assignedBankSerial.fetch_add (1, std::memory_order_release);
     }
-    void setPitchOffset (float semitones) { pitchOffset.store (semitones, std::memory_order_relaxed); }
+    void setRowsPerBeat (int rpb) { rowsPerBeat = rpb; }
 
-    // Pre-load multiple banks for multi-instrument per track
+    // Pre-load multiple banks for multi-instrument per track. Only the slots
+    // whose bank changed are swapped.
     void preloadBanks (const std::map<int, std::shared_ptr<const SampleBank>>& banks)
     {
-        const juce::SpinLock::ScopedLockType lock (bankLock);
-        preloadedBanks = banks;
+        preloadedBanks.assign (banks);
     }
 
     // Update a single bank in the preloaded set (e.g. after reloading a sample)
     void updateBank (int instrument, std::shared_ptr<const SampleBank> bank)
     {
-        const juce::SpinLock::ScopedLockType lock (bankLock);
-        if (bank != nullptr)
-            preloadedBanks[instrument] = std::move (bank);
-        else
-            preloadedBanks.erase (instrument);
+        preloadedBanks.publish (instrument, std::move (bank));
+    }
+
+    // Pattern FX of the track, compiled alongside its MIDI clip
+    void setTrackerEvents (std::shared_ptr<const TrackerEventList> events)
+    {
+        trackerEvents.publish (LoopCueFollower<TrackerEventList>::kCurrentSlot, std::move (events));
+    }
+
+    // FX of a cued pattern, taking over at the next loop wrap (nullptr withdraws it)
+    void setCuedTrackerEvents (std::shared_ptr<const TrackerEventList> events)
+    {
+        trackerEvents.publish (LoopCueFollower<TrackerEventList>::kCuedSlot, std::move (events));
+    }
+
+    // Built-in stages to run straight after the voices (nullptr = plain plugin chain)
+    void setFusedChain (std::shared_ptr<const FusedTrackChain> chain)
+    {
+        fusedChain.publish (0, std::move (chain));
     }
 
     // Preview support (called from message thread, consumed on audio thread)
     void playNote (int note, float velocity);
     void stopAllNotes();
 
+    // Polyphony shared by the track's note lanes and what happens when it runs out
+    void setVoiceLimits (int polyphony, SamplerVoicePool::Stealing stealing)
+    {
+        requestedPolyphony.store (polyphony, std::memory_order_relaxed);
+        requestedStealing.store (stealing, std::memory_order_relaxed);
+    }
+
     // Playback position for UI cursor (normalized 0-1, -1 = idle)
     float getPlaybackPosition() const { return playbackPosNorm.load (std::memory_order_relaxed); }
 
+    // Multi-lane tracks send the lane ahead of each note-on, and in kill mode
+    // cut a single lane rather than every voice.
+    static constexpr int kCcNoteLane = PatternNotes::kCcNoteLane;
+    static constexpr int kCcLaneCut = PatternNotes::kCcLaneCut;
+
 private:
-    // Monophonic voice for tracker-style playback
-    struct Voice
-    {
-        enum class State { Idle, Playing, FadingOut };
-        State state = State::Idle;
-
-        std::shared_ptr<const SampleBank> bank;
-        InstrumentParams params;
-
-        double playbackPos = 0.0;
-        int midiNote = 60;
-        float velocity = 1.0f;
-
-        int fadeOutRemaining = 0;
-        static constexpr int kFadeOutSamples = 64;
-
-        bool playingForward = true;
-        bool inLoopPhase = false;
-
-        // Slice mode boundaries (in samples)
-        double sliceStart = 0.0;
-        double sliceEnd = 0.0;
-
-        // Granular mode state
-        double grainStart = 0.0;
-        double grainEnd = 0.0;
-        int grainPos = 0;
-        int grainLength = 0;
-
-        void reset()
-        {
-            state = State::Idle;
-            bank.reset();
-            params = {};
-            playbackPos = 0.0;
-            midiNote = 60;
-            velocity = 1.0f;
-            fadeOutRemaining = 0;
-            playingForward = true;
-            inLoopPhase = false;
-            sliceStart = sliceEnd = 0.0;
-            grainStart = grainEnd = 0.0;
-            grainPos = grainLength = 0;
-        }
-    };
-
-    Voice voice;
-    Voice fadeOutVoice;
-
-    // Thread-safe sample bank access
-    juce::SpinLock bankLock;
-    std::shared_ptr<const SampleBank> sharedBank;
-
-    // Pre-loaded banks for multi-instrument per track (instrument index → bank)
-    std::map<int, std::shared_ptr<const SampleBank>> preloadedBanks;
-
-    // Params access (same pattern as InstrumentEffectsPlugin)
+    using Voice = SamplerVoice;
+
+    // Every note lane of the track plays through this pool
+    SamplerVoicePool voicePool;
+    int currentLane = 0;
+
+    // Bank and instrument set directly by the message thread (previews,
+    // single-instrument tracks). The serial tells the audio thread to pick
+    // up new ones.
+    AtomicSharedPtrTable<SampleBank, 1> assignedBank;
+    std::atomic<int> assignedInstrument { -1 };
+    std::atomic<uint32_t> assignedBankSerial { 0 };
+    uint32_t seenBankSerial = 0;
+
+    // Pre-loaded banks for multi-instrument per track (instrument index → bank).
+    // Program changes are an atomic load + ref-count bump: no lock, no lookup.
+    AtomicSharedPtrTable<SampleBank, InstrumentRouting::kMaxInstrument + 1> preloadedBanks;
+
+    LoopCueFollower<TrackerEventList>::Table trackerEvents;
+    LoopCueFollower<TrackerEventList> trackerEventsCue;
+    AtomicSharedPtrTable<FusedTrackChain, 1> fusedChain;
+
+    // Bank selected for new notes (audio thread only)
+    std::shared_ptr<const SampleBank> currentBank;
+
+    // Params access (same pattern as InstrumentEffectsPlugin). The current
+    // instrument follows program changes (audio thread only).
     SimpleSampler* samplerSource = nullptr;
     int instrumentIndex = -1;
 
+    // Used when no sampler source is attached (kept here so the audio thread
+    // never constructs params itself)
+    const InstrumentSnapshotPtr fallbackSnapshot;
+
     // Preview atomics (message thread writes, audio thread reads)
     std::atomic<int> previewNote { -1 };
     std::atomic<float> previewVelocity { 0.0f };
     std::atomic<bool> previewStop { false };
 
-    // FX pitch offset (set by InstrumentEffectsPlugin for slides/arpeggio/etc.)
-    std::atomic<float> pitchOffset { 0.0f };
+    std::atomic<int> requestedPolyphony { SamplerVoicePool::kDefaultPolyphony };
+    std::atomic<SamplerVoicePool::Stealing> requestedStealing { SamplerVoicePool::Stealing::Oldest };
+
+    // Pitch commands (Txx, Sxy/Dxy, Gxx), stepped on the control-rate grid.
+    // fxPitch is their offset for the current tick (audio thread only).
+    TrackerPitchFx pitchFx;
+    float fxPitch = 0.0f;
+    int rowsPerBeat = 4;
 
-    // Sample offset from 9xx effect (set via CC#9, consumed on next note-on)
+    // Sample offset from Pxx, applied to every note-on of the row
     int pendingSampleOffset = -1;
-    int pendingSampleOffsetHighBit = 0;
-    bool hasPendingSampleOffsetHighBit = false;
-    int currentBankMsb = 0;
+    int currentBankMsb = 0;     // audio thread only, like instrumentIndex
     int directionOverride = -1; // -1 = instrument default, 0 = backward, 1 = forward
 
     // Audio thread state
     double outputSampleRate = 44100.0;
     juce::AudioBuffer<float> scratchBuffer;
-    bool voiceTriggeredByPreview = false;
 
     // Playback position for UI cursor (normalized 0-1, -1 = idle)
     std::atomic<float> playbackPosNorm { -1.0f };
 
     // Rendering
     void triggerNote (Voice& v, int note, float vel,
-                      std::shared_ptr<const SampleBank> bank, const InstrumentParams& params);
+                      std::shared_ptr<const SampleBank> bank, InstrumentSnapshotPtr snapshot);
     void renderVoice (Voice& v, juce::AudioBuffer<float>& buffer, int startSample, int numSamples);
+    void renderFadingVoice (Voice& v, juce::AudioBuffer<float>& buffer, int startSample, int numSamples);
 
     void renderOneShot (Voice& v, juce::AudioBuffer<float>& buffer, int startSample, int numSamples,
                         const SampleBank& bank, const InstrumentParams& params);
@@ -182,8 +186,13 @@ private:
     void applyPositionCommandToVoice (Voice& v, int positionByte);
 
     double getPitchRatio (int midiNote, const SampleBank& bank, const InstrumentParams& params) const;
-    float interpolateSample (const SampleBank& bank, int channel, double pos) const;
-    float getGranularEnvelope (const InstrumentParams& params, int pos, int length) const;
+
+    // Block rendering: each mode splits its loop into constant-step runs that
+    // end at the next loop/slice boundary and hands them to SampleResampler.
+    static int samplesUntilBoundary (double pos, double step, double boundary, int maxSamples);
+    void renderSpan (Voice& v, juce::AudioBuffer<float>& buffer, int startSample, int numSamples,
+                     const SampleBank& bank, const InstrumentParams& params, double step,
+                     const float* gains = nullptr);
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TrackerSamplerPlugin)
 };
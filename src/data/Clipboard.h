@@ -1,8 +1,9 @@
 #pragma once
 
 #include "PatternData.h"
-#include <vector>
 #include <array>
+#include <limits>
+#include <vector>
 
 struct ClipboardData
 {
@@ -53,35 +54,21 @@ inline ClipboardData& getClipboard()
 // Undo actions
 //==============================================================================
 
-class CellEditAction : public juce::UndoableAction
-{
-public:
-    CellEditAction (PatternData& data, int patternIndex, int row, int track, const Cell& newCell)
-        : patternData (data), patIdx (patternIndex), r (row), t (track), newValue (newCell)
-    {
-        oldValue = patternData.getPattern (patIdx).getCell (r, t);
-    }
-
-    bool perform() override
-    {
-        if (patIdx < patternData.getNumPatterns())
-            patternData.getPattern (patIdx).setCell (r, t, newValue);
-        return true;
-    }
-
-    bool undo() override
-    {
-        if (patIdx < patternData.getNumPatterns())
-            patternData.getPattern (patIdx).setCell (r, t, oldValue);
-        return true;
-    }
-
-private:
-    PatternData& patternData;
-    int patIdx, r, t;
-    Cell oldValue, newValue;
-};
-
+/**
+ * An undoable edit of any number of cells (and master lane FX slots) in one
+ * pattern.
+ *
+ * The first perform() writes the new cells, then keeps only the pattern
+ * chunks the edit touched, as they were before and after, and drops the cell
+ * records. Undo and redo swap those chunks back in, so a step holds the
+ * chunks it changed (shared with the pattern and with neighbouring steps)
+ * rather than two copies of every cell. Should a chunk have changed since
+ * (an edit made without the undo manager), only the rows the step changed
+ * are written back, cell by cell.
+ *
+ * getSizeInUnits() is in bytes, so the UndoManager's unit limit is a memory
+ * cap on the history.
+ */
 class MultiCellEditAction : public juce::UndoableAction
 {
 public:
@@ -103,18 +90,18 @@ public:
         if (patIdx >= 0 && patIdx < patternData.getNumPatterns())
         {
             auto& pat = patternData.getPattern (patIdx);
-            for (auto& c : cells)
-            {
-                if (c.row >= 0 && c.row < pat.numRows && c.track >= 0 && c.track < kNumTracks)
-                    pat.setCell (c.row, c.track, c.newCell);
-            }
+            if (! performed)
+                performFirstTime (pat);
+            else
+                for (auto& c : chunks)
+                    restore (pat, c, c.before, c.after);
 
             for (auto& m : masterFx)
             {
                 if (m.row < 0 || m.row >= pat.numRows || m.lane < 0)
                     continue;
                 pat.ensureMasterFxSlots (m.lane + 1);
-                pat.getMasterFxSlot (m.row, m.lane) = m.newSlot;
+                pat.setMasterFxSlot (m.row, m.lane, m.newSlot);
             }
         }
         return true;
@@ -125,26 +112,106 @@ public:
         if (patIdx >= 0 && patIdx < patternData.getNumPatterns())
         {
             auto& pat = patternData.getPattern (patIdx);
-            for (auto& c : cells)
-            {
-                if (c.row >= 0 && c.row < pat.numRows && c.track >= 0 && c.track < kNumTracks)
-                    pat.setCell (c.row, c.track, c.oldCell);
-            }
+            for (auto& c : chunks)
+                restore (pat, c, c.after, c.before);
 
             for (auto& m : masterFx)
             {
                 if (m.row < 0 || m.row >= pat.numRows || m.lane < 0)
                     continue;
                 pat.ensureMasterFxSlots (m.lane + 1);
-                pat.getMasterFxSlot (m.row, m.lane) = m.oldSlot;
+                pat.setMasterFxSlot (m.row, m.lane, m.oldSlot);
             }
         }
         return true;
     }
 
+    int getSizeInUnits() override
+    {
+        // The after chunks live on in the pattern or the next step; the
+        // before chunks are what this step keeps alive
+        size_t bytes = sizeof (*this) + cells.capacity() * sizeof (CellRecord)
+                     + masterFx.capacity() * sizeof (MasterFxRecord) + chunks.capacity() * sizeof (ChunkRecord);
+        for (const auto& c : chunks)
+            if (c.before != nullptr && c.before != PatternChunk::getEmpty())
+                bytes += c.before->getStorageBytes();
+        return static_cast<int> (juce::jmin (bytes, static_cast<size_t> (std::numeric_limits<int>::max())));
+    }
+
 private:
+    struct ChunkRecord
+    {
+        int track = 0;
+        int chunkIndex = 0;
+        std::shared_ptr<const PatternChunk> before, after;
+    };
+
     PatternData& patternData;
     int patIdx;
     std::vector<CellRecord> cells;
     std::vector<MasterFxRecord> masterFx;
+    std::vector<ChunkRecord> chunks;
+    bool performed = false;
+
+    void performFirstTime (Pattern& pat)
+    {
+        const int numChunks = (pat.numRows + kChunkRows - 1) / kChunkRows;
+        std::vector<bool> recorded (static_cast<size_t> (numChunks * kNumTracks), false);
+
+        for (const auto& c : cells)
+        {
+            if (c.row < 0 || c.row >= pat.numRows || c.track < 0 || c.track >= kNumTracks)
+                continue;
+
+            const int chunkIndex = c.row / kChunkRows;
+            if (! recorded[static_cast<size_t> (chunkIndex * kNumTracks + c.track)])
+            {
+                recorded[static_cast<size_t> (chunkIndex * kNumTracks + c.track)] = true;
+                chunks.push_back ({ c.track, chunkIndex, pat.getChunk (c.track, chunkIndex), nullptr });
+            }
+
+            pat.setCell (c.row, c.track, c.newCell);
+        }
+
+        for (auto& c : chunks)
+            c.after = pat.getChunk (c.track, c.chunkIndex);
+
+        cells.clear();
+        cells.shrink_to_fit();
+        chunks.shrink_to_fit();
+        performed = true;
+    }
+
+    static void restore (Pattern& pat, const ChunkRecord& c,
+                         const std::shared_ptr<const PatternChunk>& from,
+                         const std::shared_ptr<const PatternChunk>& to)
+    {
+        if (from == nullptr || to == nullptr)
+            return;
+
+        if (pat.getChunk (c.track, c.chunkIndex) == from)
+        {
+            pat.setChunk (c.track, c.chunkIndex, to);
+            return;
+        }
+
+        // Changed behind the undo manager's back: only put back the rows this step changed
+        for (int r = 0; r < kChunkRows; ++r)
+        {
+            const int row = c.chunkIndex * kChunkRows + r;
+            if (row < pat.numRows && ! from->sameRow (*to, r))
+                pat.setCell (row, c.track, CellView (*to, r).toCell());
+        }
+    }
+};
+
+/** An undoable edit of one cell. */
+class CellEditAction : public MultiCellEditAction
+{
+public:
+    CellEditAction (PatternData& data, int patternIndex, int row, int track, const Cell& newCell)
+        : MultiCellEditAction (data, patternIndex,
+                               { { row, track, data.getPattern (patternIndex).getCell (row, track), newCell } })
+    {
+    }
 };
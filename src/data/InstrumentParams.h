@@ -36,6 +36,10 @@ struct InstrumentParams
 
     bool reversed = false;
 
+    // Resampling kernel used when playing the sample back at another pitch/rate
+    enum class Interpolation { Linear, Hermite, Sinc };
+    Interpolation interpolation = Interpolation::Linear;
+
     // === Granular params ===
     double granularPosition = 0.0; // absolute normalized sample position (0.0-1.0)
     int    granularLength   = 500; // 1-1000 ms
@@ -43,6 +47,9 @@ struct InstrumentParams
     GranShape granularShape = GranShape::Triangle;
     enum class GranLoop { Forward, Reverse, Pingpong };
     GranLoop granularLoop = GranLoop::Forward;
+    int    granularDensity  = 1;   // 1-16 overlapping grains
+    int    granularSpray    = 0;   // 0-100 % of the region, random grain start scatter
+    int    granularPitch    = 0;   // 0-1200 cents, random detune per grain
 
     // === Slice data ===
     std::vector<double> slicePoints; // absolute normalized sample positions, sorted
@@ -112,10 +119,14 @@ struct InstrumentParams
             return false;
         if (playMode != PlayMode::OneShot || reversed)
             return false;
+        if (interpolation != Interpolation::Linear)
+            return false;
         if (granularPosition != 0.0 || granularLength != 500)
             return false;
         if (granularShape != GranShape::Triangle || granularLoop != GranLoop::Forward)
             return false;
+        if (granularDensity != 1 || granularSpray != 0 || granularPitch != 0)
+            return false;
         if (! slicePoints.empty())
             return false;
         for (auto& mod : modulations)
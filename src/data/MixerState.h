@@ -130,6 +130,7 @@ struct MasterMixState
     // Limiter
     double limiterThreshold = 0.0;  // dB, -24 to 0 (0 = off)
     double limiterRelease = 50.0;   // ms, 1 to 500
+    double limiterLookahead = 0.0;  // ms, 0 to 5 (0 = off)
 
     bool isDefault() const
     {
@@ -138,7 +139,8 @@ struct MasterMixState
             && eqMidFreq == 1000.0
             && compThreshold == 0.0 && compRatio == 1.0
             && compAttack == 10.0 && compRelease == 100.0
-            && limiterThreshold == 0.0 && limiterRelease == 50.0;
+            && limiterThreshold == 0.0 && limiterRelease == 50.0
+            && limiterLookahead == 0.0;
     }
 };
 
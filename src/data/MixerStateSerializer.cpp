@@ -157,6 +157,7 @@ void save (juce::ValueTree& root, const MixerState& mixerState)
         masterTree.setProperty ("compRelease", mixerState.master.compRelease, nullptr);
         masterTree.setProperty ("limiterThresh", mixerState.master.limiterThreshold, nullptr);
         masterTree.setProperty ("limiterRelease", mixerState.master.limiterRelease, nullptr);
+        masterTree.setProperty ("limiterLookahead", mixerState.master.limiterLookahead, nullptr);
         root.addChild (masterTree, -1, nullptr);
     }
 
@@ -331,6 +332,7 @@ void load (const juce::ValueTree& root, MixerState& mixerState)
         mixerState.master.compRelease    = masterTree.getProperty ("compRelease", 100.0);
         mixerState.master.limiterThreshold = masterTree.getProperty ("limiterThresh", 0.0);
         mixerState.master.limiterRelease = masterTree.getProperty ("limiterRelease", 50.0);
+        mixerState.master.limiterLookahead = masterTree.getProperty ("limiterLookahead", 0.0);
     }
 
     // Master insert plugin slots (V9+)
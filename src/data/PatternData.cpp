@@ -1,4 +1,125 @@
 #include "PatternData.h"
+#include <algorithm>
+#include <atomic>
+
+namespace
+{
+juce::uint64 nextPatternRevision()
+{
+    static std::atomic<juce::uint64> counter { 0 };
+    return counter.fetch_add (1, std::memory_order_relaxed) + 1;
+}
+} // namespace
+
+//==============================================================================
+// Packed cells
+//==============================================================================
+
+PatternChunk::Note PatternChunk::pack (const NoteSlot& slot) noexcept
+{
+    Note packed;
+    if (slot.note >= 0)
+    {
+        packed.note = static_cast<uint8_t> (juce::jmin (255, slot.note));
+        packed.flags |= Note::hasNote;
+    }
+    if (slot.instrument >= 0)
+    {
+        packed.instrument = static_cast<uint8_t> (juce::jmin (255, slot.instrument));
+        packed.flags |= Note::hasInstrument;
+    }
+    if (slot.volume >= 0)
+    {
+        packed.volume = static_cast<uint8_t> (juce::jmin (255, slot.volume));
+        packed.flags |= Note::hasVolume;
+    }
+    return packed;
+}
+
+PatternChunk::Fx PatternChunk::pack (const FxSlot& slot) noexcept
+{
+    return { slot.fxCommand, static_cast<uint8_t> (juce::jlimit (0, 255, slot.fxParam)) };
+}
+
+const std::shared_ptr<const PatternChunk>& PatternChunk::getEmpty()
+{
+    static const std::shared_ptr<const PatternChunk> empty = std::make_shared<PatternChunk>();
+    return empty;
+}
+
+bool PatternChunk::isRowEmpty (int row) const noexcept
+{
+    for (auto index = static_cast<size_t> (row); index < notes.size(); index += kChunkRows)
+        if (! notes[index].isEmpty())
+            return false;
+    for (auto index = static_cast<size_t> (row); index < fx.size(); index += kChunkRows)
+        if (! fx[index].isEmpty())
+            return false;
+    return true;
+}
+
+bool PatternChunk::sameRow (const PatternChunk& other, int row) const noexcept
+{
+    const auto r = static_cast<size_t> (row);
+    if (numNoteLanes[r] != other.numNoteLanes[r] || numFxSlots[r] != other.numFxSlots[r])
+        return false;
+
+    for (int lane = 0; lane < kMaxNoteLanes; ++lane)
+        if (! (getNote (lane, row) == other.getNote (lane, row)))
+            return false;
+    for (int lane = 0; lane < kMaxFxLanes; ++lane)
+        if (! (getFx (lane, row) == other.getFx (lane, row)))
+            return false;
+    return true;
+}
+
+void PatternChunk::setRow (int row, const Cell& cell)
+{
+    const auto r = static_cast<size_t> (row);
+    numNoteLanes[r] = static_cast<uint8_t> (juce::jlimit (1, kMaxNoteLanes, cell.getNumNoteLanes()));
+    numFxSlots[r] = static_cast<uint8_t> (juce::jlimit (0, kMaxFxLanes, cell.getNumFxSlots()));
+
+    // Every stored lane is written (lanes past the cell's count as empty); a
+    // lane's plane is only added for a slot that holds something
+    for (int lane = 0; lane < kMaxNoteLanes; ++lane)
+    {
+        const auto packed = pack (cell.getNoteLane (lane));
+        const auto index = static_cast<size_t> (lane * kChunkRows + row);
+        if (index >= notes.size())
+        {
+            if (packed.isEmpty())
+                continue;
+            notes.resize (static_cast<size_t> ((lane + 1) * kChunkRows));
+        }
+        notes[index] = packed;
+    }
+
+    for (int lane = 0; lane < kMaxFxLanes; ++lane)
+    {
+        const auto packed = pack (cell.getFxSlot (lane));
+        const auto index = static_cast<size_t> (lane * kChunkRows + row);
+        if (index >= fx.size())
+        {
+            if (packed.isEmpty())
+                continue;
+            fx.resize (static_cast<size_t> ((lane + 1) * kChunkRows));
+        }
+        fx[index] = packed;
+    }
+}
+
+Cell CellView::toCell() const
+{
+    Cell cell;
+    for (int lane = 0; lane < getNumNoteLanes(); ++lane)
+        cell.setNoteLane (lane, getNoteLane (lane));
+
+    cell.fxSlots.clear();
+    for (int fxi = 0; fxi < getNumFxSlots(); ++fxi)
+        cell.fxSlots.push_back (getFxSlot (fxi));
+
+    return cell;
+}
 
 //==============================================================================
 // Pattern
@@ -12,40 +133,79 @@ Pattern::Pattern()
 Pattern::Pattern (int rowCount)
     : numRows (rowCount), name ("Pattern")
 {
-    rows.resize (static_cast<size_t> (numRows));
+    growStorage (numRows);
     masterFxRows.resize (static_cast<size_t> (numRows), std::vector<FxSlot> (1));
+    markAllDirty();
 }
 
-Cell& Pattern::getCell (int row, int track)
+void Pattern::growStorage (int rowCount)
 {
-    jassert (row >= 0 && row < numRows);
-    jassert (track >= 0 && track < kNumTracks);
-    return rows[static_cast<size_t> (row)][static_cast<size_t> (track)];
+    if (rowCount <= storedRows)
+        return;
+
+    const int numChunks = (rowCount + kChunkRows - 1) / kChunkRows;
+    for (auto& chunks : tracks)
+        chunks.resize (static_cast<size_t> (numChunks), PatternChunk::getEmpty());
+
+    storedRows = numChunks * kChunkRows;
 }
 
-const Cell& Pattern::getCell (int row, int track) const
+PatternChunk& Pattern::getWritableChunk (int track, int chunkIndex)
 {
-    jassert (row >= 0 && row < numRows);
-    jassert (track >= 0 && track < kNumTracks);
-    return rows[static_cast<size_t> (row)][static_cast<size_t> (track)];
+    auto& chunk = tracks[static_cast<size_t> (track)][static_cast<size_t> (chunkIndex)];
+
+    // Shared with a copy of the pattern, an undo step or a snapshot (or it's
+    // the empty chunk): write to a private copy instead
+    if (chunk.use_count() != 1)
+        chunk = std::make_shared<PatternChunk> (*chunk);
+    else
+        std::atomic_thread_fence (std::memory_order_acquire); // after the last other owner let go
+
+    // Every chunk is made non-const by make_shared and only shared as const
+    return const_cast<PatternChunk&> (*chunk);
+}
+
+Cell Pattern::getCell (int row, int track) const
+{
+    return getCellView (row, track).toCell();
 }
 
 void Pattern::setCell (int row, int track, const Cell& cell)
 {
     jassert (row >= 0 && row < numRows);
     jassert (track >= 0 && track < kNumTracks);
-    rows[static_cast<size_t> (row)][static_cast<size_t> (track)] = cell;
+    getWritableChunk (track, row / kChunkRows).setRow (row % kChunkRows, cell);
+    markTrackDirty (track);
+}
+
+std::shared_ptr<const PatternChunk> Pattern::getChunk (int track, int chunkIndex) const
+{
+    if (track < 0 || track >= kNumTracks || chunkIndex < 0
+        || chunkIndex >= static_cast<int> (tracks[static_cast<size_t> (track)].size()))
+        return nullptr;
+    return tracks[static_cast<size_t> (track)][static_cast<size_t> (chunkIndex)];
+}
+
+void Pattern::setChunk (int track, int chunkIndex, std::shared_ptr<const PatternChunk> chunk)
+{
+    if (chunk == nullptr || track < 0 || track >= kNumTracks || chunkIndex < 0
+        || chunkIndex >= static_cast<int> (tracks[static_cast<size_t> (track)].size()))
+        return;
+
+    tracks[static_cast<size_t> (track)][static_cast<size_t> (chunkIndex)] = std::move (chunk);
+    markTrackDirty (track);
 }
 
 void Pattern::clear()
 {
-    for (auto& row : rows)
-        for (auto& cell : row)
-            cell.clear();
+    for (auto& chunks : tracks)
+        std::fill (chunks.begin(), chunks.end(), PatternChunk::getEmpty());
 
     for (auto& mfxRow : masterFxRows)
         for (auto& slot : mfxRow)
             slot.clear();
+
+    markAllDirty();
 }
 
 void Pattern::resize (int newNumRows)
@@ -53,16 +213,8 @@ void Pattern::resize (int newNumRows)
     int oldNumRows = numRows;
     numRows = juce::jlimit (1, 256, newNumRows);
 
-    // Only grow the vector, never shrink it — preserves data from trimmed rows
-    if (static_cast<int> (rows.size()) < numRows)
-    {
-        int oldSize = static_cast<int> (rows.size());
-        rows.resize (static_cast<size_t> (numRows));
-
-        // Initialize any newly created rows (beyond what was ever allocated)
-        for (int i = oldSize; i < numRows; ++i)
-            rows[static_cast<size_t> (i)] = std::array<Cell, kNumTracks> {};
-    }
+    // Only grow the storage, never shrink it — preserves data from trimmed rows
+    growStorage (numRows);
 
     // Grow master FX rows to match
     if (static_cast<int> (masterFxRows.size()) < numRows)
@@ -71,9 +223,29 @@ void Pattern::resize (int newNumRows)
         masterFxRows.resize (static_cast<size_t> (numRows), std::vector<FxSlot> (static_cast<size_t> (laneCount)));
     }
 
-    // When shrinking, numRows decreases but rows.size() stays the same.
+    // When shrinking, numRows decreases but the stored rows stay the same.
     // Old data is preserved and will reappear if the pattern is expanded again.
-    juce::ignoreUnused (oldNumRows);
+    if (numRows != oldNumRows)
+        markAllDirty();
+}
+
+size_t Pattern::getCellStorageBytes() const
+{
+    size_t bytes = sizeof (tracks);
+    std::vector<const PatternChunk*> chunks;
+    for (const auto& trackChunks : tracks)
+    {
+        bytes += trackChunks.capacity() * sizeof (trackChunks[0]);
+        for (const auto& chunk : trackChunks)
+            if (chunk != PatternChunk::getEmpty())
+                chunks.push_back (chunk.get());
+    }
+
+    std::sort (chunks.begin(), chunks.end());
+    chunks.erase (std::unique (chunks.begin(), chunks.end()), chunks.end());
+    for (const auto* chunk : chunks)
+        bytes += chunk->getStorageBytes();
+    return bytes;
 }
 
 FxSlot& Pattern::getMasterFxSlot (int row, int lane)
@@ -102,6 +274,15 @@ const FxSlot& Pattern::getMasterFxSlot (int row, int lane) const
     return mfxRow[static_cast<size_t> (lane)];
 }
 
+void Pattern::setMasterFxSlot (int row, int lane, const FxSlot& slot)
+{
+    if (row < 0 || row >= static_cast<int> (masterFxRows.size()) || lane < 0)
+        return;
+
+    getMasterFxSlot (row, lane) = slot;
+    markMasterDirty();
+}
+
 void Pattern::ensureMasterFxSlots (int laneCount)
 {
     for (auto& mfxRow : masterFxRows)
@@ -109,6 +290,31 @@ void Pattern::ensureMasterFxSlots (int laneCount)
             mfxRow.push_back ({});
 }
 
+juce::uint64 Pattern::getTrackRevision (int track) const
+{
+    if (track < 0 || track >= kNumTracks)
+        return 0;
+    return trackRevisions[static_cast<size_t> (track)];
+}
+
+void Pattern::markTrackDirty (int track)
+{
+    if (track >= 0 && track < kNumTracks)
+        trackRevisions[static_cast<size_t> (track)] = nextPatternRevision();
+}
+
+void Pattern::markMasterDirty()
+{
+    masterRevision = nextPatternRevision();
+}
+
+void Pattern::markAllDirty()
+{
+    for (int t = 0; t < kNumTracks; ++t)
+        markTrackDirty (t);
+    markMasterDirty();
+}
+
 //==============================================================================
 // PatternData
 //==============================================================================
@@ -183,12 +389,7 @@ void PatternData::removePattern (int index)
     }
 }
 
-Cell& PatternData::getCell (int row, int track)
-{
-    return getCurrentPattern().getCell (row, track);
-}
-
-const Cell& PatternData::getCell (int row, int track) const
+Cell PatternData::getCell (int row, int track) const
 {
     return getCurrentPattern().getCell (row, track);
 }
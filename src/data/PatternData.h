@@ -2,6 +2,9 @@
 
 #include <JuceHeader.h>
 #include <array>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
 #include <vector>
 #include "PluginAutomationData.h"
 
@@ -115,13 +118,60 @@ struct FxSlot
     }
 };
 
+//==============================================================================
+// Lane limits and inline slot storage
+//==============================================================================
+
+// Most lanes a track can show (TrackLayout clamps to these)
+constexpr int kMaxNoteLanes = 8;
+constexpr int kMaxFxLanes = 8;
+
+/**
+ * A vector-like array of up to Capacity slots held inline, so a Cell never
+ * touches the heap. Pushing past the capacity is a bug and is dropped.
+ */
+template <typename T, int Capacity>
+class InlineSlots
+{
+public:
+    size_t size() const noexcept { return count; }
+    bool empty() const noexcept { return count == 0; }
+    static constexpr size_t capacity() noexcept { return static_cast<size_t> (Capacity); }
+
+    T& operator[] (size_t index) noexcept { jassert (index < count); return items[index]; }
+    const T& operator[] (size_t index) const noexcept { jassert (index < count); return items[index]; }
+
+    T* begin() noexcept { return items.data(); }
+    T* end() noexcept { return items.data() + count; }
+    const T* begin() const noexcept { return items.data(); }
+    const T* end() const noexcept { return items.data() + count; }
+
+    void push_back (const T& item) noexcept
+    {
+        jassert (count < capacity());
+        if (count < capacity())
+            items[count++] = item;
+    }
+
+    void clear() noexcept
+    {
+        for (size_t i = 0; i < count; ++i)
+            items[i] = T {};
+        count = 0;
+    }
+
+private:
+    std::array<T, static_cast<size_t> (Capacity)> items {};
+    size_t count = 0;
+};
+
 struct Cell
 {
     int note = -1;        // MIDI note (-1 = empty, 0-127 = note)
     int instrument = -1;  // Instrument/sample index (-1 = none)
     int volume = -1;      // Volume (-1 = default, 0-127)
-    std::vector<NoteSlot> extraNoteLanes; // Additional note lanes (lane 1+)
-    std::vector<FxSlot> fxSlots; // At least 1 slot always present
+    InlineSlots<NoteSlot, kMaxNoteLanes - 1> extraNoteLanes; // Additional note lanes (lane 1+)
+    InlineSlots<FxSlot, kMaxFxLanes> fxSlots; // At least 1 slot always present
 
     Cell() { fxSlots.push_back ({}); }
 
@@ -146,6 +196,11 @@ struct Cell
             return;
         }
         int idx = laneIndex - 1;
+        if (idx < 0 || laneIndex >= kMaxNoteLanes)
+        {
+            jassertfalse;
+            return;
+        }
         while (static_cast<int> (extraNoteLanes.size()) <= idx)
             extraNoteLanes.push_back ({});
         extraNoteLanes[static_cast<size_t> (idx)] = slot;
@@ -155,6 +210,7 @@ struct Cell
 
     void ensureNoteLanes (int count)
     {
+        count = juce::jmin (count, kMaxNoteLanes);
         if (count > 1)
         {
             while (static_cast<int> (extraNoteLanes.size()) < count - 1)
@@ -165,6 +221,13 @@ struct Cell
     // Access a specific FX lane
     FxSlot& getFxSlot (int index)
     {
+        if (index < 0 || index >= kMaxFxLanes)
+        {
+            jassertfalse;
+            static FxSlot dummy;
+            dummy.clear();
+            return dummy;
+        }
         while (static_cast<int> (fxSlots.size()) <= index)
             fxSlots.push_back ({});
         return fxSlots[static_cast<size_t> (index)];
@@ -181,6 +244,7 @@ struct Cell
 
     void ensureFxSlots (int count)
     {
+        count = juce::jmin (count, kMaxFxLanes);
         while (static_cast<int> (fxSlots.size()) < count)
             fxSlots.push_back ({});
     }
@@ -209,10 +273,141 @@ struct Cell
     }
 };
 
+//==============================================================================
+// Packed pattern storage
+//==============================================================================
+
+constexpr int kChunkRows = 16;
+
+/**
+ * kChunkRows rows of one track, packed: per row lane counts, then each note
+ * lane and FX lane as a plane of byte-packed slots, lane-major. Lanes past
+ * the last one holding anything aren't stored, so a plain one-lane chunk is a
+ * few bytes a row and scanning a lane reads contiguous memory.
+ *
+ * Patterns hold chunks by shared pointer and only ever write to one nothing
+ * else holds (copy-on-write), so a copied pattern, an undo step or an engine
+ * snapshot shares every chunk that hasn't changed since.
+ */
+struct PatternChunk
+{
+    struct Note
+    {
+        enum : uint8_t { hasNote = 1, hasInstrument = 2, hasVolume = 4 };
+
+        uint8_t note = 0, instrument = 0, volume = 0;
+        uint8_t flags = 0;
+
+        bool isEmpty() const noexcept { return flags == 0; }
+        bool operator== (const Note&) const = default;
+    };
+
+    struct Fx
+    {
+        char command = '\0';
+        uint8_t param = 0;
+
+        bool isEmpty() const noexcept { return command == '\0' && param == 0; }
+        bool operator== (const Fx&) const = default;
+    };
+
+    std::array<uint8_t, kChunkRows> numNoteLanes;   // per row, as the Cell had them
+    std::array<uint8_t, kChunkRows> numFxSlots;
+    std::vector<Note> notes;   // notes[lane * kChunkRows + row]
+    std::vector<Fx> fx;        // fx[lane * kChunkRows + row]
+
+    PatternChunk() noexcept
+    {
+        numNoteLanes.fill (1);
+        numFxSlots.fill (1);
+    }
+
+    Note getNote (int lane, int row) const noexcept
+    {
+        const auto index = static_cast<size_t> (lane * kChunkRows + row);
+        return index < notes.size() ? notes[index] : Note {};
+    }
+
+    Fx getFx (int lane, int row) const noexcept
+    {
+        const auto index = static_cast<size_t> (lane * kChunkRows + row);
+        return index < fx.size() ? fx[index] : Fx {};
+    }
+
+    bool isRowEmpty (int row) const noexcept;
+    bool sameRow (const PatternChunk& other, int row) const noexcept;
+    void setRow (int row, const Cell& cell);
+
+    size_t getStorageBytes() const noexcept
+    {
+        return sizeof (PatternChunk) + notes.capacity() * sizeof (Note) + fx.capacity() * sizeof (Fx);
+    }
+
+    /** The chunk every empty stretch of a pattern shares. */
+    static const std::shared_ptr<const PatternChunk>& getEmpty();
+
+    static Note pack (const NoteSlot& slot) noexcept;
+    static Fx pack (const FxSlot& slot) noexcept;
+
+    static NoteSlot unpack (Note slot) noexcept
+    {
+        return { (slot.flags & Note::hasNote) != 0 ? static_cast<int> (slot.note) : -1,
+                 (slot.flags & Note::hasInstrument) != 0 ? static_cast<int> (slot.instrument) : -1,
+                 (slot.flags & Note::hasVolume) != 0 ? static_cast<int> (slot.volume) : -1 };
+    }
+
+    static FxSlot unpack (Fx slot) noexcept
+    {
+        FxSlot unpacked;
+        unpacked.fxCommand = slot.command;
+        unpacked.fx = slot.command != '\0' ? fxLetterToCommand (slot.command) : 0;
+        unpacked.fxParam = slot.param;
+        return unpacked;
+    }
+};
+
+/**
+ * A read-only view of one packed cell with Cell's read accessors. Cheap to
+ * make and to pass by value; valid until the pattern is next modified. Scans
+ * that only read a few fields use this rather than unpacking whole Cells.
+ */
+class CellView
+{
+public:
+    CellView (const PatternChunk& chunk, int rowInChunk) noexcept
+        : chunk (&chunk), row (rowInChunk) {}
+
+    NoteSlot getNoteLane (int laneIndex) const
+    {
+        if (laneIndex < 0 || laneIndex >= kMaxNoteLanes)
+            return {};
+        return PatternChunk::unpack (chunk->getNote (laneIndex, row));
+    }
+
+    int getNumNoteLanes() const { return chunk->numNoteLanes[static_cast<size_t> (row)]; }
+
+    FxSlot getFxSlot (int index) const
+    {
+        if (index < 0 || index >= kMaxFxLanes)
+            return {};
+        return PatternChunk::unpack (chunk->getFx (index, row));
+    }
+
+    int getNumFxSlots() const { return chunk->numFxSlots[static_cast<size_t> (row)]; }
+
+    bool isEmpty() const { return chunk->isRowEmpty (row); }
+    bool hasNote() const { return getNoteLane (0).hasNote(); }
+
+    Cell toCell() const;
+
+private:
+    const PatternChunk* chunk;
+    int row;
+};
+
 struct Pattern
 {
     int numRows = 64;
-    std::vector<std::array<Cell, kNumTracks>> rows;
     juce::String name;
 
     // Master lane FX: masterFxRows[row][lane]
@@ -224,16 +419,105 @@ struct Pattern
     Pattern();
     explicit Pattern (int rowCount);
 
-    Cell& getCell (int row, int track);
-    const Cell& getCell (int row, int track) const;
+    // Cells are stored packed: getCell() unpacks a copy and setCell() packs
+    // one back, getCellView() reads in place.
+    Cell getCell (int row, int track) const;
     void setCell (int row, int track, const Cell& cell);
     void clear();
     void resize (int newNumRows);
 
+    CellView getCellView (int row, int track) const
+    {
+        jassert (row >= 0 && row < numRows);
+        jassert (track >= 0 && track < kNumTracks);
+        const auto& chunk = tracks[static_cast<size_t> (track)][static_cast<size_t> (row / kChunkRows)];
+        return { *chunk, row % kChunkRows };
+    }
+
+    // Row-order walks of a track's cells, resolving each chunk once per
+    // kChunkRows rows rather than per cell: fn (row, CellView). An fn that
+    // returns bool stops the walk by returning false. forEachNonEmptyCell()
+    // skips empty rows, and the shared empty chunk without reading it.
+    template <typename Fn>
+    void forEachCell (int track, Fn&& fn) const
+    {
+        walkCells (track, false, fn);
+    }
+
+    template <typename Fn>
+    void forEachNonEmptyCell (int track, Fn&& fn) const
+    {
+        walkCells (track, true, fn);
+    }
+
+    // Whole chunks, for snapshots that share them (undo). setChunk() marks the
+    // track dirty; getChunk() is nullptr past the stored rows.
+    std::shared_ptr<const PatternChunk> getChunk (int track, int chunkIndex) const;
+    void setChunk (int track, int chunkIndex, std::shared_ptr<const PatternChunk> chunk);
+
+    /** Bytes held by the cell storage, rows kept past numRows included. Chunks
+        shared with other patterns or undo steps count here too; the shared
+        empty chunk doesn't. */
+    size_t getCellStorageBytes() const;
+
     // Master lane access
     FxSlot& getMasterFxSlot (int row, int lane);
     const FxSlot& getMasterFxSlot (int row, int lane) const;
+    void setMasterFxSlot (int row, int lane, const FxSlot& slot);
     void ensureMasterFxSlots (int laneCount);
+
+    // Change tracking for incremental Edit sync. Revisions are drawn from a
+    // process-wide counter, so two patterns only share a revision when one is an
+    // unmodified copy of the other. setCell()/setChunk()/setMasterFxSlot()/
+    // clear()/resize() bump revisions; code writing through the non-const
+    // master getter must call markMasterDirty() itself.
+    juce::uint64 getTrackRevision (int track) const;
+    juce::uint64 getMasterRevision() const { return masterRevision; }
+    void markTrackDirty (int track);
+    void markMasterDirty();
+    void markAllDirty();
+
+    std::array<juce::uint64, kNumTracks> trackRevisions {};
+    juce::uint64 masterRevision = 0;
+
+private:
+    std::array<std::vector<std::shared_ptr<const PatternChunk>>, kNumTracks> tracks;
+    int storedRows = 0;   // never shrinks, so trimmed rows come back on regrow
+
+    void growStorage (int rowCount);
+
+    template <typename Fn>
+    void walkCells (int track, bool skipEmpty, Fn& fn) const
+    {
+        jassert (track >= 0 && track < kNumTracks);
+        const auto& chunks = tracks[static_cast<size_t> (track)];
+        const auto* emptyChunk = PatternChunk::getEmpty().get();
+
+        for (int firstRow = 0; firstRow < numRows; firstRow += kChunkRows)
+        {
+            const auto* chunk = chunks[static_cast<size_t> (firstRow / kChunkRows)].get();
+            if (skipEmpty && chunk == emptyChunk)
+                continue;
+
+            const int rowsInChunk = juce::jmin (kChunkRows, numRows - firstRow);
+            for (int r = 0; r < rowsInChunk; ++r)
+            {
+                if (skipEmpty && chunk->isRowEmpty (r))
+                    continue;
+
+                if constexpr (std::is_same_v<std::invoke_result_t<Fn&, int, CellView>, bool>)
+                {
+                    if (! fn (firstRow + r, CellView (*chunk, r)))
+                        return;
+                }
+                else
+                {
+                    fn (firstRow + r, CellView (*chunk, r));
+                }
+            }
+        }
+    }
+    PatternChunk& getWritableChunk (int track, int chunkIndex);
 };
 
 class PatternData
@@ -257,8 +541,7 @@ public:
     void removePattern (int index);
     void clearAllPatterns();
 
-    Cell& getCell (int row, int track);
-    const Cell& getCell (int row, int track) const;
+    Cell getCell (int row, int track) const;
     void setCell (int row, int track, const Cell& cell);
 
 private:
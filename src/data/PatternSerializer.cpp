@@ -11,7 +11,7 @@ juce::ValueTree PatternSerializer::patternToValueTree (const Pattern& pattern, i
         bool hasData = false;
         for (int t = 0; t < kNumTracks; ++t)
         {
-            if (! pattern.getCell (r, t).isEmpty())
+            if (! pattern.getCellView (r, t).isEmpty())
             {
                 hasData = true;
                 break;
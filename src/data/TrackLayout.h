@@ -227,7 +227,7 @@ public:
 
     void setVisualOrder (const std::array<int, kNumTracks>& order) { visualOrder = order; }
 
-    // Per-track note lane count (minimum 1, maximum 8)
+    // Per-track note lane count (minimum 1, maximum kMaxNoteLanes)
     int getTrackNoteLaneCount (int physicalTrack) const
     {
         return trackNoteLaneCounts[static_cast<size_t> (juce::jlimit (0, kNumTracks - 1, physicalTrack))];
@@ -236,13 +236,13 @@ public:
     void setTrackNoteLaneCount (int physicalTrack, int count)
     {
         trackNoteLaneCounts[static_cast<size_t> (juce::jlimit (0, kNumTracks - 1, physicalTrack))]
-            = juce::jlimit (1, 8, count);
+            = juce::jlimit (1, kMaxNoteLanes, count);
     }
 
     void addNoteLane (int physicalTrack)
     {
         auto& c = trackNoteLaneCounts[static_cast<size_t> (juce::jlimit (0, kNumTracks - 1, physicalTrack))];
-        if (c < 8) ++c;
+        if (c < kMaxNoteLanes) ++c;
     }
 
     void removeNoteLane (int physicalTrack)
@@ -253,7 +253,7 @@ public:
 
     const std::array<int, kNumTracks>& getTrackNoteLaneCounts() const { return trackNoteLaneCounts; }
 
-    // Per-track FX lane count (minimum 1)
+    // Per-track FX lane count (minimum 1, maximum kMaxFxLanes)
     int getTrackFxLaneCount (int physicalTrack) const
     {
         return trackFxLaneCounts[static_cast<size_t> (juce::jlimit (0, kNumTracks - 1, physicalTrack))];
@@ -262,13 +262,13 @@ public:
     void setTrackFxLaneCount (int physicalTrack, int count)
     {
         trackFxLaneCounts[static_cast<size_t> (juce::jlimit (0, kNumTracks - 1, physicalTrack))]
-            = juce::jlimit (1, 8, count);
+            = juce::jlimit (1, kMaxFxLanes, count);
     }
 
     void addFxLane (int physicalTrack)
     {
         auto& c = trackFxLaneCounts[static_cast<size_t> (juce::jlimit (0, kNumTracks - 1, physicalTrack))];
-        if (c < 8) ++c;
+        if (c < kMaxFxLanes) ++c;
     }
 
     void removeFxLane (int physicalTrack)
@@ -361,6 +361,9 @@ public:
         return true;
     }
 
+    // In bytes, like the pattern edits (the UndoManager's limit is a memory cap)
+    int getSizeInUnits() override { return static_cast<int> (sizeof (*this)); }
+
 private:
     TrackLayout& layout;
     TrackLayout::Snapshot before;
@@ -30,6 +30,103 @@ AudioPluginSettingsComponent::AudioPluginSettingsComponent (te::Engine& e,
 
     addAndMakeVisible (*audioDeviceSelector);
 
+    // --- Render threading ---
+    renderCpusLabel.setText ("Render CPUs:", juce::dontSendNotification);
+    renderCpusLabel.setFont (lnf.getMonoFont (12.0f));
+    renderCpusLabel.setColour (juce::Label::textColourId, juce::Colour (0xffcccccc));
+    addAndMakeVisible (renderCpusLabel);
+
+    // Item IDs are CPU count + 1 so that "Auto" (0) is a valid ID
+    renderCpusBox.addItem ("Auto", 1);
+    for (int n = 1; n <= juce::SystemStats::getNumCpus(); ++n)
+        renderCpusBox.addItem (juce::String (n), n + 1);
+    renderCpusBox.onChange = [this] { renderThreadingChanged(); };
+    addAndMakeVisible (renderCpusBox);
+
+    threadPoolLabel.setText ("Thread Pool:", juce::dontSendNotification);
+    threadPoolLabel.setFont (lnf.getMonoFont (12.0f));
+    threadPoolLabel.setColour (juce::Label::textColourId, juce::Colour (0xffcccccc));
+    addAndMakeVisible (threadPoolLabel);
+
+    threadPoolBox.onChange = [this] { renderThreadingChanged(); };
+    addAndMakeVisible (threadPoolBox);
+
+    sample16BitToggle.setTooltip ("Keep loaded samples as 16-bit integers (half the memory). Applies to samples loaded afterwards.");
+    sample16BitToggle.setColour (juce::ToggleButton::textColourId, juce::Colour (0xffcccccc));
+    sample16BitToggle.onClick = [this]
+    {
+        if (onSample16BitChanged != nullptr)
+            onSample16BitChanged (sample16BitToggle.getToggleState());
+    };
+    addAndMakeVisible (sample16BitToggle);
+
+    // --- Sampler voices ---
+    voicesLabel.setText ("Voices/Track:", juce::dontSendNotification);
+    voicesLabel.setFont (lnf.getMonoFont (12.0f));
+    voicesLabel.setColour (juce::Label::textColourId, juce::Colour (0xffcccccc));
+    addAndMakeVisible (voicesLabel);
+
+    voicesBox.setTooltip ("Sampler voices shared by a track's note lanes");
+    voicesBox.onChange = [this] { voiceLimitsChanged(); };
+    addAndMakeVisible (voicesBox);
+
+    stealingLabel.setText ("Voice Stealing:", juce::dontSendNotification);
+    stealingLabel.setFont (lnf.getMonoFont (12.0f));
+    stealingLabel.setColour (juce::Label::textColourId, juce::Colour (0xffcccccc));
+    addAndMakeVisible (stealingLabel);
+
+    stealingBox.setTooltip ("Which playing voice is faded out when a track runs out of voices");
+    stealingBox.onChange = [this] { voiceLimitsChanged(); };
+    addAndMakeVisible (stealingBox);
+
+    realtimeSequencingToggle.setTooltip ("Play patterns straight from the pattern data, so edits are heard from the next row "
+                                         "without rebuilding MIDI clips. Renders always use MIDI clips.");
+    realtimeSequencingToggle.setColour (juce::ToggleButton::textColourId, juce::Colour (0xffcccccc));
+    realtimeSequencingToggle.onClick = [this]
+    {
+        if (onRealtimeSequencingChanged != nullptr)
+            onRealtimeSequencingChanged (realtimeSequencingToggle.getToggleState());
+    };
+    addAndMakeVisible (realtimeSequencingToggle);
+
+    // --- Sample memory ---
+    sampleMemoryLabel.setText ("Sample RAM:", juce::dontSendNotification);
+    sampleMemoryLabel.setFont (lnf.getMonoFont (12.0f));
+    sampleMemoryLabel.setColour (juce::Label::textColourId, juce::Colour (0xffcccccc));
+    addAndMakeVisible (sampleMemoryLabel);
+
+    sampleMemoryValueLabel.setFont (lnf.getMonoFont (12.0f));
+    sampleMemoryValueLabel.setColour (juce::Label::textColourId, juce::Colour (0xffcccccc));
+    addAndMakeVisible (sampleMemoryValueLabel);
+
+    sampleMipMapsToggle.setTooltip ("Keep band-limited octave copies of loaded samples so notes transposed up alias less. "
+                                    "Costs up to as much RAM again as the samples, at most 64 MB across all samples. "
+                                    "Applies to samples loaded afterwards.");
+    sampleMipMapsToggle.setColour (juce::ToggleButton::textColourId, juce::Colour (0xffcccccc));
+    sampleMipMapsToggle.onClick = [this]
+    {
+        if (onSampleMipMapsChanged != nullptr)
+            onSampleMipMapsChanged (sampleMipMapsToggle.getToggleState());
+    };
+    addAndMakeVisible (sampleMipMapsToggle);
+
+    // --- Undo history ---
+    undoHistoryLabel.setText ("Undo RAM:", juce::dontSendNotification);
+    undoHistoryLabel.setFont (lnf.getMonoFont (12.0f));
+    undoHistoryLabel.setColour (juce::Label::textColourId, juce::Colour (0xffcccccc));
+    addAndMakeVisible (undoHistoryLabel);
+
+    // Item IDs are the size in megabytes
+    for (int megabytes : { 16, 32, 64, 128, 256, 512 })
+        undoHistoryBox.addItem (juce::String (megabytes) + " MB", megabytes);
+    undoHistoryBox.setTooltip ("Memory the undo history may hold; the oldest steps are dropped beyond it");
+    undoHistoryBox.onChange = [this]
+    {
+        if (onUndoHistoryLimitChanged != nullptr && undoHistoryBox.getSelectedId() > 0)
+            onUndoHistoryLimitChanged (undoHistoryBox.getSelectedId());
+    };
+    addAndMakeVisible (undoHistoryBox);
+
     // --- Plugin section ---
     pluginSectionLabel.setText ("Plugin Settings", juce::dontSendNotification);
     pluginSectionLabel.setFont (lnf.getMonoFont (14.0f));
@@ -132,6 +229,38 @@ void AudioPluginSettingsComponent::resized()
     // Give audio device selector a decent height
     int audioSelectorHeight = juce::jmin (200, r.getHeight() / 3);
     audioDeviceSelector->setBounds (r.removeFromTop (audioSelectorHeight));
+    r.removeFromTop (6);
+
+    auto threadingRow = r.removeFromTop (24);
+    renderCpusLabel.setBounds (threadingRow.removeFromLeft (100));
+    renderCpusBox.setBounds (threadingRow.removeFromLeft (90));
+    threadingRow.removeFromLeft (16);
+    threadPoolLabel.setBounds (threadingRow.removeFromLeft (100));
+    threadPoolBox.setBounds (threadingRow.removeFromLeft (240));
+    threadingRow.removeFromLeft (12);
+    sample16BitToggle.setBounds (threadingRow);
+    r.removeFromTop (6);
+
+    auto voicesRow = r.removeFromTop (24);
+    voicesLabel.setBounds (voicesRow.removeFromLeft (100));
+    voicesBox.setBounds (voicesRow.removeFromLeft (90));
+    voicesRow.removeFromLeft (16);
+    stealingLabel.setBounds (voicesRow.removeFromLeft (120));
+    stealingBox.setBounds (voicesRow.removeFromLeft (120));
+    voicesRow.removeFromLeft (12);
+    realtimeSequencingToggle.setBounds (voicesRow);
+    r.removeFromTop (6);
+
+    auto memoryRow = r.removeFromTop (24);
+    sampleMemoryLabel.setBounds (memoryRow.removeFromLeft (100));
+    sampleMemoryValueLabel.setBounds (memoryRow.removeFromLeft (240));
+    memoryRow.removeFromLeft (12);
+    sampleMipMapsToggle.setBounds (memoryRow);
+    r.removeFromTop (6);
+
+    auto undoRow = r.removeFromTop (24);
+    undoHistoryLabel.setBounds (undoRow.removeFromLeft (100));
+    undoHistoryBox.setBounds (undoRow.removeFromLeft (90));
     r.removeFromTop (12);
 
     // Plugin section
@@ -172,6 +301,67 @@ juce::StringArray AudioPluginSettingsComponent::getScanPaths() const
     return scanPaths;
 }
 
+void AudioPluginSettingsComponent::setRenderThreading (int numCpus, int strategyIndex,
+                                                       const juce::StringArray& strategyNames)
+{
+    threadPoolBox.clear (juce::dontSendNotification);
+    for (int i = 0; i < strategyNames.size(); ++i)
+        threadPoolBox.addItem (strategyNames[i], i + 1);
+
+    renderCpusBox.setSelectedId (juce::jlimit (0, juce::SystemStats::getNumCpus(), numCpus) + 1, juce::dontSendNotification);
+    threadPoolBox.setSelectedId (strategyIndex + 1, juce::dontSendNotification);
+}
+
+void AudioPluginSettingsComponent::setSample16Bit (bool use16Bit)
+{
+    sample16BitToggle.setToggleState (use16Bit, juce::dontSendNotification);
+}
+
+void AudioPluginSettingsComponent::setVoiceLimits (int polyphony, int stealingIndex, int maxPolyphony,
+                                                   const juce::StringArray& stealingNames)
+{
+    voicesBox.clear (juce::dontSendNotification);
+    for (int n = 1; n <= maxPolyphony; ++n)
+        voicesBox.addItem (juce::String (n), n);
+
+    stealingBox.clear (juce::dontSendNotification);
+    for (int i = 0; i < stealingNames.size(); ++i)
+        stealingBox.addItem (stealingNames[i], i + 1);
+
+    voicesBox.setSelectedId (juce::jlimit (1, maxPolyphony, polyphony), juce::dontSendNotification);
+    stealingBox.setSelectedId (stealingIndex + 1, juce::dontSendNotification);
+}
+
+void AudioPluginSettingsComponent::setRealtimeSequencing (bool shouldSequence)
+{
+    realtimeSequencingToggle.setToggleState (shouldSequence, juce::dontSendNotification);
+}
+
+void AudioPluginSettingsComponent::setSampleMipMaps (bool buildMipMaps)
+{
+    sampleMipMapsToggle.setToggleState (buildMipMaps, juce::dontSendNotification);
+}
+
+void AudioPluginSettingsComponent::setSampleMemoryUsage (size_t totalBytes, size_t mipMapBytes)
+{
+    auto megabytes = [] (size_t bytes) { return juce::String (static_cast<double> (bytes) / (1024.0 * 1024.0), 1) + " MB"; };
+
+    sampleMemoryValueLabel.setText (megabytes (totalBytes) + " (mip-maps " + megabytes (mipMapBytes) + ")",
+                                    juce::dontSendNotification);
+}
+
+void AudioPluginSettingsComponent::voiceLimitsChanged()
+{
+    if (onVoiceLimitsChanged != nullptr && voicesBox.getSelectedId() > 0 && stealingBox.getSelectedId() > 0)
+        onVoiceLimitsChanged (voicesBox.getSelectedId(), stealingBox.getSelectedId() - 1);
+}
+
+void AudioPluginSettingsComponent::renderThreadingChanged()
+{
+    if (onRenderThreadingChanged != nullptr && renderCpusBox.getSelectedId() > 0 && threadPoolBox.getSelectedId() > 0)
+        onRenderThreadingChanged (renderCpusBox.getSelectedId() - 1, threadPoolBox.getSelectedId() - 1);
+}
+
 void AudioPluginSettingsComponent::startPluginScan()
 {
     if (scanInProgress.exchange (true))
@@ -300,3 +490,11 @@ void AudioPluginSettingsComponent::PluginTableModel::sortOrderChanged (int newSo
     owner.pluginTable.updateContent();
     owner.pluginTable.repaint();
 }
+
+void AudioPluginSettingsComponent::setUndoHistoryLimit (int megabytes)
+{
+    if (undoHistoryBox.indexOfItemId (megabytes) < 0)
+        undoHistoryBox.addItem (juce::String (megabytes) + " MB", megabytes);
+
+    undoHistoryBox.setSelectedId (megabytes, juce::dontSendNotification);
+}
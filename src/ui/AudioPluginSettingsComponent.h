@@ -12,8 +12,11 @@ namespace te = tracktion;
 /**
  * Settings dialog component containing:
  *   1. Audio Output device selection (sample rate, block size, output device)
- *   2. Plugin scan paths list (editable) with scan/rescan button
- *   3. Discovered plugin list
+ *   2. Render threading (CPU count, worker thread pool strategy), sample memory format,
+ *      sampler voices (polyphony per track, voice stealing), sample mip-maps
+ *      with the memory the loaded samples take, and the undo history size
+ *   3. Plugin scan paths list (editable) with scan/rescan button
+ *   4. Discovered plugin list
  */
 class AudioPluginSettingsComponent : public juce::Component,
                                      private juce::ChangeListener
@@ -38,8 +41,47 @@ public:
     /** Refresh the discovered plugin table. */
     void refreshPluginList();
 
+    /** Set the render threading to display (numCpus 0 = engine default). */
+    void setRenderThreading (int numCpus, int strategyIndex, const juce::StringArray& strategyNames);
+
+    /** Callback when the CPU count or thread pool strategy is changed. */
+    std::function<void (int numCpus, int strategyIndex)> onRenderThreadingChanged;
+
+    /** Set whether samples are kept as 16-bit in memory. */
+    void setSample16Bit (bool use16Bit);
+
+    /** Callback when the 16-bit sample toggle changes. */
+    std::function<void (bool)> onSample16BitChanged;
+
+    /** Set the sampler voices per track and the voice stealing mode to display. */
+    void setVoiceLimits (int polyphony, int stealingIndex, int maxPolyphony, const juce::StringArray& stealingNames);
+
+    /** Callback when the voice count or stealing mode is changed. */
+    std::function<void (int polyphony, int stealingIndex)> onVoiceLimitsChanged;
+
+    /** Set whether octave mip-maps are built for loaded samples. */
+    void setSampleMipMaps (bool buildMipMaps);
+
+    /** Callback when the mip-map toggle changes. */
+    std::function<void (bool)> onSampleMipMapsChanged;
+
+    /** Set whether patterns play from the realtime sequencer rather than MIDI clips. */
+    void setRealtimeSequencing (bool shouldSequence);
+
+    /** Callback when the realtime sequencer toggle changes. */
+    std::function<void (bool)> onRealtimeSequencingChanged;
+
+    /** Show the RAM used by loaded samples, and the mip-map part of it. */
+    void setSampleMemoryUsage (size_t totalBytes, size_t mipMapBytes);
+
+    /** Set the memory the undo history may hold, in megabytes. */
+    void setUndoHistoryLimit (int megabytes);
+
+    /** Callback when the undo history size is changed. */
+    std::function<void (int megabytes)> onUndoHistoryLimitChanged;
+
     static constexpr int kPreferredWidth = 700;
-    static constexpr int kPreferredHeight = 560;
+    static constexpr int kPreferredHeight = 682;
 
 private:
     te::Engine& engine;
@@ -51,6 +93,29 @@ private:
     juce::Label audioSectionLabel;
     std::unique_ptr<juce::AudioDeviceSelectorComponent> audioDeviceSelector;
 
+    // Render threading
+    juce::Label renderCpusLabel;
+    juce::ComboBox renderCpusBox;
+    juce::Label threadPoolLabel;
+    juce::ComboBox threadPoolBox;
+    juce::ToggleButton sample16BitToggle { "16-bit samples" };
+
+    // Sampler voices
+    juce::Label voicesLabel;
+    juce::ComboBox voicesBox;
+    juce::Label stealingLabel;
+    juce::ComboBox stealingBox;
+    juce::ToggleButton realtimeSequencingToggle { "Realtime sequencer" };
+
+    // Sample memory
+    juce::Label sampleMemoryLabel;
+    juce::Label sampleMemoryValueLabel;
+    juce::ToggleButton sampleMipMapsToggle { "Octave mip-maps" };
+
+    // Undo history
+    juce::Label undoHistoryLabel;
+    juce::ComboBox undoHistoryBox;
+
     //==============================================================================
     // Plugin section
     juce::Label pluginSectionLabel;
@@ -105,6 +170,8 @@ private:
     //==============================================================================
     void changeListenerCallback (juce::ChangeBroadcaster* source) override;
     void startPluginScan();
+    void renderThreadingChanged();
+    void voiceLimitsChanged();
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AudioPluginSettingsComponent)
 };
@@ -0,0 +1,147 @@
+#include "CommandLineRenderer.h"
+#include <iostream>
+#include "OfflineRenderer.h"
+#include "ProjectSerializer.h"
+
+bool CommandLineRenderer::isRenderCommand (const juce::String& commandLine)
+{
+    return juce::ArgumentList ("TrackerAdjust", commandLine).containsOption ("--render");
+}
+
+juce::String CommandLineRenderer::getUsage()
+{
+    return "Usage: TrackerAdjust --render <project.tkadj> [--output <file.wav>] [--stems <dir>]\n"
+           "                     [--sample-rate <hz>] [--bit-depth <16|24|32>] [--tail <seconds>]";
+}
+
+int CommandLineRenderer::run (const juce::String& commandLine)
+{
+    juce::ArgumentList args ("TrackerAdjust", commandLine);
+
+    juce::File projectFile (juce::File::getCurrentWorkingDirectory().getChildFile (args.getValueForOption ("--render")));
+    if (! projectFile.existsAsFile())
+    {
+        std::cerr << "Project not found: " << projectFile.getFullPathName() << "\n" << getUsage() << "\n";
+        return 1;
+    }
+
+    OfflineRenderer::Settings settings;
+    settings.outputFile = args.containsOption ("--output")
+                              ? juce::File::getCurrentWorkingDirectory().getChildFile (args.getValueForOption ("--output"))
+                              : projectFile.withFileExtension ("wav");
+    if (args.containsOption ("--stems"))
+        settings.stemsDirectory = juce::File::getCurrentWorkingDirectory().getChildFile (args.getValueForOption ("--stems"));
+    if (args.containsOption ("--sample-rate"))
+        settings.sampleRate = juce::jlimit (8000.0, 384000.0, args.getValueForOption ("--sample-rate").getDoubleValue());
+    if (args.containsOption ("--bit-depth"))
+    {
+        const int bitDepth = args.getValueForOption ("--bit-depth").getIntValue();
+        if (bitDepth != 16 && bitDepth != 24 && bitDepth != 32)
+        {
+            std::cerr << "Unsupported bit depth: " << bitDepth << "\n" << getUsage() << "\n";
+            return 1;
+        }
+        settings.bitDepth = bitDepth;
+    }
+    if (args.containsOption ("--tail"))
+        settings.tailSeconds = juce::jmax (0.0, args.getValueForOption ("--tail").getDoubleValue());
+
+    // Load the project (state must outlive the engine, which keeps a MixerState pointer)
+    PatternData patternData;
+    Arrangement arrangement;
+    TrackLayout trackLayout;
+    MixerState mixerState;
+    DelayParams delayParams;
+    ReverbParams reverbParams;
+    double bpm = 120.0;
+    int rpb = 4;
+    std::map<int, juce::File> samples;
+    std::map<int, InstrumentParams> instParams;
+    std::map<int, InstrumentSlotInfo> pluginSlots;
+
+    auto error = ProjectSerializer::loadFromFile (projectFile, patternData, bpm, rpb, samples, instParams,
+                                                  arrangement, trackLayout, mixerState, delayParams, reverbParams,
+                                                  nullptr, nullptr, &pluginSlots);
+    if (error.isNotEmpty())
+    {
+        std::cerr << "Load error: " << error << "\n";
+        return 1;
+    }
+
+    TrackerEngine engine;
+    engine.initialise();
+    engine.setMixerState (&mixerState);
+
+    // Same engine setup as MainComponent::openProject
+    engine.setBpm (bpm);
+    engine.setRowsPerBeat (rpb);
+
+    for (auto& [index, sampleFile] : samples)
+    {
+        auto sampleError = engine.loadSampleForInstrument (index, sampleFile);
+        if (sampleError.isNotEmpty())
+            std::cerr << "Warning: " << sampleError << "\n";
+    }
+
+    for (auto& [index, params] : instParams)
+        engine.getSampler().setParams (index, params);
+
+    engine.setInstrumentSlotInfos (pluginSlots);
+    engine.setDelayParams (delayParams);
+    engine.setReverbParams (reverbParams);
+
+    for (int i = 0; i < kNumTracks; ++i)
+    {
+        if (auto* t = engine.getTrack (i))
+        {
+            t->setMute (mixerState.tracks[static_cast<size_t> (i)].muted);
+            t->setSolo (mixerState.tracks[static_cast<size_t> (i)].soloed);
+        }
+    }
+
+    engine.refreshMixerPlugins();
+    engine.invalidateTrackInstruments();
+
+    std::array<bool, kNumTracks> releaseModes {};
+    for (int i = 0; i < kNumTracks; ++i)
+        releaseModes[static_cast<size_t> (i)] = (trackLayout.getTrackNoteMode (i) == NoteMode::Release);
+
+    std::vector<std::pair<const Pattern*, int>> sequence;
+    for (auto& entry : arrangement.getEntries())
+    {
+        if (entry.patternIndex >= 0 && entry.patternIndex < patternData.getNumPatterns())
+            sequence.emplace_back (&patternData.getPattern (entry.patternIndex), entry.repeats);
+    }
+
+    if (sequence.empty())
+        engine.syncPatternToEdit (patternData.getCurrentPattern(), releaseModes);
+    else
+        engine.syncArrangementToEdit (sequence, engine.getRowsPerBeat(), releaseModes);
+
+    settings.trackNames = trackLayout.getTrackNames();
+
+    OfflineRenderer renderer (engine);
+    int lastPercent = -1;
+    auto result = renderer.renderNow (settings, [&lastPercent] (float progress)
+    {
+        const int percent = juce::roundToInt (progress * 100.0f);
+        if (percent != lastPercent)
+        {
+            lastPercent = percent;
+            std::cout << "\rRendering... " << percent << "%" << std::flush;
+        }
+        return true;
+    });
+    std::cout << "\n";
+
+    if (! result.wasSuccessful())
+    {
+        std::cerr << "Render failed: " << result.error << "\n";
+        return 1;
+    }
+
+    for (const auto& file : result.writtenFiles)
+        std::cout << file.getFullPathName() << "\n";
+
+    return 0;
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+/**
+ * Headless batch render entry point:
+ *
+ *   TrackerAdjust --render song.tkadj [--output song.wav] [--stems dir]
+ *                 [--sample-rate 48000] [--bit-depth 24] [--tail 2.0]
+ *
+ * Loads the project into a private engine, renders the arrangement (or the
+ * current pattern if the arrangement is empty) and exits without opening a window.
+ */
+class CommandLineRenderer
+{
+public:
+    /** True when the command line asks for a headless render. */
+    static bool isRenderCommand (const juce::String& commandLine);
+
+    /** Runs the render and returns the process exit code (0 = success). */
+    static int run (const juce::String& commandLine);
+
+    static juce::String getUsage();
+};
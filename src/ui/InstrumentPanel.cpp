@@ -66,6 +66,18 @@ void InstrumentPanel::updatePluginInfo (const std::map<int, InstrumentSlotInfo>&
     repaint();
 }
 
+void InstrumentPanel::updateLoadProgress (const std::map<int, float>& loadingInstruments)
+{
+    for (auto& slot : slots)
+        slot.loadProgress = -1.0f;
+
+    for (auto& [index, progress] : loadingInstruments)
+        if (index >= 0 && index < 256)
+            slots[static_cast<size_t> (index)].loadProgress = juce::jlimit (0.0f, 1.0f, progress);
+
+    repaint();
+}
+
 void InstrumentPanel::paint (juce::Graphics& g)
 {
     auto bg = lookAndFeel.findColour (TrackerLookAndFeel::backgroundColourId);
@@ -129,6 +141,12 @@ void InstrumentPanel::paint (juce::Graphics& g)
             g.drawText (truncName, 32, y, getWidth() - 38, kSlotHeight,
                         juce::Justification::centredLeft);
         }
+        else if (slot.loadProgress >= 0.0f)
+        {
+            g.setColour (lookAndFeel.findColour (TrackerLookAndFeel::textColourId).withAlpha (0.5f));
+            g.drawText ("loading " + juce::String (juce::roundToInt (slot.loadProgress * 100.0f)) + "%",
+                        32, y, getWidth() - 38, kSlotHeight, juce::Justification::centredLeft);
+        }
         else
         {
             g.setColour (lookAndFeel.findColour (TrackerLookAndFeel::textColourId).withAlpha (0.2f));
@@ -136,6 +154,13 @@ void InstrumentPanel::paint (juce::Graphics& g)
                         juce::Justification::centredLeft);
         }
 
+        // Background load in progress (also shown when replacing a sample)
+        if (slot.loadProgress >= 0.0f)
+        {
+            g.setColour (lookAndFeel.findColour (TrackerLookAndFeel::instrumentColourId).withAlpha (0.7f));
+            g.fillRect (32, y + kSlotHeight - 3, juce::roundToInt (static_cast<float> (getWidth() - 38) * slot.loadProgress), 2);
+        }
+
         // Bottom line
         g.setColour (lookAndFeel.findColour (TrackerLookAndFeel::gridLineColourId).withAlpha (0.5f));
         g.drawHorizontalLine (y + kSlotHeight - 1, 1.0f, static_cast<float> (getWidth()));
@@ -25,6 +25,9 @@ public:
     // Call to update plugin instrument info
     void updatePluginInfo (const std::map<int, InstrumentSlotInfo>& slotInfos);
 
+    // Samples still decoding in the background, with progress 0-1
+    void updateLoadProgress (const std::map<int, float>& loadingInstruments);
+
     // Callbacks
     std::function<void (int instrument)> onInstrumentSelected;
     std::function<void (int instrument)> onLoadSampleRequested;
@@ -48,6 +51,7 @@ private:
         bool isPlugin = false;
         juce::String pluginName;
         int ownerTrack = -1;
+        float loadProgress = -1.0f;   // < 0 when not loading
     };
     std::array<InstrumentSlot, 256> slots {};
 
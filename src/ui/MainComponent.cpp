@@ -51,6 +51,51 @@ MainComponent::MainComponent()
     trackerEngine.initialise();
     trackerEngine.setMixerState (&mixerState);
 
+    // Restore the render threading chosen in Audio & Plugin Settings
+    {
+        auto threading = trackerEngine.getRenderThreading();
+        int strategy = static_cast<int> (threading.strategy);
+        if (ProjectSerializer::loadGlobalRenderThreading (threading.numCpus, strategy))
+        {
+            const int numStrategies = TrackerEngine::getThreadPoolStrategyNames().size();
+            threading.strategy = static_cast<te::graph::ThreadPoolStrategy> (juce::jlimit (0, numStrategies - 1, strategy));
+            trackerEngine.setRenderThreading (threading);
+        }
+    }
+
+    // Sample memory format, before any project samples are loaded
+    {
+        auto options = trackerEngine.getSampler().getSampleLoadOptions();
+        options.use16Bit = ProjectSerializer::loadGlobalSample16Bit();
+        options.buildMipMaps = ProjectSerializer::loadGlobalSampleMipMaps();
+        trackerEngine.getSampler().setSampleLoadOptions (options);
+    }
+
+    // Sampler voice pool, before any track's plugin chain is set up
+    {
+        auto limits = trackerEngine.getSampler().getVoiceLimits();
+        int stealing = static_cast<int> (limits.stealing);
+        if (ProjectSerializer::loadGlobalVoiceLimits (limits.polyphony, stealing))
+        {
+            const int numModes = TrackerEngine::getVoiceStealingNames().size();
+            limits.stealing = static_cast<SamplerVoicePool::Stealing> (juce::jlimit (0, numModes - 1, stealing));
+            trackerEngine.setSamplerVoiceLimits (limits);
+        }
+    }
+
+    // Pattern playback: realtime sequencer or MIDI clips
+    trackerEngine.setRealtimeSequencing (ProjectSerializer::loadGlobalRealtimeSequencing());
+
+    // Undo history memory cap
+    {
+        int megabytes = kDefaultUndoHistoryBytes / (1024 * 1024);
+        if (ProjectSerializer::loadGlobalUndoHistoryLimit (megabytes))
+            setUndoHistoryLimit (juce::jlimit (1, 1024, megabytes) * 1024 * 1024);
+    }
+
+    offlineRenderer = std::make_unique<OfflineRenderer> (trackerEngine);
+    offlineRenderer->onFinished = [this] (const OfflineRenderer::Result& result) { handleRenderFinished (result); };
+
     // Create tab bar
     tabBar = std::make_unique<TabBarComponent> (trackerLookAndFeel);
     addAndMakeVisible (*tabBar);
@@ -86,7 +131,7 @@ MainComponent::MainComponent()
         bool hasData = false;
         for (int r = 0; r < pat.numRows && ! hasData; ++r)
             for (int t = 0; t < kNumTracks && ! hasData; ++t)
-                if (! pat.getCell (r, t).isEmpty())
+                if (! pat.getCellView (r, t).isEmpty())
                     hasData = true;
         for (int r = 0; r < pat.numRows && ! hasData; ++r)
             for (int lane = 0; lane < trackLayout.getMasterFxLaneCount() && ! hasData; ++lane)
@@ -135,7 +180,7 @@ MainComponent::MainComponent()
                 bool hasData = false;
                 for (int r = 0; r < pat.numRows && ! hasData; ++r)
                     for (int t = 0; t < kNumTracks && ! hasData; ++t)
-                        if (! pat.getCell (r, t).isEmpty())
+                        if (! pat.getCellView (r, t).isEmpty())
                             hasData = true;
                 for (int r = 0; r < pat.numRows && ! hasData; ++r)
                     for (int lane = 0; lane < trackLayout.getMasterFxLaneCount() && ! hasData; ++lane)
@@ -586,11 +631,14 @@ MainComponent::MainComponent()
     };
     fileBrowser->onLoadSample = [this] (int instrument, const juce::File& file)
     {
-        auto error = trackerEngine.loadSampleForInstrument (instrument, file);
-        if (error.isNotEmpty())
-            juce::AlertWindow::showMessageBoxAsync (juce::AlertWindow::WarningIcon, "Load Error", error);
-        else
+        trackerEngine.loadSampleForInstrumentAsync (instrument, file, [this, instrument] (const juce::String& error)
         {
+            if (error.isNotEmpty())
+            {
+                juce::AlertWindow::showMessageBoxAsync (juce::AlertWindow::WarningIcon, "Load Error", error);
+                return;
+            }
+
             if (trackerEngine.isPlaying())
             {
                 if (songMode)
@@ -608,9 +656,11 @@ MainComponent::MainComponent()
             updateStatusBar();
             updateInstrumentPanel();
             fileBrowser->updateInstrumentSlots (trackerEngine.getSampler().getLoadedSamples());
-            fileBrowser->advanceToNextEmptySlot();
             markDirty();
-        }
+        });
+
+        // Move on straight away so the next sample can be queued while this one decodes
+        fileBrowser->advanceToNextEmptySlot();
     };
     fileBrowser->onPreviewFile = [this] (const juce::File& file)
     {
@@ -772,11 +822,14 @@ MainComponent::MainComponent()
         trackerGrid->setCurrentInstrument (inst);
         instrumentPanel->setSelectedInstrument (inst);
 
-        auto error = trackerEngine.loadSampleForInstrument (inst, file);
-        if (error.isNotEmpty())
-            juce::AlertWindow::showMessageBoxAsync (juce::AlertWindow::WarningIcon, "Load Error", error);
-        else
+        trackerEngine.loadSampleForInstrumentAsync (inst, file, [this, inst] (const juce::String& error)
         {
+            if (error.isNotEmpty())
+            {
+                juce::AlertWindow::showMessageBoxAsync (juce::AlertWindow::WarningIcon, "Load Error", error);
+                return;
+            }
+
             if (trackerEngine.isPlaying())
             {
                 if (songMode)
@@ -789,7 +842,7 @@ MainComponent::MainComponent()
             updateToolbar();
             updateInstrumentPanel();
             markDirty();
-        }
+        });
     };
 
     trackerGrid->onNoteModeToggled = [this] (int /*track*/)
@@ -812,6 +865,11 @@ MainComponent::MainComponent()
         setTemporaryStatus (message, isError, timeoutMs);
     };
 
+    trackerEngine.onSampleLoadProgress = [this]
+    {
+        instrumentPanel->updateLoadProgress (trackerEngine.getSampleLoadProgress());
+    };
+
     trackerEngine.onNavigateToAutomation = [this] (const juce::String& pluginId, int paramIndex)
     {
         navigateToAutomationParam (pluginId, paramIndex);
@@ -882,9 +940,13 @@ MainComponent::~MainComponent()
     // Prevent any late engine callbacks from touching a partially-destroyed UI.
     trackerEngine.onTransportChanged = nullptr;
     trackerEngine.onStatusMessage = nullptr;
+    trackerEngine.onSampleLoadProgress = nullptr;
+    trackerEngine.cancelSampleLoads();
     trackerEngine.onNavigateToAutomation = nullptr;
     trackerEngine.onPluginInstrumentCleared = nullptr;
     trackerEngine.onInsertStateChanged = nullptr;
+    offlineRenderer->onFinished = nullptr;
+    offlineRenderer->cancel();
 
    #if JUCE_MAC
     juce::MenuBarModel::setMacMainMenu (nullptr);
@@ -1115,13 +1177,13 @@ bool MainComponent::keyPressed (const juce::KeyPress& key, juce::Component*)
         }
         else
         {
-            switchToPattern (patternData.getCurrentPatternIndex() + 1);
+            switchToPattern (getPatternStepBase() + 1);
         }
         return true;
     }
     if (cmd && shift && keyCode == juce::KeyPress::leftKey)
     {
-        switchToPattern (patternData.getCurrentPatternIndex() - 1);
+        switchToPattern (getPatternStepBase() - 1);
         return true;
     }
 
@@ -1308,11 +1370,14 @@ void MainComponent::getAllCommands (juce::Array<juce::CommandID>& commands)
     commands.add (cmdOpen);
     commands.add (cmdSave);
     commands.add (cmdSaveAs);
+    commands.add (cmdRenderSong);
+    commands.add (cmdRenderStems);
     commands.add (cmdShowHelp);
     commands.add (cmdToggleArrangement);
     commands.add (cmdToggleSongMode);
     commands.add (cmdToggleInstrumentPanel);
     commands.add (cmdToggleMetronome);
+    commands.add (cmdToggleCueNextPattern);
     commands.add (cmdAudioPluginSettings);
 }
 
@@ -1380,6 +1445,15 @@ void MainComponent::getCommandInfo (juce::CommandID commandID, juce::Application
             result.addDefaultKeypress ('S', juce::ModifierKeys::commandModifier | juce::ModifierKeys::shiftModifier);
             result.setActive (true);
             break;
+        case cmdRenderSong:
+            result.setInfo ("Render Song to WAV...", "Bounce the song offline to a WAV file", "File", 0);
+            result.addDefaultKeypress ('R', juce::ModifierKeys::commandModifier | juce::ModifierKeys::shiftModifier);
+            result.setActive (! offlineRenderer->isRendering());
+            break;
+        case cmdRenderStems:
+            result.setInfo ("Render Song with Stems...", "Bounce the song offline plus one WAV per track", "File", 0);
+            result.setActive (! offlineRenderer->isRendering());
+            break;
         case cmdShowHelp:
             result.setInfo ("Keyboard Shortcuts", "Show all keyboard shortcuts", "Help", 0);
             result.addDefaultKeypress ('/', juce::ModifierKeys::commandModifier);
@@ -1400,6 +1474,11 @@ void MainComponent::getCommandInfo (juce::CommandID commandID, juce::Application
             result.setInfo ("Toggle Metronome", "Toggle the metronome on/off", "View", 0);
             result.addDefaultKeypress ('K', juce::ModifierKeys::commandModifier | juce::ModifierKeys::shiftModifier);
             break;
+        case cmdToggleCueNextPattern:
+            result.setInfo ("Cue Next Pattern", "Start a pattern picked during playback at the end of the loop", "View", 0);
+            result.addDefaultKeypress ('Q', juce::ModifierKeys::commandModifier | juce::ModifierKeys::shiftModifier);
+            result.setTicked (cueNextPattern);
+            break;
         case cmdAudioPluginSettings:
             result.setInfo ("Audio & Plugin Settings...", "Configure audio output and plugin scan paths", "File", 0);
             result.addDefaultKeypress (',', juce::ModifierKeys::commandModifier);
@@ -1416,10 +1495,10 @@ bool MainComponent::perform (const InvocationInfo& info)
             loadSampleForCurrentTrack();
             return true;
         case nextPattern:
-            switchToPattern (patternData.getCurrentPatternIndex() + 1);
+            switchToPattern (getPatternStepBase() + 1);
             return true;
         case prevPattern:
-            switchToPattern (patternData.getCurrentPatternIndex() - 1);
+            switchToPattern (getPatternStepBase() - 1);
             return true;
         case addPattern:
             patternData.addPattern (patternData.getCurrentPattern().numRows);
@@ -1483,6 +1562,12 @@ bool MainComponent::perform (const InvocationInfo& info)
         case cmdSaveAs:
             saveProjectAs();
             return true;
+        case cmdRenderSong:
+            renderSong (false);
+            return true;
+        case cmdRenderStems:
+            renderSong (true);
+            return true;
         case cmdShowHelp:
             showHelpOverlay();
             return true;
@@ -1504,6 +1589,20 @@ bool MainComponent::perform (const InvocationInfo& info)
             toolbar->setMetronomeEnabled (enabled);
             return true;
         }
+        case cmdToggleCueNextPattern:
+            cueNextPattern = ! cueNextPattern;
+            if (! cueNextPattern)
+            {
+                trackerEngine.cancelCuedPattern();
+                cuedPatternIndex = -1;
+            }
+            else if (! trackerEngine.isRealtimeSequencing())
+            {
+                setTemporaryStatus ("Cueing needs the realtime sequencer (Audio & Plugin Settings)");
+            }
+            commandManager.commandStatusChanged();
+            updateStatusBar();
+            return true;
         case cmdAudioPluginSettings:
             showAudioPluginSettings();
             return true;
@@ -1531,6 +1630,9 @@ juce::PopupMenu MainComponent::getMenuForIndex (int menuIndex, const juce::Strin
         menu.addCommandItem (&commandManager, cmdSave);
         menu.addCommandItem (&commandManager, cmdSaveAs);
         menu.addSeparator();
+        menu.addCommandItem (&commandManager, cmdRenderSong);
+        menu.addCommandItem (&commandManager, cmdRenderStems);
+        menu.addSeparator();
         menu.addCommandItem (&commandManager, loadSample);
         menu.addSeparator();
         menu.addCommandItem (&commandManager, cmdAudioPluginSettings);
@@ -1553,6 +1655,7 @@ juce::PopupMenu MainComponent::getMenuForIndex (int menuIndex, const juce::Strin
         menu.addCommandItem (&commandManager, cmdToggleInstrumentPanel);
         menu.addSeparator();
         menu.addCommandItem (&commandManager, cmdToggleSongMode);
+        menu.addCommandItem (&commandManager, cmdToggleCueNextPattern);
         menu.addCommandItem (&commandManager, cmdToggleMetronome);
     }
     else if (menuIndex == 3)
@@ -1566,10 +1669,14 @@ juce::PopupMenu MainComponent::getMenuForIndex (int menuIndex, const juce::Strin
 
 void MainComponent::timerCallback()
 {
+    if (offlineRenderer->isRendering())
+        renderProgressValue = static_cast<double> (offlineRenderer->getProgress());
+
+    followCuedPattern();
+
     if (trackerEngine.isPlaying())
     {
         int playRow = -1;
-        int playPatternIndex = -1;
 
         if (songMode && arrangement.getNumEntries() > 0)
         {
@@ -1588,21 +1695,15 @@ void MainComponent::timerCallback()
                     arrangementComponent->setPlayingEntry (info.entryIndex);
 
                 playRow = info.rowInPattern;
-                playPatternIndex = info.patternIndex;
             }
         }
         else
         {
             // Pattern mode: simple row from beat position
             playRow = trackerEngine.getPlaybackRow (patternData.getCurrentPattern().numRows);
-            playPatternIndex = patternData.getCurrentPatternIndex();
         }
 
-        if (playPatternIndex >= 0 && playPatternIndex < patternData.getNumPatterns() && playRow >= 0)
-        {
-            const auto& automationData = patternData.getPattern (playPatternIndex).automationData;
-            trackerEngine.applyAutomationForPlaybackRow (automationData, playRow);
-        }
+        // Plugin automation itself is rendered on the audio thread (PluginAutomationStage).
 
         trackerGrid->setPlaybackRow (playRow);
         trackerGrid->setPlaying (true);
@@ -1724,9 +1825,11 @@ void MainComponent::updateStatusBar()
     const char* subColNames[] = { "Note", "Inst", "Vol", "FX" };
     auto subCol = subColNames[static_cast<int> (trackerGrid->getCursorSubColumn())];
 
+    auto cued = cuedPatternIndex >= 0 ? juce::String::formatted ("  Cued:%02d", cuedPatternIndex + 1) : juce::String();
+
     statusLabel.setText (juce::String (playState) + "  Row:" + row + "  Track:" + track
                              + " [" + subCol + "]"
-                             + "  Step:" + juce::String (trackerGrid->getEditStep()),
+                             + "  Step:" + juce::String (trackerGrid->getEditStep()) + cued,
                          juce::dontSendNotification);
 
     octaveLabel.setText ("Oct:" + juce::String (trackerGrid->getOctave()),
@@ -1778,12 +1881,15 @@ void MainComponent::loadSampleForCurrentTrack()
                               if (file.existsAsFile())
                               {
                                   int inst = trackerGrid->getCurrentInstrument();
-                                  auto error = trackerEngine.loadSampleForInstrument (inst, file);
-                                  if (error.isNotEmpty())
-                                      juce::AlertWindow::showMessageBoxAsync (juce::AlertWindow::WarningIcon,
-                                                                              "Load Error", error);
-                                  else
+                                  trackerEngine.loadSampleForInstrumentAsync (inst, file, [this, inst] (const juce::String& error)
                                   {
+                                      if (error.isNotEmpty())
+                                      {
+                                          juce::AlertWindow::showMessageBoxAsync (juce::AlertWindow::WarningIcon,
+                                                                                  "Load Error", error);
+                                          return;
+                                      }
+
                                       if (trackerEngine.isPlaying())
                                       {
                                           if (songMode)
@@ -1797,12 +1903,69 @@ void MainComponent::loadSampleForCurrentTrack()
                                       updateInstrumentPanel();
                                       fileBrowser->updateInstrumentSlots (trackerEngine.getSampler().getLoadedSamples());
                                       markDirty();
-                                  }
+                                  });
                               }
                           });
 }
 
 void MainComponent::switchToPattern (int index)
+{
+    index = juce::jlimit (0, patternData.getNumPatterns() - 1, index);
+
+    // Cue mode: the pattern starts at the end of the loop and the view follows it then
+    if (cueNextPattern && trackerEngine.isPlaying() && ! songMode)
+    {
+        followCuedPattern();
+
+        if (index == patternData.getCurrentPatternIndex())
+        {
+            // Picking the playing pattern again drops the cue
+            trackerEngine.cancelCuedPattern();
+            cuedPatternIndex = -1;
+            updateStatusBar();
+            return;
+        }
+
+        if (trackerEngine.cuePattern (patternData.getPattern (index), getReleaseModes()))
+        {
+            cuedPatternIndex = index;
+            updateStatusBar();
+            return;
+        }
+    }
+
+    showPattern (index);
+}
+
+int MainComponent::getPatternStepBase() const
+{
+    // Stepping through patterns while one is cued steps on from the cue
+    return cuedPatternIndex >= 0 ? cuedPatternIndex : patternData.getCurrentPatternIndex();
+}
+
+void MainComponent::followCuedPattern()
+{
+    if (cuedPatternIndex < 0)
+        return;
+
+    // Dropped by the engine (stopped, song mode, sequencer off)
+    if (! trackerEngine.hasCuedPattern())
+    {
+        cuedPatternIndex = -1;
+        updateStatusBar();
+        return;
+    }
+
+    // Playing since the loop wrapped: the sync brings tempo, loop and automation along
+    if (trackerEngine.hasCuedPatternStarted())
+    {
+        const int index = cuedPatternIndex;
+        cuedPatternIndex = -1;
+        showPattern (index);
+    }
+}
+
+void MainComponent::showPattern (int index)
 {
     index = juce::jlimit (0, patternData.getNumPatterns() - 1, index);
     patternData.setCurrentPattern (index);
@@ -1935,13 +2098,13 @@ void MainComponent::showTrackHeaderMenu (int track, juce::Point<int> screenPos)
     // Note lanes
     menu.addSeparator();
     int noteLanes = trackLayout.getTrackNoteLaneCount (track);
-    menu.addItem (22, "Add Note Lane (" + juce::String (noteLanes) + " -> " + juce::String (noteLanes + 1) + ")", noteLanes < 8);
+    menu.addItem (22, "Add Note Lane (" + juce::String (noteLanes) + " -> " + juce::String (noteLanes + 1) + ")", noteLanes < kMaxNoteLanes);
     menu.addItem (23, "Remove Note Lane (" + juce::String (noteLanes) + " -> " + juce::String (noteLanes - 1) + ")", noteLanes > 1);
 
     // FX lanes
     menu.addSeparator();
     int fxLanes = trackLayout.getTrackFxLaneCount (track);
-    menu.addItem (20, "Add FX Lane (" + juce::String (fxLanes) + " -> " + juce::String (fxLanes + 1) + ")", fxLanes < 8);
+    menu.addItem (20, "Add FX Lane (" + juce::String (fxLanes) + " -> " + juce::String (fxLanes + 1) + ")", fxLanes < kMaxFxLanes);
     menu.addItem (21, "Remove FX Lane (" + juce::String (fxLanes) + " -> " + juce::String (fxLanes - 1) + ")", fxLanes > 1);
 
     int groupIdx = trackLayout.getGroupForTrack (track);
@@ -2109,6 +2272,7 @@ void MainComponent::performUndoableTrackLayoutChange (const std::function<void()
         return;
     }
 
+    undoManager.beginNewTransaction();
     undoManager.perform (new TrackLayoutEditAction (trackLayout, std::move (before), std::move (after)));
 
     trackerGrid->setCursorPosition (trackerGrid->getCursorRow(), trackerGrid->getCursorTrack());
@@ -2140,6 +2304,12 @@ bool MainComponent::confirmDiscardChanges()
                                                 "Discard", "Cancel");
 }
 
+void MainComponent::setUndoHistoryLimit (int maxBytes)
+{
+    undoHistoryBytes = juce::jmax (0, maxBytes);
+    undoManager.setMaxNumberOfStoredUnits (undoHistoryBytes, kMinUndoSteps);
+}
+
 void MainComponent::newProject()
 {
     if (! confirmDiscardChanges()) return;
@@ -2148,6 +2318,7 @@ void MainComponent::newProject()
     patternData.clearAllPatterns();
     arrangement.clear();
     trackLayout.resetToDefault();
+    trackerEngine.cancelSampleLoads();
     trackerEngine.getSampler().clearLoadedSamples();
     arrangementComponent->setSelectedEntry (-1);
     trackerGrid->setCursorPosition (0, 0);
@@ -2185,7 +2356,7 @@ void MainComponent::openProject()
     auto chooser = std::make_shared<juce::FileChooser> (
         "Open Project",
         juce::File::getSpecialLocation (juce::File::userHomeDirectory),
-        "*.tkadj");
+        "*.tkadj;*.xml");
 
     chooser->launchAsync (juce::FileBrowserComponent::openMode | juce::FileBrowserComponent::canSelectFiles,
                           [this, chooser] (const juce::FileChooser& fc)
@@ -2218,11 +2389,21 @@ void MainComponent::openProject()
                               trackerEngine.setRowsPerBeat (rpb);
                               trackerGrid->setRowsPerBeat (trackerEngine.getRowsPerBeat());
 
-                              // Reload samples
+                              // Reload samples in the background; each bank reaches the
+                              // tracks as it lands, so playback can start right away
+                              trackerEngine.cancelSampleLoads();
                               trackerEngine.getSampler().clearLoadedSamples();
 
                               for (auto& [index, sampleFile] : samples)
-                                  trackerEngine.loadSampleForInstrument (index, sampleFile);
+                                  trackerEngine.loadSampleForInstrumentAsync (index, sampleFile, [this, index] (const juce::String& error)
+                                  {
+                                      if (error.isNotEmpty())
+                                          setTemporaryStatus ("Instrument " + juce::String::formatted ("%02X", index)
+                                                              + ": " + error, true, 4000);
+
+                                      updateInstrumentPanel();
+                                      fileBrowser->updateInstrumentSlots (trackerEngine.getSampler().getLoadedSamples());
+                                  });
 
                               // Restore instrument params
                               for (auto& [index, params] : instParams)
@@ -2294,7 +2475,7 @@ void MainComponent::saveProject()
         auto error = ProjectSerializer::saveToFile (currentProjectFile, patternData,
                                                      trackerEngine.getBpm(),
                                                      trackerEngine.getRowsPerBeat(),
-                                                     trackerEngine.getSampler().getLoadedSamples(),
+                                                     trackerEngine.getInstrumentSampleFiles(),
                                                      trackerEngine.getSampler().getAllParams(),
                                                      arrangement,
                                                      trackLayout,
@@ -2324,7 +2505,7 @@ void MainComponent::saveProjectAs()
         "Save Project As",
         currentProjectFile.existsAsFile() ? currentProjectFile.getParentDirectory()
                                            : juce::File::getSpecialLocation (juce::File::userHomeDirectory),
-        "*.tkadj");
+        "*.tkadj;*.xml");
 
     chooser->launchAsync (juce::FileBrowserComponent::saveMode | juce::FileBrowserComponent::canSelectFiles,
                           [this, chooser] (const juce::FileChooser& fc)
@@ -2332,14 +2513,15 @@ void MainComponent::saveProjectAs()
                               auto file = fc.getResult();
                               if (file == juce::File()) return;
 
-                              auto f = file.withFileExtension ("tkadj");
+                              // .xml saves as the XML interchange format, anything else as .tkadj
+                              auto f = file.hasFileExtension ("xml") ? file : file.withFileExtension ("tkadj");
                               trackerEngine.snapshotInsertPluginStates();
                               trackerEngine.snapshotPluginInstrumentStates();
                               auto& slotInfos = trackerEngine.getAllInstrumentSlotInfos();
                               auto error = ProjectSerializer::saveToFile (f, patternData,
                                                                           trackerEngine.getBpm(),
                                                                           trackerEngine.getRowsPerBeat(),
-                                                                          trackerEngine.getSampler().getLoadedSamples(),
+                                                                          trackerEngine.getInstrumentSampleFiles(),
                                                                           trackerEngine.getSampler().getAllParams(),
                                                                           arrangement,
                                                                           trackLayout,
@@ -2361,6 +2543,96 @@ void MainComponent::saveProjectAs()
                           });
 }
 
+void MainComponent::renderSong (bool withStems)
+{
+    if (offlineRenderer->isRendering())
+        return;
+
+    auto defaultDir = currentProjectFile.existsAsFile() ? currentProjectFile.getParentDirectory()
+                                                        : juce::File::getSpecialLocation (juce::File::userMusicDirectory);
+    auto defaultName = currentProjectFile.existsAsFile() ? currentProjectFile.getFileNameWithoutExtension()
+                                                         : juce::String ("Untitled");
+
+    auto chooser = std::make_shared<juce::FileChooser> (
+        withStems ? "Render Song with Stems" : "Render Song to WAV",
+        defaultDir.getChildFile (defaultName + ".wav"),
+        "*.wav");
+
+    chooser->launchAsync (juce::FileBrowserComponent::saveMode | juce::FileBrowserComponent::canSelectFiles
+                              | juce::FileBrowserComponent::warnAboutOverwriting,
+                          [this, chooser, withStems] (const juce::FileChooser& fc)
+                          {
+                              auto file = fc.getResult();
+                              if (file == juce::File()) return;
+
+                              OfflineRenderer::Settings settings;
+                              settings.outputFile = file.withFileExtension ("wav");
+                              if (withStems)
+                                  settings.stemsDirectory = settings.outputFile.getSiblingFile (
+                                      settings.outputFile.getFileNameWithoutExtension() + " Stems");
+                              settings.trackNames = trackLayout.getTrackNames();
+
+                              auto deviceRate = trackerEngine.getEngine().getDeviceManager().getSampleRate();
+                              if (deviceRate > 0.0)
+                                  settings.sampleRate = deviceRate;
+
+                              // Render the arrangement (or the current pattern when there is none),
+                              // always from MIDI clips
+                              trackerEngine.stop();
+                              realtimeSequencingBeforeRender = trackerEngine.isRealtimeSequencing();
+                              trackerEngine.setRealtimeSequencing (false);
+                              syncArrangementToEdit();
+
+                              auto error = offlineRenderer->start (settings);
+                              if (error.isNotEmpty())
+                              {
+                                  trackerEngine.setRealtimeSequencing (realtimeSequencingBeforeRender);
+                                  juce::AlertWindow::showMessageBoxAsync (juce::AlertWindow::WarningIcon,
+                                                                          "Render Error", error);
+                                  return;
+                              }
+
+                              renderProgressValue = 0.0;
+                              renderProgressWindow = std::make_unique<juce::AlertWindow> (
+                                  "Rendering", settings.outputFile.getFileName(), juce::AlertWindow::NoIcon);
+                              renderProgressWindow->addProgressBarComponent (renderProgressValue);
+                              renderProgressWindow->addButton ("Cancel", 0, juce::KeyPress (juce::KeyPress::escapeKey));
+                              renderProgressWindow->enterModalState (true, juce::ModalCallbackFunction::create (
+                                  [this] (int)
+                                  {
+                                      // Cancel button; a finished render has already stopped
+                                      offlineRenderer->cancel();
+                                  }), false);
+                              commandManager.commandStatusChanged();
+                          });
+}
+
+void MainComponent::handleRenderFinished (const OfflineRenderer::Result& result)
+{
+    if (renderProgressWindow != nullptr && renderProgressWindow->isCurrentlyModal())
+        renderProgressWindow->exitModalState (1);
+
+    // The window may be the one invoking this (Cancel), so delete it afterwards
+    juce::MessageManager::callAsync ([safeThis = juce::Component::SafePointer<MainComponent> (this)]
+    {
+        if (safeThis != nullptr)
+            safeThis->renderProgressWindow = nullptr;
+    });
+
+    commandManager.commandStatusChanged();
+
+    // The next sync goes back to the realtime sequencer if it was in use
+    trackerEngine.setRealtimeSequencing (realtimeSequencingBeforeRender);
+
+    if (result.cancelled)
+        setTemporaryStatus ("Render cancelled");
+    else if (result.error.isNotEmpty())
+        juce::AlertWindow::showMessageBoxAsync (juce::AlertWindow::WarningIcon, "Render Error", result.error);
+    else
+        setTemporaryStatus ("Rendered " + juce::String (result.writtenFiles.size())
+                            + (result.writtenFiles.size() == 1 ? " file" : " files"), false, 5000);
+}
+
 void MainComponent::showHelpOverlay()
 {
     struct HelpComponent : public juce::Component
@@ -2415,6 +2687,7 @@ void MainComponent::showHelpOverlay()
                     "Cmd+O             Open project",
                     "Cmd+S             Save",
                     "Cmd+Shift+S       Save As",
+                    "Cmd+Shift+R       Render song to WAV",
                     "Cmd+Shift+O       Load sample" }}
             };
 
@@ -2439,6 +2712,7 @@ void MainComponent::showHelpOverlay()
                     "Cmd+Shift+A       Arrangement",
                     "Cmd+Shift+I       Instruments",
                     "Cmd+Shift+P       PAT / SONG mode",
+                    "Cmd+Shift+Q       Cue next pattern",
                     "Cmd+Shift+K       Metronome",
                     "Cmd+/             Show this help" }}
             };
@@ -2528,6 +2802,13 @@ void MainComponent::toggleSongMode()
 
 void MainComponent::removePatternAndRepairArrangement (int index)
 {
+    // Pattern indices shift under a pending cue
+    if (cuedPatternIndex >= 0)
+    {
+        trackerEngine.cancelCuedPattern();
+        cuedPatternIndex = -1;
+    }
+
     patternData.removePattern (index);
     arrangement.remapAfterPatternRemoved (index, patternData.getNumPatterns());
 
@@ -2681,6 +2962,7 @@ void MainComponent::doPaste()
 
     if (! records.empty())
     {
+        undoManager.beginNewTransaction();
         undoManager.perform (new MultiCellEditAction (patternData, patternData.getCurrentPatternIndex(), std::move (records)));
         if (trackerGrid->onPatternDataChanged)
             trackerGrid->onPatternDataChanged();
@@ -2777,6 +3059,7 @@ void MainComponent::doCut()
 
     if (! cellRecords.empty() || ! masterFxRecords.empty())
     {
+        undoManager.beginNewTransaction();
         undoManager.perform (new MultiCellEditAction (patternData, patIdx,
                                                       std::move (cellRecords),
                                                       std::move (masterFxRecords)));
@@ -2835,12 +3118,15 @@ void MainComponent::loadSampleForInstrument (int instrument)
                               auto file = fc.getResult();
                               if (file.existsAsFile())
                               {
-                                  auto error = trackerEngine.loadSampleForInstrument (instrument, file);
-                                  if (error.isNotEmpty())
-                                      juce::AlertWindow::showMessageBoxAsync (juce::AlertWindow::WarningIcon,
-                                                                              "Load Error", error);
-                                  else
+                                  trackerEngine.loadSampleForInstrumentAsync (instrument, file, [this, instrument] (const juce::String& error)
                                   {
+                                      if (error.isNotEmpty())
+                                      {
+                                          juce::AlertWindow::showMessageBoxAsync (juce::AlertWindow::WarningIcon,
+                                                                                  "Load Error", error);
+                                          return;
+                                      }
+
                                       if (trackerEngine.isPlaying())
                                       {
                                           if (songMode)
@@ -2854,7 +3140,7 @@ void MainComponent::loadSampleForInstrument (int instrument)
                                       updateInstrumentPanel();
                                       fileBrowser->updateInstrumentSlots (trackerEngine.getSampler().getLoadedSamples());
                                       markDirty();
-                                  }
+                                  });
                               }
                           });
 }
@@ -3037,6 +3323,62 @@ void MainComponent::showAudioPluginSettings()
         ProjectSerializer::saveGlobalPluginScanPaths (paths);
     };
 
+    const auto threading = trackerEngine.getRenderThreading();
+    content->setRenderThreading (threading.numCpus, static_cast<int> (threading.strategy),
+                                 TrackerEngine::getThreadPoolStrategyNames());
+
+    content->onRenderThreadingChanged = [this] (int numCpus, int strategyIndex)
+    {
+        trackerEngine.setRenderThreading ({ numCpus, static_cast<te::graph::ThreadPoolStrategy> (strategyIndex) });
+        ProjectSerializer::saveGlobalRenderThreading (numCpus, strategyIndex);
+    };
+
+    content->setSample16Bit (trackerEngine.getSampler().getSampleLoadOptions().use16Bit);
+    content->onSample16BitChanged = [this] (bool use16Bit)
+    {
+        auto options = trackerEngine.getSampler().getSampleLoadOptions();
+        options.use16Bit = use16Bit;
+        trackerEngine.getSampler().setSampleLoadOptions (options);
+        ProjectSerializer::saveGlobalSample16Bit (use16Bit);
+    };
+
+    content->setSampleMipMaps (trackerEngine.getSampler().getSampleLoadOptions().buildMipMaps);
+    content->onSampleMipMapsChanged = [this] (bool buildMipMaps)
+    {
+        auto options = trackerEngine.getSampler().getSampleLoadOptions();
+        options.buildMipMaps = buildMipMaps;
+        trackerEngine.getSampler().setSampleLoadOptions (options);
+        ProjectSerializer::saveGlobalSampleMipMaps (buildMipMaps);
+    };
+
+    content->setRealtimeSequencing (trackerEngine.isRealtimeSequencing());
+    content->onRealtimeSequencingChanged = [this] (bool shouldSequence)
+    {
+        trackerEngine.setRealtimeSequencing (shouldSequence);
+        ProjectSerializer::saveGlobalRealtimeSequencing (shouldSequence);
+        resyncPlaybackForCurrentMode();
+    };
+
+    const auto sampleMemory = trackerEngine.getSampler().getSampleMemoryUsage();
+    content->setSampleMemoryUsage (sampleMemory.total, sampleMemory.mipMaps);
+
+    content->setUndoHistoryLimit (getUndoHistoryLimit() / (1024 * 1024));
+    content->onUndoHistoryLimitChanged = [this] (int megabytes)
+    {
+        setUndoHistoryLimit (megabytes * 1024 * 1024);
+        ProjectSerializer::saveGlobalUndoHistoryLimit (megabytes);
+    };
+
+    const auto voiceLimits = trackerEngine.getSampler().getVoiceLimits();
+    content->setVoiceLimits (voiceLimits.polyphony, static_cast<int> (voiceLimits.stealing),
+                             SamplerVoicePool::kMaxPolyphony, TrackerEngine::getVoiceStealingNames());
+
+    content->onVoiceLimitsChanged = [this] (int polyphony, int stealingIndex)
+    {
+        trackerEngine.setSamplerVoiceLimits ({ polyphony, static_cast<SamplerVoicePool::Stealing> (stealingIndex) });
+        ProjectSerializer::saveGlobalVoiceLimits (polyphony, stealingIndex);
+    };
+
     content->setSize (AudioPluginSettingsComponent::kPreferredWidth,
                       AudioPluginSettingsComponent::kPreferredHeight);
 
@@ -4,6 +4,7 @@
 #include "PatternData.h"
 #include "TrackerGrid.h"
 #include "TrackerEngine.h"
+#include "OfflineRenderer.h"
 #include "TrackerLookAndFeel.h"
 #include "ToolbarComponent.h"
 #include "Clipboard.h"
@@ -68,11 +69,14 @@ public:
         cmdOpen         = 0x1041,
         cmdSave         = 0x1042,
         cmdSaveAs       = 0x1043,
+        cmdRenderSong   = 0x1044,
+        cmdRenderStems  = 0x1045,
         cmdShowHelp     = 0x1050,
         cmdToggleArrangement = 0x1051,
         cmdToggleSongMode    = 0x1052,
         cmdToggleInstrumentPanel = 0x1053,
         cmdToggleMetronome       = 0x1054,
+        cmdToggleCueNextPattern  = 0x1055,
         cmdAudioPluginSettings   = 0x1060
     };
 
@@ -82,6 +86,13 @@ public:
     TrackerGrid& getTrackerGrid() { return *trackerGrid; }
     bool confirmDiscardChanges();
 
+    // Undo history is capped by memory: pattern edits report their size in
+    // bytes, and the oldest steps go once the history holds more than this
+    static constexpr int kDefaultUndoHistoryBytes = 64 * 1024 * 1024;
+    static constexpr int kMinUndoSteps = 8;
+    void setUndoHistoryLimit (int maxBytes);
+    int getUndoHistoryLimit() const { return undoHistoryBytes; }
+
 private:
     TrackerLookAndFeel trackerLookAndFeel;
     TrackLayout trackLayout;
@@ -91,7 +102,8 @@ private:
     Tab activeTab = Tab::Tracker;
     std::unique_ptr<ToolbarComponent> toolbar;
     std::unique_ptr<TrackerGrid> trackerGrid;
-    juce::UndoManager undoManager;
+    juce::UndoManager undoManager { kDefaultUndoHistoryBytes, kMinUndoSteps };
+    int undoHistoryBytes = kDefaultUndoHistoryBytes;
     Arrangement arrangement;
     std::unique_ptr<ArrangementComponent> arrangementComponent;
     std::unique_ptr<InstrumentPanel> instrumentPanel;
@@ -111,6 +123,14 @@ private:
     bool arrangementVisible = false;
     bool instrumentPanelVisible = true;
     bool songMode = false;
+
+    // Cue mode: while a pattern plays, picking another cues it to start at the
+    // end of the loop instead of switching straight away
+    bool cueNextPattern = false;
+    int cuedPatternIndex = -1;
+    void followCuedPattern();
+    int getPatternStepBase() const;
+
     enum class FollowMode { Off, Center, Page };
     FollowMode followMode = FollowMode::Off;
 
@@ -141,6 +161,7 @@ private:
     void updateToolbar();
     void loadSampleForCurrentTrack();
     void switchToPattern (int index);
+    void showPattern (int index);
     void showPatternLengthEditor();
     void showPatternNameEditor();
     void showTrackHeaderMenu (int track, juce::Point<int> screenPos);
@@ -163,6 +184,15 @@ private:
     void openProject();
     void saveProject();
     void saveProjectAs();
+
+    // Offline render (File > Render)
+    std::unique_ptr<OfflineRenderer> offlineRenderer;
+    std::unique_ptr<juce::AlertWindow> renderProgressWindow;
+    double renderProgressValue = 0.0;
+    bool realtimeSequencingBeforeRender = false; // renders play the MIDI clips, restored afterwards
+    void renderSong (bool withStems);
+    void handleRenderFinished (const OfflineRenderer::Result& result);
+
     void toggleArrangementPanel();
     void toggleSongMode();
     void syncArrangementToEdit();
@@ -668,7 +668,7 @@ void MixerComponent::paintMasterStrip (juce::Graphics& g, juce::Rectangle<int> b
 
     auto limArea = r.removeFromTop (kLimiterSectionHeight);
     MixerStripPainter::paintLimiterSection (g, lookAndFeel, master.limiterThreshold, master.limiterRelease,
-                                            limArea, isSelected, (isSelected && currentSection == Section::Limiter) ? currentParam : -1);
+                                            master.limiterLookahead, limArea, isSelected, (isSelected && currentSection == Section::Limiter) ? currentParam : -1);
 
     // Separator
     g.setColour (lookAndFeel.findColour (TrackerLookAndFeel::gridLineColourId));
@@ -217,7 +217,7 @@ MixerHitResult mixerHitTestStrip (juce::Point<int> pos, const MixerHitTestContex
         {
             result.section = MixerSection::Limiter;
             int relX = pos.x - bounds.getX();
-            result.param = (relX < bounds.getWidth() / 2) ? 0 : 1;
+            result.param = juce::jlimit (0, 2, relX * 3 / juce::jmax (1, bounds.getWidth()));
             juce::ignoreUnused (limStart);
             return result;
         }
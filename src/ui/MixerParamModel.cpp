@@ -135,6 +135,7 @@ double getParamValue (const MixerState& state, StripType stripType, int stripInd
                     {
                         case 0:  return m.limiterThreshold;
                         case 1:  return m.limiterRelease;
+                        case 2:  return m.limiterLookahead;
                         default: return 0.0;
                     }
                 case Section::Inserts: return 0.0;
@@ -229,6 +230,7 @@ void setParamValue (MixerState& state, StripType stripType, int stripIndex, Sect
                     {
                         case 0: m.limiterThreshold = juce::jlimit (-24.0, 0.0, value);  break;
                         case 1: m.limiterRelease   = juce::jlimit (1.0, 500.0, value);  break;
+                        case 2: m.limiterLookahead = juce::jlimit (0.0, 5.0, value);    break;
                         default: break;
                     }
                     break;
@@ -268,6 +270,7 @@ double getParamMin (Section section, int paramIndex)
             {
                 case 0:  return -24.0;
                 case 1:  return 1.0;
+                case 2:  return 0.0;
                 default: return 0.0;
             }
         case Section::Inserts: return 0.0;
@@ -300,6 +303,7 @@ double getParamMax (Section section, int paramIndex)
             {
                 case 0:  return 0.0;
                 case 1:  return 500.0;
+                case 2:  return 5.0;
                 default: return 1.0;
             }
         case Section::Inserts: return 1.0;
@@ -332,6 +336,7 @@ double getParamStep (Section section, int paramIndex)
             {
                 case 0:  return 0.5;
                 case 1:  return 5.0;
+                case 2:  return 0.5;
                 default: return 0.1;
             }
         case Section::Inserts: return 1.0;
@@ -351,7 +356,7 @@ int getParamCountForSection (Section section, const MixerState& state, StripType
     {
         case Section::EQ:      return 4;  // Low, Mid, High, MidFreq
         case Section::Comp:    return 4;  // Threshold, Ratio, Attack, Release
-        case Section::Limiter: return 2;  // Threshold, Release
+        case Section::Limiter: return 3;  // Threshold, Release, Lookahead
         case Section::Inserts:
         {
             if (stripType == StripType::Master)
@@ -376,14 +376,14 @@ void paintGenericMuteSolo (juce::Graphics& g, TrackerLookAndFeel& lnf,
 }
 
 void paintLimiterSection (juce::Graphics& g, TrackerLookAndFeel& lnf,
-                          double threshold, double release,
+                          double threshold, double release, double lookahead,
                           juce::Rectangle<int> bounds, bool /*isSelected*/, int selectedParam)
 {
     auto inner = bounds.reduced (2, 2);
     auto selCol = lnf.findColour (TrackerLookAndFeel::fxColourId);
     auto textCol = lnf.findColour (TrackerLookAndFeel::textColourId);
 
-    int knobSize = (inner.getWidth() - 6) / 2;
+    int knobSize = (inner.getWidth() - 6) / 3;
     int knobH = inner.getHeight();
 
     // Threshold knob
@@ -403,6 +403,15 @@ void paintLimiterSection (juce::Graphics& g, TrackerLookAndFeel& lnf,
         juce::String valueStr = juce::String (static_cast<int> (release)) + "ms";
         paintKnob (g, lnf, area, release, 1.0, 500.0, colour, valueStr);
     }
+
+    // Lookahead knob
+    {
+        auto area = juce::Rectangle<int> (inner.getX() + (knobSize + 3) * 2, inner.getY(), knobSize, knobH);
+        bool sel = (selectedParam == 2);
+        auto colour = sel ? selCol : textCol.withAlpha (0.5f);
+        juce::String valueStr = lookahead > 0.0 ? juce::String (lookahead, 1) + "ms" : juce::String ("OFF");
+        paintKnob (g, lnf, area, lookahead, 0.0, 5.0, colour, valueStr);
+    }
 }
 
 void paintInsertSlots (juce::Graphics& g, TrackerLookAndFeel& lnf,
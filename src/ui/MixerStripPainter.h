@@ -54,7 +54,7 @@ namespace MixerStripPainter
                                bool hasSolo = true);
 
     void paintLimiterSection (juce::Graphics& g, TrackerLookAndFeel& lnf,
-                              double threshold, double release,
+                              double threshold, double release, double lookahead,
                               juce::Rectangle<int> bounds, bool isSelected, int selectedParam);
 
     /** Unified insert-slot painting used by both track and master strips. */
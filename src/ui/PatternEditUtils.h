@@ -53,6 +53,8 @@ inline bool applyPatternEdit (PatternData& patternData,
 
     if (undoManager != nullptr)
     {
+        // Each edit is its own undo step, so the history's memory cap can drop the oldest
+        undoManager->beginNewTransaction();
         undoManager->perform (new MultiCellEditAction (patternData, patternIndex,
                                                        std::move (cellRecords),
                                                        std::move (masterFxRecords)));
@@ -71,7 +73,7 @@ inline bool applyPatternEdit (PatternData& patternData,
         if (rec.row < 0 || rec.row >= pat.numRows || rec.lane < 0)
             continue;
         pat.ensureMasterFxSlots (rec.lane + 1);
-        pat.getMasterFxSlot (rec.row, rec.lane) = rec.newSlot;
+        pat.setMasterFxSlot (rec.row, rec.lane, rec.newSlot);
     }
 
     return true;
@@ -0,0 +1,203 @@
+#include <cstring>
+#include "ProjectContainer.h"
+
+namespace
+{
+    constexpr char kMagic[4] = { 'T', 'K', 'A', 'P' };
+
+    void writeType (juce::OutputStream& out, const juce::String& type)
+    {
+        char id[4] = { ' ', ' ', ' ', ' ' };
+        for (int i = 0; i < juce::jmin (4, type.length()); ++i)
+            id[i] = static_cast<char> (type[i]);
+        out.write (id, 4);
+    }
+
+    juce::String readType (juce::InputStream& in)
+    {
+        char id[4] {};
+        in.read (id, 4);
+        return juce::String (id, 4).trimEnd();
+    }
+}
+
+//==============================================================================
+bool ProjectContainer::isContainer (const juce::File& file)
+{
+    juce::FileInputStream in (file);
+    if (! in.openedOk())
+        return false;
+
+    char magic[4] {};
+    return in.read (magic, 4) == 4 && std::memcmp (magic, kMagic, 4) == 0;
+}
+
+juce::String ProjectContainer::hashData (const juce::MemoryBlock& data)
+{
+    return juce::SHA256 (data.getData(), data.getSize()).toHexString();
+}
+
+bool ProjectContainer::encodeFlac (const juce::MemoryBlock& fileData, juce::MemoryBlock& flacData)
+{
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+
+    auto* source = new juce::MemoryInputStream (fileData, false);
+    std::unique_ptr<juce::AudioFormatReader> reader (formatManager.createReaderFor (std::unique_ptr<juce::InputStream> (source)));
+    if (reader == nullptr || reader->usesFloatingPointData
+        || reader->lengthInSamples <= 0 || reader->numChannels == 0 || reader->numChannels > 8
+        || ! (reader->getFormatName().containsIgnoreCase ("WAV") || reader->getFormatName().containsIgnoreCase ("AIFF")))
+        return false;
+
+    const int bitsPerSample = reader->bitsPerSample <= 16 ? 16 : 24;
+
+    juce::MemoryBlock encoded;
+    {
+        juce::FlacAudioFormat flac;
+        auto* out = new juce::MemoryOutputStream (encoded, false);
+        std::unique_ptr<juce::AudioFormatWriter> writer (flac.createWriterFor (out, reader->sampleRate,
+                                                                               reader->numChannels,
+                                                                               bitsPerSample, {}, 0));
+        if (writer == nullptr)
+        {
+            delete out;
+            return false;
+        }
+
+        if (! writer->writeFromAudioReader (*reader, 0, reader->lengthInSamples))
+            return false;
+    }
+
+    if (encoded.getSize() >= fileData.getSize())
+        return false;
+
+    flacData = std::move (encoded);
+    return true;
+}
+
+//==============================================================================
+ProjectContainer::Writer::Writer (const juce::File& target)
+    : tempFile (target)
+{
+    stream = std::make_unique<juce::FileOutputStream> (tempFile.getFile());
+    if (! stream->openedOk())
+        return;
+
+    // Header; the index offset is patched in by commit()
+    stream->write (kMagic, 4);
+    stream->writeInt (static_cast<int> (kFormatVersion));
+    stream->writeInt64 (0);
+}
+
+bool ProjectContainer::Writer::addChunk (const juce::String& type, const juce::String& key, juce::uint32 flags,
+                                         const void* data, size_t size)
+{
+    if (! isOpen())
+        return false;
+
+    ChunkInfo info;
+    info.type = type;
+    info.key = key;
+    info.flags = flags;
+    info.offset = stream->getPosition();
+    info.size = static_cast<juce::int64> (size);
+
+    if (size > 0 && ! stream->write (data, size))
+        return false;
+
+    chunks.push_back (std::move (info));
+    return true;
+}
+
+juce::Result ProjectContainer::Writer::commit()
+{
+    if (! isOpen())
+        return juce::Result::fail ("Failed to open temporary file");
+
+    const auto indexOffset = stream->getPosition();
+    stream->writeInt (static_cast<int> (chunks.size()));
+    for (const auto& chunk : chunks)
+    {
+        writeType (*stream, chunk.type);
+        stream->writeString (chunk.key);
+        stream->writeInt (static_cast<int> (chunk.flags));
+        stream->writeInt64 (chunk.offset);
+        stream->writeInt64 (chunk.size);
+    }
+
+    if (! stream->setPosition (8))
+        return juce::Result::fail ("Failed to write project index");
+    stream->writeInt64 (indexOffset);
+    stream->flush();
+
+    const bool ok = stream->getStatus().wasOk();
+    stream = nullptr;
+
+    if (! ok || ! tempFile.overwriteTargetFileWithTemporary())
+        return juce::Result::fail ("Failed to write file: " + tempFile.getTargetFile().getFullPathName());
+
+    return juce::Result::ok();
+}
+
+//==============================================================================
+ProjectContainer::Reader::Reader (const juce::File& file)
+    : stream (std::make_unique<juce::FileInputStream> (file))
+{
+    if (! stream->openedOk())
+        return;
+
+    char magic[4] {};
+    if (stream->read (magic, 4) != 4 || std::memcmp (magic, kMagic, 4) != 0)
+        return;
+
+    const auto version = static_cast<juce::uint32> (stream->readInt());
+    const auto indexOffset = stream->readInt64();
+    const auto totalSize = stream->getTotalLength();
+
+    if (version > kFormatVersion || indexOffset < kHeaderSize || indexOffset >= totalSize
+        || ! stream->setPosition (indexOffset))
+        return;
+
+    const int numChunks = stream->readInt();
+    if (numChunks < 0)
+        return;
+
+    for (int i = 0; i < numChunks; ++i)
+    {
+        ChunkInfo info;
+        info.type = readType (*stream);
+        info.key = stream->readString();
+        info.flags = static_cast<juce::uint32> (stream->readInt());
+        info.offset = stream->readInt64();
+        info.size = stream->readInt64();
+
+        if (stream->isExhausted() && i < numChunks - 1)
+            return;
+        if (info.offset < kHeaderSize || info.size < 0 || info.offset + info.size > indexOffset)
+            return;
+
+        chunks.push_back (std::move (info));
+    }
+
+    valid = true;
+}
+
+const ProjectContainer::ChunkInfo* ProjectContainer::Reader::findChunk (const juce::String& type,
+                                                                       const juce::String& key) const
+{
+    for (const auto& chunk : chunks)
+        if (chunk.type == type && chunk.key == key)
+            return &chunk;
+
+    return nullptr;
+}
+
+bool ProjectContainer::Reader::readChunk (const ChunkInfo& chunk, juce::MemoryBlock& dest)
+{
+    if (! valid || ! stream->setPosition (chunk.offset))
+        return false;
+
+    dest.setSize (static_cast<size_t> (chunk.size));
+    return chunk.size == 0
+        || stream->read (dest.getData(), static_cast<size_t> (chunk.size)) == static_cast<int> (chunk.size);
+}
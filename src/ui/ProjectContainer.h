@@ -0,0 +1,105 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <JuceHeader.h>
+
+/**
+ * Chunked binary container used for .tkadj project files.
+ *
+ *   header   "TKAP", format version, index offset
+ *   chunks   raw payloads, back to back
+ *   index    type/key/flags/offset/size of every chunk
+ *
+ * The project itself is one compact chunk (a gzipped binary ValueTree); each
+ * distinct sample file is one chunk keyed by the SHA-256 of its contents, so
+ * instruments sharing a file store it once. Readers load the index and then
+ * seek straight to the chunks they need, so samples that are still on disk
+ * are never read from the project.
+ */
+class ProjectContainer
+{
+public:
+    static constexpr juce::uint32 kFormatVersion = 1;
+
+    // Chunk types
+    static constexpr const char* kProjectChunk = "PROJ";
+    static constexpr const char* kSampleChunk = "SMPL";
+
+    // Chunk flags
+    enum Flags : juce::uint32
+    {
+        gzipped     = 1 << 0,   // PROJ: payload is GZIP-compressed
+        flacEncoded = 1 << 1,   // SMPL: payload is a FLAC file, not the original bytes
+    };
+
+    struct ChunkInfo
+    {
+        juce::String type;
+        juce::String key;
+        juce::uint32 flags = 0;
+        juce::int64 offset = 0;
+        juce::int64 size = 0;
+    };
+
+    /** True if the file starts with the container magic (otherwise treat it as XML). */
+    static bool isContainer (const juce::File& file);
+
+    /** Hex SHA-256 of a blob, used as the sample chunk key. */
+    static juce::String hashData (const juce::MemoryBlock& data);
+
+    /**
+     * Re-encodes an uncompressed WAV/AIFF file as FLAC. Returns false (leave
+     * the original bytes) for float or compressed sources, or when FLAC
+     * doesn't make the blob smaller.
+     */
+    static bool encodeFlac (const juce::MemoryBlock& fileData, juce::MemoryBlock& flacData);
+
+    //==============================================================================
+    class Writer
+    {
+    public:
+        /** Writes to a temporary file next to target; commit() replaces the target. */
+        explicit Writer (const juce::File& target);
+
+        bool isOpen() const { return stream != nullptr && stream->openedOk(); }
+
+        bool addChunk (const juce::String& type, const juce::String& key, juce::uint32 flags,
+                       const void* data, size_t size);
+
+        /** Writes the index and moves the file into place. */
+        juce::Result commit();
+
+    private:
+        juce::TemporaryFile tempFile;
+        std::unique_ptr<juce::FileOutputStream> stream;
+        std::vector<ChunkInfo> chunks;
+
+        JUCE_DECLARE_NON_COPYABLE (Writer)
+    };
+
+    //==============================================================================
+    class Reader
+    {
+    public:
+        explicit Reader (const juce::File& file);
+
+        bool isValid() const { return valid; }
+        const std::vector<ChunkInfo>& getChunks() const { return chunks; }
+
+        const ChunkInfo* findChunk (const juce::String& type, const juce::String& key = {}) const;
+
+        /** Seeks to and reads one chunk's payload. */
+        bool readChunk (const ChunkInfo& chunk, juce::MemoryBlock& dest);
+
+    private:
+        std::unique_ptr<juce::FileInputStream> stream;
+        std::vector<ChunkInfo> chunks;
+        bool valid = false;
+
+        JUCE_DECLARE_NON_COPYABLE (Reader)
+    };
+
+private:
+    static constexpr int kHeaderSize = 16;   // magic, version, index offset
+};
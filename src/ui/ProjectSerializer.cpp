@@ -1,5 +1,6 @@
 #include <set>
 #include "ProjectSerializer.h"
+#include "ProjectContainer.h"
 
 juce::String ProjectSerializer::saveToFile (const juce::File& file, const PatternData& patternData,
                                             double bpm, int rowsPerBeat,
@@ -12,8 +13,20 @@ juce::String ProjectSerializer::saveToFile (const juce::File& file, const Patter
                                             const ReverbParams& reverbParams,
                                             int followMode,
                                             const juce::String& browserDir,
-                                            const std::map<int, InstrumentSlotInfo>* pluginSlots)
+                                            const std::map<int, InstrumentSlotInfo>* pluginSlots,
+                                            const SaveOptions& options)
 {
+    const bool writeXml = options.format == SaveOptions::Format::Xml
+                       || (options.format == SaveOptions::Format::Auto && file.hasFileExtension ("xml"));
+
+    // Binary: one chunk per distinct sample file, keyed by content hash
+    struct SampleBlob
+    {
+        juce::MemoryBlock data;
+        juce::uint32 flags = 0;
+    };
+    std::map<juce::String, SampleBlob> sampleBlobs;
+
     juce::ValueTree root ("TrackerAdjustProject");
     root.setProperty ("version", 9, nullptr);
 
@@ -28,7 +41,7 @@ juce::String ProjectSerializer::saveToFile (const juce::File& file, const Patter
         settings.setProperty ("browserDir", browserDir, nullptr);
     root.addChild (settings, -1, nullptr);
 
-    // Samples (embedded as base64 for self-contained projects)
+    // Samples (embedded for self-contained projects)
     juce::ValueTree samples ("Samples");
     for (auto& [index, sampleFile] : loadedSamples)
     {
@@ -38,10 +51,30 @@ juce::String ProjectSerializer::saveToFile (const juce::File& file, const Patter
         sample.setProperty ("absPath", sampleFile.getFullPathName(), nullptr);
         sample.setProperty ("filename", sampleFile.getFileName(), nullptr);
 
-        // Embed sample data as base64 for self-contained projects
         juce::MemoryBlock fileData;
         if (sampleFile.existsAsFile() && sampleFile.loadFileAsData (fileData))
-            sample.setProperty ("data", fileData.toBase64Encoding(), nullptr);
+        {
+            if (writeXml)
+            {
+                sample.setProperty ("data", fileData.toBase64Encoding(), nullptr);
+            }
+            else
+            {
+                auto hash = ProjectContainer::hashData (fileData);
+                sample.setProperty ("hash", hash, nullptr);
+
+                if (sampleBlobs.find (hash) == sampleBlobs.end())
+                {
+                    SampleBlob blob;
+                    if (options.compressSamples && ProjectContainer::encodeFlac (fileData, blob.data))
+                        blob.flags = ProjectContainer::flacEncoded;
+                    else
+                        blob.data = std::move (fileData);
+
+                    sampleBlobs[hash] = std::move (blob);
+                }
+            }
+        }
 
         samples.addChild (sample, -1, nullptr);
     }
@@ -82,12 +115,16 @@ juce::String ProjectSerializer::saveToFile (const juce::File& file, const Patter
         // Playback
         paramTree.setProperty ("playMode", static_cast<int> (params.playMode), nullptr);
         paramTree.setProperty ("reversed", params.reversed, nullptr);
+        paramTree.setProperty ("interp", static_cast<int> (params.interpolation), nullptr);
 
         // Granular
         paramTree.setProperty ("grainPos", params.granularPosition, nullptr);
         paramTree.setProperty ("grainLen", params.granularLength, nullptr);
         paramTree.setProperty ("grainShape", static_cast<int> (params.granularShape), nullptr);
         paramTree.setProperty ("grainLoop", static_cast<int> (params.granularLoop), nullptr);
+        paramTree.setProperty ("grainDensity", params.granularDensity, nullptr);
+        paramTree.setProperty ("grainSpray", params.granularSpray, nullptr);
+        paramTree.setProperty ("grainPitch", params.granularPitch, nullptr);
 
         // Slices
         if (! params.slicePoints.empty())
@@ -414,6 +451,7 @@ juce::String ProjectSerializer::saveToFile (const juce::File& file, const Patter
         masterTree.setProperty ("compRelease", mixerState.master.compRelease, nullptr);
         masterTree.setProperty ("limiterThresh", mixerState.master.limiterThreshold, nullptr);
         masterTree.setProperty ("limiterRelease", mixerState.master.limiterRelease, nullptr);
+        masterTree.setProperty ("limiterLookahead", mixerState.master.limiterLookahead, nullptr);
         root.addChild (masterTree, -1, nullptr);
     }
 
@@ -501,14 +539,41 @@ juce::String ProjectSerializer::saveToFile (const juce::File& file, const Patter
     root.addChild (patterns, -1, nullptr);
 
     // Write to file
-    auto xml = root.createXml();
-    if (xml == nullptr)
-        return "Failed to create XML";
+    if (writeXml)
+    {
+        auto xml = root.createXml();
+        if (xml == nullptr)
+            return "Failed to create XML";
+
+        if (! xml->writeTo (file))
+            return "Failed to write file: " + file.getFullPathName();
 
-    if (! xml->writeTo (file))
+        return {};
+    }
+
+    juce::MemoryBlock projectData;
+    {
+        juce::MemoryOutputStream raw (projectData, false);
+        juce::GZIPCompressorOutputStream gzip (raw);
+        root.writeToStream (gzip);
+    }
+
+    ProjectContainer::Writer writer (file);
+    if (! writer.isOpen())
         return "Failed to write file: " + file.getFullPathName();
 
-    return {};
+    bool written = writer.addChunk (ProjectContainer::kProjectChunk, {}, ProjectContainer::gzipped,
+                                    projectData.getData(), projectData.getSize());
+
+    for (auto& [hash, blob] : sampleBlobs)
+        written = written && writer.addChunk (ProjectContainer::kSampleChunk, hash, blob.flags,
+                                              blob.data.getData(), blob.data.getSize());
+
+    if (! written)
+        return "Failed to write file: " + file.getFullPathName();
+
+    auto result = writer.commit();
+    return result.wasOk() ? juce::String() : result.getErrorMessage();
 }
 
 juce::String ProjectSerializer::loadFromFile (const juce::File& file, PatternData& patternData,
@@ -524,11 +589,38 @@ juce::String ProjectSerializer::loadFromFile (const juce::File& file, PatternDat
                                               juce::String* browserDir,
                                               std::map<int, InstrumentSlotInfo>* pluginSlots)
 {
-    auto xml = juce::XmlDocument::parse (file);
-    if (xml == nullptr)
-        return "Failed to parse XML file";
+    juce::ValueTree root;
+    std::unique_ptr<ProjectContainer::Reader> container;
+
+    if (ProjectContainer::isContainer (file))
+    {
+        container = std::make_unique<ProjectContainer::Reader> (file);
+
+        juce::MemoryBlock projectData;
+        auto* chunk = container->isValid() ? container->findChunk (ProjectContainer::kProjectChunk) : nullptr;
+        if (chunk == nullptr || ! container->readChunk (*chunk, projectData))
+            return "Failed to read project file";
+
+        if ((chunk->flags & ProjectContainer::gzipped) != 0)
+        {
+            juce::MemoryInputStream raw (projectData, false);
+            juce::GZIPDecompressorInputStream gzip (raw);
+            root = juce::ValueTree::readFromStream (gzip);
+        }
+        else
+        {
+            root = juce::ValueTree::readFromData (projectData.getData(), projectData.getSize());
+        }
+    }
+    else
+    {
+        auto xml = juce::XmlDocument::parse (file);
+        if (xml == nullptr)
+            return "Failed to parse XML file";
+
+        root = juce::ValueTree::fromXml (*xml);
+    }
 
-    auto root = juce::ValueTree::fromXml (*xml);
     if (! root.hasType ("TrackerAdjustProject"))
         return "Not a valid Tracker Adjust project file";
 
@@ -564,7 +656,30 @@ juce::String ProjectSerializer::loadFromFile (const juce::File& file, PatternDat
             if (! sampleFile.existsAsFile())
                 sampleFile = file.getParentDirectory().getChildFile (relPath);
 
-            // If file not found on disk, extract from embedded data
+            // If file not found on disk, extract from the project's sample chunk
+            // (binary) or embedded data (XML)
+            const juce::String hash = sample.getProperty ("hash", "").toString();
+            if (! sampleFile.existsAsFile() && container != nullptr && hash.isNotEmpty())
+            {
+                if (auto* chunk = container->findChunk (ProjectContainer::kSampleChunk, hash))
+                {
+                    juce::String filename = sample.getProperty ("filename", "").toString();
+                    if (filename.isEmpty())
+                        filename = "sample_" + juce::String (index) + ".wav";
+                    if ((chunk->flags & ProjectContainer::flacEncoded) != 0)
+                        filename = filename.upToLastOccurrenceOf (".", false, false) + ".flac";
+
+                    auto samplesDir = file.getParentDirectory().getChildFile (
+                        file.getFileNameWithoutExtension() + "_samples");
+                    samplesDir.createDirectory();
+                    sampleFile = samplesDir.getChildFile (filename);
+
+                    juce::MemoryBlock blob;
+                    if (! sampleFile.existsAsFile() && container->readChunk (*chunk, blob))
+                        sampleFile.replaceWithData (blob.getData(), blob.getSize());
+                }
+            }
+
             if (! sampleFile.existsAsFile())
             {
                 juce::String base64Data = sample.getProperty ("data", "").toString();
@@ -642,6 +757,12 @@ juce::String ProjectSerializer::loadFromFile (const juce::File& file, PatternDat
                 }
                 params.reversed   = paramTree.getProperty ("reversed", false);
 
+                {
+                    int interp = static_cast<int> (paramTree.getProperty ("interp", 0));
+                    if (interp >= 0 && interp <= static_cast<int> (InstrumentParams::Interpolation::Sinc))
+                        params.interpolation = static_cast<InstrumentParams::Interpolation> (interp);
+                }
+
                 // wtWindow / wtPosition properties are ignored (wavetable mode removed)
 
                 params.granularPosition = paramTree.getProperty ("grainPos", 0.0);
@@ -650,6 +771,9 @@ juce::String ProjectSerializer::loadFromFile (const juce::File& file, PatternDat
                     static_cast<int> (paramTree.getProperty ("grainShape", 1)));
                 params.granularLoop     = static_cast<InstrumentParams::GranLoop> (
                     static_cast<int> (paramTree.getProperty ("grainLoop", 0)));
+                params.granularDensity  = juce::jlimit (1, 16, static_cast<int> (paramTree.getProperty ("grainDensity", 1)));
+                params.granularSpray    = juce::jlimit (0, 100, static_cast<int> (paramTree.getProperty ("grainSpray", 0)));
+                params.granularPitch    = juce::jlimit (0, 1200, static_cast<int> (paramTree.getProperty ("grainPitch", 0)));
 
                 // Slices
                 juce::String sliceStr = paramTree.getProperty ("slices", "");
@@ -984,6 +1108,7 @@ juce::String ProjectSerializer::loadFromFile (const juce::File& file, PatternDat
         mixerState.master.compRelease    = masterTree.getProperty ("compRelease", 100.0);
         mixerState.master.limiterThreshold = masterTree.getProperty ("limiterThresh", 0.0);
         mixerState.master.limiterRelease = masterTree.getProperty ("limiterRelease", 50.0);
+        mixerState.master.limiterLookahead = masterTree.getProperty ("limiterLookahead", 0.0);
     }
 
     // Master insert plugin slots (V9+)
@@ -1118,7 +1243,7 @@ juce::ValueTree ProjectSerializer::patternToValueTree (const Pattern& pattern, i
         bool hasData = false;
         for (int t = 0; t < kNumTracks; ++t)
         {
-            if (! pattern.getCell (r, t).isEmpty())
+            if (! pattern.getCellView (r, t).isEmpty())
             {
                 hasData = true;
                 break;
@@ -1487,3 +1612,279 @@ juce::StringArray ProjectSerializer::loadGlobalPluginScanPaths()
 
     return paths;
 }
+
+//==============================================================================
+// Global render threading persistence
+//==============================================================================
+
+void ProjectSerializer::saveGlobalRenderThreading (int numCpus, int threadPoolStrategy)
+{
+    auto prefsFile = getGlobalPrefsFile();
+    if (! prefsFile.getParentDirectory().createDirectory())
+        return;
+
+    juce::ValueTree root ("TrackerAdjustPrefs");
+
+    // Load existing prefs if any
+    if (prefsFile.existsAsFile())
+    {
+        auto xml = juce::XmlDocument::parse (prefsFile);
+        if (xml != nullptr)
+        {
+            auto loaded = juce::ValueTree::fromXml (*xml);
+            if (loaded.isValid())
+                root = loaded;
+        }
+    }
+
+    root.setProperty ("renderCpus", numCpus, nullptr);
+    root.setProperty ("renderThreadPool", threadPoolStrategy, nullptr);
+
+    if (auto xml = root.createXml())
+        xml->writeTo (prefsFile);
+}
+
+bool ProjectSerializer::loadGlobalRenderThreading (int& numCpus, int& threadPoolStrategy)
+{
+    auto prefsFile = getGlobalPrefsFile();
+    if (! prefsFile.existsAsFile())
+        return false;
+
+    auto xml = juce::XmlDocument::parse (prefsFile);
+    if (xml == nullptr)
+        return false;
+
+    auto root = juce::ValueTree::fromXml (*xml);
+    if (! root.isValid() || ! root.hasProperty ("renderCpus"))
+        return false;
+
+    numCpus = static_cast<int> (root.getProperty ("renderCpus", 0));
+    threadPoolStrategy = static_cast<int> (root.getProperty ("renderThreadPool", threadPoolStrategy));
+    return true;
+}
+
+//==============================================================================
+// Global sample memory format persistence
+//==============================================================================
+
+void ProjectSerializer::saveGlobalSample16Bit (bool use16Bit)
+{
+    auto prefsFile = getGlobalPrefsFile();
+    if (! prefsFile.getParentDirectory().createDirectory())
+        return;
+
+    juce::ValueTree root ("TrackerAdjustPrefs");
+
+    // Load existing prefs if any
+    if (prefsFile.existsAsFile())
+    {
+        auto xml = juce::XmlDocument::parse (prefsFile);
+        if (xml != nullptr)
+        {
+            auto loaded = juce::ValueTree::fromXml (*xml);
+            if (loaded.isValid())
+                root = loaded;
+        }
+    }
+
+    root.setProperty ("sample16Bit", use16Bit, nullptr);
+
+    if (auto xml = root.createXml())
+        xml->writeTo (prefsFile);
+}
+
+bool ProjectSerializer::loadGlobalSample16Bit()
+{
+    auto prefsFile = getGlobalPrefsFile();
+    if (! prefsFile.existsAsFile())
+        return false;
+
+    auto xml = juce::XmlDocument::parse (prefsFile);
+    if (xml == nullptr)
+        return false;
+
+    auto root = juce::ValueTree::fromXml (*xml);
+    return root.isValid() && static_cast<bool> (root.getProperty ("sample16Bit", false));
+}
+
+void ProjectSerializer::saveGlobalSampleMipMaps (bool buildMipMaps)
+{
+    auto prefsFile = getGlobalPrefsFile();
+    if (! prefsFile.getParentDirectory().createDirectory())
+        return;
+
+    juce::ValueTree root ("TrackerAdjustPrefs");
+
+    // Load existing prefs if any
+    if (prefsFile.existsAsFile())
+    {
+        auto xml = juce::XmlDocument::parse (prefsFile);
+        if (xml != nullptr)
+        {
+            auto loaded = juce::ValueTree::fromXml (*xml);
+            if (loaded.isValid())
+                root = loaded;
+        }
+    }
+
+    root.setProperty ("sampleMipMaps", buildMipMaps, nullptr);
+
+    if (auto xml = root.createXml())
+        xml->writeTo (prefsFile);
+}
+
+bool ProjectSerializer::loadGlobalSampleMipMaps()
+{
+    auto prefsFile = getGlobalPrefsFile();
+    if (! prefsFile.existsAsFile())
+        return false;
+
+    auto xml = juce::XmlDocument::parse (prefsFile);
+    if (xml == nullptr)
+        return false;
+
+    auto root = juce::ValueTree::fromXml (*xml);
+    return root.isValid() && static_cast<bool> (root.getProperty ("sampleMipMaps", false));
+}
+
+//==============================================================================
+// Global sampler voice pool persistence
+//==============================================================================
+
+void ProjectSerializer::saveGlobalVoiceLimits (int polyphony, int stealingMode)
+{
+    auto prefsFile = getGlobalPrefsFile();
+    if (! prefsFile.getParentDirectory().createDirectory())
+        return;
+
+    juce::ValueTree root ("TrackerAdjustPrefs");
+
+    // Load existing prefs if any
+    if (prefsFile.existsAsFile())
+    {
+        auto xml = juce::XmlDocument::parse (prefsFile);
+        if (xml != nullptr)
+        {
+            auto loaded = juce::ValueTree::fromXml (*xml);
+            if (loaded.isValid())
+                root = loaded;
+        }
+    }
+
+    root.setProperty ("samplerVoices", polyphony, nullptr);
+    root.setProperty ("voiceStealing", stealingMode, nullptr);
+
+    if (auto xml = root.createXml())
+        xml->writeTo (prefsFile);
+}
+
+bool ProjectSerializer::loadGlobalVoiceLimits (int& polyphony, int& stealingMode)
+{
+    auto prefsFile = getGlobalPrefsFile();
+    if (! prefsFile.existsAsFile())
+        return false;
+
+    auto xml = juce::XmlDocument::parse (prefsFile);
+    if (xml == nullptr)
+        return false;
+
+    auto root = juce::ValueTree::fromXml (*xml);
+    if (! root.isValid() || ! root.hasProperty ("samplerVoices"))
+        return false;
+
+    polyphony = static_cast<int> (root.getProperty ("samplerVoices", polyphony));
+    stealingMode = static_cast<int> (root.getProperty ("voiceStealing", stealingMode));
+    return true;
+}
+
+//==============================================================================
+// Global pattern playback persistence
+//==============================================================================
+
+void ProjectSerializer::saveGlobalRealtimeSequencing (bool shouldSequence)
+{
+    auto prefsFile = getGlobalPrefsFile();
+    if (! prefsFile.getParentDirectory().createDirectory())
+        return;
+
+    juce::ValueTree root ("TrackerAdjustPrefs");
+
+    // Load existing prefs if any
+    if (prefsFile.existsAsFile())
+    {
+        auto xml = juce::XmlDocument::parse (prefsFile);
+        if (xml != nullptr)
+        {
+            auto loaded = juce::ValueTree::fromXml (*xml);
+            if (loaded.isValid())
+                root = loaded;
+        }
+    }
+
+    root.setProperty ("realtimeSequencing", shouldSequence, nullptr);
+
+    if (auto xml = root.createXml())
+        xml->writeTo (prefsFile);
+}
+
+bool ProjectSerializer::loadGlobalRealtimeSequencing()
+{
+    auto prefsFile = getGlobalPrefsFile();
+    if (! prefsFile.existsAsFile())
+        return false;
+
+    auto xml = juce::XmlDocument::parse (prefsFile);
+    if (xml == nullptr)
+        return false;
+
+    auto root = juce::ValueTree::fromXml (*xml);
+    return root.isValid() && static_cast<bool> (root.getProperty ("realtimeSequencing", false));
+}
+
+//==============================================================================
+// Global undo history persistence
+//==============================================================================
+
+void ProjectSerializer::saveGlobalUndoHistoryLimit (int megabytes)
+{
+    auto prefsFile = getGlobalPrefsFile();
+    if (! prefsFile.getParentDirectory().createDirectory())
+        return;
+
+    juce::ValueTree root ("TrackerAdjustPrefs");
+
+    // Load existing prefs if any
+    if (prefsFile.existsAsFile())
+    {
+        auto xml = juce::XmlDocument::parse (prefsFile);
+        if (xml != nullptr)
+        {
+            auto loaded = juce::ValueTree::fromXml (*xml);
+            if (loaded.isValid())
+                root = loaded;
+        }
+    }
+
+    root.setProperty ("undoHistoryMB", megabytes, nullptr);
+
+    if (auto xml = root.createXml())
+        xml->writeTo (prefsFile);
+}
+
+bool ProjectSerializer::loadGlobalUndoHistoryLimit (int& megabytes)
+{
+    auto prefsFile = getGlobalPrefsFile();
+    if (! prefsFile.existsAsFile())
+        return false;
+
+    auto xml = juce::XmlDocument::parse (prefsFile);
+    if (xml == nullptr)
+        return false;
+
+    auto root = juce::ValueTree::fromXml (*xml);
+    if (! root.isValid() || ! root.hasProperty ("undoHistoryMB"))
+        return false;
+
+    megabytes = static_cast<int> (root.getProperty ("undoHistoryMB", megabytes));
+    return true;
+}
@@ -13,6 +13,16 @@
 class ProjectSerializer
 {
 public:
+    struct SaveOptions
+    {
+        // Auto writes .xml files as XML (import/export) and anything else as
+        // the chunked binary container (see ProjectContainer)
+        enum class Format { Auto, Binary, Xml };
+
+        Format format = Format::Auto;
+        bool compressSamples = false;   // FLAC-encode WAV/AIFF sample chunks (binary only)
+    };
+
     static juce::String saveToFile (const juce::File& file, const PatternData& patternData,
                                     double bpm, int rowsPerBeat,
                                     const std::map<int, juce::File>& loadedSamples,
@@ -24,8 +34,11 @@ public:
                                     const ReverbParams& reverbParams,
                                     int followMode = 0,
                                     const juce::String& browserDir = {},
-                                    const std::map<int, InstrumentSlotInfo>* pluginSlots = nullptr);
+                                    const std::map<int, InstrumentSlotInfo>* pluginSlots = nullptr,
+                                    const SaveOptions& options = {});
 
+    // Reads either format; embedded samples are only extracted (next to the
+    // project, in <name>_samples) when the original file can't be found.
     static juce::String loadFromFile (const juce::File& file, PatternData& patternData,
                                       double& bpm, int& rowsPerBeat,
                                       std::map<int, juce::File>& loadedSamples,
@@ -47,6 +60,28 @@ public:
     static void saveGlobalPluginScanPaths (const juce::StringArray& paths);
     static juce::StringArray loadGlobalPluginScanPaths();
 
+    // Global render threading (CPU count, 0 = engine default; ThreadPoolStrategy index)
+    static void saveGlobalRenderThreading (int numCpus, int threadPoolStrategy);
+    static bool loadGlobalRenderThreading (int& numCpus, int& threadPoolStrategy);
+
+    // Global sample memory format (true = keep decoded samples as 16-bit)
+    static void saveGlobalSample16Bit (bool use16Bit);
+    static bool loadGlobalSample16Bit();
+    static void saveGlobalSampleMipMaps (bool buildMipMaps);
+    static bool loadGlobalSampleMipMaps();
+
+    // Global sampler voice pool (polyphony per track, stealing mode index)
+    static void saveGlobalVoiceLimits (int polyphony, int stealingMode);
+    static bool loadGlobalVoiceLimits (int& polyphony, int& stealingMode);
+
+    // Global pattern playback (true = realtime sequencer, false = MIDI clips)
+    static void saveGlobalRealtimeSequencing (bool shouldSequence);
+    static bool loadGlobalRealtimeSequencing();
+
+    // Global undo history memory cap (megabytes)
+    static void saveGlobalUndoHistoryLimit (int megabytes);
+    static bool loadGlobalUndoHistoryLimit (int& megabytes);
+
 private:
     static juce::ValueTree patternToValueTree (const Pattern& pattern, int index);
     static void valueTreeToPattern (const juce::ValueTree& tree, Pattern& pattern, int version);
@@ -238,6 +238,9 @@ bool SampleEditorComponent::isRealtimeOnlyChange (const InstrumentParams& oldP,
     if (oldP.granularLength != newP.granularLength) return false;
     if (oldP.granularShape != newP.granularShape) return false;
     if (oldP.granularLoop != newP.granularLoop) return false;
+    if (oldP.granularDensity != newP.granularDensity) return false;
+    if (oldP.granularSpray != newP.granularSpray) return false;
+    if (oldP.granularPitch != newP.granularPitch) return false;
     if (oldP.slicePoints != newP.slicePoints) return false;
     // Everything else (volume, pan, filter, overdrive, bitDepth, sends, modulations)
     // is handled by InstrumentEffectsPlugin reading from the params map each block
@@ -330,6 +333,17 @@ juce::String SampleEditorComponent::getFilterTypeName (InstrumentParams::FilterT
     return "???";
 }
 
+juce::String SampleEditorComponent::getInterpolationName (InstrumentParams::Interpolation interpolation) const
+{
+    switch (interpolation)
+    {
+        case InstrumentParams::Interpolation::Linear:  return "Linear";
+        case InstrumentParams::Interpolation::Hermite: return "Hermite";
+        case InstrumentParams::Interpolation::Sinc:    return "Sinc";
+    }
+    return "???";
+}
+
 juce::String SampleEditorComponent::getModTypeName (InstrumentParams::Modulation::Type type) const
 {
     switch (type)
@@ -437,7 +451,7 @@ int SampleEditorComponent::getColumnCount() const
     if (displayMode == DisplayMode::InstrumentEdit)
     {
         if (editSubTab == EditSubTab::Parameters)
-            return 11; // Vol, Pan, Tune, Fine, Filter, Cutoff, Rez, OD, BitDepth, RevSend, DlySend
+            return 12; // Vol, Pan, Tune, Fine, Filter, Cutoff, Rez, OD, BitDepth, RevSend, DlySend, Interp
         else
             return 8; // Modulation page
     }
@@ -452,7 +466,7 @@ int SampleEditorComponent::getColumnCount() const
             case InstrumentParams::PlayMode::PingpongLoop:                  return 5;
             case InstrumentParams::PlayMode::Slice:                          return 7; // Start, End, Slices, Sel, AutoSlice, EqChop, PlayMode
             case InstrumentParams::PlayMode::BeatSlice:                     return 7; // Start, End, NumSlices, Sel, AutoSlice, EqChop, PlayMode
-            case InstrumentParams::PlayMode::Granular:                      return 7;
+            case InstrumentParams::PlayMode::Granular:                      return 10; // Pos, Len, Shape, Loop, Density, Spray, Pitch
         }
         return 4;
     }
@@ -470,8 +484,8 @@ juce::String SampleEditorComponent::getColumnName (int col) const
         {
             const char* names[] = { "Volume", "Panning", "Tune", "Finetune", "Filter",
                                     "Cutoff", "Resonance", "Overdrive", "Bit Depth",
-                                    "Reverb Send", "Delay Send" };
-            if (col >= 0 && col < 11) return names[col];
+                                    "Reverb Send", "Delay Send", "Interpolation" };
+            if (col >= 0 && col < 12) return names[col];
         }
         else // Modulation
         {
@@ -532,8 +546,9 @@ juce::String SampleEditorComponent::getColumnName (int col) const
             }
             case InstrumentParams::PlayMode::Granular:
             {
-                const char* n[] = { "Start", "End", "Grain Pos", "Grain Len", "Shape", "Loop" };
-                if (col < 6) return n[col];
+                const char* n[] = { "Start", "End", "Grain Pos", "Grain Len", "Shape", "Loop",
+                                    "Density", "Spray", "Pitch" };
+                if (col < 9) return n[col];
                 break;
             }
         }
@@ -563,6 +578,7 @@ juce::String SampleEditorComponent::getColumnValue (int col) const
                 case 8: return juce::String (currentParams.bitDepth);
                 case 9: return formatDb (currentParams.reverbSend);
                 case 10: return formatDb (currentParams.delaySend);
+                case 11: return getInterpolationName (currentParams.interpolation);
             }
         }
         else // Modulation
@@ -670,6 +686,9 @@ juce::String SampleEditorComponent::getColumnValue (int col) const
                     case 3: return juce::String (currentParams.granularLength) + "ms";
                     case 4: return getGranShapeName (currentParams.granularShape);
                     case 5: return getGranLoopName (currentParams.granularLoop);
+                    case 6: return juce::String (currentParams.granularDensity) + "x";
+                    case 7: return juce::String (currentParams.granularSpray) + "%";
+                    case 8: return juce::String (currentParams.granularPitch) + "ct";
                 }
                 break;
         }
@@ -1078,12 +1097,12 @@ void SampleEditorComponent::drawBarMeter (juce::Graphics& g, juce::Rectangle<int
 }
 
 //==============================================================================
-// Drawing: Parameters page (merged General + Effects = 11 columns)
+// Drawing: Parameters page (merged General + Effects = 12 columns)
 //==============================================================================
 
 void SampleEditorComponent::drawParametersPage (juce::Graphics& g, juce::Rectangle<int> area)
 {
-    int numCols = 11;
+    int numCols = 12;
     int colW = area.getWidth() / numCols;
     auto greenCol = lookAndFeel.findColour (TrackerLookAndFeel::volumeColourId);
     auto blueCol = lookAndFeel.findColour (TrackerLookAndFeel::fxColourId);
@@ -1140,6 +1159,11 @@ void SampleEditorComponent::drawParametersPage (juce::Graphics& g, juce::Rectang
     // Col 10: Delay Send (-100..0 dB)
     float dly01 = static_cast<float> ((currentParams.delaySend + 100.0) / 100.0);
     drawBarMeter (g, colRect (10), dly01, parametersColumn == 10, blueCol);
+
+    // Col 11: Interpolation list
+    juce::StringArray interpItems = { "Linear", "Hermite", "Sinc" };
+    int interpIdx = static_cast<int> (currentParams.interpolation);
+    drawListColumn (g, colRect (11), interpItems, interpIdx, parametersColumn == 11, textCol);
 }
 
 //==============================================================================
@@ -1367,6 +1391,12 @@ void SampleEditorComponent::adjustCurrentValue (int direction, bool fine, bool l
                         currentParams.delaySend + direction * step);
                     break;
                 }
+                case 11: // Interpolation
+                {
+                    int v = (static_cast<int> (currentParams.interpolation) + direction + 3) % 3;
+                    currentParams.interpolation = static_cast<InstrumentParams::Interpolation> (v);
+                    break;
+                }
             }
         }
         else // Modulation
@@ -1679,6 +1709,27 @@ void SampleEditorComponent::adjustCurrentValue (int direction, bool fine, bool l
                         currentParams.granularLoop = static_cast<InstrumentParams::GranLoop> (v);
                         break;
                     }
+                    case 6: // Density
+                    {
+                        int step = large ? 4 : 1;
+                        currentParams.granularDensity = juce::jlimit (1, 16,
+                            currentParams.granularDensity + direction * step);
+                        break;
+                    }
+                    case 7: // Spray
+                    {
+                        int step = fine ? 1 : (large ? 20 : 5);
+                        currentParams.granularSpray = juce::jlimit (0, 100,
+                            currentParams.granularSpray + direction * step);
+                        break;
+                    }
+                    case 8: // Pitch spray
+                    {
+                        int step = fine ? 1 : (large ? 100 : 10);
+                        currentParams.granularPitch = juce::jlimit (0, 1200,
+                            currentParams.granularPitch + direction * step);
+                        break;
+                    }
                 }
                 break;
             }
@@ -1748,6 +1799,14 @@ void SampleEditorComponent::adjustCurrentValueByDelta (double normDelta)
                     currentParams.delaySend = juce::jlimit (-100.0, 0.0,
                         currentParams.delaySend + normDelta * 100.0);
                     break;
+                case 11: // Interpolation (list - drag inverted)
+                {
+                    int v = static_cast<int> (currentParams.interpolation)
+                            - juce::roundToInt (normDelta * 3.0);
+                    currentParams.interpolation = static_cast<InstrumentParams::Interpolation> (
+                        juce::jlimit (0, 2, v));
+                    break;
+                }
             }
         }
         else // Modulation
@@ -1995,6 +2054,18 @@ void SampleEditorComponent::adjustCurrentValueByDelta (double normDelta)
                             juce::jlimit (0, 2, v));
                         break;
                     }
+                    case 6:
+                        currentParams.granularDensity = juce::jlimit (1, 16,
+                            currentParams.granularDensity + juce::roundToInt (normDelta * 15.0));
+                        break;
+                    case 7:
+                        currentParams.granularSpray = juce::jlimit (0, 100,
+                            currentParams.granularSpray + juce::roundToInt (normDelta * 100.0));
+                        break;
+                    case 8:
+                        currentParams.granularPitch = juce::jlimit (0, 1200,
+                            currentParams.granularPitch + juce::roundToInt (normDelta * 1200.0));
+                        break;
                 }
                 break;
         }
@@ -2012,7 +2083,7 @@ bool SampleEditorComponent::isCurrentColumnDiscrete() const
     if (displayMode == DisplayMode::InstrumentEdit)
     {
         if (editSubTab == EditSubTab::Parameters)
-            return parametersColumn == 4; // Filter type list
+            return parametersColumn == 4 || parametersColumn == 11; // Filter type / interpolation lists
 
         // Modulation
         if (modColumn <= 2) return true; // Destination, Type, Mode are always lists
@@ -2039,7 +2110,7 @@ bool SampleEditorComponent::isCurrentColumnDiscrete() const
         if ((mode == InstrumentParams::PlayMode::Slice || mode == InstrumentParams::PlayMode::BeatSlice)
             && playbackColumn >= 2)
             return true; // Slices count, Selected slice
-        if (mode == InstrumentParams::PlayMode::Granular && playbackColumn >= 4)
+        if (mode == InstrumentParams::PlayMode::Granular && (playbackColumn == 4 || playbackColumn == 5))
             return true; // Shape, Loop
         return false;
     }
@@ -2308,7 +2379,7 @@ bool SampleEditorComponent::keyPressed (const juce::KeyPress& key)
             else
             {
                 setEditSubTab (EditSubTab::Parameters);
-                parametersColumn = 10; // last parameters column (11 cols, 0-10)
+                parametersColumn = 11; // last parameters column (12 cols, 0-11)
             }
             repaint();
         }
@@ -2730,6 +2801,17 @@ void SampleEditorComponent::mouseDown (const juce::MouseEvent& event)
                 return;
             }
 
+            // Interpolation list clicks (col 11)
+            if (editSubTab == EditSubTab::Parameters && col == 11)
+            {
+                int relY = event.y - contentTop;
+                int itemIdx = relY / juce::jmax (1, kListItemHeight);
+                if (itemIdx >= 0 && itemIdx < 3)
+                    currentParams.interpolation = static_cast<InstrumentParams::Interpolation> (itemIdx);
+                notifyParamsChanged();
+                return;
+            }
+
             // Click-to-set for bar columns: set value based on click Y position
             if (! isCurrentColumnDiscrete())
             {
@@ -194,6 +194,7 @@ private:
     // String helpers
     juce::String getPlayModeName (InstrumentParams::PlayMode mode) const;
     juce::String getFilterTypeName (InstrumentParams::FilterType type) const;
+    juce::String getInterpolationName (InstrumentParams::Interpolation interpolation) const;
     juce::String getModTypeName (InstrumentParams::Modulation::Type type) const;
     juce::String getLfoShapeName (InstrumentParams::Modulation::LFOShape shape) const;
     juce::String getModDestFullName (int dest) const;
@@ -1291,7 +1291,10 @@ void TrackerGrid::mouseUp (const juce::MouseEvent& event)
             auto after = trackLayout.createSnapshot();
             changed = ! TrackLayout::snapshotsEqual (layoutDragStartSnapshot, after);
             if (changed && undoManager != nullptr)
+            {
+                undoManager->beginNewTransaction();
                 undoManager->perform (new TrackLayoutEditAction (trackLayout, layoutDragStartSnapshot, after));
+            }
         }
 
         isDraggingGroupBorder = false;
@@ -1312,7 +1315,10 @@ void TrackerGrid::mouseUp (const juce::MouseEvent& event)
             auto after = trackLayout.createSnapshot();
             changed = ! TrackLayout::snapshotsEqual (layoutDragStartSnapshot, after);
             if (changed && undoManager != nullptr)
+            {
+                undoManager->beginNewTransaction();
                 undoManager->perform (new TrackLayoutEditAction (trackLayout, layoutDragStartSnapshot, after));
+            }
         }
 
         // Header drag complete -- layout already updated during drag
@@ -1416,13 +1422,16 @@ void TrackerGrid::mouseUp (const juce::MouseEvent& event)
                 }
 
                 if (undoManager != nullptr && ! records.empty())
+                {
+                    undoManager->beginNewTransaction();
                     undoManager->perform (new MultiCellEditAction (pattern, pattern.getCurrentPatternIndex(), std::move (records)));
+                }
                 else
                 {
                     // Fallback: apply directly
                     for (int r = minRow; r <= maxRow; ++r)
                         for (int vi = minViTrack; vi <= maxViTrack; ++vi)
-                            pat.getCell (r, trackLayout.visualToPhysical (vi)).clear();
+                            pat.setCell (r, trackLayout.visualToPhysical (vi), Cell {});
                     for (int r = 0; r < selRows; ++r)
                     {
                         int dr = destRow + r;
@@ -1432,7 +1441,7 @@ void TrackerGrid::mouseUp (const juce::MouseEvent& event)
                             int dvi = destViTrack + t;
                             if (dvi < 0 || dvi >= kNumTracks) continue;
                             int dphys = trackLayout.visualToPhysical (dvi);
-                            pat.getCell (dr, dphys) = buffer[static_cast<size_t> (r)][static_cast<size_t> (t)];
+                            pat.setCell (dr, dphys, buffer[static_cast<size_t> (r)][static_cast<size_t> (t)]);
                         }
                     }
                 }
@@ -0,0 +1,1393 @@
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include <JuceHeader.h>
+#include <tracktion_engine/tracktion_engine.h>
+
+#include "Clipboard.h"
+#include "Dynamics.h"
+#include "PatternData.h"
+#include "PatternTrackBlock.h"
+#include "ProjectSerializer.h"
+#include "SampleBank.h"
+#include "SampleResampler.h"
+#include "SendBuffers.h"
+#include "SilenceGate.h"
+#include "ThreeBandEQ.h"
+
+#if JUCE_INTEL
+ #if JUCE_MSVC
+  #include <intrin.h>
+ #else
+  #include <x86intrin.h>
+ #endif
+#endif
+
+namespace te = tracktion;
+
+// Microbenchmarks for hot audio-thread kernels. Not part of ctest; run
+//   TrackerAdjustBenchmarks [filter]
+// from a Release build and compare the before/after lines of each group.
+
+namespace
+{
+
+constexpr double kSampleRate = 48000.0;
+constexpr int kBlockSize = 512;
+
+struct BenchmarkResult
+{
+    double nsPerSample = 0.0;
+    double cyclesPerSample = 0.0;   // 0 where there's no cycle counter
+};
+
+// Timestamp counter (x86: counts at the nominal clock rate, not turbo)
+uint64_t readCycleCounter() noexcept
+{
+   #if JUCE_INTEL
+    return __rdtsc();
+   #else
+    return 0;
+   #endif
+}
+
+// Runs fn (which processes one block) until ~0.25 s has elapsed, after a warm-up.
+BenchmarkResult timeBlocks (const std::function<void()>& fn, int samplesPerCall)
+{
+    for (int i = 0; i < 50; ++i)
+        fn();
+
+    using Clock = std::chrono::steady_clock;
+    long long calls = 0;
+    const auto startCycles = readCycleCounter();
+    const auto start = Clock::now();
+    auto now = start;
+
+    while (now - start < std::chrono::milliseconds (250))
+    {
+        for (int i = 0; i < 100; ++i)
+            fn();
+        calls += 100;
+        now = Clock::now();
+    }
+
+    const auto cycles = static_cast<double> (readCycleCounter() - startCycles);
+    const double ns = static_cast<double> (std::chrono::duration_cast<std::chrono::nanoseconds> (now - start).count());
+    const double samples = static_cast<double> (calls) * samplesPerCall;
+    return { ns / samples, cycles / samples };
+}
+
+void report (const char* group, const char* variant, const BenchmarkResult& r)
+{
+    std::cout << group << " / " << variant << ": "
+              << juce::String (r.nsPerSample, 3) << " ns/sample";
+    if (r.cyclesPerSample > 0.0)
+        std::cout << ", " << juce::String (r.cyclesPerSample, 1) << " cycles/sample";
+    std::cout << " (" << juce::String (r.nsPerSample * kBlockSize / 1000.0, 3) << " us per " << kBlockSize << "-sample block)\n";
+}
+
+void fillTestSignal (juce::AudioBuffer<float>& buffer)
+{
+    juce::Random rng (1234);
+    for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+        for (int i = 0; i < buffer.getNumSamples(); ++i)
+            buffer.setSample (ch, i, rng.nextFloat() * 2.0f - 1.0f);
+}
+
+//==============================================================================
+// 3-band EQ (per track, stereo)
+//==============================================================================
+
+// The pre-ThreeBandEQ plugin code: coefficients redesigned (and allocated)
+// every block, six per-sample juce::dsp::IIR::Filter calls per stereo frame.
+struct LegacyEQ
+{
+    juce::dsp::IIR::Filter<float> lowL, lowR, midL, midR, highL, highR;
+
+    void process (juce::AudioBuffer<float>& buffer, double lowDb, double midDb, double highDb, double midFreq)
+    {
+        auto lowCoeffs = juce::dsp::IIR::Coefficients<float>::makeLowShelf (kSampleRate, 200.0f, 0.707f,
+                                                                             juce::Decibels::decibelsToGain (static_cast<float> (lowDb)));
+        lowL.coefficients = lowCoeffs;
+        lowR.coefficients = lowCoeffs;
+        auto midCoeffs = juce::dsp::IIR::Coefficients<float>::makePeakFilter (kSampleRate, static_cast<float> (midFreq), 1.0f,
+                                                                               juce::Decibels::decibelsToGain (static_cast<float> (midDb)));
+        midL.coefficients = midCoeffs;
+        midR.coefficients = midCoeffs;
+        auto highCoeffs = juce::dsp::IIR::Coefficients<float>::makeHighShelf (kSampleRate, 4000.0f, 0.707f,
+                                                                               juce::Decibels::decibelsToGain (static_cast<float> (highDb)));
+        highL.coefficients = highCoeffs;
+        highR.coefficients = highCoeffs;
+
+        auto* left = buffer.getWritePointer (0);
+        auto* right = buffer.getWritePointer (1);
+        for (int i = 0; i < buffer.getNumSamples(); ++i)
+        {
+            left[i]  = lowL.processSample (left[i]);
+            right[i] = lowR.processSample (right[i]);
+            left[i]  = midL.processSample (left[i]);
+            right[i] = midR.processSample (right[i]);
+            left[i]  = highL.processSample (left[i]);
+            right[i] = highR.processSample (right[i]);
+        }
+    }
+};
+
+void benchmarkThreeBandEQ()
+{
+    juce::AudioBuffer<float> buffer (2, kBlockSize);
+    fillTestSignal (buffer);
+
+    LegacyEQ legacy;
+    report ("EQ per track", "before (IIR::Filter, per-block coefficients)",
+            timeBlocks ([&] { legacy.process (buffer, 3.0, -2.0, 1.5, 1200.0); }, kBlockSize));
+
+    ThreeBandEQ eq;
+    eq.prepare (kSampleRate);
+    const ThreeBandEQ::Settings settings { 3.0, -2.0, 1.5, 1200.0 };
+    report ("EQ per track", "after (ThreeBandEQ, steady settings)",
+            timeBlocks ([&] { eq.setSettings (settings); eq.process (buffer, 0, kBlockSize); }, kBlockSize));
+
+    // Worst case: a knob moving every block keeps the coefficient ramp running
+    double midDb = 0.0;
+    report ("EQ per track", "after (ThreeBandEQ, settings change every block)",
+            timeBlocks ([&]
+            {
+                midDb = midDb > 6.0 ? -6.0 : midDb + 0.1;
+                eq.setSettings ({ 3.0, midDb, 1.5, 1200.0 });
+                eq.process (buffer, 0, kBlockSize);
+            }, kBlockSize));
+}
+
+//==============================================================================
+// Compressor / limiter (per track and master, stereo)
+//==============================================================================
+
+// The pre-Dynamics plugin code: coefficients from std::exp every block,
+// getSample per channel and dB conversions per sample.
+struct LegacyDynamics
+{
+    float compEnvelope = 0.0f;
+    float limiterEnvelope = 1.0f;
+
+    void compress (juce::AudioBuffer<float>& buffer, double thresholdDb, double ratioIn, double attackMs, double releaseMs)
+    {
+        float thresholdLinear = juce::Decibels::decibelsToGain (static_cast<float> (thresholdDb));
+        float ratio = static_cast<float> (juce::jmax (1.0, ratioIn));
+        float attackCoeff  = std::exp (-1.0f / (static_cast<float> (attackMs) * 0.001f * static_cast<float> (kSampleRate)));
+        float releaseCoeff = std::exp (-1.0f / (static_cast<float> (releaseMs) * 0.001f * static_cast<float> (kSampleRate)));
+
+        for (int i = 0; i < buffer.getNumSamples(); ++i)
+        {
+            float peak = 0.0f;
+            for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+                peak = juce::jmax (peak, std::abs (buffer.getSample (ch, i)));
+
+            if (peak > compEnvelope)
+                compEnvelope = attackCoeff * compEnvelope + (1.0f - attackCoeff) * peak;
+            else
+                compEnvelope = releaseCoeff * compEnvelope + (1.0f - releaseCoeff) * peak;
+
+            float gain = 1.0f;
+            if (compEnvelope > thresholdLinear && thresholdLinear > 0.0f)
+            {
+                float overDB = juce::Decibels::gainToDecibels (compEnvelope / thresholdLinear);
+                gain = juce::Decibels::decibelsToGain (-overDB * (1.0f - 1.0f / ratio));
+            }
+
+            for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+                buffer.getWritePointer (ch)[i] *= gain;
+        }
+    }
+
+    void limit (juce::AudioBuffer<float>& buffer, double thresholdDb, double releaseMs)
+    {
+        float thresholdLinear = juce::Decibels::decibelsToGain (static_cast<float> (thresholdDb));
+        float releaseCoeff = std::exp (-1.0f / (static_cast<float> (releaseMs) * 0.001f * static_cast<float> (kSampleRate)));
+
+        for (int i = 0; i < buffer.getNumSamples(); ++i)
+        {
+            float peak = 0.0f;
+            for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+                peak = juce::jmax (peak, std::abs (buffer.getSample (ch, i)));
+
+            float targetGain = peak > thresholdLinear ? thresholdLinear / peak : 1.0f;
+            if (targetGain < limiterEnvelope)
+                limiterEnvelope = targetGain;
+            else
+                limiterEnvelope = releaseCoeff * limiterEnvelope + (1.0f - releaseCoeff) * targetGain;
+
+            for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+                buffer.getWritePointer (ch)[i] *= limiterEnvelope;
+        }
+    }
+};
+
+void benchmarkDynamics()
+{
+    juce::AudioBuffer<float> source (2, kBlockSize);
+    fillTestSignal (source);
+    juce::AudioBuffer<float> buffer (2, kBlockSize);
+
+    // Refill each block so the gain computer stays busy (-18 dB threshold on a full-scale signal)
+    auto refill = [&]
+    {
+        for (int ch = 0; ch < 2; ++ch)
+            buffer.copyFrom (ch, 0, source, ch, 0, kBlockSize);
+    };
+
+    LegacyDynamics legacy;
+    report ("Compressor", "before (per-sample dB, per-block coefficients)",
+            timeBlocks ([&] { refill(); legacy.compress (buffer, -18.0, 4.0, 5.0, 80.0); }, kBlockSize));
+
+    Dynamics::Compressor compressor;
+    compressor.prepare (kSampleRate);
+    report ("Compressor", "after (Dynamics, log2 domain)",
+            timeBlocks ([&]
+            {
+                refill();
+                compressor.setSettings ({ -18.0, 4.0, 5.0, 80.0 });
+                compressor.process (buffer, 0, kBlockSize);
+            }, kBlockSize));
+
+    report ("Limiter", "before (per-sample, per-block coefficients)",
+            timeBlocks ([&] { refill(); legacy.limit (buffer, -6.0, 50.0); }, kBlockSize));
+
+    for (const double lookaheadMs : { 0.0, 2.0 })
+    {
+        Dynamics::Limiter limiter;
+        limiter.prepare (kSampleRate);
+        report ("Limiter", lookaheadMs > 0.0 ? "after (Dynamics, 2 ms lookahead)" : "after (Dynamics)",
+                timeBlocks ([&]
+                {
+                    refill();
+                    limiter.setSettings ({ -6.0, 50.0, lookaheadMs });
+                    limiter.process (buffer, 0, kBlockSize);
+                }, kBlockSize));
+    }
+}
+
+//==============================================================================
+// Multi-threaded graph scaling (Tracktion graph player, 1..N CPUs)
+//==============================================================================
+
+namespace tg = tracktion::graph;
+
+// Stand-in for a tracker track with several inserts: an oscillator through a
+// chain of EQs, then delay/reverb sends into the track's SendBuffers slot.
+class StressTrackNode : public tg::Node
+{
+public:
+    StressTrackNode (int index, SendBuffers& buffers, int numInserts)
+        : trackIndex (index), sendBuffers (buffers), inserts (static_cast<size_t> (numInserts))
+    {
+    }
+
+    tg::NodeProperties getNodeProperties() override
+    {
+        tg::NodeProperties props;
+        props.hasAudio = true;
+        props.numberOfChannels = 2;
+        props.nodeID = static_cast<size_t> (trackIndex + 1);
+        return props;
+    }
+
+    bool isReadyToProcess() override { return true; }
+
+    void prepareToPlay (const tg::PlaybackInitialisationInfo& info) override
+    {
+        for (size_t i = 0; i < inserts.size(); ++i)
+        {
+            const double gain = (i % 2 == 0) ? 2.0 : -2.0;
+            inserts[i].prepare (info.sampleRate);
+            inserts[i].setSettings ({ gain, -gain, gain * 0.5, 400.0 + 300.0 * static_cast<double> (i) });
+        }
+    }
+
+    void process (ProcessContext& pc) override
+    {
+        auto buffer = tg::toAudioBuffer (pc.buffers.audio);
+        const int numSamples = buffer.getNumSamples();
+        const float increment = 2.0f * (110.0f + 20.0f * static_cast<float> (trackIndex)) / static_cast<float> (kSampleRate);
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            phase += increment;
+            if (phase >= 1.0f)
+                phase -= 2.0f;
+
+            for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+                buffer.setSample (ch, i, phase * 0.1f);
+        }
+
+        for (auto& eq : inserts)
+            eq.process (buffer, 0, numSamples);
+
+        sendBuffers.addToDelay (trackIndex, buffer, 0, numSamples, 0.3f);
+        sendBuffers.addToReverb (trackIndex, buffer, 0, numSamples, 0.2f);
+    }
+
+private:
+    const int trackIndex;
+    SendBuffers& sendBuffers;
+    std::vector<ThreeBandEQ> inserts;
+    float phase = 0.0f;
+};
+
+// The send bus: waits for every track (as the aux return on the real bus
+// does), then mixes the tracks and sums their send slots like SendEffectsPlugin
+class StressSendBusNode : public tg::Node
+{
+public:
+    StressSendBusNode (SendBuffers& buffers, std::vector<std::unique_ptr<tg::Node>> producers)
+        : sendBuffers (buffers), tracks (std::move (producers))
+    {
+    }
+
+    tg::NodeProperties getNodeProperties() override
+    {
+        tg::NodeProperties props;
+        props.hasAudio = true;
+        props.numberOfChannels = 2;
+        props.nodeID = 1000;
+        return props;
+    }
+
+    std::vector<tg::Node*> getDirectInputNodes() override
+    {
+        std::vector<tg::Node*> inputs;
+        for (auto& track : tracks)
+            inputs.push_back (track.get());
+        return inputs;
+    }
+
+    bool isReadyToProcess() override
+    {
+        for (auto& track : tracks)
+            if (! track->hasProcessed())
+                return false;
+        return true;
+    }
+
+    void prepareToPlay (const tg::PlaybackInitialisationInfo& info) override
+    {
+        delayScratch.setSize (2, info.blockSize);
+        reverbScratch.setSize (2, info.blockSize);
+    }
+
+    void process (ProcessContext& pc) override
+    {
+        auto buffer = tg::toAudioBuffer (pc.buffers.audio);
+        const int numSamples = buffer.getNumSamples();
+        sendBuffers.consumeSlice (delayScratch, reverbScratch, 0, numSamples, 2);
+
+        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+        {
+            buffer.copyFrom (ch, 0, delayScratch, ch, 0, numSamples);
+            buffer.addFrom (ch, 0, reverbScratch, ch, 0, numSamples);
+        }
+
+        for (auto& track : tracks)
+        {
+            auto trackAudio = tg::toAudioBuffer (track->getProcessedOutput().audio);
+            for (int ch = 0; ch < juce::jmin (buffer.getNumChannels(), trackAudio.getNumChannels()); ++ch)
+                buffer.addFrom (ch, 0, trackAudio, ch, 0, numSamples);
+        }
+    }
+
+private:
+    SendBuffers& sendBuffers;
+    std::vector<std::unique_ptr<tg::Node>> tracks;
+    juce::AudioBuffer<float> delayScratch, reverbScratch;
+};
+
+void benchmarkGraphScaling()
+{
+    constexpr int numInserts = 12;
+    const int maxCpus = juce::SystemStats::getNumCpus();
+    const juce::String group = juce::String (kNumTracks) + " tracks x " + juce::String (numInserts) + " EQ inserts";
+    double oneCpuNs = 0.0;
+
+    for (int cpus = 1; cpus <= maxCpus; ++cpus)
+    {
+        SendBuffers sendBuffers;
+
+        std::vector<std::unique_ptr<tg::Node>> nodes;
+        for (int t = 0; t < kNumTracks; ++t)
+            nodes.push_back (std::make_unique<StressTrackNode> (t, sendBuffers, numInserts));
+
+        // Same player and pool the Edit uses; cpus - 1 workers plus this thread
+        tg::LockFreeMultiThreadedNodePlayer player (tg::getPoolCreatorFunction (tg::ThreadPoolStrategy::realTime));
+        player.setNumThreads (static_cast<size_t> (cpus - 1));
+        player.setNode (std::make_unique<StressSendBusNode> (sendBuffers, std::move (nodes)), kSampleRate, kBlockSize);
+
+        choc::buffer::ChannelArrayBuffer<float> output (2u, static_cast<choc::buffer::FrameCount> (kBlockSize));
+        te::MidiMessageArray midi;
+        int64_t position = 0;
+
+        const auto result = timeBlocks ([&]
+        {
+            output.clear();
+            midi.clear();
+            player.process ({ static_cast<choc::buffer::FrameCount> (kBlockSize),
+                              { position, position + kBlockSize },
+                              { output.getView(), midi } });
+            position += kBlockSize;
+        }, kBlockSize);
+
+        if (cpus == 1)
+            oneCpuNs = result.nsPerSample;
+
+        const auto variant = juce::String (cpus) + (cpus == 1 ? " CPU" : " CPUs")
+                             + " (x" + juce::String (oneCpuNs / result.nsPerSample, 2) + ")";
+        report (group.toRawUTF8(), variant.toRawUTF8(), result);
+    }
+}
+
+//==============================================================================
+// Built-in track chain: four plugin nodes vs. the sampler running them fused
+//==============================================================================
+
+// Stand-ins for the sampler, instrument effects, channel strip and track
+// output stages of one track, each working in place on the block.
+struct TrackStageKernels
+{
+    TrackStageKernels (const SampleBank& sampleBank, SendBuffers& buffers, int index)
+        : bank (sampleBank), sendBuffers (buffers), trackIndex (index)
+    {
+        eq.prepare (kSampleRate);
+        eq.setSettings ({ 3.0, -2.0, 1.5, 1200.0 });
+    }
+
+    void renderVoice (juce::AudioBuffer<float>& buffer, int numSamples)
+    {
+        const double step = 44100.0 / kSampleRate * SampleResampler::semitonesToRatio (static_cast<double> (trackIndex % 12));
+        buffer.clear (0, numSamples);
+        SampleResampler::render (bank, SampleResampler::Quality::Hermite, pos, step, buffer, 0, numSamples, 0.8f);
+        pos += step * numSamples;
+        if (pos >= static_cast<double> (bank.totalSamples - 16))
+            pos = 0.0;
+    }
+
+    void applyEffects (juce::AudioBuffer<float>& buffer, int numSamples)
+    {
+        for (int ch = 0; ch < 2; ++ch)
+        {
+            auto* data = buffer.getWritePointer (ch);
+            auto& z = filterState[static_cast<size_t> (ch)];
+            for (int i = 0; i < numSamples; ++i)
+            {
+                z += 0.2f * (data[i] - z);
+                data[i] = z * 0.9f;
+            }
+        }
+    }
+
+    void applyStrip (juce::AudioBuffer<float>& buffer, int numSamples)
+    {
+        eq.process (buffer, 0, numSamples);
+
+        auto* left = buffer.getWritePointer (0);
+        auto* right = buffer.getWritePointer (1);
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const float peak = juce::jmax (std::abs (left[i]), std::abs (right[i]));
+            envelope += (peak > envelope ? 0.1f : 0.001f) * (peak - envelope);
+            const float gain = envelope > 0.5f ? 0.5f / envelope : 1.0f;
+            left[i] *= gain;
+            right[i] *= gain;
+        }
+    }
+
+    void applyOutput (juce::AudioBuffer<float>& buffer, int numSamples)
+    {
+        sendBuffers.addToDelay (trackIndex, buffer, 0, numSamples, 0.3f);
+        sendBuffers.addToReverb (trackIndex, buffer, 0, numSamples, 0.2f);
+        buffer.applyGain (0, 0, numSamples, 0.7f);
+        buffer.applyGain (1, 0, numSamples, 0.6f);
+    }
+
+    const SampleBank& bank;
+    SendBuffers& sendBuffers;
+    const int trackIndex;
+    double pos = 0.0;
+    std::array<float, 2> filterState {};
+    ThreeBandEQ eq;
+    float envelope = 0.0f;
+};
+
+// One stage as its own graph node: copies its input node's block, then
+// processes it (what each plugin node in the chain does)
+class ChainStageNode : public tg::Node
+{
+public:
+    using Stage = std::function<void (juce::AudioBuffer<float>&, int)>;
+
+    ChainStageNode (std::unique_ptr<tg::Node> inputNode, Stage stageFn, size_t id)
+        : input (std::move (inputNode)), stage (std::move (stageFn)), nodeID (id)
+    {
+    }
+
+    tg::NodeProperties getNodeProperties() override
+    {
+        tg::NodeProperties props;
+        props.hasAudio = true;
+        props.numberOfChannels = 2;
+        props.nodeID = nodeID;
+        return props;
+    }
+
+    std::vector<tg::Node*> getDirectInputNodes() override
+    {
+        if (input != nullptr)
+            return { input.get() };
+        return {};
+    }
+
+    bool isReadyToProcess() override { return input == nullptr || input->hasProcessed(); }
+
+    void process (ProcessContext& pc) override
+    {
+        if (input != nullptr)
+            choc::buffer::copy (pc.buffers.audio, input->getProcessedOutput().audio);
+
+        auto buffer = tg::toAudioBuffer (pc.buffers.audio);
+        stage (buffer, buffer.getNumSamples());
+    }
+
+private:
+    std::unique_ptr<tg::Node> input;
+    Stage stage;
+    const size_t nodeID;
+};
+
+void benchmarkFusedTrackChain()
+{
+    juce::AudioBuffer<float> sample (2, static_cast<int> (kSampleRate) * 4);
+    fillTestSignal (sample);
+    auto bank = SampleBank::fromBuffer (sample, 44100.0);
+
+    const juce::String group = juce::String (kNumTracks) + " built-in tracks, 1 CPU";
+
+    for (const bool fused : { false, true })
+    {
+        SendBuffers sendBuffers;
+        std::vector<std::unique_ptr<TrackStageKernels>> kernels;
+        std::vector<std::unique_ptr<tg::Node>> nodes;
+
+        for (int t = 0; t < kNumTracks; ++t)
+        {
+            kernels.push_back (std::make_unique<TrackStageKernels> (*bank, sendBuffers, t));
+            auto* k = kernels.back().get();
+            const auto baseID = static_cast<size_t> (t * 4 + 1);
+
+            if (fused)
+            {
+                // As shipped: the sampler's node runs every stage, and the other
+                // three plugin nodes stay in the graph, finding the block done
+                // and passing it through
+                auto node = std::make_unique<ChainStageNode> (nullptr, [k] (juce::AudioBuffer<float>& b, int n)
+                {
+                    k->renderVoice (b, n);
+                    k->applyEffects (b, n);
+                    k->applyStrip (b, n);
+                    k->applyOutput (b, n);
+                }, baseID);
+
+                for (size_t stage = 1; stage < 4; ++stage)
+                    node = std::make_unique<ChainStageNode> (std::move (node), [] (juce::AudioBuffer<float>&, int) {}, baseID + stage);
+
+                nodes.push_back (std::move (node));
+            }
+            else
+            {
+                auto node = std::make_unique<ChainStageNode> (nullptr, [k] (juce::AudioBuffer<float>& b, int n) { k->renderVoice (b, n); }, baseID);
+                node = std::make_unique<ChainStageNode> (std::move (node), [k] (juce::AudioBuffer<float>& b, int n) { k->applyEffects (b, n); }, baseID + 1);
+                node = std::make_unique<ChainStageNode> (std::move (node), [k] (juce::AudioBuffer<float>& b, int n) { k->applyStrip (b, n); }, baseID + 2);
+                node = std::make_unique<ChainStageNode> (std::move (node), [k] (juce::AudioBuffer<float>& b, int n) { k->applyOutput (b, n); }, baseID + 3);
+                nodes.push_back (std::move (node));
+            }
+        }
+
+        tg::LockFreeMultiThreadedNodePlayer player (tg::getPoolCreatorFunction (tg::ThreadPoolStrategy::realTime));
+        player.setNumThreads (0);
+        player.setNode (std::make_unique<tg::SummingNode> (std::move (nodes)), kSampleRate, kBlockSize);
+
+        choc::buffer::ChannelArrayBuffer<float> output (2u, static_cast<choc::buffer::FrameCount> (kBlockSize));
+        juce::AudioBuffer<float> delayScratch (2, kBlockSize), reverbScratch (2, kBlockSize);
+        te::MidiMessageArray midi;
+        int64_t position = 0;
+
+        report (group.toRawUTF8(), fused ? "after (fused sampler + 3 pass-through nodes per track)" : "before (plugin chain, 4 nodes per track)",
+                timeBlocks ([&]
+                {
+                    output.clear();
+                    midi.clear();
+                    player.process ({ static_cast<choc::buffer::FrameCount> (kBlockSize),
+                                      { position, position + kBlockSize },
+                                      { output.getView(), midi } });
+                    sendBuffers.consumeSlice (delayScratch, reverbScratch, 0, kBlockSize, 2);
+                    position += kBlockSize;
+                }, kBlockSize));
+    }
+}
+
+// A sparse song: most tracks silent, each stage gated on its input going
+// quiet for longer than its tail (as the track plugins do)
+void benchmarkIdleTrackSleep()
+{
+    juce::AudioBuffer<float> sample (2, static_cast<int> (kSampleRate) * 4);
+    fillTestSignal (sample);
+    auto bank = SampleBank::fromBuffer (sample, 44100.0);
+
+    constexpr int kPlayingEvery = 4;
+    const juce::String group = juce::String (kNumTracks) + " tracks, 1 in " + juce::String (kPlayingEvery) + " playing";
+
+    // Filter, compressor release (100 ms), output (no tail)
+    const std::array<juce::int64, 3> tails { SilenceGate::tailForTimeConstant (kSampleRate / (juce::MathConstants<double>::pi * 1000.0)),
+                                             SilenceGate::tailForTimeConstant (0.1 * kSampleRate),
+                                             0 };
+
+    for (const bool gated : { false, true })
+    {
+        SendBuffers sendBuffers;
+        std::vector<std::unique_ptr<TrackStageKernels>> kernels;
+        std::vector<std::array<SilenceGate, 3>> gates (static_cast<size_t> (kNumTracks));
+
+        for (int t = 0; t < kNumTracks; ++t)
+        {
+            kernels.push_back (std::make_unique<TrackStageKernels> (*bank, sendBuffers, t));
+            for (size_t stage = 0; stage < tails.size(); ++stage)
+                gates[static_cast<size_t> (t)][stage].setTailSamples (tails[stage]);
+        }
+
+        juce::AudioBuffer<float> buffer (2, kBlockSize);
+        juce::AudioBuffer<float> delayScratch (2, kBlockSize), reverbScratch (2, kBlockSize);
+
+        auto runStage = [&] (SilenceGate& gate, auto&& process)
+        {
+            if (gated && gate.update (SilenceGate::isSilent (buffer, 0, kBlockSize), kBlockSize))
+                return;
+            process();
+        };
+
+        report (group.toRawUTF8(), gated ? "after (idle stages sleep)" : "before (every stage runs)",
+                timeBlocks ([&]
+                {
+                    for (int t = 0; t < kNumTracks; ++t)
+                    {
+                        auto& k = *kernels[static_cast<size_t> (t)];
+                        auto& trackGates = gates[static_cast<size_t> (t)];
+
+                        if (t % kPlayingEvery == 0)
+                            k.renderVoice (buffer, kBlockSize);
+                        else
+                            buffer.clear();
+
+                        runStage (trackGates[0], [&] { k.applyEffects (buffer, kBlockSize); });
+                        runStage (trackGates[1], [&] { k.applyStrip (buffer, kBlockSize); });
+                        runStage (trackGates[2], [&] { k.applyOutput (buffer, kBlockSize); });
+                    }
+                    sendBuffers.consumeSlice (delayScratch, reverbScratch, 0, kBlockSize, 2);
+                }, kBlockSize));
+
+        int sleeping = 0;
+        for (const auto& trackGates : gates)
+            if (trackGates[2].isSleeping())
+                ++sleeping;
+
+        std::cout << "  sleeping tracks: " << sleeping << " / " << kNumTracks << "\n";
+    }
+}
+
+//==============================================================================
+// Project save/load: XML with base64 samples vs. chunked binary container
+//==============================================================================
+
+// Best of a few runs, in milliseconds
+double timeMs (const std::function<void()>& fn, int runs = 3)
+{
+    double best = 0.0;
+    for (int i = 0; i < runs; ++i)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        fn();
+        const auto ms = std::chrono::duration<double, std::milli> (std::chrono::steady_clock::now() - start).count();
+        best = (i == 0) ? ms : juce::jmin (best, ms);
+    }
+    return best;
+}
+
+void benchmarkProjectSerialization()
+{
+    constexpr int numSamples = 16;
+    constexpr double sampleSeconds = 5.0;
+
+    auto dir = juce::File::getSpecialLocation (juce::File::tempDirectory)
+                   .getNonexistentChildFile ("tracker_project_bench", "", false);
+    auto sampleDir = dir.getChildFile ("samples");
+    sampleDir.createDirectory();
+
+    // 16 stereo 16-bit WAVs (decaying noise bursts, so FLAC has something to do)
+    std::map<int, juce::File> samples;
+    std::map<int, InstrumentParams> params;
+    {
+        juce::WavAudioFormat wav;
+        juce::Random rng (99);
+        juce::AudioBuffer<float> audio (2, static_cast<int> (sampleSeconds * kSampleRate));
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            for (int ch = 0; ch < 2; ++ch)
+                for (int n = 0; n < audio.getNumSamples(); ++n)
+                    audio.setSample (ch, n, (rng.nextFloat() * 2.0f - 1.0f) * std::exp (-static_cast<float> (n) / 20000.0f));
+
+            auto file = sampleDir.getChildFile ("sample" + juce::String (i) + ".wav");
+            std::unique_ptr<juce::AudioFormatWriter> writer (
+                wav.createWriterFor (new juce::FileOutputStream (file), kSampleRate, 2, 16, {}, 0));
+            if (writer != nullptr)
+                writer->writeFromAudioSampleBuffer (audio, 0, audio.getNumSamples());
+
+            samples[i] = file;
+            params[i].volume = -3.0;
+        }
+    }
+
+    PatternData patterns;
+    for (int p = 0; p < 8; ++p)
+    {
+        if (p > 0)
+            patterns.addPattern (64);
+
+        auto& pattern = patterns.getPattern (p);
+        for (int row = 0; row < pattern.numRows; row += 2)
+            for (int t = 0; t < kNumTracks; ++t)
+            {
+                Cell cell;
+                cell.note = 36 + (row + t) % 48;
+                cell.instrument = (row + t) % numSamples;
+                pattern.setCell (row, t, cell);
+            }
+    }
+
+    Arrangement arrangement;
+    TrackLayout layout;
+    MixerState mixer;
+    DelayParams delay;
+    ReverbParams reverb;
+
+    struct Variant
+    {
+        const char* name;
+        const char* extension;
+        bool compress;
+    };
+
+    for (const auto& variant : { Variant { "XML + base64 (before)", "xml", false },
+                                 Variant { "binary container", "tkadj", false },
+                                 Variant { "binary container + FLAC", "tkadj", true } })
+    {
+        auto projectFile = dir.getChildFile (juce::String ("project_") + (variant.compress ? "flac" : "raw")
+                                             + "." + variant.extension);
+        ProjectSerializer::SaveOptions options;
+        options.compressSamples = variant.compress;
+
+        const double saveMs = timeMs ([&]
+        {
+            ProjectSerializer::saveToFile (projectFile, patterns, 125.0, 4, samples, params, arrangement,
+                                           layout, mixer, delay, reverb, 0, {}, nullptr, options);
+        });
+
+        auto load = [&]
+        {
+            PatternData loaded;
+            double bpm = 0.0;
+            int rpb = 0;
+            std::map<int, juce::File> loadedSamples;
+            std::map<int, InstrumentParams> loadedParams;
+            Arrangement loadedArrangement;
+            TrackLayout loadedLayout;
+            MixerState loadedMixer;
+            DelayParams loadedDelay;
+            ReverbParams loadedReverb;
+            ProjectSerializer::loadFromFile (projectFile, loaded, bpm, rpb, loadedSamples, loadedParams,
+                                             loadedArrangement, loadedLayout, loadedMixer, loadedDelay, loadedReverb);
+        };
+
+        // Reopening on the same machine: samples are found where they were
+        const double loadMs = timeMs (load);
+
+        // Opening elsewhere: every sample is extracted from the project
+        auto extractDir = dir.getChildFile (projectFile.getFileNameWithoutExtension() + "_samples");
+        auto movedSamples = dir.getChildFile ("samples_away");
+        sampleDir.moveFileTo (movedSamples);
+        const double extractMs = timeMs ([&] { extractDir.deleteRecursively(); load(); });
+        movedSamples.moveFileTo (sampleDir);
+
+        std::cout << "Project (" << numSamples << " x " << sampleSeconds << " s stereo samples) / " << variant.name << ": "
+                  << juce::String (projectFile.getSize() / (1024.0 * 1024.0), 1) << " MB, save "
+                  << juce::String (saveMs, 1) << " ms, load " << juce::String (loadMs, 1)
+                  << " ms, load + extract samples " << juce::String (extractMs, 1) << " ms\n";
+    }
+
+    dir.deleteRecursively();
+}
+
+//==============================================================================
+// Sampler resampling (one voice, stereo sample, pitched up 3 semitones)
+//==============================================================================
+
+// The pre-SampleResampler voice loop: per output sample and channel, clamp
+// the indices, read two taps through SampleBank::getSample and addSample.
+void legacyRenderVoice (const SampleBank& bank, juce::AudioBuffer<float>& buffer, double& pos, double step)
+{
+    const auto maxIdx = bank.totalSamples - 1;
+
+    for (int i = 0; i < buffer.getNumSamples(); ++i)
+    {
+        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+        {
+            auto idx0 = static_cast<juce::int64> (pos);
+            const float frac = static_cast<float> (pos - static_cast<double> (idx0));
+            auto idx1 = juce::jlimit<juce::int64> (0, maxIdx, idx0 + 1);
+            idx0 = juce::jlimit<juce::int64> (0, maxIdx, idx0);
+            const int sourceCh = juce::jmin (ch, bank.numChannels - 1);
+
+            buffer.addSample (ch, i, (bank.getSample (sourceCh, idx0) * (1.0f - frac)
+                                      + bank.getSample (sourceCh, idx1) * frac) * 0.8f);
+        }
+
+        pos += step;
+    }
+}
+
+void benchmarkSamplerResampling()
+{
+    juce::AudioBuffer<float> sample (2, static_cast<int> (kSampleRate) * 10);
+    fillTestSignal (sample);
+    auto bank = SampleBank::fromBuffer (sample, 44100.0);
+
+    const double step = 44100.0 / kSampleRate * SampleResampler::semitonesToRatio (3.0);
+    const double loopEnd = static_cast<double> (bank->totalSamples - 16);
+    juce::AudioBuffer<float> buffer (2, kBlockSize);
+    buffer.clear();
+
+    // A voice block is kBlockSize output samples; voices per core is how many
+    // of them fit in one block's worth of real time.
+    auto reportVoices = [] (const char* variant, const BenchmarkResult& r)
+    {
+        report ("Sampler voice", variant, r);
+        const double blockNs = kBlockSize / kSampleRate * 1.0e9;
+        std::cout << "    ~" << juce::roundToInt (blockNs / (r.nsPerSample * kBlockSize)) << " voices per core\n";
+    };
+
+    double pos = 0.0;
+    reportVoices ("before (scalar linear, per-sample getSample)",
+                  timeBlocks ([&]
+                  {
+                      legacyRenderVoice (*bank, buffer, pos, step);
+                      if (pos >= loopEnd) pos = 0.0;
+                  }, kBlockSize));
+
+    struct Variant
+    {
+        const char* name;
+        SampleResampler::Quality quality;
+    };
+
+    for (const auto& variant : { Variant { "after (Linear)", SampleResampler::Quality::Linear },
+                                 Variant { "after (Hermite)", SampleResampler::Quality::Hermite },
+                                 Variant { "after (Sinc)", SampleResampler::Quality::Sinc } })
+    {
+        pos = 0.0;
+        reportVoices (variant.name, timeBlocks ([&]
+                      {
+                          SampleResampler::render (*bank, variant.quality, pos, step, buffer, 0, kBlockSize, 0.8f);
+                          pos += step * kBlockSize;
+                          if (pos >= loopEnd) pos = 0.0;
+                      }, kBlockSize));
+    }
+
+    // Three octaves up: full rate strides ~10 samples, mip-mapped reads level 3
+    auto mipped = SampleBank::fromBuffer (sample, 44100.0);
+    mipped->buildMipMaps (std::numeric_limits<size_t>::max());
+    const double highStep = step * 8.0;
+
+    for (const auto& variant : { std::make_pair ("+3 octaves (Sinc, full rate)", bank.get()),
+                                 std::make_pair ("+3 octaves (Sinc, mip-mapped)", mipped.get()) })
+    {
+        pos = 0.0;
+        reportVoices (variant.first, timeBlocks ([&]
+                      {
+                          SampleResampler::render (*variant.second, SampleResampler::Quality::Sinc, pos, highStep,
+                                                   buffer, 0, kBlockSize, 0.8f);
+                          pos += highStep * kBlockSize;
+                          if (pos >= loopEnd) pos = 0.0;
+                      }, kBlockSize));
+    }
+
+    std::cout << "    mip-maps: " << juce::String (mipped->getMipMapMemoryUsage() / (1024.0 * 1024.0), 1)
+              << " MB on top of " << juce::String (bank->getMemoryUsage() / (1024.0 * 1024.0), 1) << " MB\n";
+}
+
+//==============================================================================
+// Song compile: a 200-entry arrangement of 8 distinct 64-row patterns
+//==============================================================================
+
+// What syncArrangementToEdit used to do before it could touch the edit: for
+// every track, walk every row of every entry and repeat once for the FX
+// column and again per note lane. Notes are counted rather than emitted.
+size_t legacySongWalk (const std::vector<std::pair<const Pattern*, int>>& sequence, TrackerEventList& events)
+{
+    size_t notes = 0;
+
+    for (int t = 0; t < kNumTracks; ++t)
+    {
+        int numNoteLanes = 1;
+        for (const auto& [pattern, repeats] : sequence)
+            for (int row = 0; row < pattern->numRows; ++row)
+                numNoteLanes = juce::jmax (numNoteLanes, pattern->getCellView (row, t).getNumNoteLanes());
+
+        int songRow = 0;
+        for (const auto& [pattern, repeats] : sequence)
+            for (int rep = 0; rep < repeats; ++rep)
+                for (int row = 0; row < pattern->numRows; ++row, ++songRow)
+                {
+                    const auto cell = pattern->getCellView (row, t);
+                    for (int nl = 0; nl < numNoteLanes; ++nl)
+                        if (cell.getNoteLane (nl).note >= 0)
+                        {
+                            events.add ({ static_cast<double> (songRow), static_cast<uint16_t> (row) });
+                            break;
+                        }
+                }
+
+        for (int laneIdx = 0; laneIdx < numNoteLanes; ++laneIdx)
+            for (const auto& [pattern, repeats] : sequence)
+                for (int rep = 0; rep < repeats; ++rep)
+                    for (int row = 0; row < pattern->numRows; ++row)
+                        if (pattern->getCellView (row, t).getNoteLane (laneIdx).note >= 0)
+                            ++notes;
+    }
+
+    return notes;
+}
+
+// The block path: hash and compile each distinct pattern track once, then
+// place each block's events, compiled once, wherever it plays
+size_t blockSongAssemble (const std::vector<std::pair<const Pattern*, int>>& sequence, TrackerEventList& events,
+                          std::map<juce::uint64, std::shared_ptr<const PatternTrackBlock>>& cache)
+{
+    std::map<const Pattern*, std::array<std::shared_ptr<const PatternTrackBlock>, kNumTracks>> blocks;
+    for (const auto& [pattern, repeats] : sequence)
+    {
+        auto [it, isNew] = blocks.try_emplace (pattern);
+        if (! isNew)
+            continue;
+
+        for (int t = 0; t < kNumTracks; ++t)
+        {
+            auto& block = cache[PatternTrackBlock::hashTrack (*pattern, t)];
+            if (block == nullptr)
+                block = PatternTrackBlock::compile (*pattern, t);
+            it->second[static_cast<size_t> (t)] = block;
+        }
+    }
+
+    size_t notes = 0;
+    std::map<const PatternTrackBlock*, std::shared_ptr<const TrackerEventList::Segment>> segments;
+    for (int t = 0; t < kNumTracks; ++t)
+    {
+        int songRow = 0;
+        for (const auto& [pattern, repeats] : sequence)
+        {
+            const auto& block = *blocks[pattern][static_cast<size_t> (t)];
+            auto& segment = segments[&block];
+            if (segment == nullptr)
+            {
+                TrackerEventList::Segment fxEvents;
+                for (const auto& fx : block.fxEvents)
+                    fxEvents.push_back ({ static_cast<double> (fx.row), static_cast<uint16_t> (fx.row) });
+                segment = TrackerEventList::makeSegment (std::move (fxEvents));
+            }
+
+            for (int rep = 0; rep < repeats; ++rep, songRow += block.numRows)
+            {
+                events.place (segment, static_cast<double> (songRow));
+                for (const auto& lane : block.lanes)
+                    notes += lane.ops.size();
+            }
+        }
+    }
+
+    return notes;
+}
+
+void benchmarkSongCompile()
+{
+    std::vector<Pattern> patterns;
+    for (int p = 0; p < 8; ++p)
+    {
+        auto& pattern = patterns.emplace_back (64);
+        for (int row = 0; row < pattern.numRows; row += 2)
+            for (int t = 0; t < kNumTracks; ++t)
+            {
+                Cell cell;
+                cell.note = 36 + (row + t + p) % 48;
+                cell.instrument = (row + t) % 16;
+                if (row % 8 == 0)
+                    cell.getFxSlot (0).setSymbolicCommand ('V', 0x60);
+                pattern.setCell (row, t, cell);
+            }
+    }
+
+    std::vector<std::pair<const Pattern*, int>> sequence;
+    for (int entry = 0; entry < 200; ++entry)
+        sequence.emplace_back (&patterns[static_cast<size_t> ((entry * 5) % 8)], 1 + entry % 2);
+
+    size_t legacyNotes = 0, blockNotes = 0;
+    const double legacyMs = timeMs ([&]
+    {
+        TrackerEventList events;
+        legacyNotes = legacySongWalk (sequence, events);
+    });
+
+    const double coldMs = timeMs ([&]
+    {
+        std::map<juce::uint64, std::shared_ptr<const PatternTrackBlock>> cache;
+        TrackerEventList events;
+        blockNotes = blockSongAssemble (sequence, events, cache);
+    });
+
+    std::map<juce::uint64, std::shared_ptr<const PatternTrackBlock>> warmCache;
+    {
+        TrackerEventList events;
+        blockSongAssemble (sequence, events, warmCache);
+    }
+    const double warmMs = timeMs ([&]
+    {
+        TrackerEventList events;
+        blockSongAssemble (sequence, events, warmCache);
+    });
+
+    std::cout << "Song compile (200 entries, 8 x 64-row patterns, " << legacyNotes << " / " << blockNotes << " notes): "
+              << "per-row walk " << juce::String (legacyMs, 2) << " ms, blocks (cold) " << juce::String (coldMs, 2)
+              << " ms, blocks (cached) " << juce::String (warmMs, 2) << " ms\n";
+}
+
+//==============================================================================
+// Pattern storage: a Cell per slot (before) vs. packed track columns
+//==============================================================================
+
+// The layout Pattern had before packing: rows of kNumTracks Cells, each with
+// two heap vectors and one FX slot always allocated
+struct LegacyCell
+{
+    int note = -1;
+    int instrument = -1;
+    int volume = -1;
+    std::vector<NoteSlot> extraNoteLanes;
+    std::vector<FxSlot> fxSlots;
+
+    LegacyCell() { fxSlots.push_back ({}); }
+
+    NoteSlot getNoteLane (int laneIndex) const
+    {
+        if (laneIndex == 0)
+            return { note, instrument, volume };
+        const auto idx = static_cast<size_t> (laneIndex - 1);
+        return idx < extraNoteLanes.size() ? extraNoteLanes[idx] : NoteSlot {};
+    }
+
+    int getNumNoteLanes() const { return 1 + static_cast<int> (extraNoteLanes.size()); }
+    int getNumFxSlots() const { return static_cast<int> (fxSlots.size()); }
+    const FxSlot& getFxSlot (int index) const { return fxSlots[static_cast<size_t> (index)]; }
+};
+
+using LegacyRows = std::vector<std::array<LegacyCell, kNumTracks>>;
+
+// Inline and heap bytes, not counting the allocator's per-block overhead
+size_t getLegacyStorageBytes (const LegacyRows& rows)
+{
+    size_t bytes = rows.capacity() * sizeof (rows[0]);
+    for (const auto& row : rows)
+        for (const auto& cell : row)
+            bytes += cell.extraNoteLanes.capacity() * sizeof (NoteSlot) + cell.fxSlots.capacity() * sizeof (FxSlot);
+    return bytes;
+}
+
+size_t countLegacyAllocations (const LegacyRows& rows)
+{
+    size_t blocks = 1;
+    for (const auto& row : rows)
+        for (const auto& cell : row)
+            blocks += (cell.extraNoteLanes.capacity() > 0 ? 1 : 0) + (cell.fxSlots.capacity() > 0 ? 1 : 0);
+    return blocks;
+}
+
+// What the sync paths read per track (PatternTrackBlock::hashTrack/compile,
+// collectTrackInstruments): the lane count, then every lane and FX slot by row
+template <typename GetCell>
+juce::int64 scanPatternLikeSync (int numRows, GetCell&& getCell)
+{
+    juce::int64 sum = 0;
+    for (int t = 0; t < kNumTracks; ++t)
+    {
+        int numNoteLanes = 1;
+        for (int row = 0; row < numRows; ++row)
+            numNoteLanes = juce::jmax (numNoteLanes, getCell (row, t).getNumNoteLanes());
+
+        for (int row = 0; row < numRows; ++row)
+        {
+            decltype (auto) cell = getCell (row, t);
+            for (int nl = 0; nl < numNoteLanes; ++nl)
+            {
+                const auto slot = cell.getNoteLane (nl);
+                sum += slot.note + slot.instrument + slot.volume;
+            }
+            for (int fxi = 0; fxi < cell.getNumFxSlots(); ++fxi)
+                sum += cell.getFxSlot (fxi).fxParam;
+        }
+    }
+    return sum;
+}
+
+// The same read through Pattern::forEachCell, one chunk lookup per 16 rows
+juce::int64 scanPatternByChunk (const Pattern& pattern)
+{
+    juce::int64 sum = 0;
+    for (int t = 0; t < kNumTracks; ++t)
+    {
+        int numNoteLanes = 1;
+        pattern.forEachCell (t, [&] (int, CellView cell) { numNoteLanes = juce::jmax (numNoteLanes, cell.getNumNoteLanes()); });
+
+        pattern.forEachCell (t, [&] (int, CellView cell)
+        {
+            for (int nl = 0; nl < numNoteLanes; ++nl)
+            {
+                const auto slot = cell.getNoteLane (nl);
+                sum += slot.note + slot.instrument + slot.volume;
+            }
+            for (int fxi = 0; fxi < cell.getNumFxSlots(); ++fxi)
+                sum += cell.getFxSlot (fxi).fxParam;
+        });
+    }
+    return sum;
+}
+
+void benchmarkPatternStorage()
+{
+    constexpr int numRows = 256;
+    constexpr int scansPerRun = 100;
+
+    // Notes on every other row, FX every fourth, a second note lane on the first four tracks
+    auto makeCell = [] (int row, int t)
+    {
+        Cell cell;
+        if (row % 2 == 0)
+        {
+            cell.note = 36 + (row + t) % 48;
+            cell.instrument = t;
+            if (t < 4)
+                cell.setNoteLane (1, { 48 + row % 24, t, 100 });
+        }
+        if (row % 4 == 0)
+            cell.getFxSlot (0).setSymbolicCommand ('V', 0x60);
+        return cell;
+    };
+
+    auto buildLegacy = [&]
+    {
+        LegacyRows rows (numRows);
+        for (int row = 0; row < numRows; ++row)
+            for (int t = 0; t < kNumTracks; ++t)
+            {
+                const auto cell = makeCell (row, t);
+                auto& legacy = rows[static_cast<size_t> (row)][static_cast<size_t> (t)];
+                legacy.note = cell.note;
+                legacy.instrument = cell.instrument;
+                legacy.volume = cell.volume;
+                for (const auto& lane : cell.extraNoteLanes)
+                    legacy.extraNoteLanes.push_back (lane);
+                legacy.fxSlots.assign (cell.fxSlots.begin(), cell.fxSlots.end());
+            }
+        return rows;
+    };
+
+    auto buildPacked = [&]
+    {
+        Pattern pattern (numRows);
+        for (int row = 0; row < numRows; ++row)
+            for (int t = 0; t < kNumTracks; ++t)
+                pattern.setCell (row, t, makeCell (row, t));
+        return pattern;
+    };
+
+    const auto legacy = buildLegacy();
+    const auto packed = buildPacked();
+
+    // Timed builds include freeing the pattern again
+    const double buildLegacyMs = timeMs ([&] { buildLegacy(); });
+    const double buildPackedMs = timeMs ([&] { buildPacked(); });
+
+    juce::int64 legacySum = 0, copySum = 0, viewSum = 0, chunkSum = 0;
+    const double scanLegacyMs = timeMs ([&]
+    {
+        for (int i = 0; i < scansPerRun; ++i)
+            legacySum = scanPatternLikeSync (numRows, [&] (int row, int t) -> const LegacyCell&
+            {
+                return legacy[static_cast<size_t> (row)][static_cast<size_t> (t)];
+            });
+    });
+    const double scanCopyMs = timeMs ([&]
+    {
+        for (int i = 0; i < scansPerRun; ++i)
+            copySum = scanPatternLikeSync (numRows, [&] (int row, int t) { return packed.getCell (row, t); });
+    });
+    const double scanViewMs = timeMs ([&]
+    {
+        for (int i = 0; i < scansPerRun; ++i)
+            viewSum = scanPatternLikeSync (numRows, [&] (int row, int t) { return packed.getCellView (row, t); });
+    });
+    const double scanChunkMs = timeMs ([&]
+    {
+        for (int i = 0; i < scansPerRun; ++i)
+            chunkSum = scanPatternByChunk (packed);
+    });
+
+    // The sync path proper: hash, compile and verify every track's block
+    size_t blockOps = 0;
+    const double blockMs = timeMs ([&]
+    {
+        for (int i = 0; i < scansPerRun; ++i)
+            for (int t = 0; t < kNumTracks; ++t)
+            {
+                const auto block = PatternTrackBlock::compile (packed, t);
+                blockOps += block->matchesTrack (packed, t) ? block->lanes[0].ops.size() : 0;
+            }
+    });
+
+    if (legacySum != copySum || legacySum != viewSum || legacySum != chunkSum)
+        std::cout << "    scan results differ!\n";
+
+    auto us = [] (double ms) { return juce::String (ms * 1000.0 / scansPerRun, 1) + " us"; };
+
+    std::cout << "Pattern storage (" << numRows << " rows x " << kNumTracks << " tracks): "
+              << "Cell per slot " << juce::String (getLegacyStorageBytes (legacy) / 1024.0, 1) << " KB in "
+              << countLegacyAllocations (legacy) << " allocations, packed "
+              << juce::String (packed.getCellStorageBytes() / 1024.0, 1) << " KB\n"
+              << "    build: Cell per slot " << juce::String (buildLegacyMs, 3) << " ms, packed "
+              << juce::String (buildPackedMs, 3) << " ms\n"
+              << "    sync-style scan: Cell per slot " << us (scanLegacyMs) << ", packed getCell() " << us (scanCopyMs)
+              << ", packed getCellView() " << us (scanViewMs) << ", packed forEachCell() " << us (scanChunkMs) << "\n"
+              << "    track blocks (hash, compile, verify; " << blockOps << " ops): " << us (blockMs) << "\n";
+}
+
+//==============================================================================
+// Pattern versions: duplication and undo steps, deep copies vs. shared chunks
+//==============================================================================
+
+void benchmarkPatternVersions()
+{
+    constexpr int numRows = 256;
+
+    Pattern pattern (numRows);
+    LegacyRows legacy (numRows);
+    for (int row = 0; row < numRows; row += 2)
+        for (int t = 0; t < kNumTracks; ++t)
+        {
+            Cell cell;
+            cell.note = 36 + (row + t) % 48;
+            cell.instrument = t;
+            pattern.setCell (row, t, cell);
+            legacy[static_cast<size_t> (row)][static_cast<size_t> (t)].note = cell.note;
+            legacy[static_cast<size_t> (row)][static_cast<size_t> (t)].instrument = cell.instrument;
+        }
+
+    const double copyLegacyMs = timeMs ([&] { LegacyRows copy (legacy); });
+    const double copyPackedMs = timeMs ([&] { Pattern copy (pattern); });
+
+    // Undo steps used to keep an old and a new Cell per touched cell
+    auto legacyStepBytes = [] (size_t numCells)
+    {
+        return numCells * 2 * (sizeof (LegacyCell) + sizeof (FxSlot));
+    };
+
+    auto chunkStepBytes = [&] (int firstTrack, int numTracks, int firstRow, int rows)
+    {
+        PatternData data;
+        data.getPattern (0) = pattern;
+
+        std::vector<MultiCellEditAction::CellRecord> records;
+        for (int t = firstTrack; t < firstTrack + numTracks; ++t)
+            for (int row = firstRow; row < firstRow + rows; ++row)
+            {
+                auto cell = pattern.getCell (row, t);
+                auto transposed = cell;
+                if (transposed.note >= 0 && transposed.note < 115)
+                    transposed.note += 12;
+                records.push_back ({ row, t, cell, transposed });
+            }
+
+        MultiCellEditAction action (data, 0, std::move (records));
+        action.perform();
+        return static_cast<size_t> (action.getSizeInUnits());
+    };
+
+    auto kb = [] (size_t bytes) { return juce::String (bytes / 1024.0, 1) + " KB"; };
+
+    std::cout << "Pattern versions (" << numRows << " rows x " << kNumTracks << " tracks):\n"
+              << "    duplicate: deep copy " << juce::String (copyLegacyMs * 1000.0, 1) << " us, shared chunks "
+              << juce::String (copyPackedMs * 1000.0, 1) << " us\n"
+              << "    undo step, transpose everything: cell copies " << kb (legacyStepBytes (numRows * kNumTracks))
+              << ", chunks " << kb (chunkStepBytes (0, kNumTracks, 0, numRows)) << "\n"
+              << "    undo step, 8 rows of one track: cell copies " << kb (legacyStepBytes (8))
+              << ", chunks " << kb (chunkStepBytes (3, 1, 100, 8)) << "\n";
+}
+
+} // namespace
+
+int main (int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInit;
+
+    struct Benchmark
+    {
+        const char* name;
+        void (*fn)();
+    };
+
+    const std::vector<Benchmark> benchmarks {
+        { "ThreeBandEQ", &benchmarkThreeBandEQ },
+        { "Dynamics", &benchmarkDynamics },
+        { "GraphScaling", &benchmarkGraphScaling },
+        { "FusedTrackChain", &benchmarkFusedTrackChain },
+        { "IdleTrackSleep", &benchmarkIdleTrackSleep },
+        { "ProjectSerialization", &benchmarkProjectSerialization },
+        { "SamplerResampling", &benchmarkSamplerResampling },
+        { "SongCompile", &benchmarkSongCompile },
+        { "PatternStorage", &benchmarkPatternStorage },
+        { "PatternVersions", &benchmarkPatternVersions },
+    };
+
+    const juce::String filter = argc > 1 ? juce::String (argv[1]) : juce::String();
+
+    for (const auto& benchmark : benchmarks)
+    {
+        if (filter.isNotEmpty() && ! juce::String (benchmark.name).containsIgnoreCase (filter))
+            continue;
+
+        std::cout << "== " << benchmark.name << " ==\n";
+        benchmark.fn();
+    }
+
+    return 0;
+}
@@ -1,7 +1,12 @@
+#include <algorithm>
 #include <array>
+#include <atomic>
 #include <cmath>
 #include <iostream>
+#include <limits>
 #include <map>
+#include <thread>
+#include <utility>
 #include <vector>
 
 #include <JuceHeader.h>
@@ -21,6 +26,26 @@
 #include "TrackLayout.h"
 #include "TrackerGrid.h"
 #include "TrackerLookAndFeel.h"
+#include "Clipboard.h"
+#include "PatternSequencer.h"
+#include "LoopCue.h"
+#include "PatternTrackBlock.h"
+#include "Dynamics.h"
+#include "SilenceGate.h"
+#include "TrackerEvent.h"
+#include "TrackerPitchFx.h"
+#include "NoteModulators.h"
+#include "ControlRate.h"
+#include "GranularCloud.h"
+#include "SamplerVoicePool.h"
+#include "SampleResampler.h"
+#include "AtomicSharedPtrTable.h"
+#include "ProjectContainer.h"
+#include "SampleBank.h"
+#include "GlobalModState.h"
+#include "ThreeBandEQ.h"
+#include "AutomationCurve.h"
+#include "InstrumentSnapshot.h"
 
 namespace
 {
@@ -386,7 +411,7 @@ bool testSendBuffersStartSampleAlignmentAndConsume()
     return true;
 }
 
-bool testSendBuffersAutoResizeForLargeWrites()
+bool testSendBuffersSmallerPrepareKeepsCapacity()
 {
     SendBuffers buffers;
     buffers.prepare (8, 2);
@@ -396,7 +421,8 @@ bool testSendBuffersAutoResizeForLargeWrites()
         for (int i = 0; i < source.getNumSamples(); ++i)
             source.setSample (ch, i, static_cast<float> ((ch + 1) * 100 + i));
 
-    // Write beyond initial prepared length; addTo* should resize and keep all samples.
+    // prepare() never shrinks the slots, so a write past the size asked for
+    // but within the existing capacity keeps every sample.
     buffers.addToDelay (source, 4, 20, 1.0f);
     buffers.addToReverb (source, 4, 20, 0.5f);
 
@@ -406,7 +432,7 @@ bool testSendBuffersAutoResizeForLargeWrites()
 
     if (delayOut.getNumSamples() != 20 || reverbOut.getNumSamples() != 20)
     {
-        std::cerr << "auto-resize send consume returned wrong slice size\n";
+        std::cerr << "send consume after a smaller prepare returned wrong slice size\n";
         return false;
     }
 
@@ -422,7 +448,7 @@ bool testSendBuffersAutoResizeForLargeWrites()
             || ! floatsClose (reverbOut.getSample (0, i), expectedReverbL)
             || ! floatsClose (reverbOut.getSample (1, i), expectedReverbR))
         {
-            std::cerr << "auto-resize send buffer mismatch at sample " << i << "\n";
+            std::cerr << "send buffer mismatch after a smaller prepare at sample " << i << "\n";
             return false;
         }
     }
@@ -430,6 +456,54 @@ bool testSendBuffersAutoResizeForLargeWrites()
     return true;
 }
 
+bool testSendBuffersTruncateWritesPastCapacity()
+{
+    SendBuffers buffers;
+    const int capacity = buffers.getCapacity();
+
+    juce::AudioBuffer<float> source (2, capacity + 16);
+    for (int ch = 0; ch < source.getNumChannels(); ++ch)
+        for (int i = 0; i < source.getNumSamples(); ++i)
+            source.setSample (ch, i, 1.0f);
+
+    // Only the part of the write that fits lands; the slots are never resized
+    // on the audio thread (this trips the jassert in debug builds).
+    const int start = capacity - 8;
+    buffers.addToDelay (source, start, 16, 1.0f);
+
+    if (buffers.getCapacity() != capacity)
+    {
+        std::cerr << "send buffers grew from " << capacity << " to " << buffers.getCapacity() << "\n";
+        return false;
+    }
+
+    juce::AudioBuffer<float> delayOut;
+    juce::AudioBuffer<float> reverbOut;
+    buffers.consumeSlice (delayOut, reverbOut, start, 8, 2);
+
+    for (int ch = 0; ch < 2; ++ch)
+    {
+        for (int i = 0; i < 8; ++i)
+        {
+            if (! floatsClose (delayOut.getSample (ch, i), 1.0f))
+            {
+                std::cerr << "truncated send write lost sample " << i << " inside capacity\n";
+                return false;
+            }
+        }
+    }
+
+    // Nothing is left behind for the next block
+    buffers.consumeSlice (delayOut, reverbOut, 0, capacity, 2);
+    if (delayOut.getMagnitude (0, capacity) != 0.0f)
+    {
+        std::cerr << "truncated send write left data in the slot\n";
+        return false;
+    }
+
+    return true;
+}
+
 bool testPanMappingCenterAndExtremes()
 {
     if (! floatsClose (PanMapping::cc10ToPan (0), -50.0f))
@@ -4553,6 +4627,2439 @@ bool testTrackerGridClampsCursorNoteLaneOnTrackChange()
     return true;
 }
 
+bool testInstrumentSnapshotPublishAndAcquire()
+{
+    InstrumentSnapshotTable table;
+
+    if (table.acquire (3) != nullptr)
+    {
+        std::cerr << "Unpublished instrument should have no snapshot\n";
+        return false;
+    }
+
+    if (table.acquireOrDefault (3) != table.getDefaultSnapshot())
+    {
+        std::cerr << "acquireOrDefault should fall back to the default snapshot\n";
+        return false;
+    }
+
+    if (table.acquire (-1) != nullptr || table.acquire (InstrumentSnapshotTable::kNumSlots) != nullptr)
+    {
+        std::cerr << "Out-of-range instruments should have no snapshot\n";
+        return false;
+    }
+
+    InstrumentParams params;
+    params.volume = -6.0;
+    params.playMode = InstrumentParams::PlayMode::Slice;
+    params.slicePoints = { 0.25, 0.5, 0.75 };
+    table.publish (255, params);
+
+    auto snapshot = table.acquire (255);
+    if (snapshot == nullptr || ! doublesClose (snapshot->params.volume, -6.0))
+    {
+        std::cerr << "Published params not visible through acquire\n";
+        return false;
+    }
+
+    if (! vectorsClose (snapshot->sliceBoundariesNorm, SamplePlaybackLayout::getSliceBoundariesNorm (params))
+        || snapshot->getNumSliceRegions() != 4)
+    {
+        std::cerr << "Snapshot slice boundaries should be precomputed from params\n";
+        return false;
+    }
+
+    // The same published snapshot is shared, not copied
+    if (table.acquire (255).get() != snapshot.get())
+    {
+        std::cerr << "Repeated acquire should return the same snapshot\n";
+        return false;
+    }
+
+    table.remove (255);
+    if (table.acquire (255) != nullptr)
+    {
+        std::cerr << "Removed instrument should have no snapshot\n";
+        return false;
+    }
+
+    return true;
+}
+
+bool testInstrumentSnapshotRetiredWhileHeld()
+{
+    InstrumentSnapshotTable table;
+
+    InstrumentParams first;
+    first.volume = -3.0;
+    table.publish (7, first);
+
+    // Simulates a playing voice holding the old snapshot across a republish
+    auto held = table.acquire (7);
+
+    InstrumentParams second;
+    second.volume = -12.0;
+    table.publish (7, second);
+
+    if (! doublesClose (held->params.volume, -3.0))
+    {
+        std::cerr << "Held snapshot must stay immutable after republish\n";
+        return false;
+    }
+
+    if (! doublesClose (table.acquire (7)->params.volume, -12.0))
+    {
+        std::cerr << "New snapshot should be visible after republish\n";
+        return false;
+    }
+
+    if (table.collectGarbage() != 1)
+    {
+        std::cerr << "Retired snapshot still referenced by a reader must not be freed\n";
+        return false;
+    }
+
+    held.reset();
+    if (table.collectGarbage() != 0)
+    {
+        std::cerr << "Retired snapshot should be freed once no reader holds it\n";
+        return false;
+    }
+
+    table.clear();
+    if (table.acquire (7) != nullptr || table.collectGarbage() != 0)
+    {
+        std::cerr << "clear() should unpublish and free all snapshots\n";
+        return false;
+    }
+
+    return true;
+}
+
+bool testPatternRevisionTracksEditedTracksOnly()
+{
+    PatternData data;
+    auto& pat = data.getCurrentPattern();
+
+    const auto rev0 = pat.getTrackRevision (0);
+    const auto rev5 = pat.getTrackRevision (5);
+    const auto master = pat.getMasterRevision();
+
+    Cell cell;
+    cell.note = 60;
+    cell.instrument = 1;
+    data.setCell (3, 5, cell);
+
+    if (pat.getTrackRevision (5) == rev5)
+    {
+        std::cerr << "setCell should bump the edited track's revision\n";
+        return false;
+    }
+
+    if (pat.getTrackRevision (0) != rev0 || pat.getMasterRevision() != master)
+    {
+        std::cerr << "setCell should not touch other tracks or the master lane\n";
+        return false;
+    }
+
+    FxSlot tempo;
+    tempo.setSymbolicCommand ('F', 140);
+    pat.setMasterFxSlot (0, 0, tempo);
+    if (pat.getMasterRevision() == master || pat.getTrackRevision (0) != rev0)
+    {
+        std::cerr << "setMasterFxSlot should only bump the master revision\n";
+        return false;
+    }
+
+    // An unmodified copy keeps the revisions (identical content); editing it diverges
+    data.duplicatePattern (0);
+    auto& copy = data.getPattern (1);
+    if (copy.getTrackRevision (5) != pat.getTrackRevision (5))
+    {
+        std::cerr << "Duplicated pattern should carry the source revisions\n";
+        return false;
+    }
+
+    copy.setCell (0, 5, Cell {});
+    if (copy.getTrackRevision (5) == data.getPattern (0).getTrackRevision (5))
+    {
+        std::cerr << "Editing a copy must give it a distinct revision\n";
+        return false;
+    }
+
+    const auto beforeResize = copy.getTrackRevision (0);
+    copy.resize (32);
+    if (copy.getTrackRevision (0) == beforeResize)
+    {
+        std::cerr << "Changing the pattern length should dirty every track\n";
+        return false;
+    }
+
+    return true;
+}
+
+bool testCompiledAutomationCurveMatchesLane()
+{
+    AutomationLane empty;
+    if (! floatsClose (CompiledAutomationCurve::compile (empty).evaluate (3.0, 0.25f), 0.25f))
+    {
+        std::cerr << "Empty compiled curve should return the default value\n";
+        return false;
+    }
+
+    const AutomationCurveType types[] = { AutomationCurveType::Linear, AutomationCurveType::Step,
+                                          AutomationCurveType::Smooth, AutomationCurveType::SCurve };
+
+    for (auto type : types)
+    {
+        AutomationLane lane;
+        lane.setPoint (2, 0.1f, type);
+        lane.setPoint (6, 0.9f, type);
+        lane.setPoint (7, 0.4f, type);
+        lane.setPoint (15, 0.0f, type);
+        lane.setPoint (20, 1.0f, type);
+
+        auto curve = CompiledAutomationCurve::compile (lane);
+
+        for (int step = 0; step <= 96; ++step)
+        {
+            const float row = static_cast<float> (step) * 0.25f;
+            const float expected = lane.getValueAtRow (row);
+            const float actual = curve.evaluate (row);
+            if (! floatsClose (actual, expected, 1.0e-5f))
+            {
+                std::cerr << "Compiled curve (type " << static_cast<int> (type) << ") differs at row "
+                          << row << ": expected " << expected << ", got " << actual << "\n";
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+bool testThreeBandEQMatchesJuceFilters()
+{
+    constexpr double sr = 48000.0;
+    constexpr int numSamples = 2048;
+    const ThreeBandEQ::Settings settings { 6.0, -4.5, 3.0, 2500.0 };
+
+    // Coefficient design matches juce::dsp::IIR::Coefficients
+    auto bands = ThreeBandEQ::designBands (settings, sr);
+    const juce::dsp::IIR::Coefficients<float>::Ptr reference[] = {
+        juce::dsp::IIR::Coefficients<float>::makeLowShelf (sr, 200.0f, 0.707f, juce::Decibels::decibelsToGain (6.0f)),
+        juce::dsp::IIR::Coefficients<float>::makePeakFilter (sr, 2500.0f, 1.0f, juce::Decibels::decibelsToGain (-4.5f)),
+        juce::dsp::IIR::Coefficients<float>::makeHighShelf (sr, 4000.0f, 0.707f, juce::Decibels::decibelsToGain (3.0f))
+    };
+
+    for (size_t b = 0; b < ThreeBandEQ::kNumBands; ++b)
+    {
+        const auto* c = reference[b]->getRawCoefficients();
+        const auto& band = bands[b];
+        if (! floatsClose (band.b0, c[0], 1.0e-4f) || ! floatsClose (band.b1, c[1], 1.0e-4f)
+            || ! floatsClose (band.b2, c[2], 1.0e-4f) || ! floatsClose (band.a1, c[3], 1.0e-4f)
+            || ! floatsClose (band.a2, c[4], 1.0e-4f))
+        {
+            std::cerr << "EQ band " << b << " coefficients differ from juce::dsp::IIR::Coefficients\n";
+            return false;
+        }
+    }
+
+    // Processing matches the per-sample JUCE filter chain the plugins used before
+    juce::AudioBuffer<float> buffer (2, numSamples);
+    for (int i = 0; i < numSamples; ++i)
+    {
+        buffer.setSample (0, i, std::sin (static_cast<float> (i) * 0.05f));
+        buffer.setSample (1, i, 0.5f * std::cos (static_cast<float> (i) * 0.013f));
+    }
+    juce::AudioBuffer<float> expected (buffer);
+
+    juce::dsp::IIR::Filter<float> filters[2][3];
+    for (auto& channel : filters)
+        for (size_t b = 0; b < 3; ++b)
+            channel[b].coefficients = reference[b];
+
+    for (int ch = 0; ch < 2; ++ch)
+    {
+        auto* data = expected.getWritePointer (ch);
+        for (int i = 0; i < numSamples; ++i)
+            for (auto& filter : filters[ch])
+                data[i] = filter.processSample (data[i]);
+    }
+
+    ThreeBandEQ eq;
+    eq.prepare (sr);
+    eq.setSettings (settings);
+    eq.process (buffer, 0, numSamples / 2);
+    eq.process (buffer, numSamples / 2, numSamples / 2);
+
+    for (int ch = 0; ch < 2; ++ch)
+    {
+        for (int i = 0; i < numSamples; ++i)
+        {
+            if (! floatsClose (buffer.getSample (ch, i), expected.getSample (ch, i), 1.0e-4f))
+            {
+                std::cerr << "EQ output differs from JUCE filters at ch " << ch << " sample " << i << "\n";
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+bool testThreeBandEQRampsAndBypasses()
+{
+    ThreeBandEQ eq;
+    eq.prepare (48000.0, 0.01);
+
+    // Flat EQ leaves the signal untouched
+    std::vector<float> left (512, 0.25f), right (512, -0.25f);
+    eq.setSettings ({});
+    eq.process (left.data(), right.data(), 512);
+    if (eq.isActive() || left[100] != 0.25f || right[100] != -0.25f)
+    {
+        std::cerr << "Flat EQ should be bypassed\n";
+        return false;
+    }
+
+    // A change ramps towards the new design rather than jumping
+    const ThreeBandEQ::Settings boosted { 12.0, 0.0, 0.0, 1000.0 };
+    eq.setSettings (boosted);
+    eq.process (left.data(), right.data(), ThreeBandEQ::kRampChunk);
+    const auto targetBands = ThreeBandEQ::designBands (boosted, 48000.0);
+    if (floatsClose (eq.getCurrentBands()[0].b0, targetBands[0].b0, 1.0e-6f))
+    {
+        std::cerr << "EQ coefficients should ramp, not jump\n";
+        return false;
+    }
+
+    std::vector<float> block (4800, 0.0f);
+    eq.process (block.data(), nullptr, static_cast<int> (block.size()));
+    if (! floatsClose (eq.getCurrentBands()[0].b0, targetBands[0].b0, 1.0e-6f))
+    {
+        std::cerr << "EQ ramp should settle on the target coefficients\n";
+        return false;
+    }
+
+    // Ramping back to flat ends in bypass
+    eq.setSettings ({});
+    eq.process (block.data(), nullptr, static_cast<int> (block.size()));
+    if (eq.isActive())
+    {
+        std::cerr << "EQ should bypass once ramped back to flat\n";
+        return false;
+    }
+
+    return true;
+}
+
+bool testSendBuffersPerTrackSlotsSum()
+{
+    SendBuffers buffers;
+    buffers.prepare (64, 2);
+
+    juce::AudioBuffer<float> source (2, 64);
+    for (int ch = 0; ch < 2; ++ch)
+        for (int i = 0; i < 64; ++i)
+            source.setSample (ch, i, 1.0f);
+
+    // Three tracks plus a slot-less producer, written at different offsets
+    buffers.addToDelay (0, source, 0, 32, 1.0f);
+    buffers.addToDelay (5, source, 0, 32, 0.5f);
+    buffers.addToDelay (SendBuffers::slotForTrack (kNumTracks), source, 16, 16, 0.25f);
+    buffers.addToDelay (source, 0, 32, 2.0f);
+    buffers.addToReverb (3, source, 0, 32, 1.0f);
+
+    if (SendBuffers::slotForTrack (-1) != SendBuffers::kSharedSlot
+        || SendBuffers::slotForTrack (kNumTracks + 2) != SendBuffers::kSharedSlot)
+    {
+        std::cerr << "out-of-range tracks should map to the shared send slot\n";
+        return false;
+    }
+
+    juce::AudioBuffer<float> delayOut;
+    juce::AudioBuffer<float> reverbOut;
+    buffers.consumeSlice (delayOut, reverbOut, 0, 16, 2);
+    for (int i = 0; i < 16; ++i)
+    {
+        if (! floatsClose (delayOut.getSample (1, i), 3.5f) || ! floatsClose (reverbOut.getSample (0, i), 1.0f))
+        {
+            std::cerr << "per-track send slots not summed at sample " << i << "\n";
+            return false;
+        }
+    }
+
+    buffers.consumeSlice (delayOut, reverbOut, 16, 16, 2);
+    for (int i = 0; i < 16; ++i)
+    {
+        if (! floatsClose (delayOut.getSample (0, i), 3.75f))
+        {
+            std::cerr << "preview send slot not summed at sample " << (16 + i) << "\n";
+            return false;
+        }
+    }
+
+    // Everything consumed; invalid slots and oversized writes are dropped, not resized
+    buffers.addToDelay (SendBuffers::kNumSlots, source, 0, 32, 1.0f);
+    buffers.addToDelay (1, source, 0, 64, 1.0f);
+    buffers.consumeSlice (delayOut, reverbOut, 0, 32, 2);
+    for (int i = 0; i < 32; ++i)
+    {
+        if (! floatsClose (delayOut.getSample (0, i), 1.0f) || ! floatsClose (reverbOut.getSample (0, i), 0.0f))
+        {
+            std::cerr << "send slots not cleared after consume at sample " << i << "\n";
+            return false;
+        }
+    }
+
+    if (buffers.getCapacity() < SendBuffers::kDefaultCapacity)
+    {
+        std::cerr << "send buffers should keep their preallocated capacity\n";
+        return false;
+    }
+
+    return true;
+}
+
+bool testGlobalModStateAdvanceStepsGlobalEnvelopesOnly()
+{
+    GlobalModState state;
+
+    InstrumentParams params;
+    auto& globalEnv = params.modulations[0];
+    globalEnv.type = InstrumentParams::Modulation::Type::Envelope;
+    globalEnv.modMode = InstrumentParams::Modulation::ModMode::Global;
+    globalEnv.attackS = 0.1;
+    auto& perNoteEnv = params.modulations[1];
+    perNoteEnv.type = InstrumentParams::Modulation::Type::Envelope;
+
+    // At 32 kHz a tick is 1 ms, a hundredth of the attack. A note at sample
+    // 16 starts the envelopes after the tick on sample 0, so the first block
+    // steps them on the nine ticks from 32 to 288 and the next on four more.
+    state.pendingTrigger.store (16);
+    state.advance (params, 0, 320, 32000.0);
+    state.advance (params, 320, 100, 32000.0);
+
+    if (! floatsClose (state.envStates[0].level.load(), 0.13f))
+    {
+        std::cerr << "global envelope not stepped on the control-rate grid (level "
+                  << state.envStates[0].level.load() << ")\n";
+        return false;
+    }
+
+    // Other block sizes land on the same ticks
+    GlobalModState split;
+    split.pendingTrigger.store (16);
+    for (auto [start, length] : { std::pair<juce::int64, int> { 0, 7 }, { 7, 100 }, { 107, 250 }, { 357, 63 } })
+        split.advance (params, start, length, 32000.0);
+
+    if (split.load (0).level != state.load (0).level || split.load (0).stage != state.load (0).stage)
+    {
+        std::cerr << "global envelope depends on the block size (level "
+                  << split.load (0).level << ")\n";
+        return false;
+    }
+
+    if (state.envStates[1].level.load() != 0.0f || state.envStates[1].stage.load() != GlobalModState::Attack)
+    {
+        std::cerr << "per-note envelope should not be advanced by the shared state\n";
+        return false;
+    }
+
+    // Reaching full level moves on to decay
+    for (int block = 0; block < 10; ++block)
+        state.advance (params, 420 + block * 320, 320, 32000.0);
+
+    if (state.envStates[0].stage.load() < GlobalModState::Decay || state.envStates[0].level.load() > 1.0f)
+    {
+        std::cerr << "global envelope did not leave attack at full level\n";
+        return false;
+    }
+
+    // A kill queued in the block lands on its sample: nothing after it steps
+    state.pendingKill.store (3620);
+    state.advance (params, 3620, 320, 32000.0);
+    if (state.envStates[0].stage.load() != GlobalModState::Idle || state.envStates[0].level.load() != 0.0f)
+    {
+        std::cerr << "queued kill did not reset the global envelope\n";
+        return false;
+    }
+
+    return true;
+}
+
+bool testSendBuffersWorkerThreadProducersLandInTheirBlock()
+{
+    // Tracks rendering on worker threads, with the send bus ordered after
+    // them as the graph does it: each block's sends come out in that block,
+    // at the offsets they were written, and nothing carries into the next.
+    SendBuffers buffers;
+    buffers.prepare (64, 2);
+
+    constexpr int numProducers = 8;
+    constexpr int numBlocks = 200;
+    constexpr int blockSize = 64;
+
+    juce::AudioBuffer<float> delayOut;
+    juce::AudioBuffer<float> reverbOut;
+
+    for (int block = 0; block < numBlocks; ++block)
+    {
+        // A different burst each block, so a late slot would show up as a mismatch
+        const int burstStart = (block * 7) % (blockSize - 8);
+
+        std::vector<std::thread> producers;
+        for (int p = 0; p < numProducers; ++p)
+        {
+            producers.emplace_back ([&, p]
+            {
+                juce::AudioBuffer<float> source (2, blockSize);
+                source.clear();
+                for (int ch = 0; ch < 2; ++ch)
+                    for (int i = burstStart; i < burstStart + 8; ++i)
+                        source.setSample (ch, i, static_cast<float> (p + 1));
+
+                buffers.addToDelay (p, source, 0, blockSize, 1.0f);
+            });
+        }
+
+        for (auto& t : producers)
+            t.join();
+
+        buffers.consumeSlice (delayOut, reverbOut, 0, blockSize, 2);
+
+        constexpr float burstSum = numProducers * (numProducers + 1) / 2.0f;
+        for (int i = 0; i < blockSize; ++i)
+        {
+            const float expected = (i >= burstStart && i < burstStart + 8) ? burstSum : 0.0f;
+            if (! floatsClose (delayOut.getSample (0, i), expected))
+            {
+                std::cerr << "block " << block << " send sample " << i << " was " << delayOut.getSample (0, i)
+                          << ", expected " << expected << "\n";
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+bool testSampleBankStorageFormatsMatchDecodedAudio()
+{
+    constexpr double sampleRate = 44100.0;
+    constexpr int numSamples = 3000;
+
+    juce::AudioBuffer<float> source (2, numSamples);
+    for (int i = 0; i < numSamples; ++i)
+    {
+        source.setSample (0, i, 0.8f * std::sin (static_cast<float> (i) * 0.05f));
+        source.setSample (1, i, 0.5f * std::cos (static_cast<float> (i) * 0.013f));
+    }
+
+    auto file = juce::File::getSpecialLocation (juce::File::tempDirectory)
+                    .getNonexistentChildFile ("sample_bank_test", ".wav", false);
+
+    {
+        juce::WavAudioFormat wav;
+        std::unique_ptr<juce::AudioFormatWriter> writer (
+            wav.createWriterFor (new juce::FileOutputStream (file), sampleRate, 2, 32, {}, 0));
+        if (writer == nullptr || ! writer->writeFromAudioSampleBuffer (source, 0, numSamples))
+            return false;
+    }
+
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+    juce::String error;
+
+    auto floatBank = SampleBank::loadFromFile (file, formatManager, {}, error);
+
+    SampleBank::LoadOptions int16Options;
+    int16Options.use16Bit = true;
+    auto int16Bank = SampleBank::loadFromFile (file, formatManager, int16Options, error);
+
+    // Map everything past a ~20ms head
+    SampleBank::LoadOptions streamOptions;
+    streamOptions.streamAboveSeconds = 0.01;
+    streamOptions.headSeconds = 0.02;
+    auto streamedBank = SampleBank::loadFromFile (file, formatManager, streamOptions, error);
+
+    bool ok = floatBank != nullptr && int16Bank != nullptr && streamedBank != nullptr;
+
+    if (ok)
+    {
+        ok = floatBank->getStorage() == SampleBank::Storage::Float32
+          && int16Bank->getStorage() == SampleBank::Storage::Int16
+          && streamedBank->getStorage() == SampleBank::Storage::Streamed
+          && int16Bank->getMemoryUsage() * 2 == floatBank->getMemoryUsage()
+          && streamedBank->getNumPreloadedSamples() > 0
+          && streamedBank->getNumPreloadedSamples() < numSamples
+          && streamedBank->totalSamples == numSamples;
+
+        for (int ch = 0; ch < 2 && ok; ++ch)
+        {
+            for (int i = 0; i < numSamples && ok; ++i)
+            {
+                const float expected = source.getSample (ch, i);
+                ok = floatsClose (floatBank->getSample (ch, i), expected)
+                  && floatsClose (int16Bank->getSample (ch, i), expected, 1.0f / 32768.0f)
+                  && floatsClose (streamedBank->getSample (ch, i), expected);
+            }
+        }
+
+        // Prefetching from a play position past the head is harmless
+        streamedBank->notePlayPosition (numSamples / 2);
+        streamedBank->prefetch (numSamples);
+    }
+
+    floatBank.reset();
+    int16Bank.reset();
+    streamedBank.reset();
+    file.deleteFile();
+    return ok;
+}
+
+bool testSampleBankLoadReportsProgressAndCancels()
+{
+    constexpr int numSamples = 150000;   // several decode chunks
+
+    juce::AudioBuffer<float> source (1, numSamples);
+    for (int i = 0; i < numSamples; ++i)
+        source.setSample (0, i, 0.25f * std::sin (static_cast<float> (i) * 0.01f));
+
+    auto file = juce::File::getSpecialLocation (juce::File::tempDirectory)
+                    .getNonexistentChildFile ("sample_bank_progress", ".wav", false);
+
+    {
+        juce::WavAudioFormat wav;
+        std::unique_ptr<juce::AudioFormatWriter> writer (
+            wav.createWriterFor (new juce::FileOutputStream (file), 44100.0, 1, 16, {}, 0));
+        if (writer == nullptr || ! writer->writeFromAudioSampleBuffer (source, 0, numSamples))
+            return false;
+    }
+
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+
+    std::vector<float> reported;
+    juce::String error;
+    auto bank = SampleBank::loadFromFile (file, formatManager, {}, error,
+                                          [&reported] (float progress) { reported.push_back (progress); return true; });
+
+    bool ok = bank != nullptr && error.isEmpty()
+           && reported.size() > 1
+           && std::is_sorted (reported.begin(), reported.end())
+           && floatsClose (reported.back(), 1.0f);
+
+    // Abandoning after the first chunk yields no bank and an error
+    int calls = 0;
+    juce::String cancelError;
+    auto cancelled = SampleBank::loadFromFile (file, formatManager, {}, cancelError,
+                                               [&calls] (float) { return ++calls < 1; });
+
+    ok = ok && cancelled == nullptr && cancelError.isNotEmpty() && calls == 1;
+
+    bank.reset();
+    file.deleteFile();
+    return ok;
+}
+
+bool testBinaryProjectStoresSharedSamplesOnceAndExtractsMissing()
+{
+    auto dir = juce::File::getSpecialLocation (juce::File::tempDirectory)
+                   .getNonexistentChildFile ("binary_project_test", "", false);
+    dir.createDirectory();
+
+    // One 16-bit WAV used by two instruments
+    auto sampleFile = dir.getChildFile ("kick.wav");
+    {
+        juce::AudioBuffer<float> audio (1, 4000);
+        for (int i = 0; i < audio.getNumSamples(); ++i)
+            audio.setSample (0, i, 0.5f * std::sin (static_cast<float> (i) * 0.02f));
+
+        juce::WavAudioFormat wav;
+        std::unique_ptr<juce::AudioFormatWriter> writer (
+            wav.createWriterFor (new juce::FileOutputStream (sampleFile), 44100.0, 1, 16, {}, 0));
+        if (writer == nullptr || ! writer->writeFromAudioSampleBuffer (audio, 0, audio.getNumSamples()))
+            return false;
+    }
+
+    juce::MemoryBlock originalBytes;
+    sampleFile.loadFileAsData (originalBytes);
+
+    PatternData source;
+    {
+        Cell cell;
+        cell.note = 60;
+        source.getPattern (0).setCell (3, 2, cell);
+    }
+    std::map<int, juce::File> samples { { 1, sampleFile }, { 7, sampleFile } };
+    std::map<int, InstrumentParams> params;
+    params[1].volume = -6.0;
+    Arrangement arr;
+    TrackLayout layout;
+    MixerState mixer;
+    DelayParams delay;
+    ReverbParams reverb;
+
+    auto saveAndReload = [&] (const juce::File& projectFile, const ProjectSerializer::SaveOptions& options,
+                              std::map<int, juce::File>& loadedSamples, std::map<int, InstrumentParams>& loadedParams,
+                              PatternData& loaded)
+    {
+        if (ProjectSerializer::saveToFile (projectFile, source, 128.0, 4, samples, params, arr, layout,
+                                           mixer, delay, reverb, 0, {}, nullptr, options).isNotEmpty())
+            return false;
+
+        // Lose the original so the load has to extract it from the project
+        auto moved = dir.getChildFile ("kick_moved.wav");
+        sampleFile.moveFileTo (moved);
+
+        double bpm = 0.0;
+        int rpb = 0;
+        Arrangement loadedArr;
+        TrackLayout loadedLayout;
+        MixerState loadedMixer;
+        DelayParams loadedDelay;
+        ReverbParams loadedReverb;
+        const auto err = ProjectSerializer::loadFromFile (projectFile, loaded, bpm, rpb, loadedSamples, loadedParams,
+                                                          loadedArr, loadedLayout, loadedMixer, loadedDelay, loadedReverb);
+        moved.moveFileTo (sampleFile);
+        return err.isEmpty() && doublesClose (bpm, 128.0);
+    };
+
+    bool ok = true;
+
+    // Binary: the project chunk plus a single sample chunk shared by both instruments
+    {
+        auto projectFile = dir.getChildFile ("song.tkadj");
+        std::map<int, juce::File> loadedSamples;
+        std::map<int, InstrumentParams> loadedParams;
+        PatternData loaded;
+        ok = saveAndReload (projectFile, {}, loadedSamples, loadedParams, loaded);
+
+        ProjectContainer::Reader reader (projectFile);
+        int sampleChunks = 0;
+        for (auto& chunk : reader.getChunks())
+            if (chunk.type == ProjectContainer::kSampleChunk)
+                ++sampleChunks;
+
+        juce::MemoryBlock extracted;
+        ok = ok && reader.isValid() && sampleChunks == 1
+          && ProjectContainer::isContainer (projectFile)
+          && loadedSamples.size() == 2
+          && loadedSamples[1] == loadedSamples[7]
+          && loadedSamples[1].getParentDirectory().getFileName() == "song_samples"
+          && loadedSamples[1].loadFileAsData (extracted) && extracted == originalBytes
+          && loaded.getPattern (0).getCell (3, 2).note == 60
+          && doublesClose (loadedParams[1].volume, -6.0);
+    }
+
+    // Binary with FLAC sample chunks
+    {
+        auto projectFile = dir.getChildFile ("song_flac.tkadj");
+        ProjectSerializer::SaveOptions options;
+        options.compressSamples = true;
+        std::map<int, juce::File> loadedSamples;
+        std::map<int, InstrumentParams> loadedParams;
+        PatternData loaded;
+        ok = ok && saveAndReload (projectFile, options, loadedSamples, loadedParams, loaded);
+        ok = ok && loadedSamples.size() == 2 && loadedSamples[1].hasFileExtension ("flac");
+    }
+
+    // XML stays readable as the interchange format
+    {
+        auto projectFile = dir.getChildFile ("song.xml");
+        std::map<int, juce::File> loadedSamples;
+        std::map<int, InstrumentParams> loadedParams;
+        PatternData loaded;
+        ok = ok && saveAndReload (projectFile, {}, loadedSamples, loadedParams, loaded);
+        ok = ok && ! ProjectContainer::isContainer (projectFile)
+                && juce::XmlDocument::parse (projectFile) != nullptr
+                && loadedSamples.size() == 2
+                && loaded.getPattern (0).getCell (3, 2).note == 60;
+    }
+
+    dir.deleteRecursively();
+    return ok;
+}
+
+bool testBankTableSwapsEntriesWhileReadersAcquire()
+{
+    constexpr int kSlots = InstrumentRouting::kMaxInstrument + 1;
+    AtomicSharedPtrTable<SampleBank, kSlots> table;
+
+    auto makeBank = [] (float value)
+    {
+        juce::AudioBuffer<float> buffer (1, 16);
+        for (int i = 0; i < buffer.getNumSamples(); ++i)
+            buffer.setSample (0, i, value);
+        return std::shared_ptr<const SampleBank> (SampleBank::fromBuffer (buffer, 44100.0));
+    };
+
+    std::map<int, std::shared_ptr<const SampleBank>> banks { { 0, makeBank (0.25f) }, { 200, makeBank (0.5f) } };
+    table.assign (banks);
+
+    // Re-assigning with one entry changed must leave the other slot untouched
+    const auto* unchanged = table.acquire (0).get();
+    banks[200] = makeBank (0.75f);
+    table.assign (banks);
+    if (table.acquire (0).get() != unchanged || ! floatsClose (table.acquire (200)->getSample (0, 0), 0.75f))
+    {
+        std::cerr << "assign() should only swap the slots that changed\n";
+        return false;
+    }
+
+    // Reader (audio thread) switches banks while the writer republishes them
+    std::atomic<bool> done { false };
+    std::atomic<bool> badRead { false };
+    std::thread reader ([&]
+    {
+        while (! done.load())
+        {
+            for (int slot : { 0, 200 })
+            {
+                if (auto bank = table.acquire (slot))
+                {
+                    const float v = bank->getSample (0, 15);
+                    if (v < 0.0f || v > 1.0f)
+                        badRead = true;
+                }
+            }
+        }
+    });
+
+    for (int i = 0; i < 500; ++i)
+    {
+        table.publish (200, makeBank (static_cast<float> (i % 4) * 0.25f));
+        if (i % 50 == 0)
+            table.remove (0);
+        else if (i % 50 == 25)
+            table.publish (0, makeBank (1.0f));
+    }
+
+    done = true;
+    reader.join();
+
+    if (badRead)
+    {
+        std::cerr << "Reader saw a bank with unexpected contents during swaps\n";
+        return false;
+    }
+
+    table.clear();
+    if (table.collectGarbage() != 0 || table.acquire (200) != nullptr)
+    {
+        std::cerr << "Retired banks should be freed once no reader holds them\n";
+        return false;
+    }
+
+    return true;
+}
+
+bool testSampleResamplerQualitiesAndBlockRender()
+{
+    // Sine at 1/7 of the sample rate, stereo with an inverted right channel
+    constexpr int kLength = 400;
+    juce::AudioBuffer<float> source (2, kLength);
+    for (int i = 0; i < kLength; ++i)
+    {
+        const float v = std::sin (juce::MathConstants<float>::twoPi * static_cast<float> (i) / 7.0f);
+        source.setSample (0, i, v);
+        source.setSample (1, i, -v);
+    }
+
+    auto bank = SampleBank::fromBuffer (source, 44100.0);
+    auto bank16 = SampleBank::fromBuffer (source, 44100.0, true);
+
+    using Quality = SampleResampler::Quality;
+    const Quality qualities[] = { Quality::Linear, Quality::Hermite, Quality::Sinc };
+
+    // Every kernel passes through the source samples at integer positions
+    for (auto q : qualities)
+    {
+        for (int i = 10; i < 20; ++i)
+        {
+            if (! floatsClose (SampleResampler::readSample (*bank, q, 0, i), source.getSample (0, i), 1.0e-5f))
+            {
+                std::cerr << "Interpolation should be exact at integer positions (quality "
+                          << static_cast<int> (q) << ")\n";
+                return false;
+            }
+        }
+    }
+
+    // Linear matches the previous two-tap formula
+    const float x0 = source.getSample (0, 100), x1 = source.getSample (0, 101);
+    if (! floatsClose (SampleResampler::readSample (*bank, Quality::Linear, 0, 100.25), x0 + (x1 - x0) * 0.25f))
+    {
+        std::cerr << "Linear interpolation changed\n";
+        return false;
+    }
+
+    // Higher qualities track the underlying sine more closely
+    double maxError[3] = {};
+    for (int qi = 0; qi < 3; ++qi)
+    {
+        for (double pos = 50.0; pos < 350.0; pos += 0.37)
+        {
+            const double expected = std::sin (juce::MathConstants<double>::twoPi * pos / 7.0);
+            maxError[qi] = juce::jmax (maxError[qi],
+                                       std::abs (SampleResampler::readSample (*bank, qualities[qi], 0, pos) - expected));
+        }
+    }
+
+    if (! (maxError[1] < maxError[0] * 0.5 && maxError[2] < maxError[1]))
+    {
+        std::cerr << "Expected error Linear > Hermite > Sinc, got "
+                  << maxError[0] << " / " << maxError[1] << " / " << maxError[2] << "\n";
+        return false;
+    }
+
+    // Block rendering (direct RAM reads inside, clamped reads at the edges,
+    // forward and backward) matches single reads, for float and 16-bit banks
+    for (auto q : qualities)
+    {
+        for (const auto& [start, step] : { std::pair { -3.5, 1.37 }, std::pair { 20.2, 0.61 }, std::pair { 398.0, -2.3 } })
+        {
+            for (const auto* b : { bank.get(), bank16.get() })
+            {
+                constexpr int kRendered = 150;
+                juce::AudioBuffer<float> out (2, kRendered + 8);
+                out.clear();
+
+                SampleResampler::render (*b, q, start, step, out, 8, kRendered, 0.5f);
+
+                for (int i = 0; i < kRendered; ++i)
+                {
+                    const double pos = start + i * step;
+                    for (int ch = 0; ch < 2; ++ch)
+                    {
+                        const float expected = 0.5f * SampleResampler::readSample (*b, q, ch, pos);
+                        if (! floatsClose (out.getSample (ch, 8 + i), expected, 1.0e-5f))
+                        {
+                            std::cerr << "Block render differs from single reads at sample " << i
+                                      << " (quality " << static_cast<int> (q) << ", start " << start << ")\n";
+                            return false;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // Pitch tables
+    for (double semis : { -36.0, -12.5, -0.01, 0.0, 0.37, 7.0, 24.99, 48.0 })
+    {
+        if (std::abs (SampleResampler::semitonesToRatio (semis) / std::pow (2.0, semis / 12.0) - 1.0) > 1.0e-8)
+        {
+            std::cerr << "semitonesToRatio inaccurate at " << semis << " semitones\n";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool testSamplerVoicePoolAllocatesPerLaneAndSteals()
+{
+    SamplerVoicePool pool;
+    pool.setPolyphony (2);
+
+    auto start = [&pool] (int lane, int note, float velocity) -> SamplerVoice&
+    {
+        auto& v = pool.startVoice (lane);
+        v.state = SamplerVoice::State::Playing;
+        v.midiNote = note;
+        v.velocity = velocity;
+        return v;
+    };
+
+    auto countActive = [&pool]
+    {
+        int n = 0;
+        for (const auto& v : pool.getVoices())
+            n += v.state != SamplerVoice::State::Idle ? 1 : 0;
+        return n;
+    };
+
+    // Two lanes sound together
+    auto& lane0 = start (0, 60, 1.0f);
+    auto& lane1 = start (1, 64, 0.5f);
+    if (! lane0.isPlaying() || ! lane1.isPlaying() || pool.getNumPlaying() != 2)
+        return false;
+
+    // A new note on a lane fades only that lane's previous voice
+    auto& lane0Next = start (0, 62, 1.0f);
+    if (! lane0.isFadingOut() || ! lane1.isPlaying() || &lane0Next == &lane0 || countActive() != 3)
+        return false;
+
+    // Past the polyphony the oldest playing voice (lane 1) is stolen
+    auto& lane2 = start (2, 67, 1.0f);
+    if (! lane1.isFadingOut() || ! lane0Next.isPlaying() || ! lane2.isPlaying() || pool.getNumPlaying() != 2)
+        return false;
+
+    if (pool.getNewestPlaying() != &lane2)
+        return false;
+
+    // Quietest: the lowest-velocity voice goes first, whatever its age
+    pool.cutAll();
+    pool.setStealing (SamplerVoicePool::Stealing::Quietest);
+    auto& loud = start (0, 60, 1.0f);
+    auto& quiet = start (1, 60, 0.2f);
+    start (2, 72, 0.8f);
+    if (! loud.isPlaying() || ! quiet.isFadingOut())
+        return false;
+
+    // Note-off releases the oldest voice with that note only
+    pool.cutAll();
+    auto& first = start (0, 60, 1.0f);
+    auto& second = start (1, 60, 1.0f);
+    pool.releaseNote (60);
+    if (! first.isFadingOut() || ! second.isPlaying())
+        return false;
+
+    // A lane cut silences the lane at once, fading voices included
+    pool.cutLane (0);
+    if (first.state != SamplerVoice::State::Idle || ! second.isPlaying())
+        return false;
+
+    // Retriggering every lane never runs out of slots
+    pool.cutAll();
+    pool.setPolyphony (SamplerVoicePool::kMaxPolyphony);
+    for (int i = 0; i < 1000; ++i)
+        start (i % SamplerVoicePool::kMaxPolyphony, 60 + (i % 12), 1.0f);
+
+    return pool.getNumPlaying() == SamplerVoicePool::kMaxPolyphony
+        && countActive() <= SamplerVoicePool::kNumSlots;
+}
+
+bool testGranularCloudMatchesSingleGrainAndOverlaps()
+{
+    constexpr int kLength = 4000;
+    juce::AudioBuffer<float> source (1, kLength);
+    for (int i = 0; i < kLength; ++i)
+        source.setSample (0, i, std::sin (static_cast<float> (i) * 0.05f));
+
+    auto bank = SampleBank::fromBuffer (source, 44100.0);
+    using Shape = InstrumentParams::GranShape;
+
+    // Tabulated windows follow the old per-sample formulas
+    const auto& windows = GrainWindows::get();
+    constexpr int kGrain = 300;
+    std::vector<float> window (kGrain);
+    for (auto shape : { Shape::Square, Shape::Triangle, Shape::Gauss })
+    {
+        windows.fill (shape, 0, kGrain, window.data(), kGrain);
+        for (int i = 0; i < kGrain; ++i)
+        {
+            const float t = static_cast<float> (i) / static_cast<float> (kGrain);
+            const float x = (t - 0.5f) * 4.0f;
+            const float expected = shape == Shape::Square ? 1.0f
+                                 : shape == Shape::Triangle ? (t < 0.5f ? t * 2.0f : 2.0f - t * 2.0f)
+                                                            : std::exp (-x * x);
+            if (! floatsClose (window[static_cast<size_t> (i)], expected, 1.0e-4f))
+            {
+                std::cerr << "Grain window " << static_cast<int> (shape) << " differs at " << i << "\n";
+                return false;
+            }
+        }
+    }
+
+    // Density 1 without spray is the classic looping grain, pingponging here
+    GranularCloud::Settings settings;
+    settings.regionStart = 0.0;
+    settings.regionEnd = kLength;
+    settings.grainStart = 1000.0;
+    settings.grainEnd = 1000.0 + kGrain;
+    settings.grainLength = kGrain;
+    settings.loop = InstrumentParams::GranLoop::Pingpong;
+
+    constexpr int kRender = 1000;
+    constexpr double kStep = 0.75;
+    GranularCloud cloud;
+    cloud.start (settings, true, 1);
+
+    juce::AudioBuffer<float> out (1, kRender);
+    out.clear();
+    bool forward = true;
+    for (int done = 0; done < kRender; done += 100)   // block size must not matter
+        cloud.render (*bank, InstrumentParams::Interpolation::Linear, kStep, 0.5f, out, done, 100, forward);
+
+    double pos = settings.grainStart;
+    bool refForward = true;
+    for (int i = 0, age = 0; i < kRender; ++i, ++age)
+    {
+        if (age == kGrain)
+        {
+            age = 0;
+            refForward = ! refForward;
+            pos = refForward ? settings.grainStart : settings.grainEnd - 1.0;
+        }
+
+        const float t = static_cast<float> (age) / static_cast<float> (kGrain);
+        const float env = t < 0.5f ? t * 2.0f : 2.0f - t * 2.0f;
+        const float expected = 0.5f * env * SampleResampler::readSample (*bank, InstrumentParams::Interpolation::Linear, 0, pos);
+        if (! floatsClose (out.getSample (0, i), expected, 1.0e-4f))
+        {
+            std::cerr << "Single-grain cloud differs at sample " << i << "\n";
+            return false;
+        }
+        pos += refForward ? kStep : -kStep;
+    }
+
+    // Dense clouds overlap exactly density grains, and spray stays in the region
+    settings.density = 4;
+    settings.spray = 1.0;
+    settings.pitchSprayCents = 700.0;
+    settings.regionStart = 500.0;
+    settings.regionEnd = 2500.0;
+    settings.loop = InstrumentParams::GranLoop::Forward;
+
+    GranularCloud dense, denseAgain;
+    dense.start (settings, true, 1234);
+    denseAgain.start (settings, true, 1234);
+
+    juce::AudioBuffer<float> a (1, 64), b (1, 64);
+    bool forwardA = true, forwardB = true;
+    for (int block = 0; block < 40; ++block)
+    {
+        a.clear();
+        b.clear();
+        dense.render (*bank, InstrumentParams::Interpolation::Hermite, 1.0, 1.0f, a, 0, 64, forwardA);
+        denseAgain.render (*bank, InstrumentParams::Interpolation::Hermite, 1.0, 1.0f, b, 0, 32, forwardB);
+        denseAgain.render (*bank, InstrumentParams::Interpolation::Hermite, 1.0, 1.0f, b, 32, 32, forwardB);
+
+        if (dense.getNumActiveGrains() > 4 || (block * 64 >= kGrain && dense.getNumActiveGrains() != 4))
+        {
+            std::cerr << "Expected 4 overlapping grains, got " << dense.getNumActiveGrains() << "\n";
+            return false;
+        }
+
+        const double newest = dense.getNewestPosition();
+        if (newest < settings.regionStart - 64.0 * 1.5 || newest > settings.regionEnd + 64.0 * 1.5)
+        {
+            std::cerr << "Sprayed grain left the region\n";
+            return false;
+        }
+
+        for (int i = 0; i < 64; ++i)
+        {
+            if (! std::isfinite (a.getSample (0, i)) || ! floatsClose (a.getSample (0, i), b.getSample (0, i), 1.0e-5f))
+            {
+                std::cerr << "Dense cloud should be deterministic and block-size independent\n";
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+bool testSampleMipMapsBandLimitHighTranspositions()
+{
+    // A low tone plus one just below Nyquist, which folds over when read an octave up
+    constexpr int kLength = 8192;
+    juce::AudioBuffer<float> source (1, kLength);
+    for (int i = 0; i < kLength; ++i)
+        source.setSample (0, i, 0.5f * std::sin (juce::MathConstants<float>::twoPi * 0.01f * static_cast<float> (i))
+                                  + 0.5f * std::sin (juce::MathConstants<float>::twoPi * 0.45f * static_cast<float> (i)));
+
+    auto plain = SampleBank::fromBuffer (source, 44100.0);
+    auto mipped = SampleBank::fromBuffer (source, 44100.0);
+    mipped->buildMipMaps (std::numeric_limits<size_t>::max());
+
+    if (plain->getNumMipLevels() != 0 || mipped->getNumMipLevels() != SampleBank::kMaxMipLevels)
+    {
+        std::cerr << "Expected " << SampleBank::kMaxMipLevels << " mip levels, got " << mipped->getNumMipLevels() << "\n";
+        return false;
+    }
+
+    size_t expectedBytes = 0;
+    for (int level = 1; level <= SampleBank::kMaxMipLevels; ++level)
+    {
+        const auto& mip = mipped->getMipLevel (level);
+        if (mip.totalSamples != (kLength >> level) || ! doublesClose (mip.sampleRate, 44100.0 / (1 << level)))
+        {
+            std::cerr << "Mip level " << level << " has the wrong length or rate\n";
+            return false;
+        }
+        expectedBytes += static_cast<size_t> (kLength >> level) * sizeof (float);
+    }
+
+    if (mipped->getMipMapMemoryUsage() != expectedBytes
+        || mipped->getMemoryUsage() != plain->getMemoryUsage() + expectedBytes)
+    {
+        std::cerr << "Mip-map memory should be reported with the bank's\n";
+        return false;
+    }
+
+    // Levels that would go over the budget are left out
+    auto capped = SampleBank::fromBuffer (source, 44100.0, true);
+    const size_t budget = (kLength / 2 + kLength / 4 + kLength / 16) * sizeof (int16_t);
+    capped->buildMipMaps (budget);
+    if (capped->getNumMipLevels() != 2 || capped->getMipMapMemoryUsage() > budget)
+    {
+        std::cerr << "Mip-map budget not respected: " << capped->getNumMipLevels() << " levels\n";
+        return false;
+    }
+
+    if (SampleResampler::chooseMipLevel (1.0, 5) != 0 || SampleResampler::chooseMipLevel (1.99, 5) != 0
+        || SampleResampler::chooseMipLevel (2.0, 5) != 1 || SampleResampler::chooseMipLevel (-3.0, 5) != 1
+        || SampleResampler::chooseMipLevel (4.0, 5) != 2 || SampleResampler::chooseMipLevel (100.0, 5) != 5
+        || SampleResampler::chooseMipLevel (8.0, 0) != 0)
+    {
+        std::cerr << "Wrong mip level chosen for a step\n";
+        return false;
+    }
+
+    // An octave up, the mip-mapped bank keeps the low tone and drops the alias
+    constexpr int kRender = 1024;
+    constexpr double kStart = 1000.0;
+    juce::AudioBuffer<float> plainOut (1, kRender), mippedOut (1, kRender);
+    plainOut.clear();
+    mippedOut.clear();
+    SampleResampler::render (*plain, InstrumentParams::Interpolation::Hermite, kStart, 2.0, plainOut, 0, kRender, 1.0f);
+    SampleResampler::render (*mipped, InstrumentParams::Interpolation::Hermite, kStart, 2.0, mippedOut, 0, kRender, 1.0f);
+
+    double plainError = 0.0, mippedError = 0.0;
+    for (int i = 0; i < kRender; ++i)
+    {
+        const double expected = 0.5 * std::sin (juce::MathConstants<double>::twoPi * 0.01 * (kStart + 2.0 * i));
+        plainError += std::pow (plainOut.getSample (0, i) - expected, 2.0);
+        mippedError += std::pow (mippedOut.getSample (0, i) - expected, 2.0);
+    }
+    plainError = std::sqrt (plainError / kRender);
+    mippedError = std::sqrt (mippedError / kRender);
+
+    if (mippedError > 0.01 || plainError < 0.2)
+    {
+        std::cerr << "Mip-mapped render error " << mippedError << ", full-rate " << plainError << "\n";
+        return false;
+    }
+
+    return true;
+}
+
+bool testMipMapBudgetIsSharedAcrossBanks()
+{
+    if (SampleBank::LoadOptions().buildMipMaps)
+    {
+        std::cerr << "Mip-maps should be opt-in\n";
+        return false;
+    }
+
+    constexpr int kLength = 8192;
+    juce::AudioBuffer<float> source (1, kLength);
+    for (int i = 0; i < kLength; ++i)
+        source.setSample (0, i, std::sin (0.05f * static_cast<float> (i)));
+
+    // Room for one bank's full chain and a little more
+    size_t fullChain = 0;
+    for (int level = 1; level <= SampleBank::kMaxMipLevels; ++level)
+        fullChain += static_cast<size_t> (kLength >> level) * sizeof (float);
+
+    auto budget = std::make_shared<MipMapBudget> (fullChain + (kLength / 2) * sizeof (float) - 1);
+
+    auto first = SampleBank::fromBuffer (source, 44100.0);
+    first->buildMipMaps (budget);
+    auto second = SampleBank::fromBuffer (source, 44100.0);
+    second->buildMipMaps (budget);
+
+    if (first->getNumMipLevels() != SampleBank::kMaxMipLevels || second->getNumMipLevels() != 0
+        || budget->getUsed() != fullChain)
+    {
+        std::cerr << "Second bank should find the shared budget spent (levels " << first->getNumMipLevels()
+                  << ", " << second->getNumMipLevels() << ")\n";
+        return false;
+    }
+
+    // Freeing a bank gives its levels back
+    first.reset();
+    if (budget->getUsed() != 0)
+    {
+        std::cerr << "Freed bank kept " << budget->getUsed() << " mip-map bytes reserved\n";
+        return false;
+    }
+
+    second->buildMipMaps (budget);
+    if (second->getNumMipLevels() != SampleBank::kMaxMipLevels || budget->getUsed() != fullChain)
+    {
+        std::cerr << "Released budget not reusable\n";
+        return false;
+    }
+
+    return true;
+}
+
+bool testControlRateOutputIsBlockSizeIndependent()
+{
+    if (! ControlRate::isTick (0) || ControlRate::isTick (33) || ControlRate::samplesToNextTick (33) != 31
+        || ControlRate::samplesToNextTick (64) != ControlRate::kInterval)
+    {
+        std::cerr << "Control-rate grid is off\n";
+        return false;
+    }
+
+    constexpr double kSampleRate = 44100.0;
+    constexpr int kLength = 16000;
+    juce::AudioBuffer<float> source (1, 2 * kLength);   // long enough not to run out
+    for (int i = 0; i < source.getNumSamples(); ++i)
+        source.setSample (0, i, std::sin (static_cast<float> (i) * 0.03f));
+    auto bank = SampleBank::fromBuffer (source, kSampleRate);
+
+    InstrumentParams params;
+    auto& volume = params.modulations[static_cast<size_t> (InstrumentParams::ModDest::Volume)];
+    volume.type = InstrumentParams::Modulation::Type::Envelope;
+    volume.amount = 80;
+    volume.attackS = 0.05;
+    volume.decayS = 0.1;
+    volume.sustain = 40;
+    volume.releaseS = 0.05;
+    auto& pan = params.modulations[static_cast<size_t> (InstrumentParams::ModDest::Panning)];
+    pan.type = InstrumentParams::Modulation::Type::LFO;
+    pan.amount = 100;
+    pan.lfoSpeedMode = InstrumentParams::Modulation::LFOSpeedMode::MS;
+    pan.lfoSpeedMs = 50;
+    auto& cutoff = params.modulations[static_cast<size_t> (InstrumentParams::ModDest::Cutoff)];
+    cutoff.type = InstrumentParams::Modulation::Type::Envelope;
+    cutoff.modMode = InstrumentParams::Modulation::ModMode::Global;
+    cutoff.amount = 100;
+    cutoff.attackS = 0.03;
+    cutoff.decayS = 0.08;
+    cutoff.sustain = 50;
+    cutoff.releaseS = 0.02;
+
+    const NoteModulators::Timing timing { kSampleRate, 120.0, 4 };
+    const double rowsPerTick = 4.0 * 120.0 / 60.0 * ControlRate::kInterval / kSampleRate;
+
+    // Note, step slide up 3 over a row, then a one-row portamento and the release
+    std::vector<std::pair<int, juce::MidiMessage>> events {
+        { 100, juce::MidiMessage::noteOn (1, 60, 1.0f) },
+        { 14001, juce::MidiMessage::noteOff (1, 60) },
+    };
+
+    TrackerEventList fxEvents;
+    auto addFx = [&fxEvents] (int sample, TrackerEvent::Command command, uint8_t param)
+    {
+        TrackerEvent e;
+        e.time = static_cast<double> (sample) / kSampleRate;
+        e.command = command;
+        e.param = param;
+        fxEvents.add (e);
+    };
+    addFx (1000, TrackerEvent::Command::SlideUp, 0x31);
+    addFx (3000, TrackerEvent::Command::PortaSteps, 1);
+    addFx (3000, TrackerEvent::Command::PortaTarget, 64);
+    fxEvents.finalise();
+
+    // One track through the sampler's pitch commands and the effects plugin's
+    // modulators, with the shared global envelope stepped by the send bus
+    // after each block and the track's copy of it taken at the block start
+    auto render = [&] (int blockSize, float& finalPitch)
+    {
+        TrackerPitchFx pitchFx;
+        NoteModulators mods;
+        GlobalModState globalState;
+        GlobalModState::EnvValue globalEnv;
+        pitchFx.reset();
+        mods.reset();
+
+        juce::AudioBuffer<float> out (2, kLength);
+        out.clear();
+        double pos = 0.0;
+        bool playing = false;
+        float semitones = 0.0f, gain = 1.0f, panMod = 0.0f;
+
+        auto update = [&]
+        {
+            semitones = pitchFx.getPitchOffset();
+            gain = juce::jlimit (0.0f, 1.0f, 0.2f + mods.getValue (static_cast<int> (InstrumentParams::ModDest::Volume)))
+                 * (0.5f + 0.5f * globalEnv.level);
+            panMod = mods.getValue (static_cast<int> (InstrumentParams::ModDest::Panning));
+        };
+
+        for (int blockStart = 0; blockStart < kLength; blockStart += blockSize)
+        {
+            const int n = juce::jmin (blockSize, kLength - blockStart);
+            std::vector<juce::MidiMessage> blockEvents;
+            for (auto [sample, message] : events)
+            {
+                if (sample >= blockStart && sample < blockStart + n)
+                {
+                    message.setTimeStamp (static_cast<double> (sample - blockStart) / kSampleRate);
+                    blockEvents.push_back (message);
+                }
+            }
+
+            globalEnv = globalState.load (static_cast<int> (InstrumentParams::ModDest::Cutoff));
+
+            ControlRate::process (blockStart, n, kSampleRate,
+                fxEvents.getRange (blockStart, n, kSampleRate), &blockEvents,
+                [&] (int)
+                {
+                    pitchFx.advance (rowsPerTick);
+                    mods.advance (params, timing, ControlRate::kInterval);
+                    GlobalModState::step (globalEnv, cutoff, kSampleRate);
+                    update();
+                },
+                [&] (const TrackerEvent& e)
+                {
+                    pitchFx.handleEvent (e);
+                    update();
+                },
+                [&] (const juce::MidiMessage& m)
+                {
+                    const auto eventSample = blockStart + juce::roundToInt (m.getTimeStamp() * kSampleRate);
+                    pitchFx.handleMidi (m);
+                    if (m.isNoteOn())
+                    {
+                        mods.trigger();
+                        globalState.pendingTrigger.store (eventSample);
+                        GlobalModState::trigger (globalEnv);
+                        pos = 0.0;
+                        playing = true;
+                    }
+                    else if (m.isNoteOff())
+                    {
+                        mods.release();
+                        globalState.pendingRelease.store (eventSample);
+                        GlobalModState::release (globalEnv);
+                    }
+                    mods.advance (params, timing, 0);
+                    update();
+                },
+                [&] (int offset, int count)
+                {
+                    if (! playing)
+                        return;
+
+                    const double step = SampleResampler::semitonesToRatio (semitones);
+                    SampleResampler::render (*bank, InstrumentParams::Interpolation::Linear, pos, step,
+                                             out, blockStart + offset, count, gain);
+                    out.applyGain (0, blockStart + offset, count, 1.0f - 0.5f * panMod);
+                    out.applyGain (1, blockStart + offset, count, 1.0f + 0.5f * panMod);
+                    pos += step * count;
+                });
+
+            globalState.advance (params, blockStart, n, kSampleRate);
+        }
+
+        finalPitch = pitchFx.getPitchOffset();
+        return out;
+    };
+
+    float referencePitch = 0.0f;
+    const auto reference = render (kLength, referencePitch);
+
+    // The slide landed and the finished portamento handed its note over
+    if (! floatsClose (referencePitch, 3.0f))
+    {
+        std::cerr << "Expected a 3 semitone offset after the slide, got " << referencePitch << "\n";
+        return false;
+    }
+
+    // The attack rises inside the single reference block rather than per block
+    auto peak = [&reference] (int start)
+    {
+        float p = 0.0f;
+        for (int i = start; i < start + 500; ++i)
+            p = juce::jmax (p, std::abs (reference.getSample (0, i)));
+        return p;
+    };
+    if (peak (150) <= 0.0f || peak (150) > 0.9f * peak (2400))
+    {
+        std::cerr << "Envelope should move within a block: " << peak (150) << " vs " << peak (2400) << "\n";
+        return false;
+    }
+
+    for (int blockSize : { 17, 64, 333, 1024, 4096 })
+    {
+        float pitch = 0.0f;
+        const auto out = render (blockSize, pitch);
+        for (int ch = 0; ch < 2; ++ch)
+        {
+            for (int i = 0; i < kLength; ++i)
+            {
+                if (! floatsClose (out.getSample (ch, i), reference.getSample (ch, i), 1.0e-5f))
+                {
+                    std::cerr << "Block size " << blockSize << " differs at sample " << i << ": "
+                              << out.getSample (ch, i) << " vs " << reference.getSample (ch, i) << "\n";
+                    return false;
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+bool testTrackerEventRangesCoverEachEventOnce()
+{
+    constexpr double kSampleRate = 48000.0;
+
+    // Two commands on one row, one between rows and one right on a block boundary
+    TrackerEventList list;
+    auto add = [&list] (double time, TrackerEvent::Command command, uint8_t param)
+    {
+        TrackerEvent e;
+        e.time = time;
+        e.command = command;
+        e.param = param;
+        list.add (e);
+    };
+    add (0.5, TrackerEvent::Command::Volume, 0x40);
+    add (0.125, TrackerEvent::Command::RowReset, 0);
+    add (0.5, TrackerEvent::Command::DelaySend, 0xFF);
+    add (256.0 / kSampleRate, TrackerEvent::Command::Tune, 0xFE);
+    list.finalise();
+
+    // Sorted by time, with commands on the same time kept in pattern order
+    const auto& all = list.getEvents();
+    if (all.size() != 4 || all[0].command != TrackerEvent::Command::Tune
+        || all[2].command != TrackerEvent::Command::Volume || all[3].command != TrackerEvent::Command::DelaySend)
+    {
+        std::cerr << "Tracker events not in time order\n";
+        return false;
+    }
+
+    for (int blockSize : { 64, 256, 1000 })
+    {
+        std::vector<int64_t> seen;
+        for (int64_t start = 0; start < 48000; start += blockSize)
+        {
+            for (const auto& e : list.getRange (start, blockSize, kSampleRate))
+            {
+                const auto sample = TrackerEventList::getSample (e, kSampleRate);
+                if (sample < start || sample >= start + blockSize)
+                {
+                    std::cerr << "Event at sample " << sample << " given to block at " << start << "\n";
+                    return false;
+                }
+                seen.push_back (sample);
+            }
+        }
+
+        if (seen != std::vector<int64_t> { 256, 6000, 24000, 24000 })
+        {
+            std::cerr << "Expected each event once with " << blockSize << " sample blocks, got " << seen.size() << "\n";
+            return false;
+        }
+    }
+
+    // A shared segment placed three times plays each time through, offset by its start
+    TrackerEventList::Segment entry;
+    for (double time : { 0.25, 0.0, 0.25 })
+    {
+        TrackerEvent e;
+        e.time = time;
+        e.param = static_cast<uint8_t> (entry.size());
+        entry.push_back (e);
+    }
+    const auto segment = TrackerEventList::makeSegment (std::move (entry));
+
+    TrackerEventList placed;
+    for (double start : { 0.0, 0.5, 1.0 })
+        placed.place (segment, start);
+
+    if (placed.size() != 9 || (*segment)[0].param != 1 || (*segment)[2].param != 2)
+    {
+        std::cerr << "Segment not placed in time order\n";
+        return false;
+    }
+
+    for (int blockSize : { 64, 12000, 24000 })
+    {
+        std::vector<std::pair<int64_t, uint8_t>> seen;
+        for (int64_t start = 0; start < 48000; start += blockSize)
+            for (const auto& e : placed.getRange (start, blockSize, kSampleRate))
+                seen.emplace_back (TrackerEventList::getSample (e, kSampleRate), e.param);
+
+        // The third placement starts on the last block's end
+        const std::vector<std::pair<int64_t, uint8_t>> expected { { 0, 1 }, { 12000, 0 }, { 12000, 2 },
+                                                                   { 24000, 1 }, { 36000, 0 }, { 36000, 2 } };
+        if (seen != expected)
+        {
+            std::cerr << "Placed segments seen " << seen.size() << " times with " << blockSize << " sample blocks\n";
+            return false;
+        }
+    }
+
+    // FX letters without a plugin command stay off the list
+    TrackerEvent::Command command;
+    if (! getTrackerEventCommand ('V', command) || command != TrackerEvent::Command::Volume
+        || getTrackerEventCommand ('F', command))
+    {
+        std::cerr << "Unexpected FX letter mapping\n";
+        return false;
+    }
+
+    return true;
+}
+
+bool testSilenceGateSleepsOnlyAfterTail()
+{
+    constexpr int kBlock = 64;
+
+    // A one-pole decay (time constant 500 samples) fed one impulse and then
+    // silence: the gate may only sleep once the real output is below threshold
+    const double timeConstant = 500.0;
+    const float coeff = static_cast<float> (std::exp (-1.0 / timeConstant));
+
+    SilenceGate gate;
+    gate.setTailSamples (SilenceGate::tailForTimeConstant (timeConstant));
+
+    juce::AudioBuffer<float> input (2, kBlock);
+    float state = 0.0f;
+    int sleptAtBlock = -1;
+
+    for (int block = 0; block < 200; ++block)
+    {
+        input.clear();
+        if (block == 0)
+            input.setSample (0, 0, 1.0f);
+
+        const bool skip = gate.update (SilenceGate::isSilent (input, 0, kBlock), kBlock);
+
+        float peak = 0.0f;
+        for (int i = 0; i < kBlock; ++i)
+        {
+            state = state * coeff + input.getSample (0, i);
+            peak = juce::jmax (peak, std::abs (state));
+        }
+
+        if (skip)
+        {
+            if (peak > SilenceGate::kThreshold)
+            {
+                std::cerr << "Gate slept at block " << block << " while the tail was at " << peak << "\n";
+                return false;
+            }
+            if (sleptAtBlock < 0)
+                sleptAtBlock = block;
+        }
+        else if (sleptAtBlock >= 0)
+        {
+            std::cerr << "Gate woke up without input at block " << block << "\n";
+            return false;
+        }
+    }
+
+    // ...but not much later than it has to
+    const auto tail = SilenceGate::tailForTimeConstant (timeConstant);
+    if (sleptAtBlock < 0 || ! gate.isSleeping() || sleptAtBlock * kBlock > tail + 2 * kBlock)
+    {
+        std::cerr << "Gate slept at block " << sleptAtBlock << " for a " << tail << " sample tail\n";
+        return false;
+    }
+
+    // Audio wakes it straight away
+    input.setSample (1, 10, 0.5f);
+    if (gate.update (SilenceGate::isSilent (input, 0, kBlock), kBlock) || gate.isSleeping())
+    {
+        std::cerr << "Gate didn't wake on audio\n";
+        return false;
+    }
+
+    // Feedback loops: a delay that keeps half its level each pass has rung out
+    // after enough passes; one that feeds back (almost) everything never does
+    const auto delayTail = SilenceGate::tailForFeedback (0.5, 1000.0);
+    if (std::pow (0.5, static_cast<double> (delayTail) / 1000.0 - 1.0) > SilenceGate::kThreshold
+        || SilenceGate::tailForFeedback (1.0, 1000.0) != SilenceGate::kInfiniteTail
+        || SilenceGate::tailForFeedback (0.0, 1000.0) != 1000)
+    {
+        std::cerr << "Unexpected feedback tail " << delayTail << "\n";
+        return false;
+    }
+
+    return true;
+}
+
+bool testDynamicsKernelsMatchReferenceAndCatchPeaks()
+{
+    constexpr double kSampleRate = 48000.0;
+    constexpr int kNumSamples = 9600;
+
+    // Decaying bursts, louder on the left, in odd-sized blocks
+    juce::AudioBuffer<float> input (2, kNumSamples);
+    for (int i = 0; i < kNumSamples; ++i)
+    {
+        const float level = 1.5f * std::exp (-static_cast<float> (i % 2400) / 600.0f);
+        const float s = std::sin (static_cast<float> (i) * 0.05f);
+        input.setSample (0, i, level * s);
+        input.setSample (1, i, 0.5f * level * s);
+    }
+
+    // Compressor: same curve as the per-sample dB version it replaces
+    {
+        Dynamics::Compressor compressor;
+        compressor.prepare (kSampleRate);
+        compressor.setSettings ({ -18.0, 4.0, 5.0, 80.0 });
+
+        auto output = input;
+        for (int start = 0; start < kNumSamples; start += 333)
+            compressor.process (output.getWritePointer (0, start), output.getWritePointer (1, start),
+                                juce::jmin (333, kNumSamples - start));
+
+        const float threshold = std::pow (10.0f, -18.0f / 20.0f);
+        const float attack = std::exp (-1.0f / (5.0f * 0.001f * static_cast<float> (kSampleRate)));
+        const float release = std::exp (-1.0f / (80.0f * 0.001f * static_cast<float> (kSampleRate)));
+        float envelope = 0.0f;
+
+        for (int i = 0; i < kNumSamples; ++i)
+        {
+            const float peak = juce::jmax (std::abs (input.getSample (0, i)), std::abs (input.getSample (1, i)));
+            const float coeff = peak > envelope ? attack : release;
+            envelope = coeff * envelope + (1.0f - coeff) * peak;
+
+            float gain = 1.0f;
+            if (envelope > threshold)
+                gain = std::pow (10.0f, -20.0f * std::log10 (envelope / threshold) * 0.75f / 20.0f);
+
+            for (int ch = 0; ch < 2; ++ch)
+            {
+                const float expected = input.getSample (ch, i) * gain;
+                if (std::abs (output.getSample (ch, i) - expected) > 1.0e-4f)
+                {
+                    std::cerr << "Compressor differs at " << i << ": " << output.getSample (ch, i)
+                              << " vs " << expected << "\n";
+                    return false;
+                }
+            }
+        }
+    }
+
+    // Lookahead limiter: delays by the lookahead and no peak gets past the threshold
+    {
+        Dynamics::Limiter limiter;
+        limiter.prepare (kSampleRate);
+        limiter.setSettings ({ -6.0, 50.0, 2.0 });
+
+        const int lookahead = limiter.getLookaheadSamples();
+        if (lookahead != 96)
+        {
+            std::cerr << "Expected 96 lookahead samples, got " << lookahead << "\n";
+            return false;
+        }
+
+
+        auto output = input;
+        for (int start = 0; start < kNumSamples; start += 100)
+            limiter.process (output.getWritePointer (0, start), output.getWritePointer (1, start),
+                             juce::jmin (100, kNumSamples - start));
+
+        const float threshold = std::pow (10.0f, -6.0f / 20.0f);
+        for (int i = 0; i < kNumSamples; ++i)
+        {
+            for (int ch = 0; ch < 2; ++ch)
+            {
+                const float out = output.getSample (ch, i);
+                const float in = i >= lookahead ? input.getSample (ch, i - lookahead) : 0.0f;
+                if (std::abs (out) > threshold * 1.0001f || std::abs (out) > std::abs (in) + 1.0e-6f)
+                {
+                    std::cerr << "Limiter let " << out << " through at " << i << " (input " << in << ")\n";
+                    return false;
+                }
+            }
+        }
+
+        // Quiet input long after the last reduction comes out untouched
+        juce::AudioBuffer<float> quiet (2, 48000);
+        quiet.clear();
+        quiet.setSample (0, 48000 - lookahead - 1, 0.1f);
+        limiter.process (quiet.getWritePointer (0), quiet.getWritePointer (1), quiet.getNumSamples());
+        if (std::abs (quiet.getSample (0, 48000 - 1) - 0.1f) > 1.0e-4f)
+        {
+            std::cerr << "Limiter should pass quiet input after releasing, got " << quiet.getSample (0, 48000 - 1) << "\n";
+            return false;
+        }
+    }
+
+    // Fixed latency: always delayed by the maximum lookahead, limiting or not,
+    // with the lookahead only setting the detection window
+    for (const double thresholdDb : { -6.0, 0.0 })
+    {
+        Dynamics::Limiter limiter;
+        limiter.prepare (kSampleRate, true);
+        limiter.setSettings ({ thresholdDb, 50.0, 2.0 });
+
+        const int latency = limiter.getLatencySamples();
+        if (latency != Dynamics::Limiter::getMaxLookaheadSamples (kSampleRate) || latency != 240)
+        {
+            std::cerr << "Fixed-latency limiter reports " << latency << " samples\n";
+            return false;
+        }
+
+        auto output = input;
+        for (int start = 0; start < kNumSamples; start += 100)
+            limiter.process (output.getWritePointer (0, start), output.getWritePointer (1, start),
+                             juce::jmin (100, kNumSamples - start));
+
+        const float threshold = std::pow (10.0f, static_cast<float> (thresholdDb) / 20.0f);
+        for (int i = 0; i < kNumSamples; ++i)
+        {
+            for (int ch = 0; ch < 2; ++ch)
+            {
+                const float out = output.getSample (ch, i);
+                const float in = i >= latency ? input.getSample (ch, i - latency) : 0.0f;
+                const bool passesThrough = thresholdDb >= 0.0 && std::abs (out - in) > 1.0e-6f;
+                if (passesThrough || std::abs (out) > std::abs (in) + 1.0e-6f
+                    || (thresholdDb < 0.0 && std::abs (out) > threshold * 1.0001f))
+                {
+                    std::cerr << "Fixed-latency limiter gave " << out << " at " << i << " (input " << in << ")\n";
+                    return false;
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+bool testPatternTrackBlockSharedByContentAndResolvesNoteEnds()
+{
+    auto fill = [] (Pattern& pattern)
+    {
+        Cell note;
+        note.note = 60;
+        note.instrument = 3;
+        pattern.setCell (0, 1, note);
+
+        // Row 4 glides to 64 (G04 on the row), row 8 retriggers with another instrument
+        Cell glide;
+        glide.note = 64;
+        glide.getFxSlot (0).setSymbolicCommand ('G', 4);
+        pattern.setCell (4, 1, glide);
+
+        Cell retrigger;
+        retrigger.note = 67;
+        retrigger.instrument = 5;
+        retrigger.getFxSlot (0).setSymbolicCommand ('V', 0x40);
+        pattern.setCell (8, 1, retrigger);
+
+        // A portamento after the last note stays armed for whatever plays next
+        Cell armed;
+        armed.getFxSlot (0).setSymbolicCommand ('G', 2);
+        pattern.setCell (12, 1, armed);
+    };
+
+    Pattern a (16), b (16);
+    fill (a);
+    fill (b);
+
+    // Same cells on any track of any pattern hash the same
+    if (PatternTrackBlock::hashTrack (a, 1) != PatternTrackBlock::hashTrack (b, 1))
+        return false;
+    if (PatternTrackBlock::hashTrack (a, 0) != PatternTrackBlock::hashTrack (b, 2)
+        || PatternTrackBlock::hashTrack (a, 0) == PatternTrackBlock::hashTrack (a, 1))
+        return false;
+
+    auto block = PatternTrackBlock::compile (a, 1);
+    if (block->contentHash != PatternTrackBlock::hashTrack (a, 1)
+        || block->numRows != 16 || block->numNoteLanes != 1
+        || block->instruments != std::vector<int> { 3, 5 })
+        return false;
+
+    const auto& ops = block->lanes[0].ops;
+    if (ops.size() != 3)
+        return false;
+
+    // The glide target doesn't end the first note; the retrigger does
+    if (ops[0].row != 0 || ops[0].endRow != 8 || ops[0].portaArmed)
+        return false;
+    if (ops[1].row != 4 || ops[1].endRow != 8 || ! ops[1].portaArmed)
+        return false;
+    if (ops[2].row != 8 || ops[2].endRow != 16 || ops[2].portaArmed || ops[2].instrument != 5)
+        return false;
+    if (! block->lanes[0].portaArmedAtEnd)
+        return false;
+
+    // FX column: reset + nothing on row 0, reset + G on row 4, reset + V on row 8, G on row 12
+    using Command = TrackerEvent::Command;
+    const std::vector<std::pair<int, Command>> expected {
+        { 0, Command::RowReset }, { 4, Command::RowReset }, { 4, Command::PortaSteps },
+        { 8, Command::RowReset }, { 8, Command::Volume }, { 12, Command::PortaSteps } };
+    if (block->fxEvents.size() != expected.size())
+        return false;
+    for (size_t i = 0; i < expected.size(); ++i)
+        if (block->fxEvents[i].row != expected[i].first || block->fxEvents[i].command != expected[i].second)
+            return false;
+
+    // The block matches the cells it came from, on any track holding them
+    if (! block->matchesTrack (a, 1) || ! block->matchesTrack (b, 1) || block->matchesTrack (a, 0))
+        return false;
+
+    // Any edit changes the hash, and the block no longer matches
+    Cell changed = b.getCell (8, 1);
+    changed.volume = 100;
+    b.setCell (8, 1, changed);
+    if (block->matchesTrack (b, 1))
+        return false;
+
+    Cell fxChanged = a.getCell (12, 1);
+    fxChanged.getFxSlot (0).setSymbolicCommand ('G', 3);
+    Pattern c (16);
+    fill (c);
+    c.setCell (12, 1, fxChanged);
+    if (block->matchesTrack (c, 1) || block->matchesTrack (Pattern (32), 1))
+        return false;
+
+    // Cells the block has nothing for count too: an extra note, FX or instrument
+    auto matchesWithExtra = [&] (int row, const Cell& extra)
+    {
+        Pattern d (16);
+        fill (d);
+        d.setCell (row, 1, extra);
+        return block->matchesTrack (d, 1);
+    };
+
+    Cell extraNote;
+    extraNote.note = 70;
+    Cell extraFx;
+    extraFx.getFxSlot (0).setSymbolicCommand ('V', 0x20);
+    Cell extraInstrument;
+    extraInstrument.instrument = 9;
+    if (matchesWithExtra (2, extraNote) || matchesWithExtra (2, extraFx) || matchesWithExtra (2, extraInstrument))
+        return false;
+
+    return PatternTrackBlock::hashTrack (a, 1) != PatternTrackBlock::hashTrack (b, 1);
+}
+
+bool testPatternSequencerPlaysLikeTheClipPath()
+{
+    struct TimedMessage
+    {
+        juce::MidiMessage message;
+        double time = 0.0;
+    };
+
+    struct Sink
+    {
+        std::vector<TimedMessage> events;
+        void addEvent (const juce::MidiMessage& m, double time) { events.push_back ({ m, time }); }
+    };
+
+    // Two patterns on two lanes: notes, glides, OFF/KILL and instrument changes
+    auto makePattern = [] (int numRows, int seed)
+    {
+        Pattern pattern (numRows);
+        for (int row = 0; row < numRows; ++row)
+        {
+            const int r = (row * 7 + seed * 13) % 11;
+            Cell cell;
+            if (r < 4)
+            {
+                cell.note = 48 + (row + seed) % 24;
+                cell.instrument = r == 0 ? seed : -1;
+            }
+            else if (r == 5)
+            {
+                cell.note = 255;
+            }
+            else if (r == 6)
+            {
+                cell.note = 254;
+            }
+
+            // A glide armed on the last row carries into the next entry
+            if (r == 2 || r == 9 || row == numRows - 1)
+                cell.getFxSlot (0).setSymbolicCommand ('G', 3);
+
+            if (row % 3 == 0)
+                cell.setNoteLane (1, { 60 + row % 5, seed + 1, 100 });
+
+            pattern.setCell (row, 0, cell);
+        }
+        return pattern;
+    };
+
+    const auto patternA = makePattern (16, 1);
+    const auto patternB = makePattern (12, 2);
+
+    auto sequence = std::make_shared<PatternSequence>();
+    sequence->blocks.push_back ({});
+    sequence->blocks.push_back ({});
+    sequence->blocks[0][0] = PatternTrackBlock::compile (patternA, 0);
+    sequence->blocks[1][0] = PatternTrackBlock::compile (patternB, 0);
+    sequence->tracks[0] = { 2, true };
+
+    // A, B, A, A, with a tempo change in B: the last two As share a row timing
+    auto addTiming = [&sequence] (int numRows, int changeRow)
+    {
+        auto& rowTimes = sequence->rowTimings.emplace_back();
+        for (int row = 0; row <= numRows; ++row)
+            rowTimes.push_back (row == 0 ? 0.0 : rowTimes.back() + (row <= changeRow ? 0.125 : 0.1));
+    };
+    addTiming (16, 16);
+    addTiming (12, 4);
+    addTiming (16, 0);
+
+    size_t firstRow = 0;
+    double startTime = 0.0;
+    const std::pair<size_t, size_t> entries[] { { 0, 0 }, { 1, 1 }, { 0, 2 }, { 0, 2 } };   // pattern, row timing
+    for (const auto& [patternIndex, timingIndex] : entries)
+    {
+        sequence->placements.push_back ({ patternIndex, firstRow, timingIndex, startTime });
+        firstRow += static_cast<size_t> (sequence->blocks[patternIndex][0]->numRows);
+        startTime += sequence->rowTimings[timingIndex].back();
+    }
+
+    // The clip path: each lane through every placement, note ends emitted with their start
+    Sink expected;
+    for (int laneIdx = 0; laneIdx < 2; ++laneIdx)
+    {
+        PatternNotes::LanePlayState state;
+        for (const auto& placement : sequence->placements)
+        {
+            const auto& block = *sequence->blocks[placement.patternIndex][0];
+            const auto& rowTimes = sequence->rowTimings[placement.timingIndex];
+            if (laneIdx < block.numNoteLanes)
+            {
+                for (const auto& op : block.lanes[static_cast<size_t> (laneIdx)].ops)
+                {
+                    if (PatternNotes::playNoteOp (expected, op, laneIdx, true,
+                                                  placement.startTime + rowTimes[static_cast<size_t> (op.row)], state)
+                            == PatternNotes::OpResult::noteStarted)
+                    {
+                        PatternNotes::appendNoteEnd (expected, laneIdx, true, true, op.note,
+                                                     placement.startTime + rowTimes[static_cast<size_t> (op.endRow)]);
+                    }
+                }
+            }
+            PatternNotes::finishBlock (block, laneIdx, state);
+        }
+    }
+
+    auto byTime = [] (const TimedMessage& a, const TimedMessage& b) { return a.time < b.time; };
+    std::stable_sort (expected.events.begin(), expected.events.end(), byTime);
+
+    auto same = [] (const std::vector<TimedMessage>& a, const std::vector<TimedMessage>& b)
+    {
+        if (a.size() != b.size())
+            return false;
+        for (size_t i = 0; i < a.size(); ++i)
+            if (std::abs (a[i].time - b[i].time) > 1.0e-9
+                || a[i].message.getRawDataSize() != b[i].message.getRawDataSize()
+                || ! std::equal (a[i].message.getRawData(), a[i].message.getRawData() + a[i].message.getRawDataSize(),
+                                 b[i].message.getRawData()))
+                return false;
+        return true;
+    };
+
+    // The sequencer, block by block at a couple of block sizes, sorting each block
+    const double sampleRate = 48000.0;
+    const auto songEnd = static_cast<juce::int64> (sequence->getRowTime (sequence->getNumRows()) * sampleRate);
+
+    for (int blockSize : { 64, 480, 1024 })
+    {
+        PatternSequencer sequencer;
+        Sink played;
+        for (juce::int64 pos = 0; pos <= songEnd; pos += blockSize)
+        {
+            const auto first = played.events.size();
+            sequencer.process (*sequence, 0, pos, blockSize, sampleRate, played);
+            std::stable_sort (played.events.begin() + static_cast<std::ptrdiff_t> (first), played.events.end(), byTime);
+        }
+
+        if (! same (played.events, expected.events))
+            return false;
+    }
+
+    // Jumping into the middle replays the rows before it silently, so the
+    // second A plays exactly as it did in the full run
+    const auto secondA = sequence->placements[2].firstRow;
+    const auto jumpSample = static_cast<juce::int64> (std::llround (sequence->getRowTime (secondA) * sampleRate));
+    std::vector<TimedMessage> fromSecondA;
+    for (const auto& e : expected.events)
+        if (std::llround (e.time * sampleRate) >= jumpSample)
+            fromSecondA.push_back (e);
+
+    PatternSequencer sequencer;
+    Sink jumped;
+    for (juce::int64 pos = jumpSample; pos <= songEnd; pos += 256)
+    {
+        const auto first = jumped.events.size();
+        sequencer.process (*sequence, 0, pos, 256, sampleRate, jumped);
+        std::stable_sort (jumped.events.begin() + static_cast<std::ptrdiff_t> (first), jumped.events.end(), byTime);
+    }
+
+    // Notes held from before the jump weren't chased, so their ends don't come either
+    std::vector<TimedMessage> jumpedNotes, expectedNotes;
+    for (const auto& e : jumped.events)
+        if (e.message.isNoteOn())
+            jumpedNotes.push_back (e);
+    for (const auto& e : fromSecondA)
+        if (e.message.isNoteOn())
+            expectedNotes.push_back (e);
+
+    if (jumpedNotes.empty() || ! same (jumpedNotes, expectedNotes))
+        return false;
+
+    // A note held across a jump ends at the jump
+    PatternSequencer wrapping;
+    Sink wrapped;
+    wrapping.process (*sequence, 0, 0, 64, sampleRate, wrapped);
+    wrapped.events.clear();
+    wrapping.process (*sequence, 0, 0, 64, sampleRate, wrapped);
+    int noteOffs = 0;
+    for (const auto& e : wrapped.events)
+        if (e.message.isNoteOff() && e.time == 0.0)
+            ++noteOffs;
+
+    return noteOffs > 0;
+}
+
+bool testCuedSequenceTakesOverAtLoopWrap()
+{
+    struct Sink
+    {
+        std::vector<std::pair<int, double>> noteOns; // note, time
+        void addEvent (const juce::MidiMessage& m, double time)
+        {
+            if (m.isNoteOn())
+                noteOns.emplace_back (m.getNoteNumber(), time);
+        }
+    };
+
+    auto makeSequence = [] (int numRows, int note)
+    {
+        Pattern pattern (numRows);
+        for (int row = 0; row < numRows; row += 2)
+        {
+            Cell cell;
+            cell.note = note;
+            pattern.setCell (row, 0, cell);
+        }
+
+        auto sequence = std::make_shared<PatternSequence>();
+        sequence->blocks.push_back ({});
+        sequence->blocks[0][0] = PatternTrackBlock::compile (pattern, 0);
+        sequence->placements.push_back ({ 0, 0, 0, 0.0 });
+        auto& rowTimes = sequence->rowTimings.emplace_back();
+        for (int row = 0; row <= numRows; ++row)
+            rowTimes.push_back (row * 0.125);
+        return sequence;
+    };
+
+    using Follower = LoopCueFollower<PatternSequence>;
+    Follower::Table table;
+    table.publish (Follower::kCurrentSlot, makeSequence (8, 60));
+
+    // The transport looping over the pattern, blocks split at the loop end
+    // like the engine's, with the follower and sequencer as the plugin runs them
+    const double sampleRate = 48000.0;
+    const int blockSize = 480;
+    Follower follower;
+    PatternSequencer sequencer;
+    Sink sink;
+    juce::int64 position = 0;
+    int cuesTaken = 0;
+
+    auto play = [&] (double loopSeconds, int numBlocks)
+    {
+        const auto loopEnd = static_cast<juce::int64> (std::llround (loopSeconds * sampleRate));
+        for (int i = 0; i < numBlocks; ++i)
+        {
+            for (int remaining = blockSize; remaining > 0;)
+            {
+                const int n = static_cast<int> (std::min<juce::int64> (remaining, loopEnd - position));
+                bool tookCue = false;
+                if (auto sequence = follower.select (table, position, n, tookCue))
+                {
+                    if (tookCue)
+                    {
+                        sequence->cueStarted.store (true);
+                        ++cuesTaken;
+                    }
+                    sequencer.process (*sequence, 0, position, n, sampleRate, sink);
+                }
+
+                remaining -= n;
+                position += n;
+                if (position >= loopEnd)
+                    position = 0;
+            }
+        }
+    };
+
+    // A full loop of A and a bit, then B is cued
+    play (1.0, 120);
+    if (cuesTaken != 0 || sink.noteOns.size() != 5 || position != 0.2 * sampleRate)
+        return false;
+
+    auto cued = makeSequence (4, 72);
+    table.publish (Follower::kCuedSlot, cued);
+    sink.noteOns.clear();
+
+    // A plays out its loop, B starts on the wrap's first sample
+    play (1.0, 110);
+    if (cuesTaken != 1 || ! cued->cueStarted.load())
+        return false;
+
+    const std::vector<std::pair<int, double>> expected { { 60, 0.25 }, { 60, 0.5 }, { 60, 0.75 }, { 72, 0.0 }, { 72, 0.25 } };
+    if (sink.noteOns != expected)
+        return false;
+
+    // The writer catches up (same content, timed anew) and withdraws the cue:
+    // playback carries on without restarting B
+    table.publish (Follower::kCurrentSlot, makeSequence (4, 72));
+    table.remove (Follower::kCuedSlot);
+    sink.noteOns.clear();
+    position = static_cast<juce::int64> (0.4 * sampleRate);
+    play (0.5, 100);
+
+    if (cuesTaken != 1 || sink.noteOns.size() != 4 || sink.noteOns.front() != std::make_pair (72, 0.0))
+        return false;
+
+    // The next cue waits for the next wrap again
+    position = static_cast<juce::int64> (0.1 * sampleRate);
+    play (0.5, 10);
+    table.publish (Follower::kCuedSlot, makeSequence (4, 48));
+    sink.noteOns.clear();
+    play (0.5, 60);
+
+    const std::vector<std::pair<int, double>> next { { 72, 0.25 }, { 48, 0.0 }, { 48, 0.25 } };
+    if (cuesTaken != 2 || sink.noteOns != next)
+        return false;
+
+    // A stop forgets the position, so starting again isn't a wrap
+    follower.reset();
+    table.publish (Follower::kCurrentSlot, makeSequence (4, 72));
+    table.publish (Follower::kCuedSlot, makeSequence (4, 48));
+    position = 0;
+    sink.noteOns.clear();
+    play (0.5, 1);
+    return cuesTaken == 2 && ! sink.noteOns.empty() && sink.noteOns.front().first == 72;
+}
+
+bool testPackedPatternCellsRoundTrip()
+{
+    // Cells are packed per track column; every value a Cell can hold must
+    // come back from getCell()/getCellView() unchanged
+    Pattern pattern (4);
+
+    Cell cell;
+    cell.note = 255;        // OFF
+    cell.instrument = 255;
+    cell.volume = 0;
+    cell.setNoteLane (3, { 60, -1, 127 });   // lanes 1 and 2 present but empty
+    cell.getFxSlot (0).fxParam = 5;          // param without a command is not empty
+    cell.getFxSlot (2).setSymbolicCommand ('G', 0x10);
+    pattern.setCell (1, 5, cell);
+
+    const auto got = pattern.getCell (1, 5);
+    if (got.note != 255 || got.instrument != 255 || got.volume != 0
+        || got.getNumNoteLanes() != 4 || got.getNumFxSlots() != 3
+        || ! got.getNoteLane (1).isEmpty() || ! got.getNoteLane (2).isEmpty()
+        || got.getNoteLane (3).note != 60 || got.getNoteLane (3).instrument != -1 || got.getNoteLane (3).volume != 127
+        || got.getFxSlot (0).fxCommand != '\0' || got.getFxSlot (0).fxParam != 5
+        || got.getFxSlot (2).fxCommand != 'G' || got.getFxSlot (2).fx != 4 || got.getFxSlot (2).fxParam != 0x10)
+    {
+        std::cerr << "packed cell did not round-trip\n";
+        return false;
+    }
+
+    const auto view = pattern.getCellView (1, 5);
+    if (view.isEmpty() || view.getNumNoteLanes() != 4 || view.getNumFxSlots() != 3
+        || view.getNoteLane (3).note != 60 || view.getFxSlot (2).getCommandLetter() != 'G')
+    {
+        std::cerr << "cell view disagrees with the cell\n";
+        return false;
+    }
+
+    // Rows and tracks around it stay empty, with the default lane counts
+    const auto below = pattern.getCell (2, 5);
+    if (! pattern.getCellView (0, 5).isEmpty() || ! pattern.getCellView (1, 4).isEmpty()
+        || ! below.isEmpty() || below.getNumNoteLanes() != 1 || below.getNumFxSlots() != 1
+        || below.getNoteLane (3).note != -1)
+    {
+        std::cerr << "packing a cell leaked into its neighbours\n";
+        return false;
+    }
+
+    // Overwriting clears lanes the new cell doesn't have
+    pattern.setCell (1, 5, Cell {});
+    if (! pattern.getCellView (1, 5).isEmpty() || pattern.getCell (1, 5).getNumNoteLanes() != 1
+        || pattern.getCell (1, 5).getNoteLane (3).note != -1)
+    {
+        std::cerr << "overwritten cell kept stale lanes\n";
+        return false;
+    }
+
+    // Trimmed rows come back on regrow; copies are independent
+    Cell note;
+    note.note = 48;
+    pattern.setCell (3, 0, note);
+    pattern.resize (2);
+    pattern.resize (4);
+    Pattern copy = pattern;
+    copy.setCell (3, 0, Cell {});
+    if (pattern.getCell (3, 0).note != 48 || ! copy.getCellView (3, 0).isEmpty())
+    {
+        std::cerr << "resize or copy lost packed rows\n";
+        return false;
+    }
+
+    pattern.clear();
+    if (! pattern.getCellView (3, 0).isEmpty())
+    {
+        std::cerr << "clear left packed data\n";
+        return false;
+    }
+
+    // A one-lane note only allocates its chunk and the plane it uses
+    Pattern big (256);
+    const auto emptyBytes = big.getCellStorageBytes();
+    big.setCell (0, 0, note);
+    if (big.getCellStorageBytes() - emptyBytes != sizeof (PatternChunk) + kChunkRows * sizeof (PatternChunk::Note))
+    {
+        std::cerr << "unused lane planes were allocated\n";
+        return false;
+    }
+
+    return true;
+}
+
+bool testPatternChunksShareAndUndoRestores()
+{
+    PatternData data;
+    Cell lone;
+    lone.note = 72;
+    for (int row = 0; row < data.getPattern (0).numRows; row += 4)
+    {
+        Cell cell;
+        cell.note = 40 + row % 24;
+        cell.instrument = 1;
+        data.getPattern (0).setCell (row, 0, cell);
+    }
+    data.getPattern (0).setCell (40, 5, lone);
+
+    const int numChunks = data.getPattern (0).numRows / kChunkRows;
+    auto allChunks = [&] (const Pattern& p)
+    {
+        std::vector<std::shared_ptr<const PatternChunk>> chunks;
+        for (int t = 0; t < kNumTracks; ++t)
+            for (int c = 0; c < numChunks; ++c)
+                chunks.push_back (p.getChunk (t, c));
+        return chunks;
+    };
+    const auto original = allChunks (data.getPattern (0));
+
+    // The chunk walks visit rows in order, stop when asked and cover a part chunk
+    std::vector<int> visited;
+    data.getPattern (0).forEachNonEmptyCell (0, [&] (int row, CellView cell)
+    {
+        if (cell.getNoteLane (0).note == 40 + row % 24)
+            visited.push_back (row);
+    });
+    int allRows = 0, stoppedAt = -1;
+    data.getPattern (0).forEachCell (5, [&] (int, CellView) { ++allRows; });
+    data.getPattern (0).forEachNonEmptyCell (0, [&] (int row, CellView) { stoppedAt = row; return row < 8; });
+
+    Pattern shortPattern (20);
+    shortPattern.setCell (18, 2, lone);
+    std::vector<int> shortRows;
+    shortPattern.forEachNonEmptyCell (2, [&] (int row, CellView) { shortRows.push_back (row); });
+
+    if (visited.size() != static_cast<size_t> (data.getPattern (0).numRows / 4) || visited[1] != 4
+        || allRows != data.getPattern (0).numRows || stoppedAt != 8 || shortRows != std::vector<int> { 18 })
+    {
+        std::cerr << "chunk walk visited " << visited.size() << " notes, " << allRows << " rows, stopped at "
+                  << stoppedAt << "\n";
+        return false;
+    }
+
+    // A duplicate shares every chunk until it's edited, then only the edited one differs
+    data.duplicatePattern (0);
+    auto& copy = data.getPattern (1);
+    if (allChunks (copy) != original)
+    {
+        std::cerr << "duplicate didn't share the pattern's chunks\n";
+        return false;
+    }
+    copy.setCell (4, 0, lone);
+    int differing = 0;
+    const auto copyChunks = allChunks (copy);
+    for (size_t i = 0; i < original.size(); ++i)
+        differing += copyChunks[i] != original[i] ? 1 : 0;
+    if (differing != 1 || allChunks (data.getPattern (0)) != original || data.getPattern (0).getCell (4, 0).note != 44)
+    {
+        std::cerr << "editing the duplicate copied " << differing << " chunks or touched the original\n";
+        return false;
+    }
+
+    auto& pattern = data.getPattern (0);
+
+    // Transpose track 0 and move the lone note: one undo step holding only the touched chunks
+    juce::UndoManager undoManager;
+    std::vector<MultiCellEditAction::CellRecord> records;
+    for (int row = 0; row < pattern.numRows; ++row)
+    {
+        auto cell = pattern.getCell (row, 0);
+        auto transposed = cell;
+        if (transposed.note >= 0)
+            transposed.note += 12;
+        records.push_back ({ row, 0, cell, transposed });
+    }
+    records.push_back ({ 40, 5, lone, Cell {} });
+
+    auto* action = new MultiCellEditAction (data, 0, std::move (records));
+    undoManager.beginNewTransaction();
+    undoManager.perform (action);
+
+    if (pattern.getCell (8, 0).note != 40 + 8 + 12 || ! pattern.getCellView (40, 5).isEmpty())
+    {
+        std::cerr << "edit not applied\n";
+        return false;
+    }
+    if (action->getSizeInUnits() > static_cast<int> (pattern.numRows * sizeof (Cell)))
+    {
+        std::cerr << "undo step holds " << action->getSizeInUnits() << " bytes, more than one copy of the cells\n";
+        return false;
+    }
+
+    undoManager.undo();
+    if (allChunks (pattern) != original)
+    {
+        std::cerr << "undo didn't put the original chunks back\n";
+        return false;
+    }
+
+    undoManager.redo();
+    if (pattern.getCell (8, 0).note != 40 + 8 + 12 || ! pattern.getCellView (40, 5).isEmpty())
+    {
+        std::cerr << "redo didn't reapply the edit\n";
+        return false;
+    }
+
+    // A change made outside the undo manager in a touched chunk survives undo
+    pattern.setCell (34, 5, lone);
+    undoManager.undo();
+    if (pattern.getCell (40, 5).note != 72 || pattern.getCell (34, 5).note != 72 || pattern.getCell (8, 0).note != 40 + 8)
+    {
+        std::cerr << "undo over an outside change lost a cell\n";
+        return false;
+    }
+
+    // The unit limit caps the history's memory
+    juce::UndoManager capped;
+    capped.setMaxNumberOfStoredUnits (1, 1);
+    for (int step = 0; step < 3; ++step)
+    {
+        capped.beginNewTransaction();
+        capped.perform (new MultiCellEditAction (data, 0, { { step, 1, Cell {}, lone } }));
+    }
+    int undoSteps = 0;
+    while (capped.undo())
+        ++undoSteps;
+    if (undoSteps != 1 || pattern.getCell (2, 1).note != -1 || pattern.getCell (0, 1).note != 72)
+    {
+        std::cerr << "memory-capped history kept " << undoSteps << " steps\n";
+        return false;
+    }
+
+    return true;
+}
+
 } // namespace
 
 int main()
@@ -4569,7 +7076,8 @@ int main()
         { "PatternRoundTripNoExtraPattern", &testPatternRoundTripNoExtraPattern },
         { "SinglePatternRoundTripStaysSingle", &testSinglePatternRoundTripStaysSingle },
         { "SendBuffersStartSampleAlignmentAndConsume", &testSendBuffersStartSampleAlignmentAndConsume },
-        { "SendBuffersAutoResizeForLargeWrites", &testSendBuffersAutoResizeForLargeWrites },
+        { "SendBuffersSmallerPrepareKeepsCapacity", &testSendBuffersSmallerPrepareKeepsCapacity },
+        { "SendBuffersTruncateWritesPastCapacity", &testSendBuffersTruncateWritesPastCapacity },
         { "PanMappingCenterAndExtremes", &testPanMappingCenterAndExtremes },
         { "InstrumentRoutingRoundTripFullRange", &testInstrumentRoutingRoundTripFullRange },
         { "InstrumentRoutingClampsOutOfRange", &testInstrumentRoutingClampsOutOfRange },
@@ -4632,6 +7140,33 @@ int main()
         { "PluginAutomationPreservesParameterSelection", &testPluginAutomationPreservesParameterSelection },
         { "PluginAutomationMultiPluginTrack", &testPluginAutomationMultiPluginTrack },
         { "TrackerGridClampsCursorNoteLaneOnTrackChange", &testTrackerGridClampsCursorNoteLaneOnTrackChange },
+        { "InstrumentSnapshotPublishAndAcquire", &testInstrumentSnapshotPublishAndAcquire },
+        { "InstrumentSnapshotRetiredWhileHeld", &testInstrumentSnapshotRetiredWhileHeld },
+        { "PatternRevisionTracksEditedTracksOnly", &testPatternRevisionTracksEditedTracksOnly },
+        { "CompiledAutomationCurveMatchesLane", &testCompiledAutomationCurveMatchesLane },
+        { "ThreeBandEQMatchesJuceFilters", &testThreeBandEQMatchesJuceFilters },
+        { "ThreeBandEQRampsAndBypasses", &testThreeBandEQRampsAndBypasses },
+        { "SendBuffersPerTrackSlotsSum", &testSendBuffersPerTrackSlotsSum },
+        { "GlobalModStateAdvanceStepsGlobalEnvelopesOnly", &testGlobalModStateAdvanceStepsGlobalEnvelopesOnly },
+        { "SendBuffersWorkerThreadProducersLandInTheirBlock", &testSendBuffersWorkerThreadProducersLandInTheirBlock },
+        { "SampleBankStorageFormatsMatchDecodedAudio", &testSampleBankStorageFormatsMatchDecodedAudio },
+        { "SampleBankLoadReportsProgressAndCancels", &testSampleBankLoadReportsProgressAndCancels },
+        { "BinaryProjectStoresSharedSamplesOnceAndExtractsMissing", &testBinaryProjectStoresSharedSamplesOnceAndExtractsMissing },
+        { "BankTableSwapsEntriesWhileReadersAcquire", &testBankTableSwapsEntriesWhileReadersAcquire },
+        { "SampleResamplerQualitiesAndBlockRender", &testSampleResamplerQualitiesAndBlockRender },
+        { "SamplerVoicePoolAllocatesPerLaneAndSteals", &testSamplerVoicePoolAllocatesPerLaneAndSteals },
+        { "GranularCloudMatchesSingleGrainAndOverlaps", &testGranularCloudMatchesSingleGrainAndOverlaps },
+        { "SampleMipMapsBandLimitHighTranspositions", &testSampleMipMapsBandLimitHighTranspositions },
+        { "MipMapBudgetIsSharedAcrossBanks", &testMipMapBudgetIsSharedAcrossBanks },
+        { "ControlRateOutputIsBlockSizeIndependent", &testControlRateOutputIsBlockSizeIndependent },
+        { "TrackerEventRangesCoverEachEventOnce", &testTrackerEventRangesCoverEachEventOnce },
+        { "SilenceGateSleepsOnlyAfterTail", &testSilenceGateSleepsOnlyAfterTail },
+        { "DynamicsKernelsMatchReferenceAndCatchPeaks", &testDynamicsKernelsMatchReferenceAndCatchPeaks },
+        { "PatternTrackBlockSharedByContentAndResolvesNoteEnds", &testPatternTrackBlockSharedByContentAndResolvesNoteEnds },
+        { "PatternSequencerPlaysLikeTheClipPath", &testPatternSequencerPlaysLikeTheClipPath },
+        { "CuedSequenceTakesOverAtLoopWrap", &testCuedSequenceTakesOverAtLoopWrap },
+        { "PackedPatternCellsRoundTrip", &testPackedPatternCellsRoundTrip },
+        { "PatternChunksShareAndUndoRestores", &testPatternChunksShareAndUndoRestores },
     };
 
     int failures = 0;